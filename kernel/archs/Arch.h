@@ -6,6 +6,8 @@
 
 #include "system/memory/MemoryRange.h"
 
+#define ARCH_MAX_PROCESSORS 16
+
 struct Task;
 
 namespace Arch
@@ -15,6 +17,8 @@ void disable_interrupts();
 
 void enable_interrupts();
 
+bool interrupts_enabled();
+
 void halt();
 
 void yield();
@@ -29,6 +33,18 @@ size_t debug_write(const void *buffer, size_t size);
 
 TimeStamp get_time();
 
+uint64_t get_cycles();
+
+void processors_initialize();
+
+int processor_count();
+
+int processor_current();
+
+void processor_reschedule(int processor);
+
+void processor_relax();
+
 NO_RETURN void reboot();
 
 NO_RETURN void shutdown();
@@ -59,6 +75,7 @@ uintptr_t virtual_to_physical(AddressSpace *address_space, uintptr_t virtual_add
 
 HjResult virtual_map(AddressSpace *address_space, MemoryRange physical_range, uintptr_t virtual_address, MemoryFlags flags);
 
+// Maps the physical range anywhere in the kernel half.
 MemoryRange virtual_alloc(AddressSpace *address_space, MemoryRange physical_range, MemoryFlags flags);
 
 void virtual_free(AddressSpace *address_space, MemoryRange virtual_range);
@@ -19,6 +19,8 @@ void disable_interrupts() { x86::cli(); }
 
 void enable_interrupts() { x86::sti(); }
 
+bool interrupts_enabled() { return x86::eflags() & 0x200; }
+
 void halt() { x86::hlt(); }
 
 void yield() { asm("int $127"); }
@@ -79,6 +81,20 @@ size_t debug_write(const void *buffer, size_t size) { return com_write(COM1, buf
 
 TimeStamp get_time() { return rtc_now(); }
 
+// Application processors are only brought up on x86_64.
+
+void processors_initialize() {}
+
+int processor_count() { return 1; }
+
+int processor_current() { return 0; }
+
+void processor_reschedule(int processor) { UNUSED(processor); }
+
+void processor_relax() { asm volatile("pause"); }
+
+uint64_t get_cycles() { return x86::rdtsc(); }
+
 NO_RETURN void reboot()
 {
     early_console_enable();
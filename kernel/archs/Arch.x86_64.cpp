@@ -2,11 +2,13 @@
 #include "archs/x86/COM.h"
 #include "archs/x86/CPUID.h"
 #include "archs/x86/FPU.h"
+#include "archs/x86/LAPIC.h"
 #include "archs/x86/Power.h"
 #include "archs/x86/RTC.h"
 #include "archs/x86_64/GDT.h"
 #include "archs/x86_64/Interrupts.h"
 #include "archs/x86_64/Paging.h"
+#include "archs/x86_64/SMP.h"
 #include "archs/x86_64/x86_64.h"
 
 namespace Arch
@@ -16,6 +18,8 @@ void disable_interrupts() { x86::cli(); }
 
 void enable_interrupts() { x86::sti(); }
 
+bool interrupts_enabled() { return x86::eflags() & 0x200; }
+
 void halt()
 {
     x86::hlt();
@@ -81,6 +85,37 @@ TimeStamp get_time()
     return rtc_now();
 }
 
+uint64_t get_cycles()
+{
+    return x86::rdtsc();
+}
+
+void processors_initialize()
+{
+    x86_64::smp_initialize();
+}
+
+int processor_count()
+{
+    return x86_64::smp_processor_count();
+}
+
+int processor_current()
+{
+    return x86::lapic_processor_current();
+}
+
+void processor_reschedule(int processor)
+{
+    x86::lapic_send_ipi(processor, x86::LAPIC_RESCHEDULE_VECTOR);
+}
+
+void processor_relax()
+{
+    x86_64::tlb_shootdown_acknowledge();
+    asm volatile("pause");
+}
+
 NO_RETURN void reboot()
 {
     early_console_enable();
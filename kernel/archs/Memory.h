@@ -4,6 +4,27 @@
 #    define ARCH_PAGE_SIZE (4096)
 #endif
 
+// The first GiB of every address space belongs to the kernel, the task gets
+// the rest of the lower half.
+#define ARCH_KERNEL_MEMORY_END (0x40000000)
+
+#define ARCH_USER_MEMORY_START ARCH_KERNEL_MEMORY_END
+
+#ifdef __x86_64__
+#    define ARCH_USER_MEMORY_END (0x800000000000)
+#else
+#    define ARCH_USER_MEMORY_END (0x100000000)
+#endif
+
+// Ranges at least this big are placed on a boundary of this size, so the
+// arch can map them with large pages when the memory behind them is aligned
+// the same way.
+#ifdef __x86_64__
+#    define ARCH_LARGE_PAGE_SIZE (0x200000)
+#else
+#    define ARCH_LARGE_PAGE_SIZE ARCH_PAGE_SIZE
+#endif
+
 #define PAGE_ALIGN(__x) ((__x) + ARCH_PAGE_SIZE - ((__x) % ARCH_PAGE_SIZE))
 
 #define PAGE_ALIGN_UP(__x)       \
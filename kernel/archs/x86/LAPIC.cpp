@@ -1,19 +1,83 @@
+#include <assert.h>
+
 #include "system/Streams.h"
+#include "system/memory/MMIO.h"
+#include "system/system/System.h"
 
+#include "archs/Arch.h"
 #include "archs/x86/LAPIC.h"
-#include "archs/x86/PIC.h"
 
 namespace Arch::x86
 {
 
+constexpr int LAPIC_ID = 0x0020;
 constexpr int LAPIC_EOI = 0x00B0;
+constexpr int LAPIC_SPURIOUS = 0x00F0;
+constexpr int LAPIC_ICR_LOW = 0x0300;
+constexpr int LAPIC_ICR_HIGH = 0x0310;
+constexpr int LAPIC_TIMER = 0x0320;
+constexpr int LAPIC_TIMER_INITIAL = 0x0380;
+constexpr int LAPIC_TIMER_CURRENT = 0x0390;
+constexpr int LAPIC_TIMER_DIVIDE = 0x03E0;
+
+constexpr uint32_t LAPIC_ENABLE = 0x100;
+
+constexpr uint32_t LAPIC_ICR_INIT = 0x500;
+constexpr uint32_t LAPIC_ICR_STARTUP = 0x600;
+constexpr uint32_t LAPIC_ICR_PENDING = 0x1000;
+constexpr uint32_t LAPIC_ICR_ASSERT = 0x4000;
+constexpr uint32_t LAPIC_ICR_OTHERS = 0xC0000;
+
+constexpr uint32_t LAPIC_TIMER_PERIODIC = 0x20000;
+constexpr uint32_t LAPIC_TIMER_MASKED = 0x10000;
+constexpr uint32_t LAPIC_TIMER_DIVIDE_BY_16 = 0x3;
 
-static volatile uint32_t *lapic = nullptr;
+static uintptr_t _lapic_address = 0;
+static volatile uint8_t *lapic = nullptr;
+
+static int _processor_count = 0;
+static uint8_t _processor_apic_ids[ARCH_MAX_PROCESSORS] = {};
+static uint8_t _apic_id_processors[256] = {};
+
+static uint8_t bootstrap_apic_id()
+{
+    uint32_t eax = 1, ebx, ecx = 0, edx;
+    asm volatile("cpuid"
+                 : "+a"(eax), "=b"(ebx), "+c"(ecx), "=d"(edx));
+
+    return ebx >> 24;
+}
 
 void lapic_found(uintptr_t address)
 {
-    lapic = reinterpret_cast<uint32_t *>(address);
-    Kernel::logln("LAPIC found at {08x}", lapic);
+    _lapic_address = address;
+    Kernel::logln("LAPIC found at {08x}", address);
+}
+
+void lapic_processor_found(uint8_t apic_id)
+{
+    if (_processor_count == 0)
+    {
+        // The bootstrap processor is always processor 0, whatever its
+        // position in the MADT.
+        _processor_apic_ids[0] = bootstrap_apic_id();
+        _processor_count = 1;
+    }
+
+    if (apic_id == _processor_apic_ids[0])
+    {
+        return;
+    }
+
+    if (_processor_count == ARCH_MAX_PROCESSORS)
+    {
+        Kernel::logln("Too many processors, ignoring apic_id={}", apic_id);
+        return;
+    }
+
+    _processor_apic_ids[_processor_count] = apic_id;
+    _apic_id_processors[apic_id] = _processor_count;
+    _processor_count++;
 }
 
 uint32_t lapic_read(uint32_t reg)
@@ -33,9 +97,115 @@ void lapic_ack()
 
 void lapic_initialize()
 {
-    pic_disable();
+    if (_lapic_address == 0)
+    {
+        return;
+    }
+
+    // The legacy PIC stays in charge of the device IRQs (they reach the
+    // bootstrap processor through LINT0), the local APIC is only used for
+    // its timer and for inter-processor interrupts.
+    auto *range = new MMIORange(MemoryRange{_lapic_address, ARCH_PAGE_SIZE});
+    lapic = reinterpret_cast<volatile uint8_t *>(range->base());
+
+    lapic_enable();
+}
+
+void lapic_enable()
+{
+    lapic_write(LAPIC_SPURIOUS, LAPIC_ENABLE | LAPIC_SPURIOUS_VECTOR);
+}
+
+/* --- Processors ----------------------------------------------------------- */
+
+int lapic_processor_count()
+{
+    return MAX(_processor_count, 1);
+}
+
+int lapic_processor_current()
+{
+    if (lapic == nullptr)
+    {
+        return 0;
+    }
+
+    return _apic_id_processors[lapic_read(LAPIC_ID) >> 24];
+}
+
+uint8_t lapic_processor_apic_id(int processor)
+{
+    return _processor_apic_ids[processor];
+}
+
+/* --- Inter-processor interrupts ------------------------------------------- */
+
+static void lapic_send(uint32_t destination, uint32_t command)
+{
+    lapic_write(LAPIC_ICR_HIGH, destination << 24);
+    lapic_write(LAPIC_ICR_LOW, command);
+
+    while (lapic_read(LAPIC_ICR_LOW) & LAPIC_ICR_PENDING)
+    {
+        asm volatile("pause");
+    }
+}
+
+void lapic_send_ipi(int processor, int vector)
+{
+    lapic_send(_processor_apic_ids[processor], vector);
+}
+
+void lapic_send_ipi_others(int vector)
+{
+    lapic_send(0, LAPIC_ICR_OTHERS | vector);
+}
+
+void lapic_send_init(int processor)
+{
+    lapic_send(_processor_apic_ids[processor], LAPIC_ICR_INIT | LAPIC_ICR_ASSERT);
+}
+
+void lapic_send_startup(int processor, uintptr_t address)
+{
+    assert(address < 0x100000 && IS_PAGE_ALIGN(address));
+
+    lapic_send(_processor_apic_ids[processor], LAPIC_ICR_STARTUP | LAPIC_ICR_ASSERT | (address / ARCH_PAGE_SIZE));
+}
+
+/* --- Timer ---------------------------------------------------------------- */
+
+uint32_t lapic_timer_calibrate(int milliseconds)
+{
+    lapic_write(LAPIC_TIMER_DIVIDE, LAPIC_TIMER_DIVIDE_BY_16);
+    lapic_write(LAPIC_TIMER, LAPIC_TIMER_MASKED);
 
-    lapic_write(0xF0, lapic_read(0xF0) | 0x100);
+    // Align on a tick edge to get a full measurement window.
+    auto tick = system_get_tick();
+    while (system_get_tick() == tick)
+    {
+        asm volatile("pause");
+    }
+
+    lapic_write(LAPIC_TIMER_INITIAL, 0xFFFFFFFF);
+
+    tick = system_get_tick();
+    while (system_get_tick() - tick < (uint32_t)milliseconds)
+    {
+        asm volatile("pause");
+    }
+
+    uint32_t elapsed = 0xFFFFFFFF - lapic_read(LAPIC_TIMER_CURRENT);
+    lapic_write(LAPIC_TIMER_INITIAL, 0);
+
+    return elapsed / milliseconds;
+}
+
+void lapic_timer_start(uint32_t ticks)
+{
+    lapic_write(LAPIC_TIMER_DIVIDE, LAPIC_TIMER_DIVIDE_BY_16);
+    lapic_write(LAPIC_TIMER, LAPIC_TIMER_PERIODIC | LAPIC_TIMER_VECTOR);
+    lapic_write(LAPIC_TIMER_INITIAL, ticks);
 }
 
 } // namespace Arch::x86
@@ -5,10 +5,43 @@
 namespace Arch::x86
 {
 
+constexpr int LAPIC_TIMER_VECTOR = 48;
+constexpr int LAPIC_RESCHEDULE_VECTOR = 49;
+constexpr int LAPIC_TLB_SHOOTDOWN_VECTOR = 50;
+constexpr int LAPIC_SPURIOUS_VECTOR = 255;
+
 void lapic_found(uintptr_t address);
 
+void lapic_processor_found(uint8_t apic_id);
+
 void lapic_initialize();
 
+void lapic_enable();
+
 void lapic_ack();
 
+/* --- Processors ----------------------------------------------------------- */
+
+int lapic_processor_count();
+
+int lapic_processor_current();
+
+uint8_t lapic_processor_apic_id(int processor);
+
+/* --- Inter-processor interrupts ------------------------------------------- */
+
+void lapic_send_ipi(int processor, int vector);
+
+void lapic_send_ipi_others(int vector);
+
+void lapic_send_init(int processor);
+
+void lapic_send_startup(int processor, uintptr_t address);
+
+/* --- Timer ---------------------------------------------------------------- */
+
+uint32_t lapic_timer_calibrate(int milliseconds);
+
+void lapic_timer_start(uint32_t ticks);
+
 } // namespace Arch::x86
@@ -51,10 +51,27 @@ static inline CRRegister CR4()
     return r;
 }
 
+static inline CRRegister eflags()
+{
+    CRRegister r;
+    asm volatile("pushf\n"
+                 "pop %0"
+                 : "=r"(r));
+    return r;
+}
+
 static inline void cli() { asm volatile("cli"); }
 
 static inline void sti() { asm volatile("sti"); }
 
 static inline void hlt() { asm volatile("hlt"); }
 
+static inline uint64_t rdtsc()
+{
+    uint32_t low, high;
+    asm volatile("rdtsc"
+                 : "=a"(low), "=d"(high));
+    return ((uint64_t)high << 32) | low;
+}
+
 } // namespace Arch::x86
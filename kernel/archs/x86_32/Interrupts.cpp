@@ -3,9 +3,11 @@
 
 #include "system/interrupts/Dispatcher.h"
 #include "system/interrupts/Interupts.h"
+#include "system/memory/Memory.h"
 #include "system/scheduling/Scheduler.h"
 #include "system/system/System.h"
 #include "system/tasking/Syscalls.h"
+#include "system/tasking/Task-Memory.h"
 
 #include "archs/x86/PIC.h"
 #include "archs/x86_32/Interrupts.h"
@@ -49,13 +51,86 @@ static const char *_exception_messages[32] = {
     "Reserved",
 };
 
+static constexpr int PAGE_FAULT = 14;
+
+// The access was a write.
+static constexpr uint32_t PAGE_FAULT_WRITE = 0b10;
+
+// Pages of the task that were never touched get their memory and writes to
+// copy-on-write pages give the task its own copy, the access then goes
+// through when we return.
+static bool resolve_page_fault(uint32_t err)
+{
+    uintptr_t address = x86::CR2();
+    Task *task = scheduler_running();
+
+    // Resolving it takes the memory lock, a fault while holding it is a bug
+    // of the memory code itself.
+    return task && !memory_lock().held() && task_memory_fault(task, address, err & PAGE_FAULT_WRITE);
+}
+
+// The kernel was touching the memory of the task on its behalf, like the
+// arguments of a syscall, when the access failed. It's the task that gets
+// cancelled, not the system.
+static bool is_task_memory_fault(uintptr_t intno)
+{
+    uint64_t address = x86::CR2();
+    Task *task = scheduler_running();
+
+    return intno == PAGE_FAULT &&
+           address >= ARCH_USER_MEMORY_START && address < ARCH_USER_MEMORY_END &&
+           task && (task->_flags & TASK_USER) &&
+           !interrupts_retained();
+}
+
+// The child returns from the syscall like the parent does, with the same
+// registers, only the pid it finds differs.
+static HjResult process_clone(UserInterruptStackFrame *stackframe)
+{
+    Task *parent = scheduler_running();
+    int *pid = (int *)stackframe->ebx;
+
+    if (!task_memory_validate(parent, (uintptr_t)pid, sizeof(int), true))
+    {
+        return ERR_BAD_ADDRESS;
+    }
+
+    *pid = 0;
+
+    Task *child = nullptr;
+
+    {
+        InterruptsRetainer retainer;
+
+        child = task_clone(parent, stackframe->user_esp, stackframe->eip, stackframe->ecx | TASK_USER);
+
+        // Nothing schedules the child before we let go of the giant lock.
+        auto *child_stackframe = (UserInterruptStackFrame *)child->kernel_stack_pointer;
+        *child_stackframe = *stackframe;
+        child_stackframe->eax = SUCCESS;
+    }
+
+    // The memory of the task is copy-on-write now, this is where the
+    // parent and the child start to see different values.
+    *pid = child->id;
+
+    return SUCCESS;
+}
+
 extern "C" uint32_t interrupts_handler(uintptr_t esp, InterruptStackFrame stackframe)
 {
+    // The kernel also writes to the memory of tasks while it holds
+    // interrupts, when it fills a buffer for them.
+    if (stackframe.intno == PAGE_FAULT && resolve_page_fault(stackframe.err))
+    {
+        return esp;
+    }
+
     ASSERT_INTERRUPTS_NOT_RETAINED();
 
     if (stackframe.intno < 32)
     {
-        if (stackframe.cs == 0x1B)
+        if (stackframe.cs == 0x1B || is_task_memory_fault(stackframe.intno))
         {
             x86::sti();
 
@@ -117,17 +192,7 @@ extern "C" uint32_t interrupts_handler(uintptr_t esp, InterruptStackFrame stackf
 
         if (syscall == HJ_PROCESS_CLONE)
         {
-            InterruptsRetainer retainer;
-
-            auto usf = ((UserInterruptStackFrame *)&stackframe);
-
-            *((int *)stackframe.ebx) = 0;
-
-            auto child = task_clone(scheduler_running(), usf->user_esp, usf->eip, usf->ecx | TASK_USER);
-
-            *((int *)stackframe.ebx) = child->id;
-
-            stackframe.eax = SUCCESS;
+            stackframe.eax = process_clone((UserInterruptStackFrame *)&stackframe);
         }
         else
         {
@@ -23,6 +23,7 @@ __interrupt%1:
 %endmacro
 
 extern interrupts_handler
+extern scheduler_did_switch
 
 __interrupt_common:
     cld
@@ -47,6 +48,8 @@ __interrupt_common:
 
     mov esp, eax
 
+    call scheduler_did_switch
+
     pop gs
     pop fs
     pop es
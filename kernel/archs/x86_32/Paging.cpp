@@ -42,7 +42,7 @@ PageDirectory *kernel_page_directory()
 
 bool virtual_present(PageDirectory *page_directory, uintptr_t virtual_address)
 {
-    ASSERT_INTERRUPTS_RETAINED();
+    SpinlockHolder holder{memory_lock()};
 
     int page_directory_index = PAGE_DIRECTORY_INDEX(virtual_address);
     PageDirectoryEntry &page_directory_entry = page_directory->entries[page_directory_index];
@@ -62,7 +62,7 @@ bool virtual_present(PageDirectory *page_directory, uintptr_t virtual_address)
 
 uintptr_t virtual_to_physical(PageDirectory *page_directory, uintptr_t virtual_address)
 {
-    ASSERT_INTERRUPTS_RETAINED();
+    SpinlockHolder holder{memory_lock()};
 
     int page_directory_index = PAGE_DIRECTORY_INDEX(virtual_address);
     PageDirectoryEntry &page_directory_entry = page_directory->entries[page_directory_index];
@@ -87,7 +87,7 @@ uintptr_t virtual_to_physical(PageDirectory *page_directory, uintptr_t virtual_a
 
 HjResult virtual_map(PageDirectory *page_directory, MemoryRange physical_range, uintptr_t virtual_address, MemoryFlags flags)
 {
-    ASSERT_INTERRUPTS_RETAINED();
+    SpinlockHolder holder{memory_lock()};
 
     for (size_t i = 0; i < physical_range.size() / ARCH_PAGE_SIZE; i++)
     {
@@ -111,11 +111,13 @@ HjResult virtual_map(PageDirectory *page_directory, MemoryRange physical_range,
         PageTableEntry &page_table_entry = page_table->entries[page_table_index];
 
         page_table_entry.Present = 1;
-        page_table_entry.Write = 1;
+        page_table_entry.Write = !(flags & MEMORY_READONLY);
         page_table_entry.User = flags & MEMORY_USER;
         page_table_entry.PageFrameNumber = (physical_range.base() + offset) >> 12;
     }
 
+    memory_kernel_space_set_used({virtual_address, physical_range.size()});
+
     paging_invalidate_tlb();
 
     return SUCCESS;
@@ -123,46 +125,22 @@ HjResult virtual_map(PageDirectory *page_directory, MemoryRange physical_range,
 
 MemoryRange virtual_alloc(PageDirectory *page_directory, MemoryRange physical_range, MemoryFlags flags)
 {
-    ASSERT_INTERRUPTS_RETAINED();
-
-    bool is_user_memory = flags & MEMORY_USER;
+    SpinlockHolder holder{memory_lock()};
 
-    uintptr_t virtual_address = 0;
-    size_t current_size = 0;
+    // Only the kernel half is shared, the memory of tasks is placed by the
+    // tasks themselves.
+    assert(!(flags & MEMORY_USER));
 
-    // we skip the first page to make null deref trigger a page fault
-    for (size_t i = (is_user_memory ? 256 : 1) * 1024; i < (is_user_memory ? 1024 : 256) * 1024; i++)
-    {
-        uintptr_t current_address = i * ARCH_PAGE_SIZE;
+    auto virtual_range = memory_kernel_space_find(physical_range.size());
 
-        if (!virtual_present(page_directory, current_address))
-        {
-            if (current_size == 0)
-            {
-                virtual_address = current_address;
-            }
-
-            current_size += ARCH_PAGE_SIZE;
-
-            if (current_size == physical_range.size())
-            {
-                assert(SUCCESS == virtual_map(page_directory, physical_range, virtual_address, flags));
+    assert(SUCCESS == virtual_map(page_directory, physical_range, virtual_range.base(), flags));
 
-                return {virtual_address, current_size};
-            }
-        }
-        else
-        {
-            current_size = 0;
-        }
-    }
-
-    system_panic("Out of virtual memory!");
+    return virtual_range;
 }
 
 void virtual_free(PageDirectory *page_directory, MemoryRange virtual_range)
 {
-    ASSERT_INTERRUPTS_RETAINED();
+    SpinlockHolder holder{memory_lock()};
 
     for (size_t i = 0; i < virtual_range.size() / ARCH_PAGE_SIZE; i++)
     {
@@ -187,13 +165,13 @@ void virtual_free(PageDirectory *page_directory, MemoryRange virtual_range)
         }
     }
 
+    memory_kernel_space_set_free(virtual_range);
+
     paging_invalidate_tlb();
 }
 
 PageDirectory *page_directory_create()
 {
-    InterruptsRetainer retainer;
-
     PageDirectory *page_directory = nullptr;
 
     if (memory_alloc(kernel_page_directory(), sizeof(PageDirectory), MEMORY_CLEAR, (uintptr_t *)&page_directory) != SUCCESS)
@@ -221,7 +199,7 @@ PageDirectory *page_directory_create()
 
 void page_directory_destroy(PageDirectory *page_directory)
 {
-    InterruptsRetainer retainer;
+    SpinlockHolder holder{memory_lock()};
 
     assert(page_directory != kernel_page_directory());
 
@@ -256,7 +234,7 @@ void page_directory_destroy(PageDirectory *page_directory)
 
 void page_directory_switch(PageDirectory *page_directory)
 {
-    InterruptsRetainer retainer;
+    SpinlockHolder holder{memory_lock()};
     paging_load_directory(virtual_to_physical(kernel_page_directory(), (uintptr_t)page_directory));
 }
 
@@ -2,8 +2,10 @@ section .text
 
 global paging_enable
 paging_enable:
+    ; Paging and write protection, so the kernel also faults when it writes
+    ; to a copy-on-write page.
     mov eax, cr0
-    or eax, 0x80000000
+    or eax, 0x80010000
     mov cr0, eax
     ret
 
@@ -8,6 +8,8 @@
 #include "archs/x86_64/IDT.h"
 #include "system/graphics/Graphics.h"
 
+#include "acpi/ACPI.h"
+
 namespace Arch::x86_64
 {
 
@@ -33,6 +35,8 @@ extern "C" void arch_x86_64_entry(void *info, uint32_t magic)
     fpu_initialize();
     pit_initialize(1000);
 
+    Acpi::initialize(handover);
+
     system_main(handover);
 
     ASSERT_NOT_REACHED();
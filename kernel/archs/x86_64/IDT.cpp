@@ -15,14 +15,21 @@ IDT64Descriptor idt_descriptor = {
 
 void idt_initialize()
 {
-    for (int i = 0; i < 48; i++)
+    // Exceptions, legacy IRQs and the local APIC vectors.
+    for (int i = 0; i < 51; i++)
     {
         idt[i] = IDT64Entry(__interrupt_vector[i], 0, INTGATE);
     }
 
-    idt[127] = IDT64Entry(__interrupt_vector[48], 0, INTGATE);
-    idt[128] = IDT64Entry(__interrupt_vector[49], 0, INTGATE | IDT_USER);
+    idt[127] = IDT64Entry(__interrupt_vector[51], 0, INTGATE);
+    idt[128] = IDT64Entry(__interrupt_vector[52], 0, INTGATE | IDT_USER);
+    idt[255] = IDT64Entry(__interrupt_vector[53], 0, INTGATE);
 
+    idt_load();
+}
+
+void idt_load()
+{
     idt_flush((uint64_t)&idt_descriptor);
 }
 
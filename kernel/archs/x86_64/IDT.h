@@ -47,4 +47,6 @@ extern "C" void idt_flush(uint64_t);
 
 void idt_initialize();
 
+void idt_load();
+
 } // namespace Arch::x86_64
@@ -2,13 +2,17 @@
 
 #include "system/interrupts/Dispatcher.h"
 #include "system/interrupts/Interupts.h"
+#include "system/memory/Memory.h"
 #include "system/scheduling/Scheduler.h"
 #include "system/system/System.h"
 #include "system/tasking/Syscalls.h"
+#include "system/tasking/Task-Memory.h"
 
+#include "archs/x86/LAPIC.h"
 #include "archs/x86/PIC.h"
 
 #include "archs/x86_64/Interrupts.h"
+#include "archs/x86_64/SMP.h"
 #include "archs/x86_64/x86_64.h"
 
 namespace Arch::x86_64
@@ -49,13 +53,84 @@ static const char *_exception_messages[32] = {
     "Reserved",
 };
 
+static constexpr int PAGE_FAULT = 14;
+
+// The access was a write.
+static constexpr uint64_t PAGE_FAULT_WRITE = 0b10;
+
+// Pages of the task that were never touched get their memory and writes to
+// copy-on-write pages give the task its own copy, the access then goes
+// through when we return.
+static bool resolve_page_fault(uint64_t err)
+{
+    uintptr_t address = x86::CR2();
+    Task *task = scheduler_running();
+
+    // Resolving it takes the memory lock, a fault while holding it is a bug
+    // of the memory code itself.
+    return task && !memory_lock().held() && task_memory_fault(task, address, err & PAGE_FAULT_WRITE);
+}
+
+// The kernel was touching the memory of the task on its behalf, like the
+// arguments of a syscall, when the access failed. It's the task that gets
+// cancelled, not the system.
+static bool is_task_memory_fault(uintptr_t intno)
+{
+    uint64_t address = x86::CR2();
+    Task *task = scheduler_running();
+
+    return intno == PAGE_FAULT &&
+           address >= ARCH_USER_MEMORY_START && address < ARCH_USER_MEMORY_END &&
+           task && (task->_flags & TASK_USER) &&
+           !interrupts_retained();
+}
+
+// The child returns from the syscall like the parent does, with the same
+// registers, only the pid it finds differs.
+static HjResult process_clone(InterruptStackFrame *stackframe)
+{
+    Task *parent = scheduler_running();
+    int *pid = (int *)stackframe->rbx;
+
+    if (!task_memory_validate(parent, (uintptr_t)pid, sizeof(int), true))
+    {
+        return ERR_BAD_ADDRESS;
+    }
+
+    *pid = 0;
+
+    Task *child = nullptr;
+
+    {
+        InterruptsRetainer retainer;
+
+        child = task_clone(parent, stackframe->rsp, stackframe->rip, stackframe->rcx | TASK_USER);
+
+        // Nothing schedules the child before we let go of the giant lock.
+        auto *child_stackframe = (InterruptStackFrame *)child->kernel_stack_pointer;
+        *child_stackframe = *stackframe;
+        child_stackframe->rax = SUCCESS;
+    }
+
+    // The memory of the task is copy-on-write now, this is where the
+    // parent and the child start to see different values.
+    *pid = child->id;
+
+    return SUCCESS;
+}
+
 extern "C" uint64_t interrupts_handler(uintptr_t rsp)
 {
     InterruptStackFrame *stackframe = reinterpret_cast<InterruptStackFrame *>(rsp);
 
+    if (stackframe->intno == PAGE_FAULT && resolve_page_fault(stackframe->err))
+    {
+        return rsp;
+    }
+
     if (stackframe->intno < 32)
     {
-        if (stackframe->cs == 0x1B)
+        if (stackframe->cs == 0x1B || is_task_memory_fault(stackframe->intno))
         {
             Kernel::logln("Task {}({}) triggered an exception: '{}' {x}.{x} (IP={08x} CR2={08x})",
                           scheduler_running()->name,
@@ -99,6 +174,26 @@ extern "C" uint64_t interrupts_handler(uintptr_t rsp)
         }
 
         interrupts_enable_holding();
+
+        pic_ack(stackframe->intno);
+    }
+    else if (stackframe->intno == x86::LAPIC_TIMER_VECTOR ||
+             stackframe->intno == x86::LAPIC_RESCHEDULE_VECTOR)
+    {
+        interrupts_disable_holding();
+
+        rsp = schedule(rsp);
+
+        interrupts_enable_holding();
+
+        x86::lapic_ack();
+    }
+    else if (stackframe->intno == x86::LAPIC_TLB_SHOOTDOWN_VECTOR)
+    {
+        // The processor requesting the shootdown holds the giant lock.
+        tlb_shootdown_acknowledge();
+
+        x86::lapic_ack();
     }
     else if (stackframe->intno == 127)
     {
@@ -112,19 +207,24 @@ extern "C" uint64_t interrupts_handler(uintptr_t rsp)
     {
         x86::sti();
 
-        stackframe->rax = task_do_syscall(
-            (Syscall)stackframe->rax,
-            stackframe->rbx,
-            stackframe->rcx,
-            stackframe->rdx,
-            stackframe->rsi,
-            stackframe->rdi);
+        if ((Syscall)stackframe->rax == HJ_PROCESS_CLONE)
+        {
+            stackframe->rax = process_clone(stackframe);
+        }
+        else
+        {
+            stackframe->rax = task_do_syscall(
+                (Syscall)stackframe->rax,
+                stackframe->rbx,
+                stackframe->rcx,
+                stackframe->rdx,
+                stackframe->rsi,
+                stackframe->rdi);
+        }
 
         x86::cli();
     }
 
-    pic_ack(stackframe->intno);
-
     return rsp;
 }
 
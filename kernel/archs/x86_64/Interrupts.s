@@ -52,6 +52,7 @@ __interrupt%1:
 %endmacro
 
 extern interrupts_handler
+extern scheduler_did_switch
 
 __interrupt_common:
     cld
@@ -64,6 +65,8 @@ __interrupt_common:
 
     mov rsp, rax
 
+    call scheduler_did_switch
+
     __popa
 
     add rsp, 16 ; pop errcode and int number
@@ -120,9 +123,15 @@ INTERRUPT_NOERR 45
 INTERRUPT_NOERR 46
 INTERRUPT_NOERR 47
 
+INTERRUPT_NOERR 48
+INTERRUPT_NOERR 49
+INTERRUPT_NOERR 50
+
 INTERRUPT_NOERR 127
 INTERRUPT_NOERR 128
 
+INTERRUPT_NOERR 255
+
 global __interrupt_vector
 
 __interrupt_vector:
@@ -176,5 +185,11 @@ __interrupt_vector:
     INTERRUPT_NAME 46
     INTERRUPT_NAME 47
 
+    INTERRUPT_NAME 48
+    INTERRUPT_NAME 49
+    INTERRUPT_NAME 50
+
     INTERRUPT_NAME 127
     INTERRUPT_NAME 128
+
+    INTERRUPT_NAME 255
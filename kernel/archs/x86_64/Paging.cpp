@@ -7,11 +7,17 @@
 
 #include "archs/Arch.h"
 #include "archs/x86_64/Paging.h"
+#include "archs/x86_64/SMP.h"
 #include "archs/x86_64/x86_64.h"
 
 namespace Arch::x86_64
 {
 
+static constexpr uintptr_t SHARED_MEMORY_END = 512 * 512 * ARCH_PAGE_SIZE;
+
+static constexpr uint64_t LARGE_PAGE_SIZE = 512 * ARCH_PAGE_SIZE;
+static_assert(LARGE_PAGE_SIZE == ARCH_LARGE_PAGE_SIZE);
+
 PML4 kpml4 ALIGNED(ARCH_PAGE_SIZE) = {};
 PML3 kpml3 ALIGNED(ARCH_PAGE_SIZE) = {};
 PML2 kpml2 ALIGNED(ARCH_PAGE_SIZE) = {};
@@ -22,6 +28,28 @@ PML4 *kernel_pml4()
     return &kpml4;
 }
 
+// The first GiB is the same in every address space, down to the PML-2 and
+// its large pages. Its tables of 4-KByte pages are static, each one stays
+// with its 2-MByte slot and is only out of use while a large page takes it.
+static bool is_shared(uint64_t address)
+{
+    return address < SHARED_MEMORY_END;
+}
+
+static PML1 *pml1_of(PML2Entry &entry)
+{
+    return reinterpret_cast<PML1 *>(entry.physical_address * ARCH_PAGE_SIZE);
+}
+
+static void pml2_entry_set_table(PML2Entry &entry, uint64_t address, PML1 *pml1)
+{
+    entry = {};
+    entry.present = 1;
+    entry.writable = 1;
+    entry.user = !is_shared(address);
+    entry.physical_address = (uint64_t)pml1 / ARCH_PAGE_SIZE;
+}
+
 void virtual_initialize()
 {
     auto &pml4_entry = kpml4.entries[0];
@@ -38,81 +66,80 @@ void virtual_initialize()
 
     for (size_t i = 0; i < 512; i++)
     {
-        auto &pml2_entry = kpml2.entries[i];
-        pml2_entry.user = 0;
-        pml2_entry.writable = 1;
-        pml2_entry.present = 1;
-        pml2_entry.physical_address = (uint64_t)&kpml1[i] / ARCH_PAGE_SIZE;
+        pml2_entry_set_table(kpml2.entries[i], i * LARGE_PAGE_SIZE, &kpml1[i]);
     }
 }
 
 void virtual_memory_enable()
 {
     pml4_switch(kernel_pml4());
+    paging_write_protect();
 }
 
-bool virtual_present(PML4 *pml4, uintptr_t virtual_address)
+static PML2Entry *pml2_entry_lookup(PML4 *pml4, uint64_t address)
 {
-    ASSERT_INTERRUPTS_RETAINED();
-
-    auto &pml4_entry = pml4->entries[pml4_index(virtual_address)];
+    auto &pml4_entry = pml4->entries[pml4_index(address)];
 
     if (!pml4_entry.present)
     {
-        return false;
+        return nullptr;
     }
 
     auto pml3 = reinterpret_cast<PML3 *>(pml4_entry.physical_address * ARCH_PAGE_SIZE);
-    auto &pml3_entry = pml3->entries[pml3_index(virtual_address)];
+    auto &pml3_entry = pml3->entries[pml3_index(address)];
 
     if (!pml3_entry.present)
     {
-        return false;
+        return nullptr;
     }
 
     auto pml2 = reinterpret_cast<PML2 *>(pml3_entry.physical_address * ARCH_PAGE_SIZE);
-    auto &pml2_entry = pml2->entries[pml2_index(virtual_address)];
+    auto &pml2_entry = pml2->entries[pml2_index(address)];
 
     if (!pml2_entry.present)
     {
-        return false;
+        return nullptr;
     }
 
-    auto pml1 = reinterpret_cast<PML1 *>(pml2_entry.physical_address * ARCH_PAGE_SIZE);
-    auto &pml1_entry = pml1->entries[pml1_index(virtual_address)];
-
-    return pml1_entry.present;
+    return &pml2_entry;
 }
 
-uintptr_t virtual_to_physical(PML4 *pml4, uintptr_t virtual_address)
+bool virtual_present(PML4 *pml4, uintptr_t virtual_address)
 {
-    ASSERT_INTERRUPTS_RETAINED();
+    SpinlockHolder holder{memory_lock()};
 
-    auto &pml4_entry = pml4->entries[pml4_index(virtual_address)];
+    auto *pml2_entry = pml2_entry_lookup(pml4, virtual_address);
 
-    if (!pml4_entry.present)
+    if (!pml2_entry)
     {
-        return 0;
+        return false;
     }
 
-    auto pml3 = reinterpret_cast<PML3 *>(pml4_entry.physical_address * ARCH_PAGE_SIZE);
-    auto &pml3_entry = pml3->entries[pml3_index(virtual_address)];
-
-    if (!pml3_entry.present)
+    if (pml2_entry->size)
     {
-        return 0;
+        return true;
     }
 
-    auto pml2 = reinterpret_cast<PML2 *>(pml3_entry.physical_address * ARCH_PAGE_SIZE);
-    auto &pml2_entry = pml2->entries[pml2_index(virtual_address)];
+    return pml1_of(*pml2_entry)->entries[pml1_index(virtual_address)].present;
+}
 
-    if (!pml2_entry.present)
+uintptr_t virtual_to_physical(PML4 *pml4, uintptr_t virtual_address)
+{
+    SpinlockHolder holder{memory_lock()};
+
+    auto *pml2_entry = pml2_entry_lookup(pml4, virtual_address);
+
+    if (!pml2_entry)
     {
         return 0;
     }
 
-    auto pml1 = reinterpret_cast<PML1 *>(pml2_entry.physical_address * ARCH_PAGE_SIZE);
-    auto &pml1_entry = pml1->entries[pml1_index(virtual_address)];
+    if (pml2_entry->size)
+    {
+        return (pml2_entry->physical_address * ARCH_PAGE_SIZE) + (virtual_address & (LARGE_PAGE_SIZE - 1));
+    }
+
+    auto &pml1_entry = pml1_of(*pml2_entry)->entries[pml1_index(virtual_address)];
 
     if (!pml1_entry.present)
     {
@@ -122,143 +149,227 @@ uintptr_t virtual_to_physical(PML4 *pml4, uintptr_t virtual_address)
     return (pml1_entry.physical_address * ARCH_PAGE_SIZE) + (virtual_address & 0xfff);
 }
 
-HjResult virtual_map(PML4 *pml4, MemoryRange physical_range, uintptr_t virtual_address, MemoryFlags flags)
+static HjResult pml2_entry_create(PML4 *pml4, uint64_t address, PML2Entry **out_entry)
 {
-    ASSERT_INTERRUPTS_RETAINED();
+    auto pml4_entry = &pml4->entries[pml4_index(address)];
+    auto pml3 = reinterpret_cast<PML3 *>(pml4_entry->physical_address * ARCH_PAGE_SIZE);
 
-    for (size_t i = 0; i < physical_range.page_count(); i++)
+    if (!pml4_entry->present)
     {
-        uint64_t address = virtual_address + i * ARCH_PAGE_SIZE;
+        TRY(memory_alloc_identity(pml4, MEMORY_CLEAR, (uintptr_t *)&pml3));
 
-        auto pml4_entry = &pml4->entries[pml4_index(address)];
-        auto pml3 = reinterpret_cast<PML3 *>(pml4_entry->physical_address * ARCH_PAGE_SIZE);
+        pml4_entry->present = 1;
+        pml4_entry->writable = 1;
+        pml4_entry->user = 1;
+        pml4_entry->physical_address = (uint64_t)(pml3) / ARCH_PAGE_SIZE;
+    }
 
-        if (!pml4_entry->present)
-        {
-            TRY(memory_alloc_identity(pml4, MEMORY_CLEAR, (uintptr_t *)&pml3));
+    auto pml3_entry = &pml3->entries[pml3_index(address)];
+    auto pml2 = reinterpret_cast<PML2 *>(pml3_entry->physical_address * ARCH_PAGE_SIZE);
 
-            pml4_entry->present = 1;
-            pml4_entry->writable = 1;
-            pml4_entry->user = 1;
-            pml4_entry->physical_address = (uint64_t)(pml3) / ARCH_PAGE_SIZE;
-        }
+    if (!pml3_entry->present)
+    {
+        TRY(memory_alloc_identity(pml4, MEMORY_CLEAR, (uintptr_t *)&pml2));
 
-        auto pml3_entry = &pml3->entries[pml3_index(address)];
-        auto pml2 = reinterpret_cast<PML2 *>(pml3_entry->physical_address * ARCH_PAGE_SIZE);
+        pml3_entry->present = 1;
+        pml3_entry->writable = 1;
+        pml3_entry->user = 1;
+        pml3_entry->physical_address = (uint64_t)(pml2) / ARCH_PAGE_SIZE;
+    }
 
-        if (!pml3_entry->present)
-        {
-            TRY(memory_alloc_identity(pml4, MEMORY_CLEAR, (uintptr_t *)&pml2));
+    *out_entry = &pml2->entries[pml2_index(address)];
 
-            pml3_entry->present = 1;
-            pml3_entry->writable = 1;
-            pml3_entry->user = 1;
-            pml3_entry->physical_address = (uint64_t)(pml2) / ARCH_PAGE_SIZE;
-        }
+    return SUCCESS;
+}
 
-        auto pml2_entry = &pml2->entries[pml2_index(address)];
-        auto pml1 = reinterpret_cast<PML1 *>(pml2_entry->physical_address * ARCH_PAGE_SIZE);
+// Gives the entry a table of 4-KByte pages, a large page is split into the
+// same mappings.
+static HjResult pml2_entry_table(PML4 *pml4, PML2Entry &entry, uint64_t address, PML1 **out_pml1)
+{
+    if (entry.present && !entry.size)
+    {
+        *out_pml1 = pml1_of(entry);
+        return SUCCESS;
+    }
 
-        if (!pml2_entry->present)
-        {
-            TRY(memory_alloc_identity(pml4, MEMORY_CLEAR, (uintptr_t *)&pml1));
+    PML1 *pml1 = &kpml1[pml2_index(address)];
 
-            pml2_entry->present = 1;
-            pml2_entry->writable = 1;
-            pml2_entry->user = 1;
-            pml2_entry->physical_address = (uint64_t)(pml1) / ARCH_PAGE_SIZE;
-        }
+    if (!is_shared(address))
+    {
+        TRY(memory_alloc_identity(pml4, MEMORY_CLEAR, (uintptr_t *)&pml1));
+    }
 
-        auto pml1_entry = &pml1->entries[pml1_index(address)];
+    if (entry.present)
+    {
+        for (size_t i = 0; i < 512; i++)
+        {
+            auto &pml1_entry = pml1->entries[i];
 
-        pml1_entry->present = 1;
-        pml1_entry->writable = 1;
-        pml1_entry->user = flags & MEMORY_USER;
-        pml1_entry->physical_address = (physical_range.base() + i * ARCH_PAGE_SIZE) / ARCH_PAGE_SIZE;
+            pml1_entry = {};
+            pml1_entry.present = 1;
+            pml1_entry.writable = entry.writable;
+            pml1_entry.user = entry.user;
+            pml1_entry.physical_address = entry.physical_address + i;
+        }
     }
 
-    paging_invalidate_tlb();
+    pml2_entry_set_table(entry, address, pml1);
+    *out_pml1 = pml1;
 
     return SUCCESS;
 }
 
-MemoryRange virtual_alloc(PML4 *pml4, MemoryRange physical_range, MemoryFlags flags)
+// A large page can take the place of another one or of a table with
+// nothing mapped in it.
+static bool pml2_entry_can_map_large(PML2Entry &entry)
 {
-    ASSERT_INTERRUPTS_RETAINED();
+    if (!entry.present || entry.size)
+    {
+        return true;
+    }
 
-    bool is_user_memory = flags & MEMORY_USER;
+    auto *pml1 = pml1_of(entry);
+
+    for (size_t i = 0; i < 512; i++)
+    {
+        if (pml1->entries[i].present)
+        {
+            return false;
+        }
+    }
 
-    uintptr_t virtual_address = 0;
-    size_t current_size = 0;
+    return true;
+}
 
-    // we skip the first page to make null deref trigger a page fault
-    for (size_t i = (is_user_memory ? 256 : 1) * 1024; i < (is_user_memory ? 1024 : 256) * 1024; i++)
+static void pml2_entry_map_large(PML2Entry &entry, uint64_t address, uint64_t physical_address, MemoryFlags flags)
+{
+    if (entry.present && !entry.size && !is_shared(address))
     {
-        uintptr_t current_address = i * ARCH_PAGE_SIZE;
+        memory_free(kernel_pml4(), {(uintptr_t)pml1_of(entry), ARCH_PAGE_SIZE});
+    }
 
-        if (!virtual_present(pml4, current_address))
-        {
-            if (current_size == 0)
-            {
-                virtual_address = current_address;
-            }
+    entry = {};
+    entry.present = 1;
+    entry.writable = !(flags & MEMORY_READONLY);
+    entry.user = flags & MEMORY_USER;
+    entry.size = 1;
+    entry.physical_address = physical_address / ARCH_PAGE_SIZE;
+}
 
-            current_size += ARCH_PAGE_SIZE;
+HjResult virtual_map(PML4 *pml4, MemoryRange physical_range, uintptr_t virtual_address, MemoryFlags flags)
+{
+    SpinlockHolder holder{memory_lock()};
 
-            if (current_size == physical_range.size())
-            {
-                assert(SUCCESS == virtual_map(pml4, physical_range, virtual_address, flags));
+    uint64_t size = physical_range.page_count() * ARCH_PAGE_SIZE;
 
-                return (MemoryRange){virtual_address, current_size};
-            }
-        }
-        else
+    for (uint64_t offset = 0; offset < size;)
+    {
+        uint64_t address = virtual_address + offset;
+        uint64_t physical_address = physical_range.base() + offset;
+
+        PML2Entry *pml2_entry;
+        TRY(pml2_entry_create(pml4, address, &pml2_entry));
+
+        if (address % LARGE_PAGE_SIZE == 0 &&
+            physical_address % LARGE_PAGE_SIZE == 0 &&
+            size - offset >= LARGE_PAGE_SIZE &&
+            pml2_entry_can_map_large(*pml2_entry))
         {
-            current_size = 0;
+            pml2_entry_map_large(*pml2_entry, address, physical_address, flags);
+            offset += LARGE_PAGE_SIZE;
+
+            continue;
         }
+
+        PML1 *pml1;
+        TRY(pml2_entry_table(pml4, *pml2_entry, address, &pml1));
+
+        auto &pml1_entry = pml1->entries[pml1_index(address)];
+
+        pml1_entry.present = 1;
+        pml1_entry.writable = !(flags & MEMORY_READONLY);
+        pml1_entry.user = flags & MEMORY_USER;
+        pml1_entry.physical_address = physical_address / ARCH_PAGE_SIZE;
+
+        offset += ARCH_PAGE_SIZE;
     }
 
-    system_panic("Out of virtual memory!");
+    memory_kernel_space_set_used({virtual_address, physical_range.size()});
+
+    paging_invalidate_tlb();
+
+    return SUCCESS;
+}
+
+MemoryRange virtual_alloc(PML4 *pml4, MemoryRange physical_range, MemoryFlags flags)
+{
+    SpinlockHolder holder{memory_lock()};
+
+    // Only the kernel half is shared, the memory of tasks is placed by the
+    // tasks themselves.
+    assert(!(flags & MEMORY_USER));
+
+    auto virtual_range = memory_kernel_space_find(physical_range.size());
+
+    assert(SUCCESS == virtual_map(pml4, physical_range, virtual_range.base(), flags));
+
+    return virtual_range;
 }
 
 void virtual_free(PML4 *pml4, MemoryRange virtual_range)
 {
-    ASSERT_INTERRUPTS_RETAINED();
+    SpinlockHolder holder{memory_lock()};
+
+    uint64_t end = virtual_range.base() + virtual_range.page_count() * ARCH_PAGE_SIZE;
 
-    for (size_t i = 0; i < virtual_range.page_count(); i++)
+    for (uint64_t address = virtual_range.base(); address < end;)
     {
-        uint64_t address = virtual_range.base() + i * ARCH_PAGE_SIZE;
+        uint64_t next_large_page = ALIGN_DOWN(address, LARGE_PAGE_SIZE) + LARGE_PAGE_SIZE;
 
-        auto pml4_entry = &pml4->entries[pml4_index(address)];
+        auto *pml2_entry = pml2_entry_lookup(pml4, address);
 
-        if (!pml4_entry->present)
+        if (!pml2_entry)
         {
+            address = next_large_page;
             continue;
         }
 
-        auto pml3 = reinterpret_cast<PML3 *>(pml4_entry->physical_address * ARCH_PAGE_SIZE);
-        auto pml3_entry = &pml3->entries[pml3_index(address)];
-
-        if (!pml3_entry->present)
+        if (pml2_entry->size)
         {
-            continue;
-        }
-
-        auto pml2 = reinterpret_cast<PML2 *>(pml3_entry->physical_address * ARCH_PAGE_SIZE);
-        auto pml2_entry = &pml2->entries[pml2_index(address)];
+            if (address % LARGE_PAGE_SIZE == 0 && end - address >= LARGE_PAGE_SIZE)
+            {
+                if (is_shared(address))
+                {
+                    pml2_entry_set_table(*pml2_entry, address, &kpml1[pml2_index(address)]);
+                }
+                else
+                {
+                    *pml2_entry = {};
+                }
+
+                address = next_large_page;
+                continue;
+            }
 
-        if (!pml2_entry->present)
-        {
-            continue;
+            PML1 *pml1;
+            assert(SUCCESS == pml2_entry_table(pml4, *pml2_entry, address, &pml1));
         }
 
-        auto pml1 = reinterpret_cast<PML1 *>(pml2_entry->physical_address * ARCH_PAGE_SIZE);
-        auto pml1_entry = &pml1->entries[pml1_index(address)];
+        pml1_of(*pml2_entry)->entries[pml1_index(address)] = {};
 
-        *pml1_entry = {};
+        address += ARCH_PAGE_SIZE;
     }
 
+    memory_kernel_space_set_free(virtual_range);
+
     paging_invalidate_tlb();
+
+    // The first GiB is shared by every address space, so it might be cached
+    // by other processors.
+    if (virtual_range.base() < SHARED_MEMORY_END)
+    {
+        tlb_shootdown();
+    }
 }
 
 PML4 *pml4_create()
@@ -275,23 +386,11 @@ PML4 *pml4_create()
     pml4_entry.present = 1;
     pml4_entry.physical_address = (uint64_t)pml3 / ARCH_PAGE_SIZE;
 
-    PML2 *pml2;
-    memory_alloc_identity(kernel_pml4(), MEMORY_CLEAR, (uintptr_t *)&pml2);
-
     auto &pml3_entry = pml3->entries[0];
     pml3_entry.user = 1;
     pml3_entry.writable = 1;
     pml3_entry.present = 1;
-    pml3_entry.physical_address = (uint64_t)pml2 / ARCH_PAGE_SIZE;
-
-    for (size_t i = 0; i < 512; i++)
-    {
-        auto &pml2_entry = pml2->entries[i];
-        pml2_entry.user = 1;
-        pml2_entry.writable = 1;
-        pml2_entry.present = 1;
-        pml2_entry.physical_address = (uint64_t)&kpml1[i] / ARCH_PAGE_SIZE;
-    }
+    pml3_entry.physical_address = (uint64_t)&kpml2 / ARCH_PAGE_SIZE;
 
     return pml4;
 }
@@ -70,16 +70,16 @@ struct PACKED PML2Entry
     bool cache : 1;                 // Page-level cache disable
     bool accessed : 1;              // Indicates whether this entry has been used
     int zero0 : 1;                  // Ignored
-    int size : 1;                   // Must be 0 otherwise, this entry maps a 2-MByte page.
+    bool size : 1;                  // If 1, this entry maps a 2-MByte page instead of a PML-1.
     int zero1 : 4;                  // Ignored
-    uint64_t physical_address : 36; // Physical address of a 4-KByte aligned PLM-1
+    uint64_t physical_address : 36; // Physical address of a 4-KByte aligned PLM-1, or of the 2-MByte page
     int zero2 : 15;                 // Ignored
     bool execute_disabled : 1;      // If IA32_EFER.NXE = 1, Execute-disable
 };
 
 struct PACKED PML2
 {
-    PML3Entry entries[512];
+    PML2Entry entries[512];
 };
 
 static inline size_t pml2_index(uintptr_t address)
@@ -125,6 +125,8 @@ extern "C" void paging_load_directory(uintptr_t directory);
 
 extern "C" void paging_invalidate_tlb();
 
+extern "C" void paging_write_protect();
+
 PML4 *kernel_pml4();
 
 PML4 *pml4_create();
@@ -8,3 +8,12 @@ paging_invalidate_tlb:
     mov rax, cr3
     mov cr3, rax
     ret
+
+; The kernel faults when it writes to a read-only page, like user pages that
+; are copy-on-write.
+global paging_write_protect
+paging_write_protect:
+    mov rax, cr0
+    or rax, 0x10000
+    mov cr0, rax
+    ret
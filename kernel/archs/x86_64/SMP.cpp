@@ -0,0 +1,192 @@
+#include <assert.h>
+#include <string.h>
+
+#include "system/Streams.h"
+#include "system/interrupts/Interupts.h"
+#include "system/memory/Memory.h"
+#include "system/scheduling/Scheduler.h"
+#include "system/system/System.h"
+
+#include "archs/x86/FPU.h"
+#include "archs/x86/LAPIC.h"
+#include "archs/x86_64/GDT.h"
+#include "archs/x86_64/IDT.h"
+#include "archs/x86_64/Paging.h"
+#include "archs/x86_64/SMP.h"
+
+namespace Arch::x86_64
+{
+
+constexpr uintptr_t TRAMPOLINE_ADDRESS = 0x8000;
+
+struct PACKED TrampolineParameters
+{
+    uint64_t pml4;
+    uint64_t stack;
+    uint64_t entry;
+};
+
+extern "C" char __trampoline_start[];
+extern "C" char __trampoline_end[];
+extern "C" char __trampoline_parameters[];
+
+static int _online_count = 1;
+static uint32_t _online_mask = 1;
+static uint32_t _tlb_pending = 0;
+
+static uint32_t _timer_ticks = 0;
+static Task *_idle_tasks[ARCH_MAX_PROCESSORS] = {};
+
+static void smp_wait(uint32_t milliseconds)
+{
+    auto start = system_get_tick();
+
+    while (system_get_tick() - start < milliseconds)
+    {
+        asm volatile("pause");
+    }
+}
+
+static void smp_processor_entry()
+{
+    gdt_initialize();
+    idt_load();
+    fpu_initialize();
+
+    x86::lapic_enable();
+    x86::lapic_timer_start(_timer_ticks);
+
+    int processor = x86::lapic_processor_current();
+
+    // The boot context of the processor becomes its idle task.
+    scheduler_did_create_idle_task(_idle_tasks[processor]);
+    scheduler_did_create_running_task(_idle_tasks[processor]);
+
+    __atomic_or_fetch(&_online_mask, 1u << processor, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&_online_count, 1, __ATOMIC_RELEASE);
+
+    interrupts_start();
+    system_hang();
+}
+
+static bool smp_start_processor(int processor)
+{
+    Task *idle = nullptr;
+
+    {
+        InterruptsRetainer retainer;
+
+        idle = task_create(nullptr, "idle", TASK_NONE);
+        idle->state(TASK_STATE_HANG);
+    }
+
+    _idle_tasks[processor] = idle;
+
+    auto *parameters = reinterpret_cast<TrampolineParameters *>(
+        TRAMPOLINE_ADDRESS + (__trampoline_parameters - __trampoline_start));
+
+    parameters->pml4 = (uint64_t)kernel_pml4();
+    parameters->stack = (uint64_t)idle->kernel_stack + PROCESS_STACK_SIZE;
+    parameters->entry = (uint64_t)smp_processor_entry;
+
+    int online = __atomic_load_n(&_online_count, __ATOMIC_ACQUIRE);
+
+    x86::lapic_send_init(processor);
+    smp_wait(10);
+
+    // Per the MultiProcessor Specification, the STARTUP IPI is sent twice
+    // if the first one is not enough.
+    for (int attempt = 0; attempt < 2; attempt++)
+    {
+        x86::lapic_send_startup(processor, TRAMPOLINE_ADDRESS);
+
+        for (int i = 0; i < 100; i++)
+        {
+            if (__atomic_load_n(&_online_count, __ATOMIC_ACQUIRE) > online)
+            {
+                return true;
+            }
+
+            smp_wait(1);
+        }
+    }
+
+    return false;
+}
+
+void smp_initialize()
+{
+    x86::lapic_initialize();
+
+    if (x86::lapic_processor_count() == 1)
+    {
+        return;
+    }
+
+    _timer_ticks = x86::lapic_timer_calibrate(10);
+
+    {
+        InterruptsRetainer retainer;
+
+        MemoryRange trampoline{TRAMPOLINE_ADDRESS, ARCH_PAGE_SIZE};
+        assert(virtual_map(kernel_pml4(), trampoline, TRAMPOLINE_ADDRESS, MEMORY_NONE) == SUCCESS);
+    }
+
+    memcpy((void *)TRAMPOLINE_ADDRESS, __trampoline_start, __trampoline_end - __trampoline_start);
+
+    // Processors are started one by one, so they can share the trampoline
+    // parameters and always come online in order.
+    for (int processor = 1; processor < x86::lapic_processor_count(); processor++)
+    {
+        Kernel::logln("Starting processor {} (apic_id={})...", processor, x86::lapic_processor_apic_id(processor));
+
+        if (!smp_start_processor(processor))
+        {
+            Kernel::logln("Processor {} didn't respond!", processor);
+            break;
+        }
+    }
+
+    Kernel::logln("{} processors online", smp_processor_count());
+}
+
+int smp_processor_count()
+{
+    return __atomic_load_n(&_online_count, __ATOMIC_ACQUIRE);
+}
+
+void tlb_shootdown()
+{
+    // Only the paging code shoots down, once it's done with the tables.
+    assert(memory_lock().held());
+
+    uint32_t others = __atomic_load_n(&_online_mask, __ATOMIC_ACQUIRE) & ~(1u << x86::lapic_processor_current());
+
+    if (others == 0)
+    {
+        return;
+    }
+
+    __atomic_or_fetch(&_tlb_pending, others, __ATOMIC_RELEASE);
+    x86::lapic_send_ipi_others(x86::LAPIC_TLB_SHOOTDOWN_VECTOR);
+
+    // Processors spinning on a lock acknowledge shootdowns while they wait,
+    // so this can't deadlock with the giant lock held.
+    while (__atomic_load_n(&_tlb_pending, __ATOMIC_ACQUIRE) & others)
+    {
+        asm volatile("pause");
+    }
+}
+
+void tlb_shootdown_acknowledge()
+{
+    uint32_t self = 1u << x86::lapic_processor_current();
+
+    if (__atomic_load_n(&_tlb_pending, __ATOMIC_ACQUIRE) & self)
+    {
+        paging_invalidate_tlb();
+        __atomic_and_fetch(&_tlb_pending, ~self, __ATOMIC_RELEASE);
+    }
+}
+
+} // namespace Arch::x86_64
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <libutils/Prelude.h>
+
+namespace Arch::x86_64
+{
+
+void smp_initialize();
+
+int smp_processor_count();
+
+void tlb_shootdown();
+
+void tlb_shootdown_acknowledge();
+
+} // namespace Arch::x86_64
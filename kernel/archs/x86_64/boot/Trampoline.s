@@ -0,0 +1,86 @@
+;; --- application processors trampoline ------------------------------------ ;;
+
+; This code is copied at TRAMPOLINE_ADDRESS by smp_initialize(), application
+; processors start executing it in real mode after receiving a STARTUP IPI
+; and jump straight to long mode using the kernel address space.
+
+%define TRAMPOLINE_ADDRESS 0x8000
+%define TRAMPOLINE(__label) (TRAMPOLINE_ADDRESS + (__label - __trampoline_start))
+
+section .text
+
+global __trampoline_start
+global __trampoline_end
+global __trampoline_parameters
+
+bits 16
+__trampoline_start:
+    cli
+    cld
+
+    xor ax, ax
+    mov ds, ax
+
+    lgdt [TRAMPOLINE(__trampoline_gdt_descriptor)]
+
+    ; Enable PAE
+    mov eax, cr4
+    or eax, 1 << 5
+    mov cr4, eax
+
+    mov eax, [TRAMPOLINE(__trampoline_parameters.pml4)]
+    mov cr3, eax
+
+    ; Enable long mode
+    mov ecx, 0xC0000080
+    rdmsr
+    or eax, 1 << 8
+    wrmsr
+
+    ; Enable paging, protection and write protection at once
+    mov eax, cr0
+    or eax, 0x80010001
+    mov cr0, eax
+
+    jmp 0x08:TRAMPOLINE(__trampoline_long_mode)
+
+bits 64
+__trampoline_long_mode:
+    mov ax, 0x10
+
+    mov ds, ax
+    mov es, ax
+    mov fs, ax
+    mov gs, ax
+    mov ss, ax
+
+    mov rsp, [TRAMPOLINE(__trampoline_parameters.stack)]
+    mov rax, [TRAMPOLINE(__trampoline_parameters.entry)]
+
+    call rax
+
+__trampoline_hang:
+    cli
+    hlt
+    jmp __trampoline_hang
+
+align 8
+__trampoline_gdt:
+    dq 0                  ; null descriptor
+    dq 0x00AF9A000000FFFF ; kernel code
+    dq 0x00CF92000000FFFF ; kernel data
+
+__trampoline_gdt_descriptor:
+    dw __trampoline_gdt_descriptor - __trampoline_gdt - 1
+    dd TRAMPOLINE(__trampoline_gdt)
+
+align 8
+__trampoline_parameters:
+.pml4:
+    dq 0
+.stack:
+    dq 0
+.entry:
+    dq 0
+
+__trampoline_end:
@@ -22,6 +22,11 @@ void madt_initialize(MADT *madt)
             {
                 auto local_apic = reinterpret_cast<MADTLocalApicRecord *>(record);
                 Kernel::logln("Local APIC (cpu_id={}, apic_id={}, flags={08x})", local_apic->processor_id, local_apic->apic_id, local_apic->flags);
+
+                if (local_apic->flags & MADT_LAPIC_ENABLED)
+                {
+                    Arch::x86::lapic_processor_found(local_apic->apic_id);
+                }
             }
             break;
 
@@ -67,6 +72,12 @@ void initialize(Handover *handover)
 
     MADT *madt = (MADT *)rsdt->child("APIC");
 
+    if (!madt)
+    {
+        Kernel::logln("No MADT found!");
+        return;
+    }
+
     madt_initialize(madt);
 }
 
@@ -85,6 +85,8 @@ struct PACKED MADTRecord
     uint8_t lenght;
 };
 
+#define MADT_LAPIC_ENABLED (1 << 0)
+
 struct PACKED MADTLocalApicRecord
 {
     MADTRecord header;
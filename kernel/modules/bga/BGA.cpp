@@ -103,25 +103,14 @@ HjResult BGA::call(IOCall request, void *args)
 
         return set_resolution(mode->width, mode->height);
     }
-    else if (request == IOCALL_DISPLAY_BLIT)
+    else if (request == IOCALL_DISPLAY_PRESENT)
     {
-        IOCallDisplayBlitArgs *blit = (IOCallDisplayBlitArgs *)args;
-
-        for (int y = MAX(0, blit->blit_y); y < MIN(_height, blit->blit_y + blit->blit_height); y++)
-        {
-            for (int x = MAX(0, blit->blit_x); x < MIN(_width, blit->blit_x + blit->blit_width); x++)
-            {
-                uint32_t pixel = blit->buffer[y * blit->buffer_width + x];
-
-                uint32_t converted_pixel = ((pixel >> 16) & 0x000000ff) |
-                                           ((pixel)&0xff00ff00) |
-                                           ((pixel << 16) & 0x00ff0000);
-
-                _framebuffer->write32((y * _width + x) * sizeof(uint32_t), converted_pixel);
-            }
-        }
-
-        return SUCCESS;
+        return graphic_present(
+            (uint32_t *)_framebuffer->base(),
+            _width * sizeof(uint32_t),
+            _width,
+            _height,
+            (IOCallDisplayPresentArgs *)args);
     }
     else
     {
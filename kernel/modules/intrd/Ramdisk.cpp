@@ -1,8 +1,8 @@
-
 #include <abi/Result.h>
 #include <libfile/TARArchive.h>
 
 #include "archs/Arch.h"
+#include "intrd/RamdiskFile.h"
 #include "system/Streams.h"
 #include "system/memory/Memory.h"
 #include "system/modules/Modules.h"
@@ -10,42 +10,45 @@
 
 void ramdisk_load(Module *module)
 {
-    TARBlock block;
-    for (size_t i = 0; tar_read((void *)module->range.base(), &block, i); i++)
-    {
-        auto file_path = IO::Path::parse(block.name);
+    // Files are served from the module memory, which stays around until
+    // all of them have been overwritten or deleted.
+    auto image = make<RamdiskImage>(module->range);
+    auto &domain = scheduler_running()->domain();
 
-        if (block.name[strlen(block.name) - 1] == '/')
-        {
-            HjResult result = scheduler_running()->domain().mkdir(file_path);
+    size_t files = 0;
 
-            if (result != SUCCESS)
-            {
-                Kernel::logln("Failed to create directory {}: {}", block.name, result_to_string(result));
-            }
-        }
-        else if ((block.typeflag & 8) == 0 || (block.typeflag & 8) == 5)
+    tar_iterate((void *)module->range.base(), module->range.size(), [&](TARBlock &block)
         {
-            auto result_or_handle = scheduler_running()->domain().open(file_path, HJ_OPEN_WRITE | HJ_OPEN_CREATE);
+            auto file_path = IO::Path::parse(block.name);
 
-            if (!result_or_handle.success())
+            if (block.name[strlen(block.name) - 1] == '/')
             {
-                Kernel::logln("Failed to open file {}! {}", block.name, result_to_string(result_or_handle.result()));
-                continue;
-            }
-
-            auto handle = result_or_handle.unwrap();
+                HjResult result = domain.mkdir(file_path);
 
-            auto result_or_written = handle->write(block.data, block.size);
-
-            if (!result_or_written.success())
+                if (result != SUCCESS)
+                {
+                    Kernel::logln("Failed to create directory {}: {}", block.name, result_to_string(result));
+                }
+            }
+            else if ((block.typeflag & 8) == 0 || (block.typeflag & 8) == 5)
             {
-                Kernel::logln("Failed to write file: {}", result_to_string(result_or_written.result()));
+                // A later entry replaces an earlier one with the same name.
+                domain.unlink(file_path);
+
+                HjResult result = domain.link(file_path, make<FsRamdiskFile>(image, block.data, block.size));
+
+                if (result != SUCCESS)
+                {
+                    Kernel::logln("Failed to create file {}: {}", block.name, result_to_string(result));
+                }
+                else
+                {
+                    files++;
+                }
             }
-        }
-    }
 
-    memory_free(Arch::kernel_address_space(), module->range);
+            return Iter::CONTINUE;
+        });
 
-    Kernel::logln("Loading ramdisk succeeded.");
+    Kernel::logln("Loading ramdisk succeeded ({} files).", files);
 }
@@ -0,0 +1,91 @@
+#include <libmath/MinMax.h>
+#include <string.h>
+
+#include "archs/Arch.h"
+#include "intrd/RamdiskFile.h"
+#include "system/Streams.h"
+#include "system/memory/Memory.h"
+#include "system/node/Handle.h"
+
+RamdiskImage::~RamdiskImage()
+{
+    memory_free(Arch::kernel_address_space(), _range);
+
+    Kernel::logln("Ramdisk image released ({}KiB).", _range.size() / 1024);
+}
+
+FsRamdiskFile::FsRamdiskFile(RefPtr<RamdiskImage> image, const char *data, size_t size)
+    : _image(image), _data(data), _size(size)
+{
+}
+
+HjResult FsRamdiskFile::copy_out()
+{
+    if (_image)
+    {
+        TRY(write_at(0, _data, _size));
+        detach();
+    }
+
+    return SUCCESS;
+}
+
+void FsRamdiskFile::detach()
+{
+    _image = nullptr;
+    _data = nullptr;
+    _size = 0;
+}
+
+HjResult FsRamdiskFile::open(FsHandle &handle)
+{
+    if (_image && handle.has_flag(HJ_OPEN_TRUNC))
+    {
+        detach();
+    }
+
+    return FsFile::open(handle);
+}
+
+size_t FsRamdiskFile::size()
+{
+    if (_image)
+    {
+        return _size;
+    }
+
+    return FsFile::size();
+}
+
+ResultOr<size_t> FsRamdiskFile::read(FsHandle &handle, void *buffer, size_t size)
+{
+    if (!_image)
+    {
+        return FsFile::read(handle, buffer, size);
+    }
+
+    size_t read = 0;
+
+    if (handle.offset() <= _size)
+    {
+        read = MIN(_size - handle.offset(), size);
+        memcpy(buffer, _data + handle.offset(), read);
+    }
+
+    return read;
+}
+
+ResultOr<size_t> FsRamdiskFile::write(FsHandle &handle, const void *buffer, size_t size)
+{
+    TRY(copy_out());
+
+    return FsFile::write(handle, buffer, size);
+}
+
+ResultOr<Vec<MemoryObject *>> FsRamdiskFile::map(FsHandle &handle)
+{
+    // The image isn't page aligned, the file has to move to pages of its own.
+    TRY(copy_out());
+
+    return FsFile::map(handle);
+}
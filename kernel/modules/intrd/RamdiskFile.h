@@ -0,0 +1,43 @@
+#pragma once
+
+#include "system/memory/MemoryRange.h"
+#include "system/node/File.h"
+
+// The memory of the ramdisk module, freed once no file points into it anymore.
+struct RamdiskImage : public RefCounted<RamdiskImage>
+{
+private:
+    MemoryRange _range;
+
+public:
+    RamdiskImage(MemoryRange range) : _range(range) {}
+
+    ~RamdiskImage() override;
+};
+
+// A regular file whose content is read straight from the ramdisk image. It
+// only gets a copy of its own the first time it is written to or mapped.
+struct FsRamdiskFile : public FsFile
+{
+private:
+    RefPtr<RamdiskImage> _image;
+    const char *_data;
+    size_t _size;
+
+    HjResult copy_out();
+
+    void detach();
+
+public:
+    FsRamdiskFile(RefPtr<RamdiskImage> image, const char *data, size_t size);
+
+    HjResult open(FsHandle &handle) override;
+
+    size_t size() override;
+
+    ResultOr<size_t> read(FsHandle &handle, void *buffer, size_t size) override;
+
+    ResultOr<size_t> write(FsHandle &handle, const void *buffer, size_t size) override;
+
+    ResultOr<Vec<MemoryObject *>> map(FsHandle &handle) override;
+};
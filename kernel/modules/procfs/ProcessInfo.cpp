@@ -27,7 +27,12 @@ static Iter serialize_task(Json::Value::Array *list, Task *task)
     task_object["name"] = task->name;
     task_object["state"] = task_state_string(task->state());
     task_object["cpu"] = (int64_t)scheduler_get_usage(task->id);
-    task_object["ram"] = (int64_t)task_memory_usage(task);
+    task_object["ram"] = (int64_t)task->memory_resident;
+    task_object["reserved"] = (int64_t)task->memory_reserved;
+    task_object["shared"] = (int64_t)task->memory_shared;
+    task_object["included"] = (int64_t)task->memory_included;
+    task_object["handles"] = (int64_t)task->handles().count();
+    task_object["opened"] = (int64_t)task->handles().opened();
     task_object["user"] = (task->_flags & TASK_USER) == TASK_USER;
 
     list->push_back(std::move(task_object));
@@ -0,0 +1,58 @@
+#include <abi/Result.h>
+#include <string.h>
+
+#include <libjson/Json.h>
+#include <libmath/MinMax.h>
+
+#include "procfs/SchedulerInfo.h"
+#include "system/node/Handle.h"
+#include "system/scheduling/Scheduler.h"
+
+FsSchedulerInfo::FsSchedulerInfo() : FsNode(HJ_FILE_TYPE_DEVICE)
+{
+}
+
+HjResult FsSchedulerInfo::open(FsHandle &handle)
+{
+    auto stats = scheduler_stats();
+
+    Json::Value::Object object{};
+
+    object["processors"] = (int64_t)stats.processors;
+    object["schedules"] = (int64_t)stats.schedules;
+    object["context_switches"] = (int64_t)stats.context_switches;
+    object["cycles"] = (int64_t)stats.cycles;
+    object["timeouts"] = (int64_t)stats.timeouts;
+    object["runnable"] = (int64_t)stats.runnable;
+    object["blocked"] = (int64_t)stats.blocked;
+    object["timed"] = (int64_t)stats.timed;
+
+    auto str = Json::stringify(object);
+    handle.attached = str.storage().give_ref();
+    handle.attached_size = reinterpret_cast<StringStorage *>(handle.attached)->size();
+
+    return SUCCESS;
+}
+
+void FsSchedulerInfo::close(FsHandle &handle)
+{
+    deref_if_not_null(reinterpret_cast<StringStorage *>(handle.attached));
+}
+
+ResultOr<size_t> FsSchedulerInfo::read(FsHandle &handle, void *buffer, size_t size)
+{
+    size_t read = 0;
+
+    if (handle.offset() <= handle.attached_size)
+    {
+        read = MIN(handle.attached_size - handle.offset(), size);
+        memcpy(buffer, reinterpret_cast<StringStorage *>(handle.attached)->cstring() + handle.offset(), read);
+    }
+
+    return read;
+}
+
+void scheduler_info_initialize()
+{
+    scheduler_running()->domain().link(IO::Path::parse("/system/scheduler"), make<FsSchedulerInfo>());
+}
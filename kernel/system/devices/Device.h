@@ -11,6 +11,7 @@
 
 #include "system/devices/DeviceAddress.h"
 #include "system/devices/DeviceClass.h"
+#include "system/scheduling/WaitQueue.h"
 
 struct Device : public RefCounted<Device>
 {
@@ -21,6 +22,8 @@ private:
 
     Vec<RefPtr<Device>> _children{};
 
+    WaitQueue _waiters{};
+
 public:
     DeviceClass klass()
     {
@@ -42,6 +45,11 @@ public:
         return _address;
     }
 
+    WaitQueue &waiters()
+    {
+        return _waiters;
+    }
+
     void add(RefPtr<Device> child)
     {
         _children.push_back(child);
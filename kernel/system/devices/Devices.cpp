@@ -91,6 +91,7 @@ void devices_handle_interrupt(int interrupt)
             if (device->interrupt() == interrupt)
             {
                 device->handle_interrupt();
+                device->waiters().wake_up();
             }
 
             return Iter::CONTINUE;
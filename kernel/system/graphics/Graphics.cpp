@@ -1,7 +1,9 @@
 #include "system/Streams.h"
+#include <libmath/MinMax.h>
 
 #include "system/graphics/Graphics.h"
 #include "system/interrupts/Interupts.h"
+#include "system/tasking/Syscalls.h"
 
 static uintptr_t _framebuffer_address = 0;
 static int _framebuffer_width = 0;
@@ -88,4 +90,87 @@ void graphic_framebuffer_plot(int x, int y, uint32_t color)
             pixel[2] = (color >> 16) & 0xff;
         }
     }
-}
\ No newline at end of file
+}
+
+// Swaps red and blue, two pixels at a time.
+static void present_row(uint32_t *destination, const uint32_t *source, int count)
+{
+    int i = 0;
+
+    for (; i + 2 <= count; i += 2)
+    {
+        uint64_t pixels = *(const uint64_t *)(source + i);
+
+        *(uint64_t *)(destination + i) = (pixels & 0xff00ff00ff00ff00) |
+                                         ((pixels >> 16) & 0x000000ff000000ff) |
+                                         ((pixels & 0x000000ff000000ff) << 16);
+    }
+
+    for (; i < count; i++)
+    {
+        uint32_t pixel = source[i];
+
+        destination[i] = (pixel & 0xff00ff00) |
+                         ((pixel >> 16) & 0x000000ff) |
+                         ((pixel & 0x000000ff) << 16);
+    }
+}
+
+HjResult graphic_present(uint32_t *framebuffer, int pitch, int width, int height, IOCallDisplayPresentArgs *args)
+{
+    if (!syscall_validate_ptr((uintptr_t)args, sizeof(IOCallDisplayPresentArgs)))
+    {
+        return ERR_BAD_ADDRESS;
+    }
+
+    // The task could change the arguments while they are used.
+    IOCallDisplayPresentArgs present = *args;
+
+    if (present.buffer_width < 0 ||
+        present.buffer_height < 0 ||
+        present.damages_count > IOCALL_DISPLAY_PRESENT_MAX_DAMAGES)
+    {
+        return ERR_INVALID_ARGUMENT;
+    }
+
+    uint64_t buffer_size = (uint64_t)present.buffer_width * present.buffer_height * sizeof(uint32_t);
+
+    if (buffer_size != (size_t)buffer_size)
+    {
+        return ERR_INVALID_ARGUMENT;
+    }
+
+    if (!syscall_validate_ptr((uintptr_t)present.buffer, buffer_size) ||
+        !syscall_validate_ptr((uintptr_t)present.damages, present.damages_count * sizeof(IOCallDisplayRect)))
+    {
+        return ERR_BAD_ADDRESS;
+    }
+
+    width = MIN(width, present.buffer_width);
+    height = MIN(height, present.buffer_height);
+
+    for (size_t i = 0; i < present.damages_count; i++)
+    {
+        IOCallDisplayRect damage = present.damages[i];
+
+        int left = MAX(damage.x, 0);
+        int right = MIN((int64_t)damage.x + damage.width, (int64_t)width);
+        int top = MAX(damage.y, 0);
+        int bottom = MIN((int64_t)damage.y + damage.height, (int64_t)height);
+
+        if (left >= right)
+        {
+            continue;
+        }
+
+        for (int y = top; y < bottom; y++)
+        {
+            present_row(
+                (uint32_t *)((uint8_t *)framebuffer + y * pitch) + left,
+                present.buffer + y * present.buffer_width + left,
+                right - left);
+        }
+    }
+
+    return SUCCESS;
+}
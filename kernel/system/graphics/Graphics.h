@@ -1,5 +1,8 @@
 #pragma once
 
+#include <abi/IOCall.h>
+#include <abi/Result.h>
+
 #include "system/handover/Handover.h"
 
 void graphic_early_initialize(Handover *handover);
@@ -21,3 +24,7 @@ int graphic_framebuffer_height();
 int graphic_framebuffer_pitch();
 
 void graphic_framebuffer_plot(int x, int y, uint32_t color);
+
+// Copies the damaged parts of the buffer to a framebuffer of BGRA pixels,
+// clipped to both of them. The arguments come from the running task.
+HjResult graphic_present(uint32_t *framebuffer, int pitch, int width, int height, IOCallDisplayPresentArgs *args);
@@ -8,9 +8,12 @@
 #include "system/scheduling/Scheduler.h"
 
 static bool _pending_interrupts[256] = {};
+static WaitQueue *_dispatcher_waiters = nullptr;
 
 void dispatcher_initialize()
 {
+    _dispatcher_waiters = new WaitQueue();
+
     Task *task = task_spawn(nullptr, "interrupts-dispatcher", dispatcher_service, nullptr, false);
     task_go(task);
 }
@@ -19,6 +22,7 @@ void dispatcher_dispatch(int interrupt)
 {
     _pending_interrupts[interrupt] = true;
     devices_acknowledge_interrupt(interrupt);
+    _dispatcher_waiters->wake_up();
 }
 
 static bool dispatcher_has_interrupt()
@@ -52,6 +56,16 @@ public:
     {
         return dispatcher_has_interrupt();
     }
+
+    void attach(Task &task) override
+    {
+        _dispatcher_waiters->add(&task);
+    }
+
+    void detach(Task &task) override
+    {
+        _dispatcher_waiters->remove(&task);
+    }
 };
 
 void dispatcher_service()
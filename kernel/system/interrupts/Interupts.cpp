@@ -5,8 +5,62 @@
 #include "system/interrupts/Dispatcher.h"
 #include "system/interrupts/Interupts.h"
 
-static bool _can_be_holded = false;
-static int _depth = 0;
+// Disabling interrupts only protects a critical section from the processor
+// it runs on. To keep every InterruptsRetainer section correct once the
+// application processors are up, retaining interrupts also takes the giant
+// lock, and so does interrupt context. The lock is owned by a processor, not
+// by a task, because it is held across context switches.
+//
+// The giant lock still covers the task lifecycle and task states, blockers
+// and wait queues, the memory mappings of tasks and the memory objects, the
+// wake-ups of filesystem nodes, the kernel heap and the logger, devices and
+// interrupt dispatch.
+//
+// Handle tables have their own lock, and the run queue (Scheduler.cpp) and
+// the physical and virtual memory (memory_lock()) have spinlocks. The order
+// is handles, giant, run queue then memory, a section under a spinlock never
+// takes the giant lock for the first time.
+
+struct InterruptsState
+{
+    bool can_be_holded;
+    bool holds_giant;
+    int depth;
+};
+
+static InterruptsState _states[ARCH_MAX_PROCESSORS] = {};
+static bool _giant = false;
+
+static InterruptsState &interrupts_state()
+{
+    return _states[Arch::processor_current()];
+}
+
+static void giant_acquire(InterruptsState &state)
+{
+    if (state.holds_giant)
+    {
+        return;
+    }
+
+    while (__atomic_test_and_set(&_giant, __ATOMIC_ACQUIRE))
+    {
+        Arch::processor_relax();
+    }
+
+    state.holds_giant = true;
+}
+
+static void giant_release(InterruptsState &state)
+{
+    if (!state.holds_giant)
+    {
+        return;
+    }
+
+    state.holds_giant = false;
+    __atomic_clear(&_giant, __ATOMIC_RELEASE);
+}
 
 void interrupts_initialize()
 {
@@ -14,43 +68,71 @@ void interrupts_initialize()
 
     Kernel::logln("Enabling interrupts!");
 
-    interrupts_enable_holding();
+    interrupts_start();
+}
+
+void interrupts_start()
+{
+    interrupts_state().can_be_holded = true;
     Arch::enable_interrupts();
 }
 
 bool interrupts_retained()
 {
-    return !_can_be_holded || _depth > 0;
+    // Retained sections always run with interrupts disabled. Checking this
+    // first also ensures we can't migrate while looking at our own state.
+    if (Arch::interrupts_enabled())
+    {
+        return false;
+    }
+
+    auto &state = interrupts_state();
+    return !state.can_be_holded || state.depth > 0;
 }
 
 void interrupts_enable_holding()
 {
-    _can_be_holded = true;
+    auto &state = interrupts_state();
+    giant_release(state);
+    state.can_be_holded = true;
 }
 
 void interrupts_disable_holding()
 {
-    _can_be_holded = false;
+    auto &state = interrupts_state();
+    state.can_be_holded = false;
+    giant_acquire(state);
 }
 
 void interrupts_retain()
 {
-    if (_can_be_holded)
+    Arch::disable_interrupts();
+
+    auto &state = interrupts_state();
+
+    if (state.can_be_holded)
     {
-        Arch::disable_interrupts();
-        _depth++;
+        if (state.depth == 0)
+        {
+            giant_acquire(state);
+        }
+
+        state.depth++;
     }
 }
 
 void interrupts_release()
 {
-    if (_can_be_holded)
+    auto &state = interrupts_state();
+
+    if (state.can_be_holded)
     {
-        assert(_depth > 0);
-        _depth--;
+        assert(state.depth > 0);
+        state.depth--;
 
-        if (_depth == 0)
+        if (state.depth == 0)
         {
+            giant_release(state);
             Arch::enable_interrupts();
         }
     }
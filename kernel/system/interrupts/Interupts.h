@@ -8,6 +8,8 @@
 
 void interrupts_initialize();
 
+void interrupts_start();
+
 bool interrupts_retained();
 
 void interrupts_enable_holding();
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <assert.h>
+#include <libutils/Prelude.h>
+
+#include "archs/Arch.h"
+
+// A lock for the parts of the kernel that don't need the giant lock. Like
+// InterruptsRetainer it disables interrupts, so interrupt context can take it
+// too, and it is owned by a processor that can take it again while holding
+// it. Sections under a spinlock must not take the giant lock unless they
+// already hold it: no logging, no kernel heap and no InterruptsRetainer.
+struct Spinlock
+{
+private:
+    NONCOPYABLE(Spinlock);
+    NONMOVABLE(Spinlock);
+
+    static constexpr int NO_HOLDER = -1;
+
+    int _holder = NO_HOLDER;
+    int _depth = 0;
+    bool _enable_interrupts = false;
+
+public:
+    constexpr Spinlock() {}
+
+    bool held() const
+    {
+        bool enabled = Arch::interrupts_enabled();
+        Arch::disable_interrupts();
+
+        bool result = __atomic_load_n(&_holder, __ATOMIC_ACQUIRE) == Arch::processor_current();
+
+        if (enabled)
+        {
+            Arch::enable_interrupts();
+        }
+
+        return result;
+    }
+
+    void acquire()
+    {
+        bool enabled = Arch::interrupts_enabled();
+        Arch::disable_interrupts();
+
+        int current = Arch::processor_current();
+
+        if (__atomic_load_n(&_holder, __ATOMIC_ACQUIRE) != current)
+        {
+            int expected = NO_HOLDER;
+
+            // Relaxing also acknowledges TLB shootdowns, the processor doing
+            // one might be waiting on us while holding the lock.
+            while (!__atomic_compare_exchange_n(&_holder, &expected, current, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+            {
+                expected = NO_HOLDER;
+                Arch::processor_relax();
+            }
+
+            _enable_interrupts = enabled;
+        }
+
+        _depth++;
+    }
+
+    void release()
+    {
+        assert(held());
+
+        _depth--;
+
+        if (_depth == 0)
+        {
+            bool enable_interrupts = _enable_interrupts;
+
+            __atomic_store_n(&_holder, NO_HOLDER, __ATOMIC_RELEASE);
+
+            if (enable_interrupts)
+            {
+                Arch::enable_interrupts();
+            }
+        }
+    }
+};
+
+struct SpinlockHolder
+{
+private:
+    NONCOPYABLE(SpinlockHolder);
+    NONMOVABLE(SpinlockHolder);
+
+    Spinlock &_lock;
+
+public:
+    SpinlockHolder(Spinlock &lock) : _lock(lock)
+    {
+        _lock.acquire();
+    }
+
+    ~SpinlockHolder()
+    {
+        _lock.release();
+    }
+};
@@ -6,11 +6,15 @@
 /*                                                                            */
 
 #include <assert.h>
+#include <string.h>
+
+#include "archs/Arch.h"
 
 #include "system/devices/Devices.h"
 #include "system/devices/Driver.h"
 #include "system/graphics/Graphics.h"
 #include "system/interrupts/Interupts.h"
+#include "system/memory/PhysicalBenchmark.h"
 #include "system/modules/Modules.h"
 #include "system/scheduling/Scheduler.h"
 #include "system/storage/Partitions.h"
@@ -23,6 +27,7 @@
 #include "devfs/DevicesFileSystem.h"
 #include "devfs/DevicesInfo.h"
 #include "procfs/ProcessInfo.h"
+#include "procfs/SchedulerInfo.h"
 
 static void splash_screen()
 {
@@ -46,14 +51,22 @@ void system_main(Handover *handover)
     scheduler_initialize();
     tasking_initialize();
     interrupts_initialize();
+    Arch::processors_initialize();
     modules_initialize(handover);
     driver_initialize();
     device_initialize();
     partitions_initialize();
     process_info_initialize();
+    scheduler_info_initialize();
     device_info_initialize();
     devices_filesystem_initialize();
     graphic_initialize(handover);
+
+    if (strstr(handover->command_line, "benchmark=physical"))
+    {
+        physical_benchmark();
+    }
+
     userspace_initialize();
 
     ASSERT_NOT_REACHED();
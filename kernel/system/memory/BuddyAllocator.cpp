@@ -0,0 +1,331 @@
+#include <assert.h>
+#include <libmath/MinMax.h>
+#include <string.h>
+
+#include "system/memory/BuddyAllocator.h"
+
+static size_t bitmap_size(size_t page_count)
+{
+    return ALIGN_UP(page_count, 64) / 64 * sizeof(uint64_t);
+}
+
+size_t BuddyAllocator::metadata_size(size_t page_count)
+{
+    return bitmap_size(page_count) +
+           page_count * sizeof(Link) +
+           page_count * sizeof(uint8_t);
+}
+
+void BuddyAllocator::initialize(void *metadata, size_t page_count)
+{
+    assert(page_count < NO_LINK);
+
+    auto *bytes = reinterpret_cast<uint8_t *>(metadata);
+
+    _page_count = page_count;
+    _free_count = 0;
+
+    _used = reinterpret_cast<uint64_t *>(bytes);
+    bytes += bitmap_size(page_count);
+
+    _links = reinterpret_cast<Link *>(bytes);
+    bytes += page_count * sizeof(Link);
+
+    _orders = bytes;
+
+    memset(_used, 0xff, bitmap_size(page_count));
+    memset(_orders, NOT_A_BLOCK, page_count);
+
+    for (int order = 0; order < BUDDY_ORDER_COUNT; order++)
+    {
+        _free_lists[order] = NO_LINK;
+    }
+}
+
+/* --- Pages ---------------------------------------------------------------- */
+
+bool BuddyAllocator::page_used(size_t page) const
+{
+    return page >= _page_count || ((_used[page / 64] >> (page % 64)) & 1);
+}
+
+void BuddyAllocator::mark_used(size_t first, size_t end)
+{
+    for (size_t page = first; page < end; page++)
+    {
+        _used[page / 64] |= 1ull << (page % 64);
+    }
+}
+
+void BuddyAllocator::mark_free(size_t first, size_t end)
+{
+    for (size_t page = first; page < end; page++)
+    {
+        _used[page / 64] &= ~(1ull << (page % 64));
+    }
+}
+
+/* --- Blocks --------------------------------------------------------------- */
+
+void BuddyAllocator::block_push(size_t block, int order)
+{
+    auto &link = _links[block];
+
+    link.previous = NO_LINK;
+    link.next = _free_lists[order];
+
+    if (link.next != NO_LINK)
+    {
+        _links[link.next].previous = block;
+    }
+
+    _free_lists[order] = block;
+    _orders[block] = order;
+}
+
+void BuddyAllocator::block_remove(size_t block, int order)
+{
+    auto &link = _links[block];
+
+    if (link.previous != NO_LINK)
+    {
+        _links[link.previous].next = link.next;
+    }
+    else
+    {
+        _free_lists[order] = link.next;
+    }
+
+    if (link.next != NO_LINK)
+    {
+        _links[link.next].previous = link.previous;
+    }
+
+    _orders[block] = NOT_A_BLOCK;
+}
+
+void BuddyAllocator::block_free(size_t block, int order)
+{
+    // Merge with the buddy for as long as it's a free block of the same order.
+    while (order + 1 < BUDDY_ORDER_COUNT)
+    {
+        size_t buddy = block ^ (1ul << order);
+
+        if (buddy >= _page_count || _orders[buddy] != order)
+        {
+            break;
+        }
+
+        block_remove(buddy, order);
+        block = MIN(block, buddy);
+        order++;
+    }
+
+    block_push(block, order);
+}
+
+size_t BuddyAllocator::block_containing(size_t page, int &order)
+{
+    for (order = 0; order < BUDDY_ORDER_COUNT; order++)
+    {
+        size_t block = page & ~((1ul << order) - 1);
+
+        if (_orders[block] == order)
+        {
+            return block;
+        }
+    }
+
+    ASSERT_NOT_REACHED();
+}
+
+void BuddyAllocator::block_keep_outside(size_t block, int order, size_t first, size_t end)
+{
+    // The block was just taken off its free list, mark the pages in
+    // [first, end) as used and give everything else back in smaller blocks.
+    size_t block_end = block + (1ul << order);
+
+    if (block_end <= first || block >= end)
+    {
+        block_push(block, order);
+    }
+    else if (first <= block && block_end <= end)
+    {
+        mark_used(block, block_end);
+    }
+    else
+    {
+        block_keep_outside(block, order - 1, first, end);
+        block_keep_outside(block + (1ul << (order - 1)), order - 1, first, end);
+    }
+}
+
+void BuddyAllocator::free_run(size_t first, size_t end)
+{
+    while (first < end)
+    {
+        int order = 0;
+
+        while (order + 1 < BUDDY_ORDER_COUNT &&
+               (first & ((2ul << order) - 1)) == 0 &&
+               first + (2ul << order) <= end)
+        {
+            order++;
+        }
+
+        block_free(first, order);
+        first += 1ul << order;
+    }
+}
+
+/* --- Allocation ----------------------------------------------------------- */
+
+size_t BuddyAllocator::alloc(size_t count)
+{
+    assert(count > 0);
+
+    int order = 0;
+
+    while (order < BUDDY_ORDER_COUNT && (1ul << order) < count)
+    {
+        order++;
+    }
+
+    for (int current = order; current < BUDDY_ORDER_COUNT; current++)
+    {
+        if (_free_lists[current] == NO_LINK)
+        {
+            continue;
+        }
+
+        size_t block = _free_lists[current];
+        block_remove(block, current);
+
+        while (current > order)
+        {
+            current--;
+            block_push(block + (1ul << current), current);
+        }
+
+        // Give back the tail of the block when count isn't a power of two.
+        free_run(block + count, block + (1ul << order));
+
+        mark_used(block, block + count);
+        _free_count -= count;
+
+        return block;
+    }
+
+    // Enough free memory might still be there, just not in an aligned block.
+    return alloc_linear(count);
+}
+
+size_t BuddyAllocator::alloc_linear(size_t count)
+{
+    size_t run = 0;
+
+    for (size_t page = 0; page < _page_count; page++)
+    {
+        if (page % 64 == 0 && _used[page / 64] == ~0ull)
+        {
+            page += 63;
+            run = 0;
+            continue;
+        }
+
+        if (page_used(page))
+        {
+            run = 0;
+            continue;
+        }
+
+        run++;
+
+        if (run == count)
+        {
+            size_t first = page + 1 - count;
+            set_used(first, count);
+            return first;
+        }
+    }
+
+    return NO_PAGE;
+}
+
+bool BuddyAllocator::is_used(size_t first, size_t count) const
+{
+    for (size_t page = first; page < first + count; page++)
+    {
+        if (page_used(page))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+size_t BuddyAllocator::set_used(size_t first, size_t count)
+{
+    size_t end = MIN(first + count, _page_count);
+    size_t changed = 0;
+
+    size_t page = first;
+
+    while (page < end)
+    {
+        if (page_used(page))
+        {
+            page++;
+            continue;
+        }
+
+        int order;
+        size_t block = block_containing(page, order);
+        size_t block_end = block + (1ul << order);
+
+        block_remove(block, order);
+        block_keep_outside(block, order, first, end);
+
+        changed += MIN(block_end, end) - MAX(block, first);
+        page = block_end;
+    }
+
+    _free_count -= changed;
+
+    return changed;
+}
+
+size_t BuddyAllocator::set_free(size_t first, size_t count)
+{
+    size_t end = MIN(first + count, _page_count);
+    size_t changed = 0;
+
+    size_t page = first;
+
+    while (page < end)
+    {
+        if (!page_used(page))
+        {
+            page++;
+            continue;
+        }
+
+        size_t run_end = page;
+
+        while (run_end < end && page_used(run_end))
+        {
+            run_end++;
+        }
+
+        mark_free(page, run_end);
+        free_run(page, run_end);
+
+        changed += run_end - page;
+        page = run_end;
+    }
+
+    _free_count += changed;
+
+    return changed;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <libutils/Prelude.h>
+
+// Binary buddy allocator over page numbers. Free memory is kept as naturally
+// aligned power-of-two blocks, with one free list per order. It only touches
+// its own metadata, never the pages it hands out, so it can run before they
+// are mapped anywhere.
+
+static constexpr int BUDDY_ORDER_COUNT = 20;
+
+struct BuddyAllocator
+{
+private:
+    static constexpr uint32_t NO_LINK = 0xffffffff;
+    static constexpr uint8_t NOT_A_BLOCK = 0xff;
+
+    struct Link
+    {
+        uint32_t previous;
+        uint32_t next;
+    };
+
+    size_t _page_count = 0;
+    size_t _free_count = 0;
+
+    // One bit per page, set when the page is used.
+    uint64_t *_used = nullptr;
+
+    // Free list links and order of the free block starting at each page.
+    Link *_links = nullptr;
+    uint8_t *_orders = nullptr;
+
+    uint32_t _free_lists[BUDDY_ORDER_COUNT] = {};
+
+    bool page_used(size_t page) const;
+
+    void mark_used(size_t first, size_t end);
+
+    void mark_free(size_t first, size_t end);
+
+    void block_push(size_t block, int order);
+
+    void block_remove(size_t block, int order);
+
+    void block_free(size_t block, int order);
+
+    size_t block_containing(size_t page, int &order);
+
+    void block_keep_outside(size_t block, int order, size_t first, size_t end);
+
+    void free_run(size_t first, size_t end);
+
+    size_t alloc_linear(size_t count);
+
+public:
+    static constexpr size_t NO_PAGE = (size_t)-1;
+
+    static size_t metadata_size(size_t page_count);
+
+    size_t page_count() const { return _page_count; }
+
+    size_t free_count() const { return _free_count; }
+
+    // Every page starts out used, metadata must be metadata_size() bytes.
+    void initialize(void *metadata, size_t page_count);
+
+    // Returns the first of count contiguous pages, or NO_PAGE.
+    size_t alloc(size_t count);
+
+    bool is_used(size_t first, size_t count) const;
+
+    // Both return how many pages actually changed state.
+    size_t set_used(size_t first, size_t count);
+
+    size_t set_free(size_t first, size_t count);
+};
@@ -0,0 +1,195 @@
+#include <assert.h>
+#include <libmath/MinMax.h>
+#include <string.h>
+
+#include "system/memory/FreeRunTree.h"
+
+void FreeRunTree::initialize(void *metadata, size_t page_count)
+{
+    auto *bytes = reinterpret_cast<uint8_t *>(metadata);
+
+    _page_count = page_count;
+    _leaf_count = leaf_count(page_count);
+
+    _used = reinterpret_cast<uint64_t *>(bytes);
+    bytes += _leaf_count * sizeof(uint64_t);
+
+    _nodes = reinterpret_cast<Node *>(bytes);
+
+    memset(_used, 0, _leaf_count * sizeof(uint64_t));
+
+    // The pages past the end are used forever.
+    for (size_t page = page_count; page < _leaf_count * WORD_PAGES; page++)
+    {
+        _used[page / WORD_PAGES] |= 1ull << (page % WORD_PAGES);
+    }
+
+    update(0, _leaf_count - 1);
+}
+
+/* --- Tree ----------------------------------------------------------------- */
+
+void FreeRunTree::update_leaf(size_t word)
+{
+    auto &node = _nodes[_leaf_count + word];
+    uint64_t used = _used[word];
+
+    if (used == 0)
+    {
+        node = {WORD_PAGES, WORD_PAGES, WORD_PAGES};
+        return;
+    }
+
+    node.prefix = __builtin_ctzll(used);
+    node.suffix = __builtin_clzll(used);
+
+    // Each step shortens every run of free pages by one.
+    uint64_t free = ~used;
+    uint32_t longest = 0;
+
+    while (free)
+    {
+        free &= free << 1;
+        longest++;
+    }
+
+    node.longest = longest;
+}
+
+void FreeRunTree::update_node(size_t index, size_t node_pages)
+{
+    auto &left = _nodes[index * 2];
+    auto &right = _nodes[index * 2 + 1];
+    uint32_t half = node_pages / 2;
+
+    auto &node = _nodes[index];
+
+    node.prefix = left.prefix == half ? half + right.prefix : left.prefix;
+    node.suffix = right.suffix == half ? half + left.suffix : right.suffix;
+    node.longest = MAX(MAX(left.longest, right.longest), left.suffix + right.prefix);
+}
+
+void FreeRunTree::update(size_t first_word, size_t last_word)
+{
+    for (size_t word = first_word; word <= last_word; word++)
+    {
+        update_leaf(word);
+    }
+
+    size_t node_pages = WORD_PAGES * 2;
+
+    for (size_t first = (_leaf_count + first_word) / 2, last = (_leaf_count + last_word) / 2;
+         first >= 1;
+         first /= 2, last /= 2, node_pages *= 2)
+    {
+        for (size_t index = first; index <= last; index++)
+        {
+            update_node(index, node_pages);
+        }
+    }
+}
+
+/* --- Pages ---------------------------------------------------------------- */
+
+void FreeRunTree::mark(size_t first, size_t count, bool used)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    assert(first + count <= _page_count);
+
+    size_t end = first + count;
+
+    for (size_t page = first; page < end;)
+    {
+        size_t word = page / WORD_PAGES;
+        size_t bit = page % WORD_PAGES;
+        size_t bits = MIN(WORD_PAGES - bit, end - page);
+
+        uint64_t mask = bits == WORD_PAGES ? ~0ull : ((1ull << bits) - 1) << bit;
+
+        if (used)
+        {
+            _used[word] |= mask;
+        }
+        else
+        {
+            _used[word] &= ~mask;
+        }
+
+        page += bits;
+    }
+
+    update(first / WORD_PAGES, (end - 1) / WORD_PAGES);
+}
+
+size_t FreeRunTree::find(size_t count) const
+{
+    assert(count > 0);
+
+    if (_nodes[1].longest < count)
+    {
+        return NO_PAGE;
+    }
+
+    size_t index = 1;
+    size_t first = 0;
+    size_t node_pages = _leaf_count * WORD_PAGES;
+
+    // Runs in the left half come first, then the one across the middle.
+    while (index < _leaf_count)
+    {
+        auto &left = _nodes[index * 2];
+        auto &right = _nodes[index * 2 + 1];
+
+        node_pages /= 2;
+
+        if (left.longest >= count)
+        {
+            index = index * 2;
+        }
+        else if (left.suffix + right.prefix >= count)
+        {
+            return first + node_pages - left.suffix;
+        }
+        else
+        {
+            index = index * 2 + 1;
+            first += node_pages;
+        }
+    }
+
+    uint64_t used = _used[index - _leaf_count];
+    size_t run = 0;
+
+    for (size_t bit = 0; bit < WORD_PAGES; bit++)
+    {
+        if ((used >> bit) & 1)
+        {
+            run = 0;
+        }
+        else if (++run == count)
+        {
+            return first + bit + 1 - count;
+        }
+    }
+
+    ASSERT_NOT_REACHED();
+}
+
+bool FreeRunTree::is_used(size_t page) const
+{
+    return page >= _page_count || ((_used[page / WORD_PAGES] >> (page % WORD_PAGES)) & 1);
+}
+
+void FreeRunTree::set_used(size_t first, size_t count)
+{
+    mark(first, count, true);
+}
+
+void FreeRunTree::set_free(size_t first, size_t count)
+{
+    mark(first, count, false);
+}
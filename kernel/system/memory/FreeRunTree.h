@@ -0,0 +1,75 @@
+#pragma once
+
+#include <libutils/Prelude.h>
+
+// One bit per page, in words of 64 pages, with a tree over the words that
+// remembers the longest run of free pages of each subtree and the free pages
+// at both of its ends. The first run of n free pages is found by walking down
+// the tree instead of the pages. Like the buddy allocator it only touches its
+// own metadata.
+
+struct FreeRunTree
+{
+private:
+    struct Node
+    {
+        uint32_t prefix;
+        uint32_t suffix;
+        uint32_t longest;
+    };
+
+    static constexpr size_t WORD_PAGES = 64;
+
+    size_t _page_count = 0;
+    size_t _leaf_count = 0;
+
+    // One bit per page, set when the page is used.
+    uint64_t *_used = nullptr;
+
+    // Heap ordered, the root is at 1 and the leaves start at _leaf_count.
+    Node *_nodes = nullptr;
+
+    static constexpr size_t leaf_count(size_t page_count)
+    {
+        size_t words = (page_count + WORD_PAGES - 1) / WORD_PAGES;
+        size_t count = 1;
+
+        while (count < words)
+        {
+            count *= 2;
+        }
+
+        return count;
+    }
+
+    void update_leaf(size_t word);
+
+    void update_node(size_t node, size_t node_pages);
+
+    void update(size_t first_word, size_t last_word);
+
+    void mark(size_t first, size_t count, bool used);
+
+public:
+    static constexpr size_t NO_PAGE = (size_t)-1;
+
+    static constexpr size_t metadata_size(size_t page_count)
+    {
+        return leaf_count(page_count) * sizeof(uint64_t) +
+               leaf_count(page_count) * 2 * sizeof(Node);
+    }
+
+    size_t page_count() const { return _page_count; }
+
+    // Every page starts out free, metadata must be metadata_size() bytes.
+    void initialize(void *metadata, size_t page_count);
+
+    // Returns the first of count contiguous free pages, or NO_PAGE.
+    size_t find(size_t count) const;
+
+    bool is_used(size_t page) const;
+
+    void set_used(size_t first, size_t count);
+
+    void set_free(size_t first, size_t count);
+};
@@ -2,8 +2,8 @@
 
 #include "archs/Arch.h"
 
-#include "system/interrupts/Interupts.h"
 #include "system/memory/MMIO.h"
+#include "system/memory/Memory.h"
 #include "system/memory/Physical.h"
 
 MMIORange::MMIORange()
@@ -14,7 +14,7 @@ MMIORange::MMIORange(size_t size)
 {
     size = PAGE_ALIGN_UP(size);
 
-    InterruptsRetainer retainer;
+    SpinlockHolder holder{memory_lock()};
 
     _own_physical_range = true;
     _physical_range = {physical_alloc(size)};
@@ -23,8 +23,6 @@ MMIORange::MMIORange(size_t size)
 
 MMIORange::MMIORange(MemoryRange range)
 {
-    InterruptsRetainer retainer;
-
     _physical_range = {range};
     _virtual_range = {Arch::virtual_alloc(Arch::kernel_address_space(), _physical_range, MEMORY_NONE)};
 
@@ -37,7 +35,7 @@ MMIORange::~MMIORange()
     if (empty())
         return;
 
-    InterruptsRetainer retainer;
+    SpinlockHolder holder{memory_lock()};
 
     Arch::virtual_free(Arch::kernel_address_space(), _virtual_range);
 
@@ -1,18 +1,32 @@
 
 #include <assert.h>
+#include <libmath/MinMax.h>
 #include <string.h>
 
 #include "archs/Arch.h"
 
 #include "system/Streams.h"
 #include "system/graphics/Graphics.h"
-#include "system/interrupts/Interupts.h"
+#include "system/interrupts/Spinlock.h"
+#include "system/memory/FreeRunTree.h"
 #include "system/memory/Memory.h"
 #include "system/memory/MemoryObject.h"
 #include "system/memory/Physical.h"
+#include "system/system/System.h"
 
 static bool _memory_initialized = false;
 
+static Spinlock _memory_lock{};
+
+// The first pages are left to the identity mappings of the low memory.
+static constexpr uintptr_t KERNEL_SPACE_START = 1024 * ARCH_PAGE_SIZE;
+static constexpr size_t KERNEL_SPACE_PAGES = (ARCH_KERNEL_MEMORY_END - KERNEL_SPACE_START) / ARCH_PAGE_SIZE;
+static_assert(KERNEL_SPACE_START % ARCH_LARGE_PAGE_SIZE == 0);
+
+static uint8_t _kernel_space_metadata[FreeRunTree::metadata_size(KERNEL_SPACE_PAGES)] ALIGNED(sizeof(uint64_t));
+static FreeRunTree _kernel_space{};
+static bool _kernel_space_initialized = false;
+
 extern int __start;
 extern int __end;
 
@@ -25,20 +39,11 @@ void memory_initialize(Handover *handover)
 {
     Kernel::logln("Initializing memory management...");
 
-    for (size_t i = 0; i < 1024 * 1024 / 8; i++)
-    {
-        MEMORY[i] = 0xff;
-    }
+    physical_initialize(handover, kernel_memory_range());
 
-    for (size_t i = 0; i < handover->memory_map_size; i++)
-    {
-        MemoryMapEntry *entry = &handover->memory_map[i];
-
-        if (entry->type == MEMORY_MAP_ENTRY_AVAILABLE)
-        {
-            physical_set_free(entry->range);
-        }
-    }
+    // Keep the first MiB for the firmware and the application processors
+    // trampoline, which has to live in real mode addressable memory.
+    physical_set_used({0, 1024 * 1024});
 
     Arch::virtual_initialize();
 
@@ -48,6 +53,9 @@ void memory_initialize(Handover *handover)
     Kernel::logln("Mapping kernel...");
     memory_map_identity(Arch::kernel_address_space(), kernel_memory_range(), MEMORY_NONE);
 
+    Kernel::logln("Mapping physical memory allocator...");
+    memory_map_identity(Arch::kernel_address_space(), physical_metadata_range(), MEMORY_NONE);
+
     Kernel::logln("Mapping modules...");
     for (size_t i = 0; i < handover->modules_size; i++)
     {
@@ -74,6 +82,11 @@ void memory_initialize(Handover *handover)
     memory_object_initialize();
 }
 
+Spinlock &memory_lock()
+{
+    return _memory_lock;
+}
+
 void memory_dump()
 {
     Kernel::logln("\tMemory status:");
@@ -83,14 +96,14 @@ void memory_dump()
 
 size_t memory_get_used()
 {
-    InterruptsRetainer retainer;
+    SpinlockHolder holder{_memory_lock};
 
     return USED_MEMORY;
 }
 
 size_t memory_get_total()
 {
-    InterruptsRetainer retainer;
+    SpinlockHolder holder{_memory_lock};
 
     return TOTAL_MEMORY;
 }
@@ -99,7 +112,7 @@ HjResult memory_map(Arch::AddressSpace *address_space, MemoryRange virtual_range
 {
     assert(virtual_range.is_page_aligned());
 
-    InterruptsRetainer retainer;
+    SpinlockHolder holder{_memory_lock};
 
     for (size_t i = 0; i < virtual_range.size() / ARCH_PAGE_SIZE; i++)
     {
@@ -129,7 +142,7 @@ HjResult memory_map_identity(Arch::AddressSpace *address_space, MemoryRange phys
 {
     assert(physical_range.is_page_aligned());
 
-    InterruptsRetainer retainer;
+    SpinlockHolder holder{_memory_lock};
 
     physical_set_used(physical_range);
     assert(SUCCESS == Arch::virtual_map(address_space, physical_range, physical_range.base(), flags));
@@ -147,35 +160,20 @@ HjResult memory_alloc(Arch::AddressSpace *address_space, size_t size, MemoryFlag
 {
     assert(IS_PAGE_ALIGN(size));
 
-    InterruptsRetainer retainer;
+    *out_address = 0;
 
     if (!size)
     {
-        *out_address = 0;
         Kernel::logln("Allocation with size=0!");
         return SUCCESS;
     }
 
-    *out_address = 0;
+    SpinlockHolder holder{_memory_lock};
 
+    // Both panic when they run out, nothing gets logged under the lock.
     auto physical_range = physical_alloc(size);
-
-    if (physical_range.empty())
-    {
-        Kernel::logln("Failed to allocate memory: Not enough physical memory!");
-        return ERR_OUT_OF_MEMORY;
-    }
-
     uintptr_t virtual_address = Arch::virtual_alloc(address_space, physical_range, flags).base();
 
-    if (!virtual_address)
-    {
-        physical_free(physical_range);
-
-        Kernel::logln("Failed to allocate memory: Not enough virtual memory!");
-        return ERR_OUT_OF_MEMORY;
-    }
-
     if (flags & MEMORY_CLEAR)
     {
         memset((void *)virtual_address, 0, size);
@@ -187,26 +185,28 @@ HjResult memory_alloc(Arch::AddressSpace *address_space, size_t size, MemoryFlag
 
 HjResult memory_alloc_identity(Arch::AddressSpace *address_space, MemoryFlags flags, uintptr_t *out_address)
 {
-    InterruptsRetainer retainer;
-
-    for (size_t i = 1; i < 256 * 1024; i++)
     {
-        MemoryRange identity_range{i * ARCH_PAGE_SIZE, ARCH_PAGE_SIZE};
+        SpinlockHolder holder{_memory_lock};
 
-        if (!Arch::virtual_present(address_space, identity_range.base()) &&
-            !physical_is_used(identity_range))
+        for (size_t i = 1; i < 256 * 1024; i++)
         {
-            physical_set_used(identity_range);
-            assert(SUCCESS == Arch::virtual_map(address_space, identity_range, identity_range.base(), flags));
+            MemoryRange identity_range{i * ARCH_PAGE_SIZE, ARCH_PAGE_SIZE};
 
-            if (flags & MEMORY_CLEAR)
+            if (!Arch::virtual_present(address_space, identity_range.base()) &&
+                !physical_is_used(identity_range))
             {
-                memset((void *)identity_range.base(), 0, ARCH_PAGE_SIZE);
-            }
+                physical_set_used(identity_range);
+                assert(SUCCESS == Arch::virtual_map(address_space, identity_range, identity_range.base(), flags));
+
+                if (flags & MEMORY_CLEAR)
+                {
+                    memset((void *)identity_range.base(), 0, ARCH_PAGE_SIZE);
+                }
 
-            *out_address = identity_range.base();
+                *out_address = identity_range.base();
 
-            return SUCCESS;
+                return SUCCESS;
+            }
         }
     }
 
@@ -221,21 +221,124 @@ HjResult memory_free(Arch::AddressSpace *address_space, MemoryRange virtual_rang
 {
     assert(virtual_range.is_page_aligned());
 
-    InterruptsRetainer retainer;
+    SpinlockHolder holder{_memory_lock};
+
+    // The physical pages go back in contiguous runs. The mappings are removed
+    // in one go, so large pages stay whole and the TLB is flushed (and shot
+    // down on the other processors) once.
+    MemoryRange physical_run{};
 
     for (size_t i = 0; i < virtual_range.size() / ARCH_PAGE_SIZE; i++)
     {
         uintptr_t virtual_address = virtual_range.base() + i * ARCH_PAGE_SIZE;
 
-        if (Arch::virtual_present(address_space, virtual_address))
+        if (!Arch::virtual_present(address_space, virtual_address))
         {
-            MemoryRange page_physical_range{Arch::virtual_to_physical(address_space, virtual_address), ARCH_PAGE_SIZE};
-            MemoryRange page_virtual_range{virtual_address, ARCH_PAGE_SIZE};
+            continue;
+        }
+
+        uintptr_t physical_address = Arch::virtual_to_physical(address_space, virtual_address);
 
-            physical_free(page_physical_range);
-            Arch::virtual_free(address_space, page_virtual_range);
+        if (!physical_run.empty() && physical_run.end() + 1 == physical_address)
+        {
+            physical_run = {physical_run.base(), physical_run.size() + ARCH_PAGE_SIZE};
+            continue;
         }
+
+        if (!physical_run.empty())
+        {
+            physical_free(physical_run);
+        }
+
+        physical_run = {physical_address, ARCH_PAGE_SIZE};
     }
 
+    if (!physical_run.empty())
+    {
+        physical_free(physical_run);
+    }
+
+    Arch::virtual_free(address_space, virtual_range);
+
     return SUCCESS;
 }
+
+/* --- Kernel space --------------------------------------------------------- */
+
+// Mappings happen before memory_initialize(), while the kernel maps itself.
+static FreeRunTree &kernel_space()
+{
+    if (!_kernel_space_initialized)
+    {
+        _kernel_space.initialize(_kernel_space_metadata, KERNEL_SPACE_PAGES);
+        _kernel_space_initialized = true;
+    }
+
+    return _kernel_space;
+}
+
+static bool kernel_space_pages(MemoryRange range, size_t &first, size_t &count)
+{
+    uintptr_t base = MAX(range.base(), KERNEL_SPACE_START);
+    uintptr_t end = MIN(range.base() + range.size(), (uintptr_t)ARCH_KERNEL_MEMORY_END);
+
+    if (base >= end)
+    {
+        return false;
+    }
+
+    first = (base - KERNEL_SPACE_START) / ARCH_PAGE_SIZE;
+    count = (end - base) / ARCH_PAGE_SIZE;
+
+    return true;
+}
+
+void memory_kernel_space_set_used(MemoryRange range)
+{
+    assert(_memory_lock.held());
+
+    size_t first, count;
+
+    if (kernel_space_pages(range, first, count))
+    {
+        kernel_space().set_used(first, count);
+    }
+}
+
+void memory_kernel_space_set_free(MemoryRange range)
+{
+    assert(_memory_lock.held());
+
+    size_t first, count;
+
+    if (kernel_space_pages(range, first, count))
+    {
+        kernel_space().set_free(first, count);
+    }
+}
+
+MemoryRange memory_kernel_space_find(size_t size)
+{
+    assert(_memory_lock.held());
+
+    size_t count = size / ARCH_PAGE_SIZE;
+    size_t align = size >= ARCH_LARGE_PAGE_SIZE ? ARCH_LARGE_PAGE_SIZE / ARCH_PAGE_SIZE : 1;
+
+    size_t page = kernel_space().find(count + align - 1);
+
+    // Without a free run big enough to be aligned, it ends up in small pages.
+    if (page == FreeRunTree::NO_PAGE && align > 1)
+    {
+        align = 1;
+        page = kernel_space().find(count);
+    }
+
+    if (page == FreeRunTree::NO_PAGE)
+    {
+        system_panic("Out of virtual memory!");
+    }
+
+    page = ALIGN_UP(page, align);
+
+    return {KERNEL_SPACE_START + page * ARCH_PAGE_SIZE, size};
+}
@@ -5,10 +5,15 @@
 
 #include "archs/Arch.h"
 #include "system/handover/Handover.h"
+#include "system/interrupts/Spinlock.h"
 #include "system/memory/MemoryRange.h"
 
 void memory_initialize(Handover *handover);
 
+// Physical memory, the kernel space and the page tables of every address
+// space. The functions below and the arch paging code take it themselves.
+Spinlock &memory_lock();
+
 void memory_dump();
 
 size_t memory_get_used();
@@ -24,3 +29,13 @@ HjResult memory_alloc(Arch::AddressSpace *address_space, size_t size, MemoryFlag
 HjResult memory_alloc_identity(Arch::AddressSpace *address_space, MemoryFlags flags, uintptr_t *out_address);
 
 HjResult memory_free(Arch::AddressSpace *address_space, MemoryRange range);
+
+// The kernel half is the same in every address space, the arch code keeps
+// track of which of its pages are mapped so free ones are found without
+// walking the page tables. Ranges outside of it are ignored. These expect the
+// memory lock to be held.
+void memory_kernel_space_set_used(MemoryRange range);
+
+void memory_kernel_space_set_free(MemoryRange range);
+
+MemoryRange memory_kernel_space_find(size_t size);
@@ -1,4 +1,5 @@
-#include <libutils/List.h>
+#include <libutils/HashMap.h>
+#include <string.h>
 
 #include "system/interrupts/Interupts.h"
 #include "system/memory/Memory.h"
@@ -6,11 +7,13 @@
 #include "system/memory/Physical.h"
 
 static int _memory_object_id = 0;
-static List<MemoryObject *> *_memory_objects;
+
+// Indexed by id, shared memory is looked up every time a task includes it.
+static HashMap<uint32_t, MemoryObject *> *_memory_objects;
 
 void memory_object_initialize()
 {
-    _memory_objects = new List<MemoryObject *>();
+    _memory_objects = new HashMap<uint32_t, MemoryObject *>();
 }
 
 MemoryObject *memory_object_create(size_t size)
@@ -25,14 +28,31 @@ MemoryObject *memory_object_create(size_t size)
     memory_object->refcount = 1;
     memory_object->_range = physical_alloc(size);
 
-    _memory_objects->push_back(memory_object);
+    (*_memory_objects)[memory_object->id] = memory_object;
 
     return memory_object;
 }
 
+MemoryObject *memory_object_clone(MemoryObject *memory_object)
+{
+    InterruptsRetainer retainer;
+
+    auto *clone = memory_object_create(memory_object->range().size());
+
+    auto source = Arch::virtual_alloc(Arch::kernel_address_space(), memory_object->range(), MEMORY_NONE);
+    auto destination = Arch::virtual_alloc(Arch::kernel_address_space(), clone->range(), MEMORY_NONE);
+
+    memcpy((void *)destination.base(), (void *)source.base(), source.size());
+
+    Arch::virtual_free(Arch::kernel_address_space(), source);
+    Arch::virtual_free(Arch::kernel_address_space(), destination);
+
+    return clone;
+}
+
 void memory_object_destroy(MemoryObject *memory_object)
 {
-    _memory_objects->remove(memory_object);
+    _memory_objects->remove_key((uint32_t)memory_object->id);
 
     physical_free(memory_object->range());
     free(memory_object);
@@ -59,14 +79,10 @@ MemoryObject *memory_object_by_id(int id)
 {
     InterruptsRetainer retainer;
 
-    for (auto *object : *_memory_objects)
+    if (id < 0 || !_memory_objects->has_key((uint32_t)id))
     {
-        if (object->id == id)
-        {
-            memory_object_ref(object);
-            return object;
-        }
+        return nullptr;
     }
 
-    return nullptr;
+    return memory_object_ref((*_memory_objects)[id]);
 }
@@ -2,6 +2,8 @@
 
 #include <libutils/Prelude.h>
 
+#include "system/memory/MemoryRange.h"
+
 struct MemoryObject
 {
     int id;
@@ -16,6 +18,10 @@ void memory_object_initialize();
 
 MemoryObject *memory_object_create(size_t size);
 
+// Creates a new memory object with the same content, the pages are copied
+// through a temporary mapping in the kernel address space.
+MemoryObject *memory_object_clone(MemoryObject *memory_object);
+
 void memory_object_destroy(MemoryObject *memory_object);
 
 MemoryObject *memory_object_ref(MemoryObject *memory_object);
@@ -0,0 +1,93 @@
+#include <string.h>
+
+#include "system/interrupts/Interupts.h"
+#include "system/memory/Memory.h"
+#include "system/memory/MemoryPage.h"
+#include "system/memory/Physical.h"
+
+static MemoryPage *memory_page_create(MemoryRange range)
+{
+    MemoryPage *memory_page = CREATE(MemoryPage);
+
+    memory_page->address = range.base();
+    memory_page->size = range.size();
+    memory_page->refcount = 1;
+
+    return memory_page;
+}
+
+MemoryPage *memory_page_create(size_t size)
+{
+    InterruptsRetainer retainer;
+
+    return memory_page_create(physical_alloc(size));
+}
+
+MemoryPage *memory_page_try_create(size_t size)
+{
+    InterruptsRetainer retainer;
+
+    auto range = physical_try_alloc(size);
+
+    if (range.empty())
+    {
+        return nullptr;
+    }
+
+    return memory_page_create(range);
+}
+
+MemoryPage *memory_page_copy(MemoryRange range)
+{
+    InterruptsRetainer retainer;
+
+    auto *copy = memory_page_create(range.size());
+
+    auto source = Arch::virtual_alloc(Arch::kernel_address_space(), range, MEMORY_NONE);
+    auto destination = Arch::virtual_alloc(Arch::kernel_address_space(), copy->range(), MEMORY_NONE);
+
+    memcpy((void *)destination.base(), (void *)source.base(), source.size());
+
+    Arch::virtual_free(Arch::kernel_address_space(), source);
+    Arch::virtual_free(Arch::kernel_address_space(), destination);
+
+    return copy;
+}
+
+MemoryPage *memory_page_slice(MemoryPage *large, size_t offset)
+{
+    assert(offset + ARCH_PAGE_SIZE <= large->size);
+
+    InterruptsRetainer retainer;
+
+    auto *slice = memory_page_create(MemoryRange{large->address + offset, ARCH_PAGE_SIZE});
+    slice->large = memory_page_ref(large);
+
+    return slice;
+}
+
+MemoryPage *memory_page_ref(MemoryPage *memory_page)
+{
+    __atomic_add_fetch(&memory_page->refcount, 1, __ATOMIC_SEQ_CST);
+
+    return memory_page;
+}
+
+void memory_page_deref(MemoryPage *memory_page)
+{
+    InterruptsRetainer retainer;
+
+    if (__atomic_sub_fetch(&memory_page->refcount, 1, __ATOMIC_SEQ_CST) == 0)
+    {
+        if (memory_page->large)
+        {
+            memory_page_deref(memory_page->large);
+        }
+        else
+        {
+            physical_free(memory_page->range());
+        }
+
+        free(memory_page);
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <libutils/Prelude.h>
+
+#include "system/memory/MemoryRange.h"
+
+// A page of anonymous memory, shared by a task and its clones until one of
+// them writes to it. Unlike memory objects, pages have no id and can't be
+// shared by handle, so nothing but the mappings keeps track of them.
+struct MemoryPage
+{
+    uintptr_t address;
+    size_t size;
+
+    int refcount;
+
+    // Set on the pages a large page was split into, they keep a reference
+    // on it instead of owning their memory.
+    MemoryPage *large;
+
+    MemoryRange range() { return {address, size}; }
+};
+
+MemoryPage *memory_page_create(size_t size);
+
+// Gives back nullptr instead of panicking when there isn't enough contiguous
+// memory, large pages can fall back to smaller ones.
+MemoryPage *memory_page_try_create(size_t size);
+
+// Creates a new page with the content of the physical memory at `range`,
+// which is copied through a temporary mapping in the kernel address space.
+MemoryPage *memory_page_copy(MemoryRange range);
+
+// One of the pages of a large page, `offset` bytes in.
+MemoryPage *memory_page_slice(MemoryPage *large, size_t offset);
+
+MemoryPage *memory_page_ref(MemoryPage *memory_page);
+
+void memory_page_deref(MemoryPage *memory_page);
@@ -2,70 +2,157 @@
 
 #include "archs/Memory.h"
 
-#include "system/interrupts/Interupts.h"
+#include "system/memory/BuddyAllocator.h"
+#include "system/memory/Memory.h"
 #include "system/memory/Physical.h"
 #include "system/system/System.h"
 
 size_t TOTAL_MEMORY = 0;
 size_t USED_MEMORY = 0;
 
-size_t best_bet = 0;
-uint8_t MEMORY[1024 * 1024 / 8] = {};
+// The allocator metadata has to stay reachable from every address space, so
+// it goes in the identity mapped first GiB, above the memory kept for the
+// firmware.
+static constexpr uintptr_t METADATA_LOWEST = 1024 * 1024;
+static constexpr uintptr_t METADATA_HIGHEST = 1024 * 1024 * 1024;
 
-bool physical_page_is_used(uintptr_t address)
+static BuddyAllocator _allocator{};
+static MemoryRange _metadata{};
+
+static bool physical_overlaps(MemoryRange a, MemoryRange b)
 {
-    uintptr_t page = address / ARCH_PAGE_SIZE;
+    if (a.empty() || b.empty())
+    {
+        return false;
+    }
 
-    return MEMORY[page / 8] & (1 << (page % 8));
+    return a.base() <= b.end() && b.base() <= a.end();
 }
 
-void physical_page_set_used(uintptr_t address)
+static MemoryRange physical_find_metadata_range(Handover *handover, MemoryRange kernel, size_t size)
 {
-    uintptr_t page = address / ARCH_PAGE_SIZE;
-
-    if (page == best_bet)
+    for (size_t i = 0; i < handover->memory_map_size; i++)
     {
-        best_bet++;
+        MemoryMapEntry *entry = &handover->memory_map[i];
+
+        if (entry->type != MEMORY_MAP_ENTRY_AVAILABLE)
+        {
+            continue;
+        }
+
+        uintptr_t base = ALIGN_UP(MAX(entry->range.base(), METADATA_LOWEST), ARCH_PAGE_SIZE);
+
+        // The bootloader might have put the kernel and the modules in
+        // available memory, step over them.
+        bool moved = true;
+
+        while (moved)
+        {
+            moved = false;
+
+            if (physical_overlaps({base, size}, kernel))
+            {
+                base = ALIGN_UP(kernel.end() + 1, ARCH_PAGE_SIZE);
+                moved = true;
+            }
+
+            for (size_t j = 0; j < handover->modules_size; j++)
+            {
+                MemoryRange module = handover->modules[j].range;
+
+                if (physical_overlaps({base, size}, module))
+                {
+                    base = ALIGN_UP(module.end() + 1, ARCH_PAGE_SIZE);
+                    moved = true;
+                }
+            }
+        }
+
+        if (base + size <= entry->range.base() + entry->range.size() &&
+            base + size <= METADATA_HIGHEST)
+        {
+            return {base, size};
+        }
     }
 
-    MEMORY[page / 8] |= 1 << (page % 8);
+    system_panic("No room for the physical memory allocator (%dkio)!", size / 1024);
 }
 
-void physical_page_set_free(uintptr_t address)
+void physical_initialize(Handover *handover, MemoryRange kernel)
 {
-    uintptr_t page = address / ARCH_PAGE_SIZE;
+    uintptr_t highest = 0;
 
-    if (page < best_bet)
+    for (size_t i = 0; i < handover->memory_map_size; i++)
     {
-        best_bet = page;
+        MemoryMapEntry *entry = &handover->memory_map[i];
+
+        if (entry->type == MEMORY_MAP_ENTRY_AVAILABLE)
+        {
+            highest = MAX(highest, entry->range.base() + entry->range.size());
+        }
     }
 
-    MEMORY[page / 8] &= ~(1 << (page % 8));
+    size_t page_count = highest / ARCH_PAGE_SIZE;
+    size_t size = ALIGN_UP(BuddyAllocator::metadata_size(page_count), ARCH_PAGE_SIZE);
+
+    _metadata = physical_find_metadata_range(handover, kernel, size);
+
+    Kernel::logln("Physical allocator metadata for {} pages at {p} ({}kio)", page_count, _metadata.base(), size / 1024);
+
+    _allocator.initialize(reinterpret_cast<void *>(_metadata.base()), page_count);
+
+    for (size_t i = 0; i < handover->memory_map_size; i++)
+    {
+        MemoryMapEntry *entry = &handover->memory_map[i];
+
+        if (entry->type == MEMORY_MAP_ENTRY_AVAILABLE)
+        {
+            _allocator.set_free(entry->range.base() / ARCH_PAGE_SIZE, entry->range.page_count());
+        }
+    }
+
+    // The metadata itself stays on the free lists until memory_initialize()
+    // maps it, like the kernel, nothing gets allocated before that.
+}
+
+MemoryRange physical_metadata_range()
+{
+    return _metadata;
 }
 
 MemoryRange physical_alloc(size_t size)
 {
-    ASSERT_INTERRUPTS_RETAINED();
+    auto range = physical_try_alloc(size);
+
+    if (range.empty())
+    {
+        system_panic("Out of physical memory!\tTrying to allocat %dkio but free memory is %dkio !", size / 1024, (TOTAL_MEMORY - USED_MEMORY) / 1024);
+    }
+
+    return range;
+}
+
+MemoryRange physical_try_alloc(size_t size)
+{
+    SpinlockHolder holder{memory_lock()};
 
     assert(IS_PAGE_ALIGN(size));
 
-    for (size_t i = best_bet; i < ((TOTAL_MEMORY - size) / ARCH_PAGE_SIZE); i++)
-    {
-        MemoryRange range(i * ARCH_PAGE_SIZE, size);
+    size_t page = _allocator.alloc(size / ARCH_PAGE_SIZE);
 
-        if (!physical_is_used(range))
-        {
-            physical_set_used(range);
-            return range;
-        }
+    if (page == BuddyAllocator::NO_PAGE)
+    {
+        return {};
     }
 
-    system_panic("Out of physical memory!\tTrying to allocat %dkio but free memory is %dkio !", size / 1024, (TOTAL_MEMORY - USED_MEMORY) / 1024);
+    USED_MEMORY += size;
+
+    return {page * ARCH_PAGE_SIZE, size};
 }
 
 void physical_free(MemoryRange range)
 {
-    ASSERT_INTERRUPTS_RETAINED();
+    SpinlockHolder holder{memory_lock()};
 
     assert(range.is_page_aligned());
 
@@ -74,55 +161,27 @@ void physical_free(MemoryRange range)
 
 bool physical_is_used(MemoryRange range)
 {
-    ASSERT_INTERRUPTS_RETAINED();
+    SpinlockHolder holder{memory_lock()};
 
     assert(range.is_page_aligned());
 
-    for (size_t i = 0; i < range.page_count(); i++)
-    {
-        uintptr_t address = range.base() + i * ARCH_PAGE_SIZE;
-
-        if (physical_page_is_used(address))
-        {
-            return true;
-        }
-    }
-
-    return false;
+    return _allocator.is_used(range.base() / ARCH_PAGE_SIZE, range.page_count());
 }
 
 void physical_set_used(MemoryRange range)
 {
-    ASSERT_INTERRUPTS_RETAINED();
+    SpinlockHolder holder{memory_lock()};
 
     assert(range.is_page_aligned());
 
-    for (size_t i = 0; i < range.page_count(); i++)
-    {
-        uintptr_t address = range.base() + i * ARCH_PAGE_SIZE;
-
-        if (!physical_page_is_used(address))
-        {
-            USED_MEMORY += ARCH_PAGE_SIZE;
-            physical_page_set_used(address);
-        }
-    }
+    USED_MEMORY += _allocator.set_used(range.base() / ARCH_PAGE_SIZE, range.page_count()) * ARCH_PAGE_SIZE;
 }
 
 void physical_set_free(MemoryRange range)
 {
-    ASSERT_INTERRUPTS_RETAINED();
+    SpinlockHolder holder{memory_lock()};
 
     assert(range.is_page_aligned());
 
-    for (size_t i = 0; i < range.page_count(); i++)
-    {
-        uintptr_t address = range.base() + i * ARCH_PAGE_SIZE;
-
-        if (physical_page_is_used(address))
-        {
-            USED_MEMORY -= ARCH_PAGE_SIZE;
-            physical_page_set_free(address);
-        }
-    }
+    USED_MEMORY -= _allocator.set_free(range.base() / ARCH_PAGE_SIZE, range.page_count()) * ARCH_PAGE_SIZE;
 }
@@ -2,14 +2,22 @@
 
 #include <libutils/Prelude.h>
 
+#include "system/handover/Handover.h"
 #include "system/memory/MemoryRange.h"
 
 extern size_t TOTAL_MEMORY;
 extern size_t USED_MEMORY;
-extern uint8_t MEMORY[1024 * 1024 / 8];
+
+void physical_initialize(Handover *handover, MemoryRange kernel);
+
+MemoryRange physical_metadata_range();
 
 MemoryRange physical_alloc(size_t size);
 
+// Like physical_alloc() but gives back an empty range when there isn't
+// enough contiguous memory instead of panicking.
+MemoryRange physical_try_alloc(size_t size);
+
 void physical_free(MemoryRange range);
 
 bool physical_is_used(MemoryRange range);
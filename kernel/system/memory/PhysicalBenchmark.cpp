@@ -0,0 +1,187 @@
+#include <string.h>
+
+#include "archs/Arch.h"
+
+#include "system/Streams.h"
+#include "system/memory/BuddyAllocator.h"
+#include "system/memory/PhysicalBenchmark.h"
+
+// 128MiB worth of pages, neither allocator ever touches the pages themselves.
+static constexpr size_t BENCHMARK_PAGES = 32 * 1024;
+static constexpr size_t BENCHMARK_ROUNDS = 4096;
+static constexpr size_t BENCHMARK_LIVE = 256;
+static constexpr size_t BENCHMARK_SIZES[] = {1, 1, 1, 1, 2, 2, 4, 8};
+
+// What physical_alloc() used to do: a first-fit scan of a bitmap, starting
+// from the lowest page that was ever freed.
+struct LinearBitmapAllocator
+{
+private:
+    uint8_t *_bitmap;
+    size_t _page_count;
+    size_t _best_bet = 0;
+
+    bool page_used(size_t page) const
+    {
+        return _bitmap[page / 8] & (1 << (page % 8));
+    }
+
+public:
+    static constexpr size_t NO_PAGE = (size_t)-1;
+
+    LinearBitmapAllocator(uint8_t *bitmap, size_t page_count)
+        : _bitmap{bitmap}, _page_count{page_count}
+    {
+        memset(_bitmap, 0xff, page_count / 8);
+    }
+
+    bool is_used(size_t first, size_t count) const
+    {
+        for (size_t page = first; page < first + count; page++)
+        {
+            if (page_used(page))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void set_used(size_t first, size_t count)
+    {
+        for (size_t page = first; page < first + count; page++)
+        {
+            if (page == _best_bet)
+            {
+                _best_bet++;
+            }
+
+            _bitmap[page / 8] |= 1 << (page % 8);
+        }
+    }
+
+    void set_free(size_t first, size_t count)
+    {
+        for (size_t page = first; page < first + count; page++)
+        {
+            if (page < _best_bet)
+            {
+                _best_bet = page;
+            }
+
+            _bitmap[page / 8] &= ~(1 << (page % 8));
+        }
+    }
+
+    size_t alloc(size_t count)
+    {
+        for (size_t page = _best_bet; page < _page_count - count; page++)
+        {
+            if (!is_used(page, count))
+            {
+                set_used(page, count);
+                return page;
+            }
+        }
+
+        return NO_PAGE;
+    }
+};
+
+struct Allocation
+{
+    size_t page;
+    size_t count;
+};
+
+static uint32_t benchmark_random(uint32_t &state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+template <typename TAllocator>
+static void benchmark_run(const char *name, TAllocator &allocator)
+{
+    uint32_t random = 0x5eed;
+
+    // Fragment the memory: allocate everything one page at a time, then give
+    // back about half of it in random order.
+    allocator.set_free(0, BENCHMARK_PAGES);
+
+    for (size_t i = 0; i < BENCHMARK_PAGES; i++)
+    {
+        allocator.alloc(1);
+    }
+
+    for (size_t i = 0; i < BENCHMARK_PAGES; i++)
+    {
+        if (benchmark_random(random) % 2)
+        {
+            allocator.set_free(i, 1);
+        }
+    }
+
+    Allocation live[BENCHMARK_LIVE] = {};
+
+    uint64_t alloc_cycles = 0;
+    uint64_t free_cycles = 0;
+    size_t frees = 0;
+    size_t failures = 0;
+
+    for (size_t round = 0; round < BENCHMARK_ROUNDS; round++)
+    {
+        auto &slot = live[round % BENCHMARK_LIVE];
+
+        if (slot.count)
+        {
+            uint64_t start = Arch::get_cycles();
+            allocator.set_free(slot.page, slot.count);
+            free_cycles += Arch::get_cycles() - start;
+
+            frees++;
+            slot = {};
+        }
+
+        size_t count = BENCHMARK_SIZES[benchmark_random(random) % ARRAY_LENGTH(BENCHMARK_SIZES)];
+
+        uint64_t start = Arch::get_cycles();
+        size_t page = allocator.alloc(count);
+        alloc_cycles += Arch::get_cycles() - start;
+
+        if (page == TAllocator::NO_PAGE)
+        {
+            failures++;
+        }
+        else
+        {
+            slot = {page, count};
+        }
+    }
+
+    Kernel::logln("{}\t{}\t{}\t{}",
+                  name,
+                  alloc_cycles / BENCHMARK_ROUNDS,
+                  frees ? free_cycles / frees : 0,
+                  failures);
+}
+
+void physical_benchmark()
+{
+    Kernel::logln("Benchmarking the physical memory allocator over {} pages...", BENCHMARK_PAGES);
+    Kernel::logln("allocator\tcycles/alloc\tcycles/free\tfailures");
+
+    auto *bitmap = new uint8_t[BENCHMARK_PAGES / 8];
+    LinearBitmapAllocator linear{bitmap, BENCHMARK_PAGES};
+    benchmark_run("linear", linear);
+    delete[] bitmap;
+
+    auto *metadata = new uint8_t[BuddyAllocator::metadata_size(BENCHMARK_PAGES)];
+    BuddyAllocator buddy{};
+    buddy.initialize(metadata, BENCHMARK_PAGES);
+    benchmark_run("buddy", buddy);
+    delete[] metadata;
+}
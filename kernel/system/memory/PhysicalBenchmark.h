@@ -0,0 +1,6 @@
+#pragma once
+
+// Compares the buddy allocator against the linear bitmap scan it replaced,
+// on a fragmented synthetic memory map. Enabled with "benchmark=physical" on
+// the kernel command line.
+void physical_benchmark();
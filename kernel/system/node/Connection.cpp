@@ -11,6 +11,10 @@ FsConnection::FsConnection() : FsNode(HJ_FILE_TYPE_CONNECTION) {}
 void FsConnection::accepted()
 {
     _accepted = true;
+
+    // The client is blocked on the connection, not on the socket the server
+    // is holding right now.
+    write_waiters().wake_up();
 }
 
 bool FsConnection::is_accepted()
@@ -20,6 +20,16 @@ public:
     {
     }
 
+    WaitQueue &read_waiters() override
+    {
+        return _device->waiters();
+    }
+
+    WaitQueue &write_waiters() override
+    {
+        return _device->waiters();
+    }
+
     size_t size() override
     {
         return _device->size();
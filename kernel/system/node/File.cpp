@@ -2,62 +2,180 @@
 #include <libmath/MinMax.h>
 #include <string.h>
 
+#include "archs/Arch.h"
+#include "system/interrupts/Interupts.h"
 #include "system/node/File.h"
 #include "system/node/Handle.h"
 
 FsFile::FsFile() : FsNode(HJ_FILE_TYPE_REGULAR)
 {
-    _buffer = (char *)malloc(512);
-    _buffer_allocated = 512;
-    _buffer_size = 0;
 }
 
 FsFile::~FsFile()
 {
-    free(_buffer);
+    truncate();
 }
 
-HjResult FsFile::open(FsHandle &handle)
+size_t FsFile::extent_index(size_t offset)
 {
-    if (handle.has_flag(HJ_OPEN_TRUNC))
+    size_t low = 0;
+    size_t high = _extents.count();
+
+    while (high - low > 1)
     {
-        free(_buffer);
-        _buffer = (char *)malloc(512);
-        _buffer_allocated = 512;
-        _buffer_size = 0;
+        size_t middle = (low + high) / 2;
+
+        if (_extents[middle].offset <= offset)
+        {
+            low = middle;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+HjResult FsFile::reserve(size_t size)
+{
+    InterruptsRetainer retainer;
+
+    while (_capacity < size)
+    {
+        size_t extent_size = MIN(MAX(_capacity, (size_t)ARCH_PAGE_SIZE), MAX_EXTENT_SIZE);
+
+        auto *object = memory_object_create(extent_size);
+
+        if (object->range().empty())
+        {
+            memory_object_deref(object);
+            return ERR_OUT_OF_MEMORY;
+        }
+
+        auto *data = (uint8_t *)Arch::virtual_alloc(Arch::kernel_address_space(), object->range(), MEMORY_NONE).base();
+        memset(data, 0, extent_size);
+
+        _extents.push_back({object, data, _capacity, extent_size});
+        _capacity += extent_size;
     }
 
     return SUCCESS;
 }
 
-size_t FsFile::size()
+void FsFile::truncate()
 {
-    return _buffer_size;
+    InterruptsRetainer retainer;
+
+    for (auto &extent : _extents)
+    {
+        // Tasks which mapped the file keep their own reference on the pages.
+        Arch::virtual_free(Arch::kernel_address_space(), {(uintptr_t)extent.data, extent.size});
+        memory_object_deref(extent.object);
+    }
+
+    _extents.clear();
+    _capacity = 0;
+    _size = 0;
 }
 
-ResultOr<size_t> FsFile::read(FsHandle &handle, void *buffer, size_t size)
+ResultOr<size_t> FsFile::read_at(size_t offset, void *buffer, size_t size)
 {
+    if (offset >= _size)
+    {
+        return 0;
+    }
+
+    size = MIN(_size - offset, size);
+
     size_t read = 0;
+    size_t index = extent_index(offset);
 
-    if (handle.offset() <= _buffer_size)
+    while (read < size)
     {
-        read = MIN(_buffer_size - handle.offset(), size);
-        memcpy(buffer, (char *)_buffer + handle.offset(), read);
+        auto &extent = _extents[index];
+
+        size_t extent_offset = offset + read - extent.offset;
+        size_t chunk = MIN(extent.size - extent_offset, size - read);
+
+        memcpy((uint8_t *)buffer + read, extent.data + extent_offset, chunk);
+
+        read += chunk;
+        index++;
     }
 
     return read;
 }
 
-ResultOr<size_t> FsFile::write(FsHandle &handle, const void *buffer, size_t size)
+ResultOr<size_t> FsFile::write_at(size_t offset, const void *buffer, size_t size)
+{
+    if (size == 0)
+    {
+        return 0;
+    }
+
+    TRY(reserve(offset + size));
+
+    size_t written = 0;
+    size_t index = extent_index(offset);
+
+    while (written < size)
+    {
+        auto &extent = _extents[index];
+
+        size_t extent_offset = offset + written - extent.offset;
+        size_t chunk = MIN(extent.size - extent_offset, size - written);
+
+        memcpy(extent.data + extent_offset, (const uint8_t *)buffer + written, chunk);
+
+        written += chunk;
+        index++;
+    }
+
+    _size = MAX(offset + size, _size);
+
+    return written;
+}
+
+HjResult FsFile::open(FsHandle &handle)
 {
-    if ((handle.offset() + size) > _buffer_allocated)
+    if (handle.has_flag(HJ_OPEN_TRUNC))
     {
-        _buffer = (char *)realloc(_buffer, handle.offset() + size);
-        _buffer_allocated = handle.offset() + size;
+        truncate();
     }
 
-    _buffer_size = MAX(handle.offset() + size, _buffer_size);
-    memcpy((char *)(_buffer) + handle.offset(), buffer, size);
+    return SUCCESS;
+}
+
+size_t FsFile::size()
+{
+    return _size;
+}
+
+ResultOr<size_t> FsFile::read(FsHandle &handle, void *buffer, size_t size)
+{
+    return read_at(handle.offset(), buffer, size);
+}
+
+ResultOr<size_t> FsFile::write(FsHandle &handle, const void *buffer, size_t size)
+{
+    return write_at(handle.offset(), buffer, size);
+}
+
+ResultOr<Vec<MemoryObject *>> FsFile::map(FsHandle &)
+{
+    Vec<MemoryObject *> objects;
+
+    for (auto &extent : _extents)
+    {
+        if (extent.offset >= _size)
+        {
+            break;
+        }
+
+        objects.push_back(extent.object);
+    }
 
-    return size;
+    return objects;
 }
@@ -1,13 +1,39 @@
 #pragma once
 
+#include <libutils/Vec.h>
+
+#include "system/memory/MemoryObject.h"
 #include "system/node/Node.h"
 
 struct FsFile : public FsNode
 {
 private:
-    char *_buffer;
-    size_t _buffer_allocated;
-    size_t _buffer_size;
+    // Each extent is twice as big as the previous one, up to
+    // MAX_EXTENT_SIZE, so appending never moves what is already written.
+    static constexpr size_t MAX_EXTENT_SIZE = 256 * 1024;
+
+    struct Extent
+    {
+        MemoryObject *object;
+        uint8_t *data;
+        size_t offset;
+        size_t size;
+    };
+
+    Vec<Extent> _extents;
+    size_t _capacity = 0;
+    size_t _size = 0;
+
+    size_t extent_index(size_t offset);
+
+    HjResult reserve(size_t size);
+
+protected:
+    void truncate();
+
+    ResultOr<size_t> read_at(size_t offset, void *buffer, size_t size);
+
+    ResultOr<size_t> write_at(size_t offset, const void *buffer, size_t size);
 
 public:
     FsFile();
@@ -21,4 +47,6 @@ public:
     ResultOr<size_t> read(FsHandle &handle, void *buffer, size_t size) override;
 
     ResultOr<size_t> write(FsHandle &handle, const void *buffer, size_t size) override;
+
+    ResultOr<Vec<MemoryObject *>> map(FsHandle &handle) override;
 };
@@ -111,6 +111,9 @@ ResultOr<size_t> FsHandle::read(void *buffer, size_t size)
     _offset += read_result.unwrap();
     _node->release(scheduler_running_id());
 
+    // There is room for the writers now.
+    _node->write_waiters().wake_up();
+
     return read_result;
 }
 
@@ -146,6 +149,9 @@ ResultOr<size_t> FsHandle::write(const void *buffer, size_t size)
 
         _node->release(scheduler_running_id());
 
+        // And something to read for the readers.
+        _node->read_waiters().wake_up();
+
         return write_result;
     };
 
@@ -237,6 +243,32 @@ HjResult FsHandle::stat(HjStat *stat)
     return SUCCESS;
 }
 
+ResultOr<Vec<MemoryObject *>> FsHandle::map(size_t *size)
+{
+    if (!has_flag(HJ_OPEN_READ))
+    {
+        return ERR_WRITE_ONLY_STREAM;
+    }
+
+    _node->acquire(scheduler_running_id());
+
+    auto objects_or_result = _node->map(*this);
+
+    if (objects_or_result.success())
+    {
+        for (auto *object : objects_or_result.unwrap())
+        {
+            memory_object_ref(object);
+        }
+
+        *size = _node->size();
+    }
+
+    _node->release(scheduler_running_id());
+
+    return objects_or_result;
+}
+
 ResultOr<RefPtr<FsHandle>> FsHandle::accept()
 {
     BlockerAccept blocker{_node};
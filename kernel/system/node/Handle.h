@@ -49,5 +49,8 @@ public:
 
     HjResult stat(HjStat *stat);
 
+    // The memory objects of the node, referenced for the caller.
+    ResultOr<Vec<MemoryObject *>> map(size_t *size);
+
     ResultOr<RefPtr<FsHandle>> accept();
 };
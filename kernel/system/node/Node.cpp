@@ -1,5 +1,6 @@
 #include <string.h>
 
+#include "system/interrupts/Interupts.h"
 #include "system/node/Handle.h"
 #include "system/node/Node.h"
 
@@ -52,11 +53,24 @@ void FsNode::deref_handle(FsHandle &handle)
     {
         __atomic_sub_fetch(&_server, 1, __ATOMIC_SEQ_CST);
     }
+
+    // Readers and writers waiting on the other end might want to know.
+    read_waiters().wake_up();
+    write_waiters().wake_up();
 }
 
 bool FsNode::is_acquire()
 {
-    return _lock.locked();
+    if (!_lock.locked())
+    {
+        return false;
+    }
+
+    // Blockers ask this, the tasks waiting for the node to be released have
+    // to be woken up by release() whatever queue they are on.
+    _contended = true;
+
+    return true;
 }
 
 void FsNode::acquire(int who_acquire)
@@ -67,4 +81,13 @@ void FsNode::acquire(int who_acquire)
 void FsNode::release(int who_release)
 {
     _lock.release_for(who_release);
+
+    InterruptsRetainer retainer;
+
+    if (_contended)
+    {
+        _contended = false;
+        read_waiters().wake_up();
+        write_waiters().wake_up();
+    }
 }
@@ -8,6 +8,10 @@
 #include <libutils/RefPtr.h>
 #include <libutils/ResultOr.h>
 #include <libutils/String.h>
+#include <libutils/Vec.h>
+
+#include "system/memory/MemoryObject.h"
+#include "system/scheduling/WaitQueue.h"
 
 struct FsNode;
 struct FsHandle;
@@ -23,6 +27,10 @@ private:
     unsigned int _clients = 0;
     unsigned int _server = 0;
 
+    WaitQueue _read_waiters{};
+    WaitQueue _write_waiters{};
+    bool _contended = false;
+
 public:
     HjFileType type() { return _type; }
 
@@ -40,6 +48,14 @@ public:
     {
     }
 
+    // Tasks blocked until they can read from (or accept on) this node, woken
+    // up by writes.
+    virtual WaitQueue &read_waiters() { return _read_waiters; }
+
+    // Tasks blocked until they can write to (or connect over) this node,
+    // woken up by reads.
+    virtual WaitQueue &write_waiters() { return _write_waiters; }
+
     void ref_handle(FsHandle &handle);
 
     void deref_handle(FsHandle &handle);
@@ -81,6 +97,15 @@ public:
         return ERR_NOT_WRITABLE;
     }
 
+    // The memory objects holding the content of the node, in order, so it
+    // can be mapped in the address space of a task.
+    virtual ResultOr<Vec<MemoryObject *>> map(FsHandle &handle)
+    {
+        UNUSED(handle);
+
+        return ERR_OPERATION_NOT_SUPPORTED;
+    }
+
     virtual RefPtr<FsNode> find(String name)
     {
         UNUSED(name);
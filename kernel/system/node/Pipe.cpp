@@ -4,19 +4,19 @@
 #include "system/node/Handle.h"
 #include "system/node/Pipe.h"
 
-FsPipe::FsPipe() : FsNode(HJ_FILE_TYPE_PIPE)
+FsPipe::FsPipe(size_t capacity)
+    : FsNode(HJ_FILE_TYPE_PIPE),
+      _buffer{capacity}
 {
 }
 
 bool FsPipe::can_read(FsHandle &)
 {
-    // FIXME: make this atomic or something...
     return !_buffer.empty() || !writers();
 }
 
 bool FsPipe::can_write(FsHandle &)
 {
-    // FIXME: make this atomic or something...
     return !_buffer.full() || !readers();
 }
 
@@ -29,7 +29,7 @@ ResultOr<size_t> FsPipe::read(FsHandle &handle, void *buffer, size_t size)
         return ERR_STREAM_CLOSED;
     }
 
-    return _buffer.read((char *)buffer, size);
+    return _buffer.read(buffer, size);
 }
 
 ResultOr<size_t> FsPipe::write(FsHandle &handle, const void *buffer, size_t size)
@@ -41,5 +41,5 @@ ResultOr<size_t> FsPipe::write(FsHandle &handle, const void *buffer, size_t size
         return ERR_STREAM_CLOSED;
     }
 
-    return _buffer.write((const char *)buffer, size);
+    return _buffer.write(buffer, size);
 }
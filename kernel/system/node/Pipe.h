@@ -1,18 +1,17 @@
 #pragma once
 
-#include <libutils/Ring.h>
-
 #include "system/node/Node.h"
+#include "system/node/PipeBuffer.h"
 
 struct FsPipe : public FsNode
 {
 private:
-    static constexpr int BUFFER_SIZE = 4096;
-
-    Ring<char> _buffer{BUFFER_SIZE};
+    PipeBuffer _buffer;
 
 public:
-    FsPipe();
+    static constexpr size_t DEFAULT_CAPACITY = 64 * 1024;
+
+    FsPipe(size_t capacity);
 
     bool can_read(FsHandle &handle) override;
 
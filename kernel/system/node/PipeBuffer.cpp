@@ -0,0 +1,59 @@
+#include <assert.h>
+#include <libmath/MinMax.h>
+#include <string.h>
+
+#include "archs/Arch.h"
+#include "system/memory/Memory.h"
+#include "system/node/PipeBuffer.h"
+
+PipeBuffer::PipeBuffer(size_t capacity)
+{
+    _capacity = MIN_CAPACITY;
+
+    while (_capacity < MIN(capacity, MAX_CAPACITY))
+    {
+        _capacity *= 2;
+    }
+
+    assert(memory_alloc(Arch::kernel_address_space(), _capacity, MEMORY_NONE, (uintptr_t *)&_data) == SUCCESS);
+}
+
+PipeBuffer::~PipeBuffer()
+{
+    memory_free(Arch::kernel_address_space(), (MemoryRange){(uintptr_t)_data, _capacity});
+}
+
+size_t PipeBuffer::read(void *buffer, size_t size)
+{
+    size_t read = _read;
+    size_t available = __atomic_load_n(&_written, __ATOMIC_ACQUIRE) - read;
+    size = MIN(size, available);
+
+    // At most two copies, before and after the end of the buffer.
+    size_t offset = read & (_capacity - 1);
+    size_t first = MIN(size, _capacity - offset);
+
+    memcpy(buffer, _data + offset, first);
+    memcpy((char *)buffer + first, _data, size - first);
+
+    __atomic_store_n(&_read, read + size, __ATOMIC_RELEASE);
+
+    return size;
+}
+
+size_t PipeBuffer::write(const void *buffer, size_t size)
+{
+    size_t written = _written;
+    size_t available = _capacity - (written - __atomic_load_n(&_read, __ATOMIC_ACQUIRE));
+    size = MIN(size, available);
+
+    size_t offset = written & (_capacity - 1);
+    size_t first = MIN(size, _capacity - offset);
+
+    memcpy(_data + offset, buffer, first);
+    memcpy(_data, (const char *)buffer + first, size - first);
+
+    __atomic_store_n(&_written, written + size, __ATOMIC_RELEASE);
+
+    return size;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <libutils/Prelude.h>
+
+// The bytes in flight between the two ends of a pipe or a terminal, in
+// pages of their own. The node is held while reading or writing, so there
+// is a single reader and a single writer at a time: each side only advances
+// its own position, and the other side can look at it without a lock.
+struct PipeBuffer
+{
+private:
+    char *_data = nullptr;
+    size_t _capacity = 0;
+
+    // Bytes read and written since the creation of the buffer, they wrap
+    // around together and their difference is what's in the buffer.
+    size_t _read = 0;
+    size_t _written = 0;
+
+public:
+    static constexpr size_t MIN_CAPACITY = 4096;
+    static constexpr size_t MAX_CAPACITY = 1024 * 1024;
+
+    NONCOPYABLE(PipeBuffer);
+    NONMOVABLE(PipeBuffer);
+
+    size_t capacity() const { return _capacity; }
+
+    size_t used() const
+    {
+        return __atomic_load_n(&_written, __ATOMIC_ACQUIRE) -
+               __atomic_load_n(&_read, __ATOMIC_ACQUIRE);
+    }
+
+    bool empty() const { return used() == 0; }
+
+    bool full() const { return used() == _capacity; }
+
+    // The capacity is rounded up to a power of two between MIN_CAPACITY and
+    // MAX_CAPACITY.
+    PipeBuffer(size_t capacity);
+
+    ~PipeBuffer();
+
+    size_t read(void *buffer, size_t size);
+
+    size_t write(const void *buffer, size_t size);
+};
@@ -35,7 +35,7 @@ ResultOr<size_t> FsTerminal::read(FsHandle &handle, void *buffer, size_t size)
     {
         if (writers())
         {
-            return client_to_server_buffer.read((char *)buffer, size);
+            return client_to_server_buffer.read(buffer, size);
         }
         else
         {
@@ -46,7 +46,7 @@ ResultOr<size_t> FsTerminal::read(FsHandle &handle, void *buffer, size_t size)
     {
         if (server())
         {
-            return server_to_client_buffer.read((char *)buffer, size);
+            return server_to_client_buffer.read(buffer, size);
         }
         else
         {
@@ -61,7 +61,7 @@ ResultOr<size_t> FsTerminal::write(FsHandle &handle, const void *buffer, size_t
     {
         if (readers())
         {
-            return server_to_client_buffer.write((const char *)buffer, size);
+            return server_to_client_buffer.write(buffer, size);
         }
         else
         {
@@ -72,7 +72,7 @@ ResultOr<size_t> FsTerminal::write(FsHandle &handle, const void *buffer, size_t
     {
         if (server())
         {
-            return client_to_server_buffer.write((const char *)buffer, size);
+            return client_to_server_buffer.write(buffer, size);
         }
         else
         {
@@ -1,20 +1,19 @@
 #pragma once
 
-#include <libutils/Ring.h>
-
 #include "system/node/Node.h"
+#include "system/node/PipeBuffer.h"
 
 struct FsTerminal : public FsNode
 {
 private:
-    static constexpr int BUFFER_SIZE = 1024;
+    static constexpr size_t BUFFER_SIZE = 16 * 1024;
 
     int _width = 80;
     int _height = 25;
 
 public:
-    Ring<char> server_to_client_buffer{BUFFER_SIZE};
-    Ring<char> client_to_server_buffer{BUFFER_SIZE};
+    PipeBuffer server_to_client_buffer{BUFFER_SIZE};
+    PipeBuffer client_to_server_buffer{BUFFER_SIZE};
 
     FsTerminal();
 
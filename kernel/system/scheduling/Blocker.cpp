@@ -8,6 +8,16 @@ bool BlockerAccept::can_unblock(Task &)
     return !_node->is_acquire() && _node->can_accept();
 }
 
+void BlockerAccept::attach(Task &task)
+{
+    _node->read_waiters().add(&task);
+}
+
+void BlockerAccept::detach(Task &task)
+{
+    _node->read_waiters().remove(&task);
+}
+
 void BlockerAccept::on_unblock(Task &task)
 {
     _node->acquire(task.id);
@@ -20,6 +30,16 @@ bool BlockerConnect::can_unblock(Task &)
     return _connection->is_accepted();
 }
 
+void BlockerConnect::attach(Task &task)
+{
+    _connection->write_waiters().add(&task);
+}
+
+void BlockerConnect::detach(Task &task)
+{
+    _connection->write_waiters().remove(&task);
+}
+
 /* --- BlockerRead ---------------------------------------------------------- */
 
 bool BlockerRead::can_unblock(Task &)
@@ -27,6 +47,16 @@ bool BlockerRead::can_unblock(Task &)
     return !_handle.node()->is_acquire() && _handle.node()->can_read(_handle);
 }
 
+void BlockerRead::attach(Task &task)
+{
+    _handle.node()->read_waiters().add(&task);
+}
+
+void BlockerRead::detach(Task &task)
+{
+    _handle.node()->read_waiters().remove(&task);
+}
+
 void BlockerRead::on_unblock(Task &task)
 {
     _handle.node()->acquire(task.id);
@@ -53,6 +83,33 @@ bool BlockerSelect::can_unblock(Task &)
     return should_be_unblock;
 }
 
+void BlockerSelect::attach(Task &task)
+{
+    for (size_t i = 0; i < _handles.count(); i++)
+    {
+        auto &selected = _handles[i];
+
+        if (selected.events & (POLL_READ | POLL_ACCEPT))
+        {
+            selected.handle->node()->read_waiters().add(&task);
+        }
+
+        if (selected.events & (POLL_WRITE | POLL_CONNECT))
+        {
+            selected.handle->node()->write_waiters().add(&task);
+        }
+    }
+}
+
+void BlockerSelect::detach(Task &task)
+{
+    for (size_t i = 0; i < _handles.count(); i++)
+    {
+        _handles[i].handle->node()->read_waiters().remove(&task);
+        _handles[i].handle->node()->write_waiters().remove(&task);
+    }
+}
+
 /* --- BlockerWait ---------------------------------------------------------- */
 
 bool BlockerWait::can_unblock(Task &)
@@ -60,6 +117,16 @@ bool BlockerWait::can_unblock(Task &)
     return _task->state() == TASK_STATE_CANCELING;
 }
 
+void BlockerWait::attach(Task &task)
+{
+    _task->exit_waiters().add(&task);
+}
+
+void BlockerWait::detach(Task &task)
+{
+    _task->exit_waiters().remove(&task);
+}
+
 void BlockerWait::on_unblock(Task &)
 {
     _task->state(TASK_STATE_CANCELED);
@@ -74,6 +141,16 @@ bool BlockerWrite::can_unblock(Task &)
            _handle.node()->can_write(_handle);
 }
 
+void BlockerWrite::attach(Task &task)
+{
+    _handle.node()->write_waiters().add(&task);
+}
+
+void BlockerWrite::detach(Task &task)
+{
+    _handle.node()->write_waiters().remove(&task);
+}
+
 void BlockerWrite::on_unblock(Task &task)
 {
     _handle.node()->acquire(task.id);
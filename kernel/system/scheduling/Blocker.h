@@ -42,6 +42,13 @@ public:
         on_interrupt(task);
     }
 
+    TimeStamp deadline() { return _timeout; }
+
+    bool has_deadline()
+    {
+        return _timeout != (Timeout)-1;
+    }
+
     bool has_timeout()
     {
         return _timeout != (Timeout)-1 && _timeout <= system_get_tick();
@@ -54,6 +61,11 @@ public:
 
     virtual bool can_unblock(Task &) { return true; }
 
+    // Register the task on the wait queues of whatever we are waiting on.
+    virtual void attach(Task &) {}
+
+    virtual void detach(Task &) {}
+
     virtual void on_unblock(Task &) {}
 
     virtual void on_timeout(Task &) {}
@@ -73,6 +85,10 @@ public:
 
     bool can_unblock(Task &task) override;
 
+    void attach(Task &task) override;
+
+    void detach(Task &task) override;
+
     void on_unblock(Task &task) override;
 };
 
@@ -88,6 +104,10 @@ public:
     }
 
     bool can_unblock(Task &task) override;
+
+    void attach(Task &task) override;
+
+    void detach(Task &task) override;
 };
 
 struct BlockerRead : public Blocker
@@ -103,6 +123,10 @@ public:
 
     bool can_unblock(Task &task) override;
 
+    void attach(Task &task) override;
+
+    void detach(Task &task) override;
+
     void on_unblock(Task &task) override;
 };
 
@@ -126,6 +150,10 @@ public:
     }
 
     bool can_unblock(Task &task) override;
+
+    void attach(Task &task) override;
+
+    void detach(Task &task) override;
 };
 
 struct BlockerTime : public Blocker
@@ -150,6 +178,10 @@ public:
 
     bool can_unblock(Task &task) override;
 
+    void attach(Task &task) override;
+
+    void detach(Task &task) override;
+
     void on_unblock(Task &task) override;
 };
 
@@ -166,5 +198,9 @@ public:
 
     bool can_unblock(Task &task) override;
 
+    void attach(Task &task) override;
+
+    void detach(Task &task) override;
+
     void on_unblock(Task &task) override;
 };
@@ -0,0 +1,135 @@
+#include <assert.h>
+
+#include "system/scheduling/RunQueue.h"
+#include "system/tasking/Task.h"
+
+int RunQueue::timeslice(int priority)
+{
+    // Higher priority tasks get longer slices: from 4 ticks at the top down
+    // to a single tick at the bottom.
+    return (SCHEDULER_PRIORITY_COUNT - priority + 7) / 8;
+}
+
+void RunQueue::push_back(int array, Task *task)
+{
+    auto &level = _arrays[array].levels[task->_priority];
+
+    task->_run_array = array;
+    task->_run_prev = level.tail;
+    task->_run_next = nullptr;
+
+    if (level.tail)
+    {
+        level.tail->_run_next = task;
+    }
+    else
+    {
+        level.head = task;
+    }
+
+    level.tail = task;
+
+    _arrays[array].bitmap |= (1u << task->_priority);
+    _arrays[array].count++;
+}
+
+void RunQueue::remove(Task *task)
+{
+    auto &array = _arrays[task->_run_array];
+    auto &level = array.levels[task->_priority];
+
+    if (task->_run_prev)
+    {
+        task->_run_prev->_run_next = task->_run_next;
+    }
+    else
+    {
+        level.head = task->_run_next;
+    }
+
+    if (task->_run_next)
+    {
+        task->_run_next->_run_prev = task->_run_prev;
+    }
+    else
+    {
+        level.tail = task->_run_prev;
+    }
+
+    if (level.head == nullptr)
+    {
+        array.bitmap &= ~(1u << task->_priority);
+    }
+
+    array.count--;
+
+    task->_run_array = -1;
+    task->_run_prev = nullptr;
+    task->_run_next = nullptr;
+}
+
+void RunQueue::enqueue(Task *task)
+{
+    assert(task->_run_array == -1);
+    assert(task->_priority >= 0 && task->_priority < SCHEDULER_PRIORITY_COUNT);
+
+    if (task->_timeslice <= 0)
+    {
+        task->_timeslice = timeslice(task->_priority);
+    }
+
+    push_back(_active, task);
+}
+
+void RunQueue::dequeue(Task *task)
+{
+    if (task->_run_array != -1)
+    {
+        remove(task);
+    }
+}
+
+Task *RunQueue::pick(Task *current)
+{
+    if (current)
+    {
+        assert(current->_run_array == -1);
+
+        current->_timeslice--;
+
+        auto &active = _arrays[_active];
+        bool preempted = active.bitmap && __builtin_ctz(active.bitmap) < current->_priority;
+
+        if (current->_timeslice > 0 && !preempted)
+        {
+            return current;
+        }
+
+        if (current->_timeslice <= 0)
+        {
+            current->_timeslice = timeslice(current->_priority);
+            push_back(!_active, current);
+        }
+        else
+        {
+            push_back(_active, current);
+        }
+    }
+
+    if (_arrays[_active].bitmap == 0)
+    {
+        _active = !_active;
+    }
+
+    auto &active = _arrays[_active];
+
+    if (active.bitmap == 0)
+    {
+        return nullptr;
+    }
+
+    Task *next = active.levels[__builtin_ctz(active.bitmap)].head;
+    remove(next);
+
+    return next;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <libutils/Prelude.h>
+
+#define SCHEDULER_PRIORITY_COUNT 32
+
+#define SCHEDULER_PRIORITY_HIGHEST 0
+#define SCHEDULER_PRIORITY_KERNEL 8
+#define SCHEDULER_PRIORITY_USER 16
+#define SCHEDULER_PRIORITY_LOWEST (SCHEDULER_PRIORITY_COUNT - 1)
+
+struct Task;
+
+// O(1) multi-level run queue.
+//
+// Runnable tasks are kept in one FIFO per priority level and a bitmap tells
+// which levels are non-empty, so picking the next task is a single bit scan.
+// Tasks that consume their timeslice are moved to the "expired" array, which
+// is swapped with the "active" one once it runs dry. Every runnable task is
+// thus guaranteed to run once per epoch, whatever its priority.
+//
+// Tasks are taken off the queue while they run on a processor, so two
+// processors can never pick the same task.
+struct RunQueue
+{
+private:
+    struct Level
+    {
+        Task *head = nullptr;
+        Task *tail = nullptr;
+    };
+
+    struct Array
+    {
+        uint32_t bitmap = 0;
+        size_t count = 0;
+        Level levels[SCHEDULER_PRIORITY_COUNT] = {};
+    };
+
+    static_assert(SCHEDULER_PRIORITY_COUNT <= 32, "The level bitmap is 32 bits wide");
+
+    Array _arrays[2] = {};
+    int _active = 0;
+
+    void push_back(int array, Task *task);
+
+    void remove(Task *task);
+
+public:
+    static int timeslice(int priority);
+
+    size_t count() const
+    {
+        return _arrays[0].count + _arrays[1].count;
+    }
+
+    bool empty() const
+    {
+        return count() == 0;
+    }
+
+    void enqueue(Task *task);
+
+    void dequeue(Task *task);
+
+    // Charge the timeslice of `current` (the runnable task leaving the
+    // processor, if any) and return the task that should run next.
+    Task *pick(Task *current);
+};
@@ -1,77 +1,163 @@
-#include <libutils/List.h>
-
 #include "archs/Arch.h"
 
 #include "system/interrupts/Interupts.h"
+#include "system/interrupts/Spinlock.h"
+#include "system/scheduling/RunQueue.h"
 #include "system/scheduling/Scheduler.h"
+#include "system/scheduling/TimeoutHeap.h"
 #include "system/system/System.h"
 
-static bool scheduler_context_switch = false;
-static int scheduler_record[SCHEDULER_RECORD_COUNT] = {};
+struct Processor
+{
+    Task *running;
+    Task *idle;
+
+    // The task we just switched away from, its kernel stack stays in use
+    // until the interrupt stub has moved to the stack of the next one.
+    Task *previous;
+
+    bool context_switch;
+
+    int record[SCHEDULER_RECORD_COUNT];
+};
+
+static Processor processors[ARCH_MAX_PROCESSORS] = {};
+static uint32_t idle_processors = 0;
 
-static Task *running = nullptr;
-static Task *idle = nullptr;
+// The run queue, the timeouts, the counters and the records of the
+// processors. Changing the state of a task still happens under the giant
+// lock, this one is for everything that only looks at the queues.
+static Spinlock run_queue_lock{};
 
-static Utils::List<Task *> *blocked_tasks;
-static Utils::List<Task *> *running_tasks;
+static RunQueue *run_queue;
+static TimeoutHeap *timeouts;
+
+static size_t blocked_count = 0;
+
+static SchedulerStats stats = {};
+
+static Processor &processor()
+{
+    return processors[Arch::processor_current()];
+}
 
 void scheduler_initialize()
 {
-    blocked_tasks = new Utils::List<Task *>();
-    running_tasks = new Utils::List<Task *>();
+    run_queue = new RunQueue();
+    timeouts = new TimeoutHeap();
 }
 
 void scheduler_did_create_idle_task(Task *task)
 {
-    idle = task;
+    processor().idle = task;
 }
 
 void scheduler_did_create_running_task(Task *task)
 {
-    running = task;
+    int current = Arch::processor_current();
+
+    processors[current].running = task;
+    task->_processor = current;
+
+    if (task == processors[current].idle)
+    {
+        __atomic_or_fetch(&idle_processors, 1u << current, __ATOMIC_RELEASE);
+    }
+    else
+    {
+        SpinlockHolder holder{run_queue_lock};
+        run_queue->dequeue(task);
+    }
+}
+
+static void scheduler_wake_up_idle_processor()
+{
+    uint32_t candidates = __atomic_load_n(&idle_processors, __ATOMIC_ACQUIRE) & ~(1u << Arch::processor_current());
+
+    if (candidates == 0)
+    {
+        return;
+    }
+
+    int target = __builtin_ctz(candidates);
+
+    // Don't send another interrupt until the processor went through schedule().
+    __atomic_and_fetch(&idle_processors, ~(1u << target), __ATOMIC_RELEASE);
+    Arch::processor_reschedule(target);
 }
 
 void scheduler_did_change_task_state(Task *task, TaskState oldstate, TaskState newstate)
 {
     ASSERT_INTERRUPTS_RETAINED();
 
+    SpinlockHolder holder{run_queue_lock};
+
     if (oldstate != newstate)
     {
         if (oldstate == TASK_STATE_RUNNING)
         {
-            running_tasks->remove(task);
+            run_queue->dequeue(task);
+
+            // Get it off the other processor right away, this is how canceled
+            // tasks stop running.
+            if (task->_processor != -1 && task->_processor != Arch::processor_current())
+            {
+                Arch::processor_reschedule(task->_processor);
+            }
         }
 
         if (oldstate == TASK_STATE_BLOCKED)
         {
-            blocked_tasks->remove(task);
+            blocked_count--;
+            timeouts->remove(task);
         }
 
         if (newstate == TASK_STATE_BLOCKED)
         {
-            blocked_tasks->push_back(task);
+            blocked_count++;
+
+            if (task->_blocker->has_deadline())
+            {
+                timeouts->push(task);
+            }
         }
 
-        if (newstate == TASK_STATE_RUNNING)
+        // A task that is still on a processor is put back in the run queue
+        // by schedule() when it leaves it.
+        if (newstate == TASK_STATE_RUNNING && task->_processor == -1)
         {
-            // Maybe we should push the task to the start of the list if it's a low latency tasks.
-            running_tasks->push_back(task);
+            run_queue->enqueue(task);
+            scheduler_wake_up_idle_processor();
         }
     }
 }
 
 bool scheduler_is_context_switch()
 {
-    return scheduler_context_switch;
+    return processor().context_switch;
 }
 
 Task *scheduler_running()
 {
+    // No need for the giant lock here, we only have to make sure we are not
+    // migrated between looking up the processor and reading its task.
+    bool enabled = Arch::interrupts_enabled();
+    Arch::disable_interrupts();
+
+    Task *running = processor().running;
+
+    if (enabled)
+    {
+        Arch::enable_interrupts();
+    }
+
     return running;
 }
 
 int scheduler_running_id()
 {
+    Task *running = scheduler_running();
+
     if (running == nullptr)
     {
         return -1;
@@ -87,44 +173,153 @@ void scheduler_yield()
     ASSERT_INTERRUPTS_NOT_RETAINED();
 }
 
+void scheduler_wait_until_descheduled(Task *task)
+{
+    ASSERT_INTERRUPTS_NOT_RETAINED();
+
+    while (__atomic_load_n(&task->_processor, __ATOMIC_ACQUIRE) != -1 ||
+           __atomic_load_n(&task->_switching, __ATOMIC_ACQUIRE))
+    {
+        Arch::processor_relax();
+    }
+}
+
 int scheduler_get_usage(int task_id)
 {
-    InterruptsRetainer retainer;
+    SpinlockHolder holder{run_queue_lock};
 
     int count = 0;
 
-    for (int i = 0; i < SCHEDULER_RECORD_COUNT; i++)
+    for (int processor = 0; processor < Arch::processor_count(); processor++)
     {
-        if (scheduler_record[i] == task_id)
+        for (int i = 0; i < SCHEDULER_RECORD_COUNT; i++)
         {
-            count++;
+            if (processors[processor].record[i] == task_id)
+            {
+                count++;
+            }
         }
     }
 
-    return (count * 100) / SCHEDULER_RECORD_COUNT;
+    return (count * 100) / (SCHEDULER_RECORD_COUNT * Arch::processor_count());
+}
+
+SchedulerStats scheduler_stats()
+{
+    SpinlockHolder holder{run_queue_lock};
+
+    SchedulerStats result = stats;
+    result.runnable = run_queue->count();
+    result.blocked = blocked_count;
+    result.timed = timeouts->count();
+    result.processors = Arch::processor_count();
+
+    return result;
+}
+
+static void scheduler_expire_timeouts()
+{
+    // Blocked tasks are woken up by whatever they are waiting on, the tick
+    // only has to look at the earliest deadline. The blocker runs outside of
+    // the run queue lock.
+
+    while (true)
+    {
+        Task *task = nullptr;
+
+        {
+            SpinlockHolder holder{run_queue_lock};
+
+            if (timeouts->empty() ||
+                timeouts->peek()->_blocker->deadline() > system_get_tick())
+            {
+                return;
+            }
+
+            task = timeouts->pop();
+            stats.timeouts++;
+        }
+
+        task->try_unblock();
+    }
 }
 
 uintptr_t schedule(uintptr_t current_stack_pointer)
 {
-    scheduler_context_switch = true;
+    ASSERT_INTERRUPTS_RETAINED();
+
+    uint64_t start = Arch::get_cycles();
+
+    int current = Arch::processor_current();
+    auto &self = processors[current];
+
+    self.context_switch = true;
+
+    Task *previous = self.running;
+    previous->kernel_stack_pointer = current_stack_pointer;
+    Arch::save_context(previous);
+
+    scheduler_expire_timeouts();
+
+    SpinlockHolder holder{run_queue_lock};
 
-    running->kernel_stack_pointer = current_stack_pointer;
-    Arch::save_context(running);
+    self.record[system_get_tick() % SCHEDULER_RECORD_COUNT] = previous->id;
 
-    scheduler_record[system_get_tick() % SCHEDULER_RECORD_COUNT] = running->id;
+    bool runnable = previous != self.idle && previous->state() == TASK_STATE_RUNNING;
+    Task *next = run_queue->pick(runnable ? previous : nullptr);
 
-    blocked_tasks->foreach([](auto &task)
+    if (next == nullptr)
+    {
+        next = self.idle;
+    }
+
+    if (next != previous)
+    {
+        stats.context_switches++;
+
+        previous->_processor = -1;
+        __atomic_store_n(&previous->_switching, true, __ATOMIC_RELEASE);
+        self.previous = previous;
+
+        // The task might have been running on another processor a moment
+        // ago, wait for it to be done with its kernel stack.
+        while (__atomic_load_n(&next->_switching, __ATOMIC_ACQUIRE))
         {
-            task->try_unblock();
-            return Iter::CONTINUE;
-        });
+            Arch::processor_relax();
+        }
 
-    running = running_tasks->requeue().unwrap_or(idle);
+        next->_processor = current;
+    }
 
-    Arch::address_space_switch(running->address_space);
-    Arch::load_context(running);
+    if (next == self.idle)
+    {
+        __atomic_or_fetch(&idle_processors, 1u << current, __ATOMIC_RELEASE);
+    }
+    else
+    {
+        __atomic_and_fetch(&idle_processors, ~(1u << current), __ATOMIC_RELEASE);
+    }
+
+    self.running = next;
+
+    Arch::address_space_switch(next->address_space);
+    Arch::load_context(next);
+
+    self.context_switch = false;
+
+    stats.schedules++;
+    stats.cycles += Arch::get_cycles() - start;
 
-    scheduler_context_switch = false;
+    return next->kernel_stack_pointer;
+}
+
+void scheduler_did_switch()
+{
+    auto &self = processor();
 
-    return running->kernel_stack_pointer;
+    if (self.previous)
+    {
+        __atomic_store_n(&self.previous->_switching, false, __ATOMIC_RELEASE);
+        self.previous = nullptr;
+    }
 }
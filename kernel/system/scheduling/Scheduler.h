@@ -4,6 +4,19 @@
 
 #define SCHEDULER_RECORD_COUNT 1000
 
+struct SchedulerStats
+{
+    uint64_t schedules;
+    uint64_t context_switches;
+    uint64_t cycles;
+    uint64_t timeouts;
+
+    size_t processors;
+    size_t runnable;
+    size_t blocked;
+    size_t timed;
+};
+
 void scheduler_initialize();
 
 void scheduler_did_create_idle_task(Task *task);
@@ -16,10 +29,18 @@ bool scheduler_is_context_switch();
 
 int scheduler_get_usage(int task_id);
 
+SchedulerStats scheduler_stats();
+
 Task *scheduler_running();
 
 int scheduler_running_id();
 
 void scheduler_yield();
 
+void scheduler_wait_until_descheduled(Task *task);
+
 uintptr_t schedule(uintptr_t current_stack_pointer);
+
+// Called by the interrupt stub once it is running on the stack returned by
+// schedule(), the previous task can now be picked by other processors.
+extern "C" void scheduler_did_switch();
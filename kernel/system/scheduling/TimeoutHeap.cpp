@@ -0,0 +1,102 @@
+#include <assert.h>
+
+#include "system/scheduling/TimeoutHeap.h"
+#include "system/tasking/Task.h"
+
+TimeStamp TimeoutHeap::deadline(Task *task)
+{
+    return task->_blocker->deadline();
+}
+
+void TimeoutHeap::swap(size_t a, size_t b)
+{
+    std::swap(_tasks[a], _tasks[b]);
+
+    _tasks[a]->_timeout_index = a;
+    _tasks[b]->_timeout_index = b;
+}
+
+void TimeoutHeap::sift_up(size_t index)
+{
+    while (index > 0)
+    {
+        size_t parent = (index - 1) / 2;
+
+        if (deadline(_tasks[parent]) <= deadline(_tasks[index]))
+        {
+            return;
+        }
+
+        swap(parent, index);
+        index = parent;
+    }
+}
+
+void TimeoutHeap::sift_down(size_t index)
+{
+    while (true)
+    {
+        size_t smallest = index;
+        size_t left = index * 2 + 1;
+        size_t right = index * 2 + 2;
+
+        if (left < _tasks.count() && deadline(_tasks[left]) < deadline(_tasks[smallest]))
+        {
+            smallest = left;
+        }
+
+        if (right < _tasks.count() && deadline(_tasks[right]) < deadline(_tasks[smallest]))
+        {
+            smallest = right;
+        }
+
+        if (smallest == index)
+        {
+            return;
+        }
+
+        swap(smallest, index);
+        index = smallest;
+    }
+}
+
+void TimeoutHeap::push(Task *task)
+{
+    assert(task->_timeout_index == -1);
+
+    task->_timeout_index = _tasks.count();
+    _tasks.push_back(task);
+    sift_up(task->_timeout_index);
+}
+
+void TimeoutHeap::remove(Task *task)
+{
+    if (task->_timeout_index == -1)
+    {
+        return;
+    }
+
+    size_t index = task->_timeout_index;
+    size_t last = _tasks.count() - 1;
+
+    if (index != last)
+    {
+        swap(index, last);
+    }
+
+    _tasks.pop_back();
+    task->_timeout_index = -1;
+
+    if (index < _tasks.count())
+    {
+        sift_down(index);
+        sift_up(index);
+    }
+}
+
+Task *TimeoutHeap::pop()
+{
+    Task *task = peek();
+    remove(task);
+    return task;
+}
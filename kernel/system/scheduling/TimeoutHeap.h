@@ -0,0 +1,37 @@
+#pragma once
+
+#include <libutils/Vec.h>
+
+#include <skift/Time.h>
+
+struct Task;
+
+// Binary min-heap of blocked tasks ordered by the deadline of their blocker.
+// Each task remembers its slot so it can be taken out in O(log n) when it
+// gets unblocked before its deadline.
+struct TimeoutHeap
+{
+private:
+    Vec<Task *> _tasks{};
+
+    static TimeStamp deadline(Task *task);
+
+    void swap(size_t a, size_t b);
+
+    void sift_up(size_t index);
+
+    void sift_down(size_t index);
+
+public:
+    bool empty() const { return _tasks.empty(); }
+
+    size_t count() const { return _tasks.count(); }
+
+    Task *peek() const { return _tasks[0]; }
+
+    void push(Task *task);
+
+    void remove(Task *task);
+
+    Task *pop();
+};
@@ -0,0 +1,42 @@
+#include "system/interrupts/Interupts.h"
+#include "system/scheduling/WaitQueue.h"
+#include "system/tasking/Task.h"
+
+void WaitQueue::add(Task *task)
+{
+    ASSERT_INTERRUPTS_RETAINED();
+
+    // A task polling the same node through two handles only waits once.
+    if (!_tasks.contains(task))
+    {
+        _tasks.push_back(task);
+    }
+}
+
+void WaitQueue::remove(Task *task)
+{
+    ASSERT_INTERRUPTS_RETAINED();
+
+    _tasks.remove(task);
+}
+
+void WaitQueue::wake_up()
+{
+    InterruptsRetainer retainer;
+
+    // Unblocking a task removes it from every queue it is on, so the tasks
+    // are taken out first and the ones still blocked are put back.
+    List<Task *> tasks = std::move(_tasks);
+
+    tasks.foreach([this](auto *task)
+        {
+            task->try_unblock();
+
+            if (task->state() == TASK_STATE_BLOCKED)
+            {
+                add(task);
+            }
+
+            return Iter::CONTINUE;
+        });
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <libutils/List.h>
+
+struct Task;
+
+// Tasks blocked on something that can change (a node, a device, another
+// task...) register themselves here, so whoever changes it can wake exactly
+// the tasks that care instead of having the scheduler poll every blocker.
+struct WaitQueue
+{
+private:
+    List<Task *> _tasks{};
+
+public:
+    bool empty() const { return _tasks.empty(); }
+
+    void add(Task *task);
+
+    void remove(Task *task);
+
+    void wake_up();
+};
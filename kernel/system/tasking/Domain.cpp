@@ -129,6 +129,9 @@ ResultOr<RefPtr<FsHandle>> Domain::connect(IO::Path path)
     auto connection_or_result = node->connect();
     node->release(scheduler_running_id());
 
+    // The server waits to accept on the socket.
+    node->read_waiters().wake_up();
+
     if (!connection_or_result.success())
     {
         return connection_or_result.result();
@@ -156,7 +159,7 @@ HjResult Domain::mkdir(IO::Path path)
 
 HjResult Domain::mkpipe(IO::Path path)
 {
-    return link(path, make<FsPipe>());
+    return link(path, make<FsPipe>(FsPipe::DEFAULT_CAPACITY));
 }
 
 HjResult Domain::mklink(IO::Path old_path, IO::Path new_path)
@@ -7,32 +7,87 @@
 #include "system/scheduling/Scheduler.h"
 #include "system/tasking/Handles.h"
 
+void Handles::link_free(int index)
+{
+    _previous_free[index] = HANDLE_INVALID_ID;
+    _next_free[index] = _first_free;
+
+    if (_first_free != HANDLE_INVALID_ID)
+    {
+        _previous_free[_first_free] = index;
+    }
+
+    _first_free = index;
+}
+
+void Handles::unlink_free(int index)
+{
+    int previous = _previous_free[index];
+    int next = _next_free[index];
+
+    if (previous != HANDLE_INVALID_ID)
+    {
+        _next_free[previous] = next;
+    }
+    else
+    {
+        _first_free = next;
+    }
+
+    if (next != HANDLE_INVALID_ID)
+    {
+        _previous_free[next] = previous;
+    }
+}
+
+void Handles::reset_free()
+{
+    _first_free = HANDLE_INVALID_ID;
+
+    // Backward, so the lowest slots are handed out first.
+    for (int i = PROCESS_HANDLE_COUNT - 1; i >= 0; i--)
+    {
+        link_free(i);
+    }
+}
+
 ResultOr<int> Handles::add(RefPtr<FsHandle> handle)
 {
     LockHolder holder(_lock);
 
-    for (int i = 0; i < PROCESS_HANDLE_COUNT; i++)
+    if (_first_free == HANDLE_INVALID_ID)
     {
-        if (_handles[i] == nullptr)
-        {
-            _handles[i] = handle;
-
-            return i;
-        }
+        return ERR_TOO_MANY_HANDLE;
     }
 
-    return ERR_TOO_MANY_HANDLE;
+    int index = _first_free;
+    unlink_free(index);
+
+    _handles[index] = handle;
+    _count++;
+    _opened++;
+
+    return index;
 }
 
 HjResult Handles::add_at(RefPtr<FsHandle> handle, int index)
 {
-    if (index < 0 && index >= PROCESS_HANDLE_COUNT)
+    if (index < 0 || index >= PROCESS_HANDLE_COUNT)
     {
         return ERR_BAD_HANDLE;
     }
 
     LockHolder holder(_lock);
+
+    if (_handles[index] == nullptr)
+    {
+        unlink_free(index);
+        _count++;
+    }
+
     _handles[index] = handle;
+    _opened++;
+
     return SUCCESS;
 }
 
@@ -53,6 +108,8 @@ HjResult Handles::remove(int handle_index)
     }
 
     _handles[handle_index] = nullptr;
+    link_free(handle_index);
+    _count--;
 
     return SUCCESS;
 }
@@ -110,6 +167,9 @@ void Handles::close_all()
     {
         _handles[i] = nullptr;
     }
+
+    reset_free();
+    _count = 0;
 }
 
 HjResult Handles::reopen(int handle, int *reopened)
@@ -269,6 +329,22 @@ HjResult Handles::stat(int handle_index, HjStat *stat)
     return result;
 }
 
+ResultOr<Vec<MemoryObject *>> Handles::map(int handle_index, size_t *size)
+{
+    auto handle = acquire(handle_index);
+
+    if (!handle)
+    {
+        return ERR_BAD_HANDLE;
+    }
+
+    auto result = handle->map(size);
+
+    release(handle_index);
+
+    return result;
+}
+
 ResultOr<int> Handles::accept(int socket_handle_index)
 {
     auto socket_handle = acquire(socket_handle_index);
@@ -359,10 +435,10 @@ HjResult Handles::term(int *server, int *client)
         HJ_OPEN_CLIENT | HJ_OPEN_READ | HJ_OPEN_WRITE);
 }
 
-HjResult Handles::pipe(int *reader, int *writer)
+HjResult Handles::pipe(int *reader, int *writer, size_t capacity)
 {
     return duplex(
-        make<FsPipe>(),
+        make<FsPipe>(capacity),
 
         reader,
         HJ_OPEN_READ,
@@ -11,6 +11,21 @@ private:
 
     RefPtr<FsHandle> _handles[PROCESS_HANDLE_COUNT];
 
+    // The free slots are linked together, the last freed one is reused
+    // first. add_at() can take any of them, so the list goes both ways.
+    int _first_free = HANDLE_INVALID_ID;
+    int _next_free[PROCESS_HANDLE_COUNT];
+    int _previous_free[PROCESS_HANDLE_COUNT];
+
+    size_t _count = 0;
+    size_t _opened = 0;
+
+    void link_free(int index);
+
+    void unlink_free(int index);
+
+    void reset_free();
+
     ResultOr<int> add(RefPtr<FsHandle> handle);
 
     HjResult add_at(RefPtr<FsHandle> handle, int index);
@@ -24,10 +39,16 @@ private:
     HjResult release(int handle_index);
 
 public:
-    Handles() {}
+    Handles() { reset_free(); }
 
     ~Handles() { close_all(); }
 
+    // Handles open right now.
+    size_t count() const { return _count; }
+
+    // Handles given out since the task started.
+    size_t opened() const { return _opened; }
+
     ResultOr<int> open(Domain &domain, IO::Path &path, HjOpenFlag flags);
 
     ResultOr<int> connect(Domain &domain, IO::Path &socket_path);
@@ -52,6 +73,8 @@ public:
 
     HjResult stat(int handle_index, HjStat *stat);
 
+    ResultOr<Vec<MemoryObject *>> map(int handle_index, size_t *size);
+
     ResultOr<int> accept(int handle_index);
 
     HjResult duplex(
@@ -61,7 +84,7 @@ public:
 
     HjResult term(int *server, int *client);
 
-    HjResult pipe(int *reader, int *writer);
+    HjResult pipe(int *reader, int *writer, size_t capacity);
 
     HjResult pass(Handles &handles, int source, int destination);
 };
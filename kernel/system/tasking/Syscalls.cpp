@@ -8,6 +8,7 @@
 #include "archs/Arch.h"
 
 #include "system/interrupts/Interupts.h"
+#include "system/node/Pipe.h"
 #include "system/scheduling/Scheduler.h"
 #include "system/system/System.h"
 #include "system/tasking/Syscalls.h"
@@ -16,16 +17,31 @@
 
 typedef HjResult (*SyscallHandler)(uintptr_t, uintptr_t, uintptr_t, uintptr_t, uintptr_t);
 
-bool syscall_validate_ptr(uintptr_t ptr, size_t size)
+static bool syscall_validate_range(uintptr_t ptr, size_t size)
 {
     return ptr >= 0x100000 && ptr + size >= 0x100000 && ptr + size >= ptr;
 }
 
+// The kernel reads from the memory, it has to be mapped by the task.
+bool syscall_validate_ptr(uintptr_t ptr, size_t size)
+{
+    return syscall_validate_range(ptr, size) &&
+           task_memory_validate(scheduler_running(), ptr, size, false);
+}
+
+// The kernel writes to the memory, read-only mappings like the code of the
+// program would fault in the kernel.
+static bool syscall_validate_out_ptr(uintptr_t ptr, size_t size)
+{
+    return syscall_validate_range(ptr, size) &&
+           task_memory_validate(scheduler_running(), ptr, size, true);
+}
+
 /* --- Process -------------------------------------------------------------- */
 
 HjResult hj_process_this(int *pid)
 {
-    if (!syscall_validate_ptr((uintptr_t)pid, sizeof(int)))
+    if (!syscall_validate_out_ptr((uintptr_t)pid, sizeof(int)))
     {
         return ERR_BAD_ADDRESS;
     }
@@ -37,7 +53,7 @@ HjResult hj_process_this(int *pid)
 
 HjResult hj_process_name(char *name, size_t size)
 {
-    if (!syscall_validate_ptr((uintptr_t)name, size))
+    if (!syscall_validate_out_ptr((uintptr_t)name, size))
     {
         return ERR_BAD_ADDRESS;
     }
@@ -98,7 +114,7 @@ static void free_launchpad(Launchpad *launchpad)
 HjResult hj_process_launch(Launchpad *launchpad, int *pid)
 {
     if (!valid_launchpad(launchpad) ||
-        !syscall_validate_ptr((uintptr_t)pid, sizeof(int)))
+        !syscall_validate_out_ptr((uintptr_t)pid, sizeof(int)))
     {
         return ERR_BAD_ADDRESS;
     }
@@ -116,7 +132,7 @@ HjResult hj_process_launch(Launchpad *launchpad, int *pid)
 
 HjResult hj_process_clone(int *, TaskFlags)
 {
-    // Implemented in archs/x86_32/Interrupts.cpp
+    // Implemented in the interrupt handler of each arch.
     return ERR_NOT_IMPLEMENTED;
 }
 
@@ -178,7 +194,7 @@ HjResult hj_process_wait(int tid, int *user_exit_value)
 
     HjResult result = task_wait(tid, &exit_value);
 
-    if (syscall_validate_ptr((uintptr_t)user_exit_value, sizeof(int)))
+    if (syscall_validate_out_ptr((uintptr_t)user_exit_value, sizeof(int)))
     {
         *user_exit_value = exit_value;
     }
@@ -188,19 +204,19 @@ HjResult hj_process_wait(int tid, int *user_exit_value)
 
 /* --- Shared memory -------------------------------------------------------- */
 
-HjResult hj_memory_alloc(size_t size, uintptr_t *out_address)
+HjResult hj_memory_alloc(size_t size, int flags, uintptr_t *out_address)
 {
-    if (!syscall_validate_ptr((uintptr_t)out_address, sizeof(uintptr_t)))
+    if (!syscall_validate_out_ptr((uintptr_t)out_address, sizeof(uintptr_t)))
     {
         return ERR_BAD_ADDRESS;
     }
 
-    return task_memory_alloc(scheduler_running(), size, out_address);
+    return task_memory_alloc(scheduler_running(), size, flags, out_address);
 }
 
 HjResult hj_memory_map(uintptr_t address, size_t size, int flags)
 {
-    if (!syscall_validate_ptr(address, size))
+    if (!syscall_validate_range(address, size))
     {
         return ERR_BAD_ADDRESS;
     }
@@ -216,8 +232,8 @@ HjResult hj_memory_free(uintptr_t address)
 HjResult hj_memory_include(int handle, uintptr_t *out_address, size_t *out_size)
 {
 
-    if (!syscall_validate_ptr((uintptr_t)out_address, sizeof(uintptr_t)) ||
-        !syscall_validate_ptr((uintptr_t)out_size, sizeof(size_t)))
+    if (!syscall_validate_out_ptr((uintptr_t)out_address, sizeof(uintptr_t)) ||
+        !syscall_validate_out_ptr((uintptr_t)out_size, sizeof(size_t)))
     {
         return ERR_BAD_ADDRESS;
     }
@@ -227,7 +243,7 @@ HjResult hj_memory_include(int handle, uintptr_t *out_address, size_t *out_size)
 
 HjResult hj_memory_get_handle(uintptr_t address, int *out_handle)
 {
-    if (!syscall_validate_ptr((uintptr_t)out_handle, sizeof(int)))
+    if (!syscall_validate_out_ptr((uintptr_t)out_handle, sizeof(int)))
     {
         return ERR_BAD_ADDRESS;
     }
@@ -235,6 +251,17 @@ HjResult hj_memory_get_handle(uintptr_t address, int *out_handle)
     return task_memory_get_handle(scheduler_running(), address, out_handle);
 }
 
+HjResult hj_memory_map_handle(int handle, uintptr_t *out_address, size_t *out_size)
+{
+    if (!syscall_validate_out_ptr((uintptr_t)out_address, sizeof(uintptr_t)) ||
+        !syscall_validate_out_ptr((uintptr_t)out_size, sizeof(size_t)))
+    {
+        return ERR_BAD_ADDRESS;
+    }
+
+    return task_memory_map_handle(scheduler_running(), handle, out_address, out_size);
+}
+
 /* --- Filesystem ----------------------------------------------------------- */
 
 HjResult hj_filesystem_mkdir(const char *raw_path, size_t size)
@@ -268,7 +295,7 @@ HjResult hj_filesystem_mkpipe(const char *raw_path, size_t size)
 HjResult hj_filesystem_link(const char *raw_old_path, size_t old_size,
                             const char *raw_new_path, size_t new_size)
 {
-    if (!syscall_validate_ptr((uintptr_t)raw_old_path, old_size) &&
+    if (!syscall_validate_ptr((uintptr_t)raw_old_path, old_size) ||
         !syscall_validate_ptr((uintptr_t)raw_new_path, new_size))
     {
         return ERR_BAD_ADDRESS;
@@ -302,7 +329,7 @@ HjResult hj_filesystem_unlink(const char *raw_path, size_t size)
 HjResult hj_filesystem_rename(const char *raw_old_path, size_t old_size,
                               const char *raw_new_path, size_t new_size)
 {
-    if (!syscall_validate_ptr((uintptr_t)raw_old_path, old_size) &&
+    if (!syscall_validate_ptr((uintptr_t)raw_old_path, old_size) ||
         !syscall_validate_ptr((uintptr_t)raw_new_path, new_size))
     {
         return ERR_BAD_ADDRESS;
@@ -321,6 +348,11 @@ HjResult hj_filesystem_rename(const char *raw_old_path, size_t old_size,
 
 HjResult hj_system_info(SystemInfo *info)
 {
+    if (!syscall_validate_out_ptr((uintptr_t)info, sizeof(SystemInfo)))
+    {
+        return ERR_BAD_ADDRESS;
+    }
+
     strncpy(info->kernel_name, "hjert", SYSTEM_INFO_FIELD_SIZE);
 
     strncpy(info->kernel_release, __BUILD_VERSION__, SYSTEM_INFO_FIELD_SIZE);
@@ -339,6 +371,11 @@ ElapsedTime system_get_uptime();
 
 HjResult hj_system_status(SystemStatus *status)
 {
+    if (!syscall_validate_out_ptr((uintptr_t)status, sizeof(SystemStatus)))
+    {
+        return ERR_BAD_ADDRESS;
+    }
+
     // FIXME: get a real uptime value;
     status->uptime = system_get_uptime();
 
@@ -353,6 +390,11 @@ HjResult hj_system_status(SystemStatus *status)
 
 HjResult hj_system_get_time(TimeStamp *timestamp)
 {
+    if (!syscall_validate_out_ptr((uintptr_t)timestamp, sizeof(TimeStamp)))
+    {
+        return ERR_BAD_ADDRESS;
+    }
+
     *timestamp = Arch::get_time();
 
     return SUCCESS;
@@ -360,7 +402,7 @@ HjResult hj_system_get_time(TimeStamp *timestamp)
 
 HjResult hj_system_get_ticks(uint32_t *tick)
 {
-    if (!syscall_validate_ptr((uintptr_t)tick, sizeof(uintptr_t)))
+    if (!syscall_validate_out_ptr((uintptr_t)tick, sizeof(uintptr_t)))
     {
         return ERR_BAD_ADDRESS;
     }
@@ -383,21 +425,31 @@ HjResult hj_system_shutdown()
 
 /* --- Create --------------------------------------------------------------- */
 
-HjResult hj_create_pipe(int *reader_handle, int *writer_handle)
+HjResult hj_create_pipe(int *reader_handle, int *writer_handle, size_t capacity)
 {
-    if (!syscall_validate_ptr((uintptr_t)reader_handle, sizeof(int)) ||
-        !syscall_validate_ptr((uintptr_t)writer_handle, sizeof(int)))
+    if (!syscall_validate_out_ptr((uintptr_t)reader_handle, sizeof(int)) ||
+        !syscall_validate_out_ptr((uintptr_t)writer_handle, sizeof(int)))
     {
         return ERR_BAD_ADDRESS;
     }
 
-    return scheduler_running()->handles().pipe(reader_handle, writer_handle);
+    if (capacity == 0)
+    {
+        capacity = FsPipe::DEFAULT_CAPACITY;
+    }
+
+    if (capacity > PipeBuffer::MAX_CAPACITY)
+    {
+        return ERR_INVALID_ARGUMENT;
+    }
+
+    return scheduler_running()->handles().pipe(reader_handle, writer_handle, capacity);
 }
 
 HjResult hj_create_term(int *server_handle, int *client_handle)
 {
-    if (!syscall_validate_ptr((uintptr_t)server_handle, sizeof(int)) ||
-        !syscall_validate_ptr((uintptr_t)client_handle, sizeof(int)))
+    if (!syscall_validate_out_ptr((uintptr_t)server_handle, sizeof(int)) ||
+        !syscall_validate_out_ptr((uintptr_t)client_handle, sizeof(int)))
     {
         return ERR_BAD_ADDRESS;
     }
@@ -413,7 +465,7 @@ HjResult hj_handle_open(int *handle,
                         const char *raw_path, size_t size,
                         HjOpenFlag flags)
 {
-    if (!syscall_validate_ptr((uintptr_t)handle, sizeof(int)) ||
+    if (!syscall_validate_out_ptr((uintptr_t)handle, sizeof(int)) ||
         !syscall_validate_ptr((uintptr_t)raw_path, size))
     {
         return ERR_BAD_ADDRESS;
@@ -448,7 +500,7 @@ HjResult hj_handle_close(int handle)
 
 HjResult hj_handle_reopen(int handle, int *reopened)
 {
-    if (!syscall_validate_ptr((uintptr_t)reopened, sizeof(int)))
+    if (!syscall_validate_out_ptr((uintptr_t)reopened, sizeof(int)))
     {
         return ERR_BAD_ADDRESS;
     }
@@ -467,7 +519,7 @@ HjResult hj_handle_copy(int source, int destination)
 
 HjResult hj_handle_poll(HandlePoll *handle_poll, size_t count, Timeout timeout)
 {
-    if (!syscall_validate_ptr((uintptr_t)handle_poll, sizeof(HandlePoll) * count))
+    if (!syscall_validate_out_ptr((uintptr_t)handle_poll, sizeof(HandlePoll) * count))
     {
         return ERR_BAD_ADDRESS;
     }
@@ -494,8 +546,8 @@ HjResult hj_handle_poll(HandlePoll *handle_poll, size_t count, Timeout timeout)
 
 HjResult hj_handle_read(int handle, void *buffer, size_t size, size_t *read)
 {
-    if (!syscall_validate_ptr((uintptr_t)buffer, size) ||
-        !syscall_validate_ptr((uintptr_t)read, sizeof(size_t)))
+    if (!syscall_validate_out_ptr((uintptr_t)buffer, size) ||
+        !syscall_validate_out_ptr((uintptr_t)read, sizeof(size_t)))
     {
         return ERR_BAD_ADDRESS;
     }
@@ -519,7 +571,7 @@ HjResult hj_handle_read(int handle, void *buffer, size_t size, size_t *read)
 HjResult hj_handle_write(int handle, const void *buffer, size_t size, size_t *written)
 {
     if (!syscall_validate_ptr((uintptr_t)buffer, size) ||
-        !syscall_validate_ptr((uintptr_t)written, sizeof(size_t)))
+        !syscall_validate_out_ptr((uintptr_t)written, sizeof(size_t)))
     {
         return ERR_BAD_ADDRESS;
     }
@@ -549,8 +601,8 @@ HjResult hj_handle_call(int handle, IOCall request, void *args)
 
 HjResult hj_handle_seek(int handle, ssize64_t *offset_ptr, HjWhence whence, ssize64_t *result_ptr)
 {
-    if ((offset_ptr != nullptr && !syscall_validate_ptr((uintptr_t)offset_ptr, sizeof(int))) ||
-        (result_ptr != nullptr && !syscall_validate_ptr((uintptr_t)result_ptr, sizeof(int))))
+    if ((offset_ptr != nullptr && !syscall_validate_ptr((uintptr_t)offset_ptr, sizeof(ssize64_t))) ||
+        (result_ptr != nullptr && !syscall_validate_out_ptr((uintptr_t)result_ptr, sizeof(ssize64_t))))
     {
         return ERR_BAD_ADDRESS;
     }
@@ -571,7 +623,7 @@ HjResult hj_handle_seek(int handle, ssize64_t *offset_ptr, HjWhence whence, ssiz
 
 HjResult hj_handle_stat(int handle, HjStat *state)
 {
-    if (!syscall_validate_ptr((uintptr_t)state, sizeof(HjStat)))
+    if (!syscall_validate_out_ptr((uintptr_t)state, sizeof(HjStat)))
     {
         return ERR_BAD_ADDRESS;
     }
@@ -583,7 +635,7 @@ HjResult hj_handle_stat(int handle, HjStat *state)
 
 HjResult hj_handle_connect(int *handle, const char *raw_path, size_t size)
 {
-    if (!syscall_validate_ptr((uintptr_t)handle, sizeof(int)) &&
+    if (!syscall_validate_out_ptr((uintptr_t)handle, sizeof(int)) ||
         !syscall_validate_ptr((uintptr_t)raw_path, size))
     {
         return ERR_BAD_ADDRESS;
@@ -611,7 +663,7 @@ HjResult hj_handle_connect(int *handle, const char *raw_path, size_t size)
 
 HjResult hj_handle_accept(int handle, int *connection_handle)
 {
-    if (!syscall_validate_ptr((uintptr_t)connection_handle, sizeof(int)))
+    if (!syscall_validate_out_ptr((uintptr_t)connection_handle, sizeof(int)))
     {
         return ERR_BAD_ADDRESS;
     }
@@ -650,6 +702,7 @@ static SyscallHandler syscalls[__SYSCALL_COUNT] = {
     [HJ_MEMORY_FREE] = reinterpret_cast<SyscallHandler>(hj_memory_free),
     [HJ_MEMORY_INCLUDE] = reinterpret_cast<SyscallHandler>(hj_memory_include),
     [HJ_MEMORY_GET_HANDLE] = reinterpret_cast<SyscallHandler>(hj_memory_get_handle),
+    [HJ_MEMORY_MAP_HANDLE] = reinterpret_cast<SyscallHandler>(hj_memory_map_handle),
     [HJ_FILESYSTEM_LINK] = reinterpret_cast<SyscallHandler>(hj_filesystem_link),
     [HJ_FILESYSTEM_UNLINK] = reinterpret_cast<SyscallHandler>(hj_filesystem_unlink),
     [HJ_FILESYSTEM_RENAME] = reinterpret_cast<SyscallHandler>(hj_filesystem_rename),
@@ -18,7 +18,17 @@ struct ELFLoader
     using Program = TELFFormat::Program;
     using Symbole = TELFFormat::Symbole;
 
-    static HjResult load_program(Task *task, Stream *elf_file, Program *program_header)
+    // Read-only segments are mapped straight from the pages of the file, so
+    // every task running the same executable shares them.
+    static bool can_map_program(Program *program_header, size_t elf_size)
+    {
+        return !(program_header->flags & ELF_PROGRAM_W) &&
+               program_header->filesz == program_header->memsz &&
+               program_header->offset % ARCH_PAGE_SIZE == program_header->vaddr % ARCH_PAGE_SIZE &&
+               program_header->offset + program_header->filesz <= elf_size;
+    }
+
+    static HjResult load_program(Task *task, Stream *elf_file, Vec<MemoryObject *> &elf_objects, size_t elf_size, Program *program_header)
     {
         if (program_header->vaddr == 0)
         {
@@ -31,10 +41,18 @@ struct ELFLoader
             return ERR_EXEC_FORMAT_ERROR;
         }
 
-        auto *parent_address_space = task_switch_address_space(scheduler_running(), task->address_space);
-
         MemoryRange range = MemoryRange::around_non_aligned_address(program_header->vaddr, program_header->memsz);
 
+        if (can_map_program(program_header, elf_size) &&
+            !task_memory_mapping_colides(task, range.base(), range.size()))
+        {
+            task_memory_mapping_create_many(task, elf_objects, PAGE_ALIGN_DOWN(program_header->offset), range.size(), range.base(), MEMORY_READONLY);
+
+            return SUCCESS;
+        }
+
+        auto *parent_address_space = task_switch_address_space(scheduler_running(), task->address_space);
+
         task_memory_map(task, range.base(), range.size(), MEMORY_CLEAR);
 
         stream_seek(elf_file, IO::SeekFrom::start(program_header->offset));
@@ -56,6 +74,24 @@ struct ELFLoader
         }
     }
 
+    static HjResult load_programs(Task *task, Stream *elf_file, Vec<MemoryObject *> &elf_objects, size_t elf_size, Header &elf_header)
+    {
+        for (int i = 0; i < elf_header.phnum; i++)
+        {
+            Program elf_program_header;
+            stream_seek(elf_file, IO::SeekFrom::start(elf_header.phoff + elf_header.phentsize * i));
+
+            if (stream_read(elf_file, &elf_program_header, sizeof(Program)) != sizeof(Program))
+            {
+                return ERR_EXEC_FORMAT_ERROR;
+            }
+
+            TRY(load_program(task, elf_file, elf_objects, elf_size, &elf_program_header));
+        }
+
+        return SUCCESS;
+    }
+
     static HjResult load(Task *task, Stream *elf_file)
     {
         Header elf_header;
@@ -68,20 +104,18 @@ struct ELFLoader
 
         task_set_entry(task, reinterpret_cast<TaskEntryPoint>(elf_header.entry));
 
-        for (int i = 0; i < elf_header.phnum; i++)
-        {
-            Program elf_program_header;
-            stream_seek(elf_file, IO::SeekFrom::start(elf_header.phoff + elf_header.phentsize * i));
+        // Files which can't be mapped are read segment by segment instead.
+        size_t elf_size = 0;
+        auto elf_objects = scheduler_running()->handles().map(elf_file->handle.id, &elf_size).unwrap_or({});
 
-            if (stream_read(elf_file, &elf_program_header, sizeof(Program)) != sizeof(Program))
-            {
-                return ERR_EXEC_FORMAT_ERROR;
-            }
+        HjResult result = load_programs(task, elf_file, elf_objects, elf_size, elf_header);
 
-            TRY(load_program(task, elf_file, &elf_program_header));
+        for (auto *object : elf_objects)
+        {
+            memory_object_deref(object);
         }
 
-        return SUCCESS;
+        return result;
     }
 };
 
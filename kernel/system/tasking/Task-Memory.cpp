@@ -1,13 +1,15 @@
+#include <libmath/MinMax.h>
 #include <string.h>
 
 #include "archs/Arch.h"
 
 #include "system/interrupts/Interupts.h"
+#include "system/system/System.h"
 #include "system/tasking/Task-Memory.h"
 
 static bool will_i_be_kill_if_i_allocate_that(Task *task, size_t size)
 {
-    auto usage = task_memory_usage(task);
+    auto usage = task->memory_resident;
 
     if (usage + size > memory_get_total() / 2)
     {
@@ -28,17 +30,165 @@ static void kill_me_if_too_greedy(Task *task, size_t size)
     }
 }
 
+// The pages of a mapping that isn't lazy are the ones it wrote to since it
+// was cloned, they come on top of the object.
+static size_t task_memory_mapping_resident(MemoryMapping *memory_mapping)
+{
+    size_t resident = 0;
+
+    memory_mapping->pages.foreach([&](auto, auto *memory_page)
+        {
+            resident += memory_page->size;
+            return Iter::CONTINUE;
+        });
+
+    if (!memory_mapping->lazy)
+    {
+        resident += memory_mapping->size;
+    }
+
+    return resident;
+}
+
+static constexpr size_t LARGE_PAGE_PAGES = ARCH_LARGE_PAGE_SIZE / ARCH_PAGE_SIZE;
+
+// The index of the first page of the large page the page would be part of.
+static size_t task_memory_mapping_large(MemoryMapping *memory_mapping, size_t page)
+{
+    uintptr_t address = memory_mapping->address + page * ARCH_PAGE_SIZE;
+    return page - (address / ARCH_PAGE_SIZE) % LARGE_PAGE_PAGES;
+}
+
+// Large pages are kept under the first page they cover, the page might be
+// part of one.
+static MemoryPage *task_memory_mapping_page(MemoryMapping *memory_mapping, size_t page)
+{
+    if (memory_mapping->pages.has_key((uint32_t)page))
+    {
+        return memory_mapping->pages[page];
+    }
+
+    size_t first = task_memory_mapping_large(memory_mapping, page);
+
+    if (first > page ||
+        !memory_mapping->pages.has_key((uint32_t)first) ||
+        memory_mapping->pages[first]->size != ARCH_LARGE_PAGE_SIZE)
+    {
+        return nullptr;
+    }
+
+    return memory_mapping->pages[first];
+}
+
+static void task_memory_mapping_add(Task *task, MemoryMapping *memory_mapping)
+{
+    task->memory_reserved += memory_mapping->size;
+    task->memory_resident += task_memory_mapping_resident(memory_mapping);
+
+    task->memory_mapping->insert(memory_mapping->address, memory_mapping->size, memory_mapping);
+}
+
+// Page tables only know about the pages which are present, reserved pages
+// that were never touched are only in the mappings of the task.
+static uintptr_t task_memory_find(Task *task, size_t size)
+{
+    size_t align = size >= ARCH_LARGE_PAGE_SIZE ? ARCH_LARGE_PAGE_SIZE : ARCH_PAGE_SIZE;
+
+    auto address = task->memory_mapping->find_gap(size + align - ARCH_PAGE_SIZE);
+
+    if (!address.present() && align > ARCH_PAGE_SIZE)
+    {
+        align = ARCH_PAGE_SIZE;
+        address = task->memory_mapping->find_gap(size);
+    }
+
+    if (!address.present())
+    {
+        system_panic("Out of virtual memory!");
+    }
+
+    return ALIGN_UP(address.unwrap(), align);
+}
+
 MemoryMapping *task_memory_mapping_create(Task *task, MemoryObject *memory_object)
 {
     InterruptsRetainer retainer;
 
-    auto memory_mapping = CREATE(MemoryMapping);
+    auto memory_mapping = new MemoryMapping();
 
-    memory_mapping->object = memory_object_ref(memory_object);
-    memory_mapping->address = Arch::virtual_alloc(task->address_space, memory_object->range(), MEMORY_USER).base();
+    memory_mapping->objects.push_back(memory_object_ref(memory_object));
+    memory_mapping->address = task_memory_find(task, memory_object->range().size());
     memory_mapping->size = memory_object->range().size();
+    memory_mapping->flags = MEMORY_USER;
+
+    assert(SUCCESS == Arch::virtual_map(task->address_space, memory_object->range(), memory_mapping->address, MEMORY_USER));
+
+    task_memory_mapping_add(task, memory_mapping);
+
+    return memory_mapping;
+}
+
+MemoryMapping *task_memory_mapping_create_lazy(Task *task, size_t size)
+{
+    assert(IS_PAGE_ALIGN(size));
+
+    InterruptsRetainer retainer;
+
+    auto memory_mapping = new MemoryMapping();
+
+    memory_mapping->address = task_memory_find(task, size);
+    memory_mapping->size = size;
+    memory_mapping->flags = MEMORY_USER;
+    memory_mapping->lazy = true;
+
+    task_memory_mapping_add(task, memory_mapping);
+
+    return memory_mapping;
+}
+
+MemoryMapping *task_memory_mapping_create_many(Task *task, Vec<MemoryObject *> &memory_objects, size_t offset, size_t size, uintptr_t address, MemoryFlags flags)
+{
+    assert(IS_PAGE_ALIGN(offset) && IS_PAGE_ALIGN(size));
+
+    InterruptsRetainer retainer;
+
+    auto memory_mapping = new MemoryMapping();
+
+    if (address == 0)
+    {
+        address = task_memory_find(task, size);
+    }
+
+    memory_mapping->address = address;
+    memory_mapping->size = size;
+    memory_mapping->flags = flags | MEMORY_USER;
+
+    size_t object_offset = 0;
+
+    for (auto *memory_object : memory_objects)
+    {
+        auto range = memory_object->range();
+
+        size_t start = MAX(offset, object_offset);
+        size_t end = MIN(offset + size, object_offset + range.size());
 
-    task->memory_mapping->push_back(memory_mapping);
+        if (start < end)
+        {
+            MemoryRange physical_range{range.base() + start - object_offset, end - start};
+
+            if (memory_mapping->objects.empty())
+            {
+                memory_mapping->offset = start - object_offset;
+            }
+
+            memory_mapping->objects.push_back(memory_object_ref(memory_object));
+            assert(SUCCESS == Arch::virtual_map(task->address_space, physical_range, address + start - offset, flags | MEMORY_USER));
+        }
+
+        object_offset += range.size();
+    }
+
+    task_memory_mapping_add(task, memory_mapping);
 
     return memory_mapping;
 }
@@ -47,15 +197,16 @@ MemoryMapping *task_memory_mapping_create_at(Task *task, MemoryObject *memory_ob
 {
     InterruptsRetainer retainer;
 
-    auto memory_mapping = CREATE(MemoryMapping);
+    auto memory_mapping = new MemoryMapping();
 
-    memory_mapping->object = memory_object_ref(memory_object);
+    memory_mapping->objects.push_back(memory_object_ref(memory_object));
     memory_mapping->address = address;
     memory_mapping->size = memory_object->range().size();
+    memory_mapping->flags = MEMORY_USER;
 
     assert(SUCCESS == Arch::virtual_map(task->address_space, memory_object->range(), address, MEMORY_USER));
 
-    task->memory_mapping->push_back(memory_mapping);
+    task_memory_mapping_add(task, memory_mapping);
 
     return memory_mapping;
 }
@@ -65,51 +216,461 @@ void task_memory_mapping_destroy(Task *task, MemoryMapping *memory_mapping)
     InterruptsRetainer retainer;
 
     Arch::virtual_free(task->address_space, (MemoryRange){memory_mapping->address, memory_mapping->size});
-    memory_object_deref(memory_mapping->object);
 
-    task->memory_mapping->remove(memory_mapping);
-    free(memory_mapping);
+    task->memory_reserved -= memory_mapping->size;
+    task->memory_resident -= task_memory_mapping_resident(memory_mapping);
+
+    for (auto *memory_object : memory_mapping->objects)
+    {
+        memory_object_deref(memory_object);
+    }
+
+    memory_mapping->pages.foreach([](auto, auto *memory_page)
+        {
+            memory_page_deref(memory_page);
+            return Iter::CONTINUE;
+        });
+
+    task->memory_mapping->remove(memory_mapping->address);
+    delete memory_mapping;
 }
 
 MemoryMapping *task_memory_mapping_by_address(Task *task, uintptr_t address)
 {
-    for (auto *memory_mapping : *task->memory_mapping)
+    auto **memory_mapping = task->memory_mapping->at(address);
+    return memory_mapping ? *memory_mapping : nullptr;
+}
+
+MemoryMapping *task_memory_mapping_containing(Task *task, uintptr_t address)
+{
+    auto **memory_mapping = task->memory_mapping->containing(address);
+    return memory_mapping ? *memory_mapping : nullptr;
+}
+
+bool task_memory_mapping_colides(Task *task, uintptr_t address, size_t size)
+{
+    // Everything outside of the user memory belongs to the kernel.
+    if ((uint64_t)address < ARCH_USER_MEMORY_START ||
+        (uint64_t)address + size > ARCH_USER_MEMORY_END)
     {
-        if (memory_mapping->address == address)
+        return true;
+    }
+
+    return task->memory_mapping->colides(address, size);
+}
+
+// Anonymous memory is backed by a single object, or by the pages that were
+// touched when it is lazy. The pages written to after a clone take the place
+// of the ones of the object.
+static void task_memory_mapping_remap(Task *task, MemoryMapping *memory_mapping)
+{
+    auto flags = memory_mapping->flags;
+
+    if (memory_mapping->copy_on_write)
+    {
+        flags |= MEMORY_READONLY;
+    }
+
+    if (!memory_mapping->lazy)
+    {
+        assert(SUCCESS == Arch::virtual_map(task->address_space, memory_mapping->objects[0]->range(), memory_mapping->address, flags));
+    }
+
+    memory_mapping->pages.foreach([&](auto page, auto *memory_page)
         {
-            return memory_mapping;
+            assert(SUCCESS == Arch::virtual_map(task->address_space, memory_page->range(), memory_mapping->address + page * ARCH_PAGE_SIZE, flags));
+            return Iter::CONTINUE;
+        });
+}
+
+// A large page can back the page if the mapping covers all of it and none
+// of its pages were touched yet.
+static bool task_memory_mapping_can_populate_large(Task *task, MemoryMapping *memory_mapping, size_t page)
+{
+    size_t first = task_memory_mapping_large(memory_mapping, page);
+
+    if (LARGE_PAGE_PAGES == 1 ||
+        first > page ||
+        (first + LARGE_PAGE_PAGES) * ARCH_PAGE_SIZE > memory_mapping->size ||
+        will_i_be_kill_if_i_allocate_that(task, ARCH_LARGE_PAGE_SIZE))
+    {
+        return false;
+    }
+
+    for (size_t i = first; i < first + LARGE_PAGE_PAGES; i++)
+    {
+        if (memory_mapping->pages.has_key((uint32_t)i))
+        {
+            return false;
         }
     }
 
-    return nullptr;
+    return true;
 }
 
-bool task_memory_mapping_colides(Task *task, uintptr_t address, size_t size)
+// Gives the page its memory, along with the rest of its large page when the
+// arch has them and the memory is there. Returns false if the task can't
+// have it. The task has to be the one running.
+static bool task_memory_mapping_populate(Task *task, MemoryMapping *memory_mapping, size_t page)
 {
-    for (auto *memory_mapping : *task->memory_mapping)
+    MemoryPage *memory_page = nullptr;
+
+    if (task_memory_mapping_can_populate_large(task, memory_mapping, page))
+    {
+        memory_page = memory_page_try_create(ARCH_LARGE_PAGE_SIZE);
+    }
+
+    if (memory_page)
+    {
+        page = task_memory_mapping_large(memory_mapping, page);
+    }
+    else if (will_i_be_kill_if_i_allocate_that(task, ARCH_PAGE_SIZE))
     {
-        if (address < memory_mapping->address + memory_mapping->size &&
-            address + size > memory_mapping->address)
+        return false;
+    }
+    else
+    {
+        memory_page = memory_page_create(ARCH_PAGE_SIZE);
+    }
+
+    uintptr_t address = memory_mapping->address + page * ARCH_PAGE_SIZE;
+
+    memory_mapping->pages[page] = memory_page;
+    assert(SUCCESS == Arch::virtual_map(task->address_space, memory_page->range(), address, memory_mapping->flags));
+    memset((void *)address, 0, memory_page->size);
+
+    task->memory_resident += memory_page->size;
+
+    return true;
+}
+
+// Gives the mapping a page for each of the pages of the large one, they
+// are copied one at a time when it writes to them.
+static void task_memory_mapping_split(MemoryMapping *memory_mapping, size_t first)
+{
+    auto *large = memory_mapping->pages[first];
+
+    for (size_t i = 0; i < LARGE_PAGE_PAGES; i++)
+    {
+        memory_mapping->pages[first + i] = memory_page_slice(large, i * ARCH_PAGE_SIZE);
+    }
+
+    memory_page_deref(large);
+}
+
+// Moves a lazy mapping, or one that was split by copy-on-write, to a single
+// object with the same content, which can then be shared with other tasks.
+// The pages that were never touched are cleared instead of copied. Memory
+// allocated to be shared doesn't go through here. The task has to be the
+// one running.
+static void task_memory_mapping_materialize(Task *task, MemoryMapping *memory_mapping)
+{
+    size_t resident = task_memory_mapping_resident(memory_mapping);
+
+    auto *memory_object = memory_object_create(memory_mapping->size);
+
+    auto range = Arch::virtual_alloc(Arch::kernel_address_space(), memory_object->range(), MEMORY_NONE);
+    auto *data = reinterpret_cast<uint8_t *>(range.base());
+
+    size_t page_count = memory_mapping->size / ARCH_PAGE_SIZE;
+
+    for (size_t i = 0; i < page_count; i++)
+    {
+        if (!memory_mapping->lazy || task_memory_mapping_page(memory_mapping, i))
         {
-            return true;
+            memcpy(data + i * ARCH_PAGE_SIZE, (void *)(memory_mapping->address + i * ARCH_PAGE_SIZE), ARCH_PAGE_SIZE);
         }
+        else
+        {
+            memset(data + i * ARCH_PAGE_SIZE, 0, ARCH_PAGE_SIZE);
+        }
+    }
+
+    Arch::virtual_free(Arch::kernel_address_space(), range);
+
+    memory_mapping->pages.foreach([](auto, auto *memory_page)
+        {
+            memory_page_deref(memory_page);
+            return Iter::CONTINUE;
+        });
+
+    for (auto *old_object : memory_mapping->objects)
+    {
+        memory_object_deref(old_object);
+    }
+
+    memory_mapping->pages.clear();
+    memory_mapping->objects.clear();
+    memory_mapping->objects.push_back(memory_object);
+    memory_mapping->lazy = false;
+    memory_mapping->copy_on_write = false;
+
+    task->memory_resident -= resident;
+    task->memory_resident += task_memory_mapping_resident(memory_mapping);
+
+    // Dropping the pages first lets the arch use large pages.
+    Arch::virtual_free(task->address_space, memory_mapping->range());
+    task_memory_mapping_remap(task, memory_mapping);
+}
+
+// Gives the mapping pages of its own before they are shared by handle.
+static void task_memory_mapping_unshare(Task *task, MemoryMapping *memory_mapping)
+{
+    if (memory_mapping->lazy ||
+        memory_mapping->objects[0]->refcount > 1 ||
+        memory_mapping->pages.count() > 0)
+    {
+        task_memory_mapping_materialize(task, memory_mapping);
+        return;
     }
 
-    return false;
+    memory_mapping->copy_on_write = false;
+    task_memory_mapping_remap(task, memory_mapping);
+}
+
+// Copy-on-write mappings are copied one page at a time, the other pages
+// might still be shared so the mapping stays copy-on-write. The last one to
+// write keeps the original pages.
+static void task_memory_mapping_unshare_page(Task *task, MemoryMapping *memory_mapping, size_t page)
+{
+    uintptr_t address = memory_mapping->address + page * ARCH_PAGE_SIZE;
+
+    auto *memory_page = task_memory_mapping_page(memory_mapping, page);
+
+    if (memory_page && memory_page->size == ARCH_LARGE_PAGE_SIZE && LARGE_PAGE_PAGES > 1)
+    {
+        size_t first = task_memory_mapping_large(memory_mapping, page);
+
+        if (memory_page->refcount == 1)
+        {
+            address = memory_mapping->address + first * ARCH_PAGE_SIZE;
+            assert(SUCCESS == Arch::virtual_map(task->address_space, memory_page->range(), address, memory_mapping->flags));
+            return;
+        }
+
+        task_memory_mapping_split(memory_mapping, first);
+        memory_page = memory_mapping->pages[page];
+    }
+
+    // The memory of a piece of a large page is still shared with whoever
+    // holds the rest of it.
+    if (memory_page && (memory_page->refcount > 1 || memory_page->large))
+    {
+        memory_mapping->pages[page] = memory_page_copy(memory_page->range());
+        memory_page_deref(memory_page);
+    }
+    else if (!memory_page)
+    {
+        auto *memory_object = memory_mapping->objects[0];
+        MemoryRange range{memory_object->range().base() + page * ARCH_PAGE_SIZE, ARCH_PAGE_SIZE};
+
+        if (memory_object->refcount == 1 && memory_mapping->pages.count() == 0)
+        {
+            memory_mapping->copy_on_write = false;
+            task_memory_mapping_remap(task, memory_mapping);
+            return;
+        }
+
+        if (memory_object->refcount == 1)
+        {
+            assert(SUCCESS == Arch::virtual_map(task->address_space, range, address, memory_mapping->flags));
+            return;
+        }
+
+        memory_mapping->pages[page] = memory_page_copy(range);
+        task->memory_resident += ARCH_PAGE_SIZE;
+    }
+
+    assert(SUCCESS == Arch::virtual_map(task->address_space, memory_mapping->pages[page]->range(), address, memory_mapping->flags));
+}
+
+void task_memory_clone(Task *task, Task *clone)
+{
+    InterruptsRetainer retainer;
+
+    task->memory_mapping->foreach([&](auto *memory_mapping)
+        {
+            if (memory_mapping->flags & MEMORY_READONLY)
+            {
+                // Nobody writes to these pages, both tasks can use them.
+                task_memory_mapping_create_many(
+                    clone,
+                    memory_mapping->objects,
+                    memory_mapping->offset,
+                    memory_mapping->size,
+                    memory_mapping->address,
+                    memory_mapping->flags);
+
+                return Iter::CONTINUE;
+            }
+
+            auto *clone_mapping = new MemoryMapping();
+
+            clone_mapping->address = memory_mapping->address;
+            clone_mapping->size = memory_mapping->size;
+            clone_mapping->flags = memory_mapping->flags;
+
+            if (memory_mapping->lazy)
+            {
+                // The pages are never shared by handle, only with clones.
+                clone_mapping->lazy = true;
+                clone_mapping->pages = memory_mapping->pages;
+
+                clone_mapping->pages.foreach([](auto, auto *memory_page)
+                    {
+                        memory_page_ref(memory_page);
+                        return Iter::CONTINUE;
+                    });
+
+                memory_mapping->copy_on_write = true;
+                task_memory_mapping_remap(task, memory_mapping);
+
+                clone_mapping->copy_on_write = true;
+            }
+            else if (memory_mapping->copy_on_write || memory_mapping->objects[0]->refcount == 1)
+            {
+                memory_mapping->copy_on_write = true;
+                task_memory_mapping_remap(task, memory_mapping);
+
+                clone_mapping->objects.push_back(memory_object_ref(memory_mapping->objects[0]));
+                clone_mapping->pages = memory_mapping->pages;
+
+                clone_mapping->pages.foreach([](auto, auto *memory_page)
+                    {
+                        memory_page_ref(memory_page);
+                        return Iter::CONTINUE;
+                    });
+
+                clone_mapping->copy_on_write = true;
+            }
+            else
+            {
+                // The object is shared with another task, like a bitmap with the
+                // compositor, the task keeps writing to it and the clone gets
+                // the content it has right now.
+                clone_mapping->objects.push_back(memory_object_clone(memory_mapping->objects[0]));
+            }
+
+            task_memory_mapping_remap(clone, clone_mapping);
+            task_memory_mapping_add(clone, clone_mapping);
+
+            return Iter::CONTINUE;
+        });
+}
+
+bool task_memory_fault(Task *task, uintptr_t address, bool is_write)
+{
+    InterruptsRetainer retainer;
+
+    auto *memory_mapping = task_memory_mapping_containing(task, address);
+
+    if (!memory_mapping)
+    {
+        return false;
+    }
+
+    size_t page = (address - memory_mapping->address) / ARCH_PAGE_SIZE;
+
+    if (memory_mapping->lazy && !task_memory_mapping_page(memory_mapping, page))
+    {
+        // We can't cancel the task from here, the fault goes through as
+        // a real one instead and the interrupt handler does it.
+        if (!task_memory_mapping_populate(task, memory_mapping, page))
+        {
+            return false;
+        }
+    }
+    else if (is_write && memory_mapping->copy_on_write)
+    {
+        task_memory_mapping_unshare_page(task, memory_mapping, page);
+    }
+    else
+    {
+        return false;
+    }
+
+    return true;
+}
+
+bool task_memory_validate(Task *task, uintptr_t address, size_t size, bool is_write)
+{
+    InterruptsRetainer retainer;
+
+    uint64_t current = address;
+    uint64_t end = (uint64_t)address + size;
+
+    if (end < current)
+    {
+        return false;
+    }
+
+    while (current < end)
+    {
+        auto *memory_mapping = task_memory_mapping_containing(task, current);
+
+        if (!memory_mapping ||
+            (is_write && (memory_mapping->flags & MEMORY_READONLY)))
+        {
+            return false;
+        }
+
+        uint64_t mapping_end = (uint64_t)memory_mapping->address + memory_mapping->size;
+
+        if (memory_mapping->lazy)
+        {
+            size_t first = (current - memory_mapping->address) / ARCH_PAGE_SIZE;
+            size_t last = (MIN(end, mapping_end) - 1 - memory_mapping->address) / ARCH_PAGE_SIZE;
+
+            for (size_t page = first; page <= last; page++)
+            {
+                if (task_memory_mapping_page(memory_mapping, page))
+                {
+                    continue;
+                }
+
+                if (!task_memory_mapping_populate(task, memory_mapping, page))
+                {
+                    return false;
+                }
+            }
+        }
+
+        current = mapping_end;
+    }
+
+    return true;
 }
 
 /* --- User facing API ------------------------------------------------------ */
 
-HjResult task_memory_alloc(Task *task, size_t size, uintptr_t *out_address)
+HjResult task_memory_alloc(Task *task, size_t size, MemoryFlags flags, uintptr_t *out_address)
 {
+    if (size == 0)
+    {
+        return ERR_INVALID_ARGUMENT;
+    }
+
+    size = PAGE_ALIGN_UP(size);
+
     kill_me_if_too_greedy(task, size);
 
+    if (!(flags & MEMORY_SHARED))
+    {
+        auto memory_mapping = task_memory_mapping_create_lazy(task, size);
+
+        *out_address = memory_mapping->address;
+
+        return SUCCESS;
+    }
+
     auto memory_object = memory_object_create(size);
 
     auto memory_mapping = task_memory_mapping_create(task, memory_object);
 
     memory_object_deref(memory_object);
 
+    memset((void *)memory_mapping->address, 0, size);
+
     *out_address = memory_mapping->address;
 
     return SUCCESS;
@@ -171,22 +732,57 @@ HjResult task_memory_include(Task *task, int handle, uintptr_t *out_address, siz
 
     memory_object_deref(memory_object);
 
+    task->memory_included++;
+
     *out_address = memory_mapping->address;
     *out_size = memory_mapping->size;
 
     return SUCCESS;
 }
 
+HjResult task_memory_map_handle(Task *task, int handle, uintptr_t *out_address, size_t *out_size)
+{
+    size_t size = 0;
+    auto objects = TRY(task->handles().map(handle, &size));
+
+    *out_address = 0;
+    *out_size = size;
+
+    if (objects.count() > 0)
+    {
+        auto memory_mapping = task_memory_mapping_create_many(task, objects, 0, PAGE_ALIGN_UP(size), 0, MEMORY_READONLY);
+        *out_address = memory_mapping->address;
+    }
+
+    for (auto *object : objects)
+    {
+        memory_object_deref(object);
+    }
+
+    return SUCCESS;
+}
+
 HjResult task_memory_get_handle(Task *task, uintptr_t address, int *out_handle)
 {
     auto memory_mapping = task_memory_mapping_by_address(task, address);
 
-    if (!memory_mapping)
+    // Only anonymous memory can be shared by handle.
+    if (!memory_mapping || (!memory_mapping->lazy && memory_mapping->objects.count() != 1))
     {
         return ERR_BAD_ADDRESS;
     }
 
-    *out_handle = memory_mapping->object->id;
+    // Whoever includes the object writes to it, it can't be the one our
+    // clones still read from.
+    if (memory_mapping->lazy || memory_mapping->copy_on_write)
+    {
+        InterruptsRetainer retainer;
+        task_memory_mapping_unshare(task, memory_mapping);
+    }
+
+    task->memory_shared++;
+
+    *out_handle = memory_mapping->objects[0]->id;
     return SUCCESS;
 }
 
@@ -200,15 +796,3 @@ Arch::AddressSpace *task_switch_address_space(Task *task, Arch::AddressSpace *ad
 
     return old_address_space;
 }
-
-size_t task_memory_usage(Task *task)
-{
-    size_t total = 0;
-
-    for (auto *memory_mapping : *task->memory_mapping)
-    {
-        total += memory_mapping->size;
-    }
-
-    return total;
-}
@@ -1,25 +1,61 @@
 #pragma once
 
+#include <libutils/HashMap.h>
+#include <libutils/Vec.h>
+
 #include "system/memory/MemoryObject.h"
+#include "system/memory/MemoryPage.h"
 #include "system/tasking/Task.h"
 
 struct MemoryMapping
 {
-    MemoryObject *object;
+    // The memory objects behind the mapping, laid out one after the other.
+    // Anonymous memory has a single one and files one per extent, lazy
+    // mappings have none.
+    Vec<MemoryObject *> objects;
+
+    // By index in the mapping, the pages of a lazy mapping that were touched,
+    // or the ones a copy-on-write mapping wrote to instead of its object. A
+    // large page is kept under the first page it covers.
+    HashMap<uint32_t, MemoryPage *> pages;
+
+    // Where the mapping starts in the first object.
+    size_t offset;
 
     uintptr_t address;
     size_t size;
+    MemoryFlags flags;
+
+    // The object is shared with clones of the task and the pages are mapped
+    // read-only, the first write to a page gives the mapping its own copy.
+    bool copy_on_write;
+
+    // The memory is only reserved, pages are filled with zeros the first
+    // time they are touched.
+    bool lazy;
 
     MemoryRange range() { return {address, size}; }
 };
 
 MemoryMapping *task_memory_mapping_create(Task *task, MemoryObject *memory_object);
 
+MemoryMapping *task_memory_mapping_create_lazy(Task *task, size_t size);
+
+// Maps `size` bytes of the memory objects, taken one after the other and
+// starting `offset` bytes in, at `address` or anywhere if it is 0.
+MemoryMapping *task_memory_mapping_create_many(Task *task, Vec<MemoryObject *> &memory_objects, size_t offset, size_t size, uintptr_t address, MemoryFlags flags);
+
+MemoryMapping *task_memory_mapping_containing(Task *task, uintptr_t address);
+
+bool task_memory_mapping_colides(Task *task, uintptr_t address, size_t size);
+
 void task_memory_mapping_destroy(Task *task, MemoryMapping *memory_mapping);
 
 MemoryMapping *task_memory_mapping_by_address(Task *task, uintptr_t address);
 
-HjResult task_memory_alloc(Task *task, size_t size, uintptr_t *out_address);
+// Memory is reserved and filled on first touch, unless it is allocated with
+// MEMORY_SHARED to be shared by handle right away.
+HjResult task_memory_alloc(Task *task, size_t size, MemoryFlags flags, uintptr_t *out_address);
 
 HjResult task_memory_map(Task *task, uintptr_t address, size_t size, MemoryFlags flags);
 
@@ -27,8 +63,24 @@ HjResult task_memory_free(Task *task, uintptr_t address);
 
 HjResult task_memory_include(Task *task, int handle, uintptr_t *out_address, size_t *out_size);
 
+// Maps the content of a file read-only, it stays mapped after the handle is closed.
+HjResult task_memory_map_handle(Task *task, int handle, uintptr_t *out_address, size_t *out_size);
+
 HjResult task_memory_get_handle(Task *task, uintptr_t address, int *out_handle);
 
-Arch::AddressSpace *task_switch_address_space(Task *task, Arch::AddressSpace *address_space);
+// Gives `clone` the memory of `task`. Memory only the task uses is shared
+// copy-on-write, memory other tasks write to is copied right away.
+void task_memory_clone(Task *task, Task *clone);
 
-size_t task_memory_usage(Task *task);
+// Handles a page fault of the running task, either on a page that was never
+// touched or on a write to a copy-on-write page. Returns false if the fault
+// is a real one.
+bool task_memory_fault(Task *task, uintptr_t address, bool is_write);
+
+// Checks that the task maps all of the range before the kernel touches it on
+// its behalf, a read-only range can't be written to. Lazy pages in the range
+// are filled now, so the kernel never faults on them; this fails if the task
+// can't have them.
+bool task_memory_validate(Task *task, uintptr_t address, size_t size, bool is_write);
+
+Arch::AddressSpace *task_switch_address_space(Task *task, Arch::AddressSpace *address_space);
@@ -5,6 +5,7 @@
 
 #include "system/Streams.h"
 #include "system/interrupts/Interupts.h"
+#include "system/scheduling/RunQueue.h"
 #include "system/scheduling/Scheduler.h"
 #include "system/system/System.h"
 #include "system/tasking/Finalizer.h"
@@ -23,9 +24,26 @@ void Task::state(TaskState state)
 {
     ASSERT_INTERRUPTS_RETAINED();
 
-    scheduler_did_change_task_state(this, _state, state);
+    TaskState old_state = _state;
+
+    if (old_state == TASK_STATE_BLOCKED && state != TASK_STATE_BLOCKED)
+    {
+        _blocker->detach(*this);
+    }
+
+    scheduler_did_change_task_state(this, old_state, state);
     _state = state;
 
+    if (state == TASK_STATE_BLOCKED && old_state != TASK_STATE_BLOCKED)
+    {
+        _blocker->attach(*this);
+    }
+
+    if (state == TASK_STATE_CANCELING)
+    {
+        _exit_waiters.wake_up();
+    }
+
     if (state == TASK_STATE_CANCELED)
     {
         _tasks->remove(this);
@@ -42,6 +60,11 @@ void Task::interrupt()
     if (_blocker)
     {
         _blocker->interrupt(*this, INTERRUPTED);
+
+        if (_state == TASK_STATE_BLOCKED)
+        {
+            try_unblock();
+        }
     }
 }
 
@@ -119,6 +142,7 @@ Task *task_create(Task *parent, const char *name, TaskFlags flags)
     strlcpy(task->name, name, PROCESS_NAME_SIZE);
     task->_state = TASK_STATE_NONE;
     task->_flags = flags;
+    task->_priority = (flags & TASK_USER) ? SCHEDULER_PRIORITY_USER : SCHEDULER_PRIORITY_KERNEL;
 
     if (task->_flags & TASK_USER)
     {
@@ -133,7 +157,7 @@ Task *task_create(Task *parent, const char *name, TaskFlags flags)
         task->_domain = parent->_domain;
 
     // Setup shms
-    task->memory_mapping = new List<MemoryMapping *>();
+    task->memory_mapping = new RangeTree<MemoryMapping *>(ARCH_USER_MEMORY_START, ARCH_USER_MEMORY_END);
 
     memory_alloc(task->address_space, PROCESS_STACK_SIZE, MEMORY_CLEAR, (uintptr_t *)&task->kernel_stack);
     task->kernel_stack_pointer = ((uintptr_t)task->kernel_stack + PROCESS_STACK_SIZE);
@@ -169,11 +193,12 @@ Task *task_clone(Task *parent, uintptr_t sp, uintptr_t ip, TaskFlags flags)
     task->_flags = flags;
     strlcpy(task->name, parent->name, PROCESS_NAME_SIZE);
     task->_state = TASK_STATE_NONE;
+    task->_priority = parent->_priority;
 
     task->address_space = Arch::address_space_create();
 
     // Setup shms
-    task->memory_mapping = new List<MemoryMapping *>();
+    task->memory_mapping = new RangeTree<MemoryMapping *>(ARCH_USER_MEMORY_START, ARCH_USER_MEMORY_END);
 
     if (parent)
     {
@@ -189,26 +214,7 @@ Task *task_clone(Task *parent, uintptr_t sp, uintptr_t ip, TaskFlags flags)
     memory_alloc(task->address_space, PROCESS_STACK_SIZE, MEMORY_CLEAR, (uintptr_t *)&task->kernel_stack);
     task->kernel_stack_pointer = ((uintptr_t)task->kernel_stack + PROCESS_STACK_SIZE);
 
-    for (auto *mapping : *parent->memory_mapping)
-    {
-        auto virtual_range = mapping->range();
-
-        auto physical_range = mapping->object->range();
-
-        void *buffer = malloc(physical_range.size());
-        assert(buffer);
-        assert(virtual_range.base());
-        memcpy(buffer, (void *)virtual_range.base(), virtual_range.size());
-
-        auto *parent_address_space = task_switch_address_space(scheduler_running(), task->address_space);
-
-        task_memory_map(task, virtual_range.base(), virtual_range.size(), MEMORY_USER);
-        memcpy((void *)virtual_range.base(), buffer, virtual_range.size());
-
-        task_switch_address_space(scheduler_running(), parent_address_space);
-
-        free(buffer);
-    }
+    task_memory_clone(parent, task);
 
     task->user_stack_pointer = sp;
     task->entry_point = (TaskEntryPoint)ip;
@@ -222,6 +228,8 @@ Task *task_clone(Task *parent, uintptr_t sp, uintptr_t ip, TaskFlags flags)
 
 void task_destroy(Task *task)
 {
+    scheduler_wait_until_descheduled(task);
+
     interrupts_retain();
 
     task->state(TASK_STATE_NONE);
@@ -230,7 +238,7 @@ void task_destroy(Task *task)
 
     while (task->memory_mapping->any())
     {
-        MemoryMapping *mapping = task->memory_mapping->peek();
+        MemoryMapping *mapping = task->memory_mapping->first();
         task_memory_mapping_destroy(task, mapping);
     }
 
@@ -250,7 +258,7 @@ void task_clear_userspace(Task *task)
 {
     while (task->memory_mapping->any())
     {
-        MemoryMapping *mapping = task->memory_mapping->peek();
+        MemoryMapping *mapping = task->memory_mapping->first();
         task_memory_mapping_destroy(task, mapping);
     }
 
@@ -426,11 +434,12 @@ void task_dump(Task *task)
     Kernel::logln("\t   State: {}", task_state_string(task->state()));
     Kernel::logln("\t   Memory: ");
 
-    for (auto *mapping : *task->memory_mapping)
-    {
-        auto virtual_range = mapping->range();
-        Kernel::logln("\t   - {08x} - {08x} ({08x})", virtual_range.base(), virtual_range.end(), virtual_range.size());
-    }
+    task->memory_mapping->foreach([](auto *mapping)
+        {
+            auto virtual_range = mapping->range();
+            Kernel::logln("\t   - {08x} - {08x} ({08x})", virtual_range.base(), virtual_range.end(), virtual_range.size());
+            return Iter::CONTINUE;
+        });
 
     if (task->address_space == Arch::kernel_address_space())
     {
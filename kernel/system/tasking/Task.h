@@ -5,9 +5,11 @@
 
 #include <libio/Path.h>
 #include <libutils/List.h>
+#include <libutils/RangeTree.h>
 
 #include "system/memory/Memory.h"
 #include "system/scheduling/Blocker.h"
+#include "system/scheduling/WaitQueue.h"
 
 #include "system/tasking/Domain.h"
 #include "system/tasking/Handles.h"
@@ -30,6 +32,17 @@ struct Task
     TaskState _state;
     Blocker *_blocker;
 
+    int _priority;
+    int _timeslice = 0;
+    int _run_array = -1;
+    Task *_run_prev = nullptr;
+    Task *_run_next = nullptr;
+
+    int _timeout_index = -1;
+
+    int _processor = -1;
+    bool _switching = false;
+
     uintptr_t user_stack_pointer;
     void *user_stack;
 
@@ -39,16 +52,25 @@ struct Task
     TaskEntryPoint entry_point;
     char fpu_registers[512];
 
-    List<MemoryMapping *> *memory_mapping;
+    RangeTree<MemoryMapping *> *memory_mapping;
+    size_t memory_reserved = 0;
+    size_t memory_resident = 0;
+
+    // Shared memory handed out by hj_memory_get_handle and taken in by
+    // hj_memory_include.
+    size_t memory_shared = 0;
+    size_t memory_included = 0;
     Arch::AddressSpace *address_space;
 
     int exit_value = 0;
 
     Handles _handles;
     Domain _domain;
+    WaitQueue _exit_waiters;
 
     Handles &handles() { return _handles; }
     Domain &domain() { return _domain; }
+    WaitQueue &exit_waiters() { return _exit_waiters; }
 
     TaskState state();
 
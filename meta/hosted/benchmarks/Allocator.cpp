@@ -0,0 +1,205 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <time.h>
+
+// The same allocator built twice, once as it is and once with the slabs
+// compiled out, see meta/hosted/benchmarks/allocator.sh.
+
+extern "C" void *slabs_malloc(size_t size);
+extern "C" void slabs_free(void *ptr);
+extern "C" void *liballoc_malloc(size_t size);
+extern "C" void liballoc_free(void *ptr);
+
+/* --- Memory plugs --------------------------------------------------------- */
+
+// Everything the allocators get from the system is mapped eagerly on skift,
+// so the mapped bytes are what the heap adds to the RSS.
+static size_t _mapped = 0;
+static size_t _peak = 0;
+
+void __plug_memory_lock() {}
+
+void __plug_memory_unlock() {}
+
+void *__plug_memory_alloc(size_t size)
+{
+    void *address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (address == MAP_FAILED)
+    {
+        return nullptr;
+    }
+
+    _mapped += size;
+
+    if (_mapped > _peak)
+    {
+        _peak = _mapped;
+    }
+
+    return address;
+}
+
+void __plug_memory_free(void *address, size_t size)
+{
+    munmap(address, size);
+    _mapped -= size;
+}
+
+/* --- Workloads ------------------------------------------------------------ */
+
+struct Allocator
+{
+    const char *name;
+    void *(*alloc)(size_t);
+    void (*free)(void *);
+};
+
+static constexpr Allocator ALLOCATORS[] = {
+    {"liballoc", liballoc_malloc, liballoc_free},
+    {"slabs", slabs_malloc, slabs_free},
+};
+
+static constexpr size_t LIVE_COUNT = 16 * 1024;
+static constexpr size_t OPERATIONS = 1000 * 1000;
+
+static void *_live[LIVE_COUNT];
+
+static uint32_t random_next(uint32_t &state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static size_t small_size(uint32_t &state)
+{
+    return 8 + random_next(state) % 248;
+}
+
+static size_t mixed_size(uint32_t &state)
+{
+    if (random_next(state) % 64 == 0)
+    {
+        return 2048 + random_next(state) % (62 * 1024);
+    }
+
+    return 8 + random_next(state) % 1016;
+}
+
+// Replace random objects in a working set, like a long running application.
+static size_t churn(const Allocator &allocator, size_t (*size)(uint32_t &))
+{
+    uint32_t state = 0x5eed;
+
+    for (size_t i = 0; i < LIVE_COUNT; i++)
+    {
+        _live[i] = allocator.alloc(size(state));
+    }
+
+    for (size_t i = 0; i < OPERATIONS; i++)
+    {
+        size_t slot = random_next(state) % LIVE_COUNT;
+        allocator.free(_live[slot]);
+        _live[slot] = allocator.alloc(size(state));
+    }
+
+    for (size_t i = 0; i < LIVE_COUNT; i++)
+    {
+        allocator.free(_live[i]);
+    }
+
+    return LIVE_COUNT * 2 + OPERATIONS * 2;
+}
+
+static size_t churn_small(const Allocator &allocator)
+{
+    return churn(allocator, small_size);
+}
+
+static size_t churn_mixed(const Allocator &allocator)
+{
+    return churn(allocator, mixed_size);
+}
+
+// Build and tear down trees of small nodes, like widgets.
+static size_t trees(const Allocator &allocator)
+{
+    struct Node
+    {
+        Node *next;
+        char data[40];
+    };
+
+    size_t operations = 0;
+
+    for (int round = 0; round < 64; round++)
+    {
+        Node *head = nullptr;
+
+        for (size_t i = 0; i < LIVE_COUNT; i++)
+        {
+            Node *node = (Node *)allocator.alloc(sizeof(Node));
+            node->next = head;
+            head = node;
+        }
+
+        while (head)
+        {
+            Node *next = head->next;
+            allocator.free(head);
+            head = next;
+        }
+
+        operations += LIVE_COUNT * 2;
+    }
+
+    return operations;
+}
+
+struct Workload
+{
+    const char *name;
+    size_t (*run)(const Allocator &);
+};
+
+static constexpr Workload WORKLOADS[] = {
+    {"churn-small", churn_small},
+    {"churn-mixed", churn_mixed},
+    {"trees", trees},
+};
+
+static double now()
+{
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+int main()
+{
+    printf("workload\tallocator\tMops/s\tpeak KiB\n");
+
+    for (auto &workload : WORKLOADS)
+    {
+        for (auto &allocator : ALLOCATORS)
+        {
+            _peak = _mapped;
+            size_t base = _mapped;
+
+            double start = now();
+            size_t operations = workload.run(allocator);
+            double elapsed = now() - start;
+
+            printf("%s\t%s\t%.2f\t%zu\n",
+                   workload.name,
+                   allocator.name,
+                   operations / elapsed / 1e6,
+                   (_peak - base) / 1024);
+        }
+    }
+
+    return 0;
+}
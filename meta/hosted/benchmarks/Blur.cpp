@@ -0,0 +1,86 @@
+#include <stdio.h>
+#include <time.h>
+
+#include <libgraphic/Painter.h>
+
+using namespace Graphic;
+
+static constexpr double MIN_DURATION = 0.25;
+
+static constexpr int WIDTH = 1920;
+static constexpr int HEIGHT = 1080;
+
+// Bitmap.cpp and Icon.cpp bring the image loaders and the memory syscalls
+// with them, the benchmark only draws into static pixels.
+Bitmap::~Bitmap() {}
+
+ResultOr<RefPtr<Bitmap>> Bitmap::load_from(String, int) { return ERR_NOT_IMPLEMENTED; }
+
+RefPtr<Bitmap> Icon::bitmap(IconSize) { return nullptr; }
+
+static double now()
+{
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+// Returns the time of one call in milliseconds.
+template <typename Callback>
+static double measure(Callback callback)
+{
+    size_t iterations = 0;
+    double start = now();
+    double elapsed = 0;
+
+    do
+    {
+        callback();
+        iterations++;
+        elapsed = now() - start;
+    } while (elapsed < MIN_DURATION);
+
+    return elapsed * 1000 / iterations;
+}
+
+int main(int, char const *[])
+{
+    static Color pixels[WIDTH * HEIGHT];
+
+    for (int y = 0; y < HEIGHT; y++)
+    {
+        for (int x = 0; x < WIDTH; x++)
+        {
+            pixels[y * WIDTH + x] = Color::from_rgb_byte(x * 255 / WIDTH, y * 255 / HEIGHT, (x ^ y) & 0xff);
+        }
+    }
+
+    auto bitmap = make<Bitmap>(-1, BITMAP_STATIC, WIDTH, HEIGHT, pixels);
+    Painter painter{*bitmap};
+
+    // A panel behind an acrylic window and the whole screen, like the
+    // wallpaper of the compositor.
+    Math::Recti panel{400, 300, 480, 320};
+    Math::Recti screen = bitmap->bound();
+
+    for (int radius : {4, 8, 16, 32})
+    {
+        double panel_time = measure([&]() { painter.blur(panel, radius); });
+        double screen_time = measure([&]() { painter.blur(screen, radius); });
+
+        // One line per measure, blur.sh puts the two builds side by side.
+        printf("%d %.3f %.3f\n", radius, panel_time, screen_time);
+
+        // The standard streams of libio close the handles on exit, before
+        // stdio gets to flush.
+        fflush(stdout);
+    }
+
+    double panel_time = measure([&]() { painter.acrylic(panel); });
+    double screen_time = measure([&]() { painter.acrylic(screen); });
+
+    printf("acrylic %.3f %.3f\n", panel_time, screen_time);
+    fflush(stdout);
+
+    return 0;
+}
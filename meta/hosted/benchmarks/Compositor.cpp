@@ -0,0 +1,123 @@
+#include <stdio.h>
+#include <time.h>
+
+#include "compositor/Composite.h"
+
+using namespace Graphic;
+
+static constexpr int WIDTH = 1920;
+static constexpr int HEIGHT = 1080;
+
+static constexpr int FRAMES = 600;
+
+// Bitmap.cpp and Icon.cpp bring the image loaders and the memory syscalls
+// with them, the benchmark only draws into static pixels.
+Bitmap::~Bitmap() {}
+
+ResultOr<RefPtr<Bitmap>> Bitmap::load_from(String, int) { return ERR_NOT_IMPLEMENTED; }
+
+RefPtr<Bitmap> Icon::bitmap(IconSize) { return nullptr; }
+
+static double now()
+{
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+static RefPtr<Bitmap> create_bitmap(int width, int height, Color color)
+{
+    Color *pixels = new Color[width * height];
+
+    for (int i = 0; i < width * height; i++)
+    {
+        pixels[i] = color;
+    }
+
+    return make<Bitmap>(-1, BITMAP_STATIC, width, height, pixels);
+}
+
+// A desktop with a popover, a panel on top, a few overlapping application
+// windows, one of them acrylic, and the desktop itself at the back, the
+// first layer is the one in front.
+static const Math::Recti BOUNDS[] = {
+    {300, 200, 600, 400},
+    {0, 0, WIDTH, 32},
+    {200, 150, 800, 600},
+    {500, 300, 900, 640},
+    {900, 100, 700, 500},
+    {100, 500, 640, 480},
+    {0, 0, WIDTH, HEIGHT},
+};
+
+static const WindowFlag FLAGS[] = {
+    WINDOW_TRANSPARENT,
+    WINDOW_NO_ROUNDED_CORNERS,
+    WINDOW_NONE,
+    WINDOW_ACRYLIC,
+    WINDOW_NONE,
+    WINDOW_NONE,
+    WINDOW_NO_ROUNDED_CORNERS | WINDOW_TRANSPARENT,
+};
+
+// Drags one of the layers around the screen, each frame repaints where it
+// was and where it is now.
+static void run(const char *name, size_t dragged, Painter &painter, Bitmap &wallpaper, Bitmap &acrylic)
+{
+    Vec<RefPtr<Bitmap>> bitmaps;
+    Vec<compositor::Layer> layers;
+
+    for (size_t i = 0; i < sizeof(BOUNDS) / sizeof(*BOUNDS); i++)
+    {
+        auto color = (FLAGS[i] & WINDOW_TRANSPARENT) ? Colors::BLACK.with_alpha(0.5) : Colors::WHITE;
+
+        bitmaps.push_back(create_bitmap(BOUNDS[i].width(), BOUNDS[i].height(), color));
+        layers.push_back({BOUNDS[i], FLAGS[i], bitmaps.peek_back().naked()});
+    }
+
+    size_t damaged = 0;
+    size_t written = 0;
+    double start = now();
+
+    for (int frame = 0; frame < FRAMES; frame++)
+    {
+        auto &layer = layers[dragged];
+        auto old_bound = layer.bound;
+
+        int x = 100 + (frame * 7) % (WIDTH - layer.bound.width() - 200);
+        int y = 100 + (frame * 3) % (HEIGHT - layer.bound.height() - 200);
+        layer.bound = Math::Recti{x, y, layer.bound.width(), layer.bound.height()};
+
+        Math::Regioni damage{old_bound};
+        damage = damage.unite(layer.bound);
+
+        damaged += damage.area();
+        written += compositor::composite(painter, damage, layers, wallpaper, acrylic);
+    }
+
+    double elapsed = now() - start;
+
+    printf("%-12s %12.3f %16zu %16zu\n", name, elapsed * 1000 / FRAMES, damaged / FRAMES, written / FRAMES);
+
+    // The standard streams of libio close the handles on exit, before
+    // stdio gets to flush.
+    fflush(stdout);
+}
+
+int main(int, char const *[])
+{
+    auto screen = create_bitmap(WIDTH, HEIGHT, Colors::BLACK);
+    auto wallpaper = create_bitmap(WIDTH, HEIGHT, Colors::BLUE);
+    auto acrylic = create_bitmap(WIDTH, HEIGHT, Colors::GRAY);
+
+    Painter painter{*screen};
+
+    printf("%-12s %12s %16s %16s\n", "dragging", "ms/frame", "damage/frame", "pixels/frame");
+
+    run("popover", 0, painter, *wallpaper, *acrylic);
+    run("front", 2, painter, *wallpaper, *acrylic);
+    run("acrylic", 3, painter, *wallpaper, *acrylic);
+    run("behind", 5, painter, *wallpaper, *acrylic);
+
+    return 0;
+}
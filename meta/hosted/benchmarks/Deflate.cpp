@@ -0,0 +1,137 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <libcompression/Deflate.h>
+#include <libcompression/Inflate.h>
+#include <libio/MemoryReader.h>
+#include <libio/MemoryWriter.h>
+#include <libutils/Vec.h>
+
+static constexpr double MIN_DURATION = 0.25;
+
+static double now()
+{
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+static bool read_file(const char *path, Vec<uint8_t> &content)
+{
+    FILE *file = fopen(path, "rb");
+
+    if (!file)
+    {
+        return false;
+    }
+
+    uint8_t buffer[4096];
+    size_t read;
+
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        content.push_back_many(buffer, read);
+    }
+
+    fclose(file);
+    return true;
+}
+
+static size_t compress(Compression::Deflate &deflate, const Vec<uint8_t> &file, IO::MemoryWriter &writer)
+{
+    IO::MemoryReader reader{file.raw_storage(), file.count()};
+    deflate.perform(reader, writer);
+
+    return writer.length().unwrap();
+}
+
+static bool round_trips(const Vec<uint8_t> &file, IO::MemoryWriter &compressed)
+{
+    auto data = Slice(compressed.slice());
+
+    IO::MemoryReader reader{data};
+    IO::MemoryWriter writer;
+    Compression::Inflate inflate;
+
+    if (!inflate.perform(reader, writer).success())
+    {
+        return false;
+    }
+
+    auto output = Slice(writer.slice());
+
+    return output.size() == file.count() &&
+           memcmp(output.start(), file.raw_storage(), file.count()) == 0;
+}
+
+// Every file given on the command line is compressed at each level, the
+// totals are reported per level.
+int main(int argc, char const *argv[])
+{
+    Vec<Vec<uint8_t>> files;
+    size_t total = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        Vec<uint8_t> file;
+
+        if (read_file(argv[i], file))
+        {
+            total += file.count();
+            files.push_back(file);
+        }
+    }
+
+    printf("%zu files, %zu KiB\n", files.count(), total / 1024);
+    printf("%-6s %12s %8s %10s\n", "level", "out KiB", "ratio", "MB/s");
+
+    for (unsigned int level = 0; level <= Compression::Deflate::MAX_COMPRESSION_LEVEL; level++)
+    {
+        Compression::Deflate deflate{level};
+        size_t compressed = 0;
+        size_t failures = 0;
+
+        for (size_t i = 0; i < files.count(); i++)
+        {
+            IO::MemoryWriter writer;
+            compressed += compress(deflate, files[i], writer);
+
+            if (!round_trips(files[i], writer))
+            {
+                failures++;
+            }
+        }
+
+        size_t iterations = 0;
+        double start = now();
+        double elapsed = 0;
+
+        do
+        {
+            for (size_t i = 0; i < files.count(); i++)
+            {
+                IO::MemoryWriter writer;
+                compress(deflate, files[i], writer);
+            }
+
+            iterations++;
+            elapsed = now() - start;
+        } while (elapsed < MIN_DURATION);
+
+        printf("%-6u %12zu %8.3f %10.1f", level, compressed / 1024, (double)compressed / total, (total * iterations) / elapsed / (1024 * 1024));
+
+        if (failures)
+        {
+            printf("  %zu files don't round trip", failures);
+        }
+
+        printf("\n");
+
+        // The standard streams of libio close the handles on exit, before
+        // stdio gets to flush.
+        fflush(stdout);
+    }
+
+    return 0;
+}
@@ -0,0 +1,190 @@
+#include <stdio.h>
+#include <time.h>
+
+#include <libgraphic/Font.h>
+#include <libgraphic/Spans.h>
+
+using namespace Graphic;
+
+static constexpr double MIN_DURATION = 0.25;
+
+static constexpr int COLUMNS = 80;
+static constexpr int ROWS = 25;
+static constexpr int CELL_WIDTH = 7;
+static constexpr int CELL_HEIGHT = 16;
+static constexpr int WIDTH = COLUMNS * CELL_WIDTH;
+static constexpr int HEIGHT = ROWS * CELL_HEIGHT;
+
+static constexpr int ATLAS_WIDTH = 261;
+static constexpr int ATLAS_HEIGHT = 115;
+
+// Bitmap.cpp brings the image loaders and the memory syscalls with it, the
+// benchmark only uses static pixels.
+Bitmap::~Bitmap() {}
+
+ResultOr<RefPtr<Bitmap>> Bitmap::load_from(String, int)
+{
+    return ERR_NOT_IMPLEMENTED;
+}
+
+static double now()
+{
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+// Returns the number of screens per second.
+template <typename Callback>
+static double measure(Callback callback)
+{
+    size_t iterations = 0;
+    double start = now();
+    double elapsed = 0;
+
+    do
+    {
+        callback();
+        iterations++;
+        elapsed = now() - start;
+    } while (elapsed < MIN_DURATION);
+
+    return iterations / elapsed;
+}
+
+static Vec<Glyph> load_glyphs(const char *path)
+{
+    Vec<Glyph> glyphs;
+    FILE *file = fopen(path, "rb");
+
+    if (!file)
+    {
+        return glyphs;
+    }
+
+    Glyph glyph;
+
+    while (fread(&glyph, sizeof(Glyph), 1, file) == 1)
+    {
+        glyphs.push_back(glyph);
+    }
+
+    fclose(file);
+    return glyphs;
+}
+
+// Draws a screen of text the way Painter::draw_glyph() does, without the
+// clipping, with rows cycling through eight colors like a colored listing.
+int main(int argc, char const *argv[])
+{
+    auto glyphs = load_glyphs(argc > 1 ? argv[1] : "sysroot/files/fonts/mono.glyph");
+
+    if (glyphs.count() == 0)
+    {
+        printf("No glyphs\n");
+        return 1;
+    }
+
+    static Color atlas_pixels[ATLAS_WIDTH * ATLAS_HEIGHT];
+    static Color screen_pixels[WIDTH * HEIGHT];
+
+    for (int i = 0; i < ATLAS_WIDTH * ATLAS_HEIGHT; i++)
+    {
+        uint8_t value = (i * 2654435761u) >> 24;
+        atlas_pixels[i] = Color::from_rgb_byte(value, value, value);
+    }
+
+    auto atlas = make<Bitmap>(-1, BITMAP_STATIC, ATLAS_WIDTH, ATLAS_HEIGHT, atlas_pixels);
+    auto font = make<Font>(atlas, glyphs);
+
+    Text::Rune screen[ROWS][COLUMNS];
+    const char *text = "skift@skift:~$ ls -la /System/Applications | grep terminal && make all ";
+
+    for (int y = 0; y < ROWS; y++)
+    {
+        for (int x = 0; x < COLUMNS; x++)
+        {
+            screen[y][x] = (y % 5 == 4) ? 0x2500 : text[(x + y * 7) % 70];
+        }
+    }
+
+    auto row_color = [](int y) {
+        return Color::from_rgb_byte(0x40 + y * 7, 0xc0 - y * 3, 0x80 + (y % 3) * 40);
+    };
+
+    for (int i = 0; i < WIDTH * HEIGHT; i++)
+    {
+        screen_pixels[i] = Colors::BLACK;
+    }
+
+    // Keeps the lookups from being optimized away.
+    static volatile int advance = 0;
+
+    double lookups = measure([&]() {
+        for (int y = 0; y < ROWS; y++)
+        {
+            for (int x = 0; x < COLUMNS; x++)
+            {
+                advance = font->glyph(screen[y][x]).advance;
+            }
+        }
+    });
+
+    auto draw = [&](auto blit_glyph) {
+        for (int y = 0; y < ROWS; y++)
+        {
+            Color color = row_color(y % 8);
+
+            for (int x = 0; x < COLUMNS; x++)
+            {
+                auto &glyph = font->glyph(screen[y][x]);
+                Math::Vec2i position = Math::Vec2i{x * CELL_WIDTH, y * CELL_HEIGHT + 13} - glyph.origin;
+
+                if (Math::Recti{WIDTH, HEIGHT}.contains(Math::Recti{position, glyph.bound.size()}))
+                {
+                    blit_glyph(glyph, color, screen_pixels + position.y() * WIDTH + position.x());
+                }
+            }
+        }
+    };
+
+    double masked = measure([&]() {
+        draw([&](const Glyph &glyph, Color color, Color *destination) {
+            for (int y = 0; y < glyph.bound.height(); y++)
+            {
+                span_blend_mask(
+                    destination + y * WIDTH,
+                    atlas_pixels + (glyph.bound.y() + y) * ATLAS_WIDTH + glyph.bound.x(),
+                    color,
+                    glyph.bound.width());
+            }
+        });
+    });
+
+    // One line per measure, glyphs.sh puts the two builds side by side.
+    printf("lookup %.1f\n", 1e9 / (lookups * ROWS * COLUMNS));
+    printf("masked %.1f\n", masked);
+
+#ifdef FONT_WITHOUT_TINTS
+    printf("tinted -\n");
+#else
+    double tinted = measure([&]() {
+        draw([&](const Glyph &glyph, Color color, Color *destination) {
+            const Color *pixels = font->tinted(glyph, color);
+
+            for (int y = 0; y < glyph.bound.height(); y++)
+            {
+                span_blend(destination + y * WIDTH, pixels + y * glyph.bound.width(), glyph.bound.width());
+            }
+        });
+    });
+
+    printf("tinted %.1f\n", tinted);
+#endif
+
+    // The standard streams of libio close the handles on exit, before stdio
+    // gets to flush.
+    fflush(stdout);
+
+    return 0;
+}
@@ -0,0 +1,112 @@
+#include <stdio.h>
+#include <time.h>
+
+#include <libutils/HashMap.h>
+#include <libutils/String.h>
+#include <libutils/Vec.h>
+
+static constexpr size_t KEY_COUNTS[] = {100, 1000, 10000, 100000, 1000000};
+
+static double now()
+{
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+static uint32_t random_next(uint32_t &state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static Vec<uint32_t> integer_keys(size_t count)
+{
+    Vec<uint32_t> keys(count);
+    uint32_t state = 0x5eed;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        keys.push_back(random_next(state));
+    }
+
+    return keys;
+}
+
+static Vec<String> string_keys(size_t count)
+{
+    Vec<String> keys(count);
+    uint32_t state = 0x5eed;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "key-%08x", random_next(state));
+        keys.push_back(buffer);
+    }
+
+    return keys;
+}
+
+template <typename TKey>
+static void run(const char *name, Vec<TKey> keys)
+{
+    HashMap<TKey, uint32_t> map;
+    size_t count = keys.count();
+
+    double start = now();
+
+    for (size_t i = 0; i < count; i++)
+    {
+        map[keys[i]] = i;
+    }
+
+    double inserted = now();
+
+    size_t found = 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        found += map.has_key(keys[i]);
+    }
+
+    double looked_up = now();
+
+    for (size_t i = 0; i < count; i++)
+    {
+        map.remove_key(keys[i]);
+    }
+
+    double erased = now();
+
+    if (found != count || map.count() != 0)
+    {
+        printf("%s: lost keys!\n", name);
+    }
+
+    printf("%s\t%zu\t%.1f\t%.1f\t%.1f\n",
+           name,
+           count,
+           (inserted - start) / count * 1e9,
+           (looked_up - inserted) / count * 1e9,
+           (erased - looked_up) / count * 1e9);
+}
+
+int main()
+{
+    printf("keys\tcount\tinsert ns\tlookup ns\terase ns\n");
+
+    for (size_t count : KEY_COUNTS)
+    {
+        run("integer", integer_keys(count));
+    }
+
+    for (size_t count : KEY_COUNTS)
+    {
+        run("string", string_keys(count));
+    }
+
+    return 0;
+}
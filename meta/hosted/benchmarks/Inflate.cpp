@@ -0,0 +1,232 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <libcompression/Inflate.h>
+#include <libio/MemoryReader.h>
+#include <libio/MemoryWriter.h>
+#include <libutils/Vec.h>
+
+// Inflate as it was before the lookup tables, built from the previous
+// revision by inflate.sh.
+ResultOr<size_t> baseline_inflate(IO::Reader &compressed, IO::Writer &uncompressed);
+
+static constexpr double MIN_DURATION = 0.25;
+
+struct Stream
+{
+    Vec<uint8_t> compressed;
+    size_t uncompressed_size;
+};
+
+static double now()
+{
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+static uint32_t read_be32(const uint8_t *data)
+{
+    return (data[0] << 24) | (data[1] << 16) | (data[2] << 8) | data[3];
+}
+
+static uint32_t read_le32(const uint8_t *data)
+{
+    return data[0] | (data[1] << 8) | (data[2] << 16) | (data[3] << 24);
+}
+
+static uint16_t read_le16(const uint8_t *data)
+{
+    return data[0] | (data[1] << 8);
+}
+
+static bool read_file(const char *path, Vec<uint8_t> &content)
+{
+    FILE *file = fopen(path, "rb");
+
+    if (!file)
+    {
+        return false;
+    }
+
+    uint8_t buffer[4096];
+    size_t read;
+
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        content.push_back_many(buffer, read);
+    }
+
+    fclose(file);
+    return true;
+}
+
+// The concatenated IDAT chunks, without the two bytes of zlib header.
+static void png_streams(const Vec<uint8_t> &file, Vec<Stream> &streams)
+{
+    Stream stream{};
+    size_t offset = 8;
+
+    while (offset + 8 <= file.count())
+    {
+        uint32_t length = read_be32(&file[offset]);
+        const uint8_t *type = &file[offset + 4];
+
+        if (offset + 12 + length > file.count())
+        {
+            break;
+        }
+
+        if (memcmp(type, "IDAT", 4) == 0)
+        {
+            stream.compressed.push_back_many(&file[offset + 8], length);
+        }
+
+        offset += 12 + length;
+    }
+
+    if (stream.compressed.count() > 2)
+    {
+        stream.compressed.remove_index(0);
+        stream.compressed.remove_index(0);
+        streams.push_back(stream);
+    }
+}
+
+// Every deflated entry, found through their local headers.
+static void zip_streams(const Vec<uint8_t> &file, Vec<Stream> &streams)
+{
+    size_t offset = 0;
+
+    while (offset + 30 <= file.count() && read_le32(&file[offset]) == 0x04034b50)
+    {
+        uint16_t method = read_le16(&file[offset + 8]);
+        uint32_t compressed_size = read_le32(&file[offset + 18]);
+        uint16_t name_length = read_le16(&file[offset + 26]);
+        uint16_t extra_length = read_le16(&file[offset + 28]);
+
+        size_t data = offset + 30 + name_length + extra_length;
+
+        if (data + compressed_size > file.count())
+        {
+            break;
+        }
+
+        if (method == 8)
+        {
+            Stream stream{};
+
+            stream.compressed.push_back_many(&file[data], compressed_size);
+
+            streams.push_back(stream);
+        }
+
+        offset = data + compressed_size;
+    }
+}
+
+template <typename TCallback>
+static double throughput(const Vec<Stream> &streams, size_t total, TCallback callback)
+{
+    size_t iterations = 0;
+    double start = now();
+    double elapsed = 0;
+
+    do
+    {
+        for (size_t i = 0; i < streams.count(); i++)
+        {
+            IO::MemoryReader reader{streams[i].compressed.raw_storage(), streams[i].compressed.count()};
+            IO::MemoryWriter writer{streams[i].uncompressed_size};
+            callback(reader, writer);
+        }
+
+        iterations++;
+        elapsed = now() - start;
+    } while (elapsed < MIN_DURATION);
+
+    return (total * iterations) / elapsed / (1024 * 1024);
+}
+
+int main(int argc, char const *argv[])
+{
+    printf("%-40s %10s %10s %12s %12s\n", "file", "in KiB", "out KiB", "before MB/s", "after MB/s");
+
+    for (int i = 1; i < argc; i++)
+    {
+        Vec<uint8_t> file;
+
+        if (!read_file(argv[i], file))
+        {
+            printf("%-40s cannot be read\n", argv[i]);
+            fflush(stdout);
+            continue;
+        }
+
+        Vec<Stream> streams;
+
+        if (strstr(argv[i], ".png"))
+        {
+            png_streams(file, streams);
+        }
+        else
+        {
+            zip_streams(file, streams);
+        }
+
+        size_t compressed = 0;
+        size_t total = 0;
+        bool matching = true;
+
+        for (size_t j = 0; j < streams.count(); j++)
+        {
+            auto &stream = streams[j];
+
+            IO::MemoryReader baseline_reader{stream.compressed.raw_storage(), stream.compressed.count()};
+            IO::MemoryWriter baseline_writer;
+            auto baseline_result = baseline_inflate(baseline_reader, baseline_writer);
+
+            IO::MemoryReader reader{stream.compressed.raw_storage(), stream.compressed.count()};
+            IO::MemoryWriter writer;
+            Compression::Inflate inflate;
+            auto result = inflate.perform(reader, writer);
+
+            auto baseline_output = Slice(baseline_writer.slice());
+            auto output = Slice(writer.slice());
+
+            matching = matching &&
+                       result.result() == baseline_result.result() &&
+                       output.size() == baseline_output.size() &&
+                       memcmp(output.start(), baseline_output.start(), output.size()) == 0;
+
+            stream.uncompressed_size = output.size();
+            compressed += stream.compressed.count();
+            total += output.size();
+        }
+
+        if (!matching)
+        {
+            printf("%-40s output differs from the baseline\n", argv[i]);
+            fflush(stdout);
+            continue;
+        }
+
+        double before = throughput(streams, total, [](auto &reader, auto &writer) {
+            baseline_inflate(reader, writer);
+        });
+
+        double after = throughput(streams, total, [](auto &reader, auto &writer) {
+            Compression::Inflate inflate;
+            inflate.perform(reader, writer);
+        });
+
+        printf("%-40s %10zu %10zu %12.1f %12.1f\n", argv[i], compressed / 1024, total / 1024, before, after);
+
+        // The standard streams of libio close the handles on exit, before
+        // stdio gets to flush.
+        fflush(stdout);
+    }
+
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <libterminal/Terminal.h>
+
+static constexpr int COLUMNS = 80;
+static constexpr int ROWS = 25;
+
+// Pipes hand the terminal at most this much at a time.
+static constexpr size_t CHUNK = 4096;
+
+static double now()
+{
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+// Something like the output of a build, lines of various lengths with a
+// colored tag every few lines.
+static Vec<char> generate(size_t size)
+{
+    Vec<char> text;
+    const char *words = "[CXX] userspace/libraries/libterminal/Terminal.cpp -> build/libterminal.a ";
+    size_t words_length = strlen(words);
+    size_t line = 0;
+
+    while (text.count() < size)
+    {
+        if (line % 4 == 0)
+        {
+            for (const char *c = "\e[32m[ OK ]\e[m "; *c; c++)
+            {
+                text.push_back(*c);
+            }
+        }
+
+        size_t length = 20 + (line * 37) % 60;
+
+        for (size_t i = 0; i < length; i++)
+        {
+            text.push_back(words[(line + i) % words_length]);
+        }
+
+        text.push_back('\n');
+        line++;
+    }
+
+    return text;
+}
+
+int main(int argc, char const *argv[])
+{
+    size_t megabytes = argc > 1 ? atoi(argv[1]) : 10;
+    auto text = generate(megabytes * 1024 * 1024);
+
+    Terminal::Terminal terminal{COLUMNS, ROWS};
+
+    double start = now();
+
+    for (size_t offset = 0; offset < text.count(); offset += CHUNK)
+    {
+        terminal.write(&text[offset], MIN(CHUNK, text.count() - offset));
+    }
+
+    double elapsed = now() - start;
+
+    // One line per measure, terminal.sh puts the two builds side by side.
+    printf("streamed %zu\n", megabytes);
+    printf("elapsed %.3f\n", elapsed);
+    printf("throughput %.2f\n", megabytes / elapsed);
+
+    // The standard streams of libio close the handles on exit, before stdio
+    // gets to flush.
+    fflush(stdout);
+
+    return 0;
+}
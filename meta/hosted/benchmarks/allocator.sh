@@ -0,0 +1,44 @@
+#!/bin/bash
+# Compares the libc allocator with and without its slabs, run from the root
+# of the repository.
+
+set -e
+
+BUILD=$(mktemp -d)
+trap "rm -rf $BUILD" EXIT
+
+FLAGS="-O2 -std=c++20 \
+    -Imeta/hosted/includes \
+    -Iuserspace/libraries \
+    -idirafter userspace/libraries/libc \
+    -D__CONFIG_IS_RELEASE__=1 \
+    -D__CONFIG_IS_HOSTED__=1"
+
+# Both variants end up in the same binary, next to the host malloc.
+variant() {
+    g++ $FLAGS \
+        -DALLOCATOR_SLABS=$2 \
+        -c userspace/libraries/libc/stdlib/allocator.cpp \
+        -o $BUILD/$1.o
+
+    objcopy \
+        --redefine-sym malloc=$1_malloc \
+        --redefine-sym free=$1_free \
+        --redefine-sym calloc=$1_calloc \
+        --redefine-sym realloc=$1_realloc \
+        --localize-symbol _Z14malloc_cleanupPv \
+        --localize-symbol _Z15allocator_statsP14AllocatorStats \
+        $BUILD/$1.o
+}
+
+variant slabs 1
+variant liballoc 0
+
+g++ $FLAGS \
+    meta/hosted/benchmarks/Allocator.cpp \
+    meta/hosted/plugs/Assert.cpp \
+    $BUILD/slabs.o \
+    $BUILD/liballoc.o \
+    -o $BUILD/allocator
+
+$BUILD/allocator
@@ -0,0 +1,53 @@
+#!/bin/bash
+# Measures Painter::blur at a few radii on a panel sized region and on a
+# whole 1080p screen, then the acrylic effect the compositor renders the
+# wallpaper with, against the stack blur it replaced. Run from the root of the
+# repository, BASELINE can point to another revision to compare with.
+
+set -e
+
+BUILD=$(mktemp -d)
+trap "rm -rf $BUILD" EXIT
+
+BASELINE=${BASELINE:-$(git rev-list --reverse --grep='^\[user-020\]' HEAD | head -n 1)^}
+
+mkdir -p $BUILD/baseline
+git archive $BASELINE userspace/libraries/libgraphic | tar -x -C $BUILD/baseline --strip-components=2
+
+# The painter pulls <skift/Time.h> through libmath/Random.h, the rest of the
+# skift libc would shadow the one of the host.
+mkdir -p $BUILD/includes/skift
+cp userspace/libraries/libc/skift/Time.h $BUILD/includes/skift
+
+# Both trees build the same benchmark, the baseline one finds the old
+# libgraphic first. The blur lives in StackBlur.cpp there and in Blur.cpp
+# here.
+variant() {
+    g++ -O3 -std=c++20 -msse2 \
+        -Imeta/hosted/includes \
+        -I$BUILD/includes \
+        -I$2 \
+        -Iuserspace/libraries \
+        -D__CONFIG_IS_RELEASE__=1 \
+        -D__CONFIG_IS_HOSTED__=1 \
+        meta/hosted/benchmarks/Blur.cpp \
+        $2/libgraphic/*Blur.cpp \
+        $2/libgraphic/Painter.cpp \
+        $2/libgraphic/Font.cpp \
+        $2/libgraphic/Spans.cpp \
+        $2/libgraphic/rast/Rasterizer.cpp \
+        $2/libgraphic/svg/Path.cpp \
+        $2/libgraphic/svg/SubPath.cpp \
+        userspace/libraries/libio/*.cpp \
+        meta/hosted/plugs/*.cpp \
+        -o $BUILD/$1
+
+    $BUILD/$1 > $BUILD/$1.txt
+}
+
+variant before $BUILD/baseline
+variant after userspace/libraries
+
+printf "%-12s %14s %14s %14s %14s\n" "radius (ms)" "before panel" "after panel" "before screen" "after screen"
+paste $BUILD/before.txt $BUILD/after.txt |
+    awk '{ printf "%-12s %14s %14s %14s %14s\n", $1, $2, $5, $3, $6 }'
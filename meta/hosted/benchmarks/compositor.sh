@@ -0,0 +1,36 @@
+#!/bin/bash
+# Measures how long the compositor takes to repaint a 1080p desktop while a
+# window is dragged over the others, and how many pixels it writes per
+# frame. Run from the root of the repository.
+
+set -e
+
+BUILD=$(mktemp -d)
+trap "rm -rf $BUILD" EXIT
+
+# The painter pulls <skift/Time.h> through libmath/Random.h, the rest of the
+# skift libc would shadow the one of the host.
+mkdir -p $BUILD/includes/skift
+cp userspace/libraries/libc/skift/Time.h $BUILD/includes/skift
+
+g++ -O2 -std=c++20 -msse2 \
+    -Imeta/hosted/includes \
+    -I$BUILD/includes \
+    -Iuserspace/libraries \
+    -Iuserspace/apps \
+    -D__CONFIG_IS_RELEASE__=1 \
+    -D__CONFIG_IS_HOSTED__=1 \
+    meta/hosted/benchmarks/Compositor.cpp \
+    userspace/apps/compositor/Composite.cpp \
+    userspace/libraries/libgraphic/Painter.cpp \
+    userspace/libraries/libgraphic/Font.cpp \
+    userspace/libraries/libgraphic/Blur.cpp \
+    userspace/libraries/libgraphic/rast/Rasterizer.cpp \
+    userspace/libraries/libgraphic/svg/Path.cpp \
+    userspace/libraries/libgraphic/svg/SubPath.cpp \
+    userspace/libraries/libgraphic/Spans.cpp \
+    userspace/libraries/libio/*.cpp \
+    meta/hosted/plugs/*.cpp \
+    -o $BUILD/compositor
+
+$BUILD/compositor
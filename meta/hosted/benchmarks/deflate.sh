@@ -0,0 +1,23 @@
+#!/bin/bash
+# Measures the compression ratio and speed of each Deflate level on the
+# files of the sysroot, and checks that Inflate gets them back. Run from the
+# root of the repository.
+
+set -e
+
+BUILD=$(mktemp -d)
+trap "rm -rf $BUILD" EXIT
+
+g++ -O2 -std=c++20 \
+    -Imeta/hosted/includes \
+    -Iuserspace/libraries \
+    -D__CONFIG_IS_RELEASE__=1 \
+    -D__CONFIG_IS_HOSTED__=1 \
+    meta/hosted/benchmarks/Deflate.cpp \
+    userspace/libraries/libcompression/Deflate.cpp \
+    userspace/libraries/libcompression/Inflate.cpp \
+    userspace/libraries/libio/Streams.cpp \
+    meta/hosted/plugs/*.cpp \
+    -o $BUILD/deflate
+
+$BUILD/deflate $(find sysroot -type f | sort)
@@ -0,0 +1,42 @@
+#!/bin/bash
+# Measures glyph lookups and how fast a full terminal screen of text is
+# drawn, blending the font mask or the pre-tinted glyphs, against the font
+# that scanned its glyphs and had no tints. Run from the root of the
+# repository, BASELINE can point to another revision to compare with.
+
+set -e
+
+BUILD=$(mktemp -d)
+trap "rm -rf $BUILD" EXIT
+
+BASELINE=${BASELINE:-$(git rev-list --reverse --grep='^\[user-013\]' HEAD | head -n 1)^}
+
+mkdir -p $BUILD/baseline
+git archive $BASELINE userspace/libraries/libgraphic | tar -x -C $BUILD/baseline --strip-components=2
+
+# Both trees build the same benchmark, the baseline one finds the old
+# libgraphic first.
+variant() {
+    g++ -O2 -std=c++20 -msse2 \
+        -Imeta/hosted/includes \
+        -I$2 \
+        -Iuserspace/libraries \
+        -D__CONFIG_IS_RELEASE__=1 \
+        -D__CONFIG_IS_HOSTED__=1 \
+        $3 \
+        meta/hosted/benchmarks/Glyphs.cpp \
+        $2/libgraphic/Font.cpp \
+        $2/libgraphic/Spans.cpp \
+        userspace/libraries/libio/*.cpp \
+        meta/hosted/plugs/*.cpp \
+        -o $BUILD/$1
+
+    $BUILD/$1 sysroot/files/fonts/mono.glyph > $BUILD/$1.txt
+}
+
+variant before $BUILD/baseline -DFONT_WITHOUT_TINTS
+variant after userspace/libraries
+
+printf "%-12s %12s %12s\n" "" "before" "after"
+paste $BUILD/before.txt $BUILD/after.txt |
+    awk '{ printf "%-12s %12s %12s %s\n", $1, $2, $4, $1 == "lookup" ? "ns/glyph" : "screens/s" }'
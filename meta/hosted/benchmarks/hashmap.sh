@@ -0,0 +1,19 @@
+#!/bin/bash
+# Measures HashMap insert, lookup and erase times, run from the root of the
+# repository.
+
+set -e
+
+BUILD=$(mktemp -d)
+trap "rm -rf $BUILD" EXIT
+
+g++ -O2 -std=c++20 \
+    -Imeta/hosted/includes \
+    -Iuserspace/libraries \
+    -D__CONFIG_IS_RELEASE__=1 \
+    -D__CONFIG_IS_HOSTED__=1 \
+    meta/hosted/benchmarks/HashMap.cpp \
+    meta/hosted/plugs/Assert.cpp \
+    -o $BUILD/hashmap
+
+$BUILD/hashmap
@@ -0,0 +1,54 @@
+#!/bin/bash
+# Measures Inflate throughput on the PNGs and zip files of the sysroot,
+# against the bit by bit decoder it replaced. Run from the root of the
+# repository, BASELINE can point to another revision to compare with.
+
+set -e
+
+BUILD=$(mktemp -d)
+trap "rm -rf $BUILD" EXIT
+
+INFLATE=userspace/libraries/libcompression/Inflate.cpp
+
+# The decoder was rewritten by the commit that brought the lookup tables, the
+# later ones touching the file only added to it.
+BASELINE=${BASELINE:-$(git rev-list --reverse --grep='^\[user-007\]' HEAD | head -n 1)^}
+
+FLAGS="-O2 -std=c++20 \
+    -Imeta/hosted/includes \
+    -Iuserspace/libraries \
+    -D__CONFIG_IS_RELEASE__=1 \
+    -D__CONFIG_IS_HOSTED__=1"
+
+mkdir -p $BUILD/baseline/libcompression
+
+for file in Common.h Huffman.h Inflate.h Inflate.cpp; do
+    git show $BASELINE:userspace/libraries/libcompression/$file > $BUILD/baseline/libcompression/$file
+done
+
+cat > $BUILD/baseline/Baseline.cpp <<EOF
+#include <libcompression/Inflate.h>
+
+ResultOr<size_t> baseline_inflate(IO::Reader &compressed, IO::Writer &uncompressed)
+{
+    Compression::Inflate inflate;
+    return inflate.perform(compressed, uncompressed);
+}
+EOF
+
+# The baseline lives in its own namespace, next to the current one.
+for source in Baseline.cpp libcompression/Inflate.cpp; do
+    g++ -I$BUILD/baseline $FLAGS -DCompression=BaselineCompression \
+        -c $BUILD/baseline/$source \
+        -o $BUILD/$(basename $source .cpp).baseline.o
+done
+
+g++ $FLAGS \
+    meta/hosted/benchmarks/Inflate.cpp \
+    $INFLATE \
+    userspace/libraries/libio/Streams.cpp \
+    meta/hosted/plugs/*.cpp \
+    $BUILD/*.baseline.o \
+    -o $BUILD/inflate
+
+$BUILD/inflate $(find sysroot -name '*.png' -o -name '*.zip' | sort)
@@ -0,0 +1,42 @@
+#!/bin/bash
+# Measures how fast the rasterizer fills an icon at a few sizes inside a
+# 1080p window, against the one that walked the whole clip rectangle. Run
+# from the root of the repository, BASELINE can point to another revision to
+# compare with.
+
+set -e
+
+BUILD=$(mktemp -d)
+trap "rm -rf $BUILD" EXIT
+
+BASELINE=${BASELINE:-$(git rev-list --reverse --grep='^\[user-012\]' HEAD | head -n 1)^}
+
+mkdir -p $BUILD/baseline
+git archive $BASELINE userspace/libraries/libgraphic | tar -x -C $BUILD/baseline --strip-components=2
+
+# Both trees build the same benchmark, the baseline one finds the old
+# libgraphic first.
+variant() {
+    g++ -O2 -std=c++20 -msse2 \
+        -Imeta/hosted/includes \
+        -I$2 \
+        -Iuserspace/libraries \
+        -D__CONFIG_IS_RELEASE__=1 \
+        -D__CONFIG_IS_HOSTED__=1 \
+        meta/hosted/benchmarks/Rasterizer.cpp \
+        $2/libgraphic/rast/Rasterizer.cpp \
+        $2/libgraphic/svg/Path.cpp \
+        $2/libgraphic/svg/SubPath.cpp \
+        userspace/libraries/libio/Streams.cpp \
+        meta/hosted/plugs/*.cpp \
+        -o $BUILD/$1
+
+    $BUILD/$1 > $BUILD/$1.txt
+}
+
+variant before $BUILD/baseline
+variant after userspace/libraries
+
+printf "%-12s %14s %14s %10s\n" "size" "before us/fill" "after us/fill" "speedup"
+paste $BUILD/before.txt $BUILD/after.txt |
+    awk '{ printf "%-12s %14.2f %14.2f %9.1fx\n", $1, $2, $4, $2 / $4 }'
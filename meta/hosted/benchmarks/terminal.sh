@@ -0,0 +1,43 @@
+#!/bin/bash
+# Streams text through a terminal the way the terminal application does when
+# a command prints a lot, against the terminal that shifted its whole buffer
+# on every new line. The optional arguments are the amounts in MiB for the
+# current terminal and for the baseline, which is much slower. Run from the
+# root of the repository, BASELINE can point to another revision to compare
+# with.
+
+set -e
+
+BUILD=$(mktemp -d)
+trap "rm -rf $BUILD" EXIT
+
+BASELINE=${BASELINE:-$(git rev-list --reverse --grep='^\[user-014\]' HEAD | head -n 1)^}
+
+mkdir -p $BUILD/baseline
+git archive $BASELINE userspace/libraries/libterminal | tar -x -C $BUILD/baseline --strip-components=2
+
+# Both trees build the same benchmark, the baseline one finds the old
+# libterminal first.
+variant() {
+    g++ -O2 -std=c++20 -msse2 \
+        -Imeta/hosted/includes \
+        -I$2 \
+        -Iuserspace/libraries \
+        -D__CONFIG_IS_RELEASE__=1 \
+        -D__CONFIG_IS_HOSTED__=1 \
+        meta/hosted/benchmarks/Terminal.cpp \
+        $2/libterminal/*.cpp \
+        userspace/libraries/libio/*.cpp \
+        meta/hosted/plugs/*.cpp \
+        -o $BUILD/$1
+
+    $BUILD/$1 $3 > $BUILD/$1.txt
+}
+
+variant before $BUILD/baseline ${2:-1}
+variant after userspace/libraries ${1:-10}
+
+printf "%-12s %12s %12s\n" "" "before" "after"
+paste $BUILD/before.txt $BUILD/after.txt |
+    awk 'BEGIN { unit["streamed"] = "MiB"; unit["elapsed"] = "s"; unit["throughput"] = "MiB/s" }
+         { printf "%-12s %12s %12s %s\n", $1, $2, $4, unit[$1] }'
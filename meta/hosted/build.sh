@@ -12,9 +12,7 @@ g++ \
     meta/hosted/test.cpp \
     userspace/libraries/libpng/Reader.cpp \
     userspace/libraries/libcompression/Inflate.cpp \
-    userspace/libraries/libcompression/CRC.cpp \
     userspace/libraries/libio/File.cpp \
-    userspace/libraries/libio/Format.cpp \
     userspace/libraries/libio/Streams.cpp \
     meta/hosted/plugs/*.cpp \
     -fsanitize=address \
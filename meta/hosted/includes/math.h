@@ -0,0 +1,5 @@
+#pragma once
+
+#include_next <math.h>
+
+#define PI (3.14159265358979323846264338327f)
@@ -1,10 +1,12 @@
 #include <abi/Syscalls.h>
 #include <libio/Streams.h>
 #include <libmath/MinMax.h>
+#include <libutils/HashMap.h>
 
 #include <errno.h>
 #include <fcntl.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -184,4 +186,51 @@ HjResult hj_handle_call(int handle, IOCall call, void *args)
     UNUSED(args);
 
     return ERR_NOT_IMPLEMENTED;
-}
\ No newline at end of file
+}
+
+static HashMap<uintptr_t, size_t> _mappings;
+
+HjResult hj_memory_map_handle(int handle, uintptr_t *out_address, size_t *out_size)
+{
+    struct stat sb;
+
+    if (fstat(handle, &sb) < 0)
+    {
+        return errno_to_skift_result();
+    }
+
+    // Like the kernel, an empty file maps to nothing.
+    if (sb.st_size == 0)
+    {
+        *out_address = 0;
+        *out_size = 0;
+
+        return SUCCESS;
+    }
+
+    void *address = mmap(nullptr, sb.st_size, PROT_READ, MAP_PRIVATE, handle, 0);
+
+    if (address == MAP_FAILED)
+    {
+        return errno_to_skift_result();
+    }
+
+    *out_address = reinterpret_cast<uintptr_t>(address);
+    *out_size = sb.st_size;
+    _mappings[*out_address] = sb.st_size;
+
+    return SUCCESS;
+}
+
+HjResult hj_memory_free(uintptr_t address)
+{
+    if (!_mappings.has_key(address))
+    {
+        return ERR_BAD_ADDRESS;
+    }
+
+    munmap(reinterpret_cast<void *>(address), _mappings[address]);
+    _mappings.remove_key(address);
+
+    return SUCCESS;
+}
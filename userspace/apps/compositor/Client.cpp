@@ -4,6 +4,7 @@
 
 #include "compositor/Client.h"
 #include "compositor/Cursor.h"
+#include "compositor/Frame.h"
 #include "compositor/Manager.h"
 #include "compositor/Protocol.h"
 #include "compositor/Renderer.h"
@@ -85,6 +86,8 @@ void Client::handle(const CompositorFlipWindow &flip_window)
     CompositorMessage message = {};
     message.type = COMPOSITOR_MESSAGE_ACK;
     send_message(message);
+
+    frame_notify(window);
 }
 
 void Client::handle(const CompositorCursorWindow &cursor_window)
@@ -126,6 +129,15 @@ void Client::handle_get_mouse_position()
     send_message(message);
 }
 
+void Client::handle_get_frame_stats()
+{
+    CompositorMessage message = {};
+    message.type = COMPOSITOR_MESSAGE_FRAME_STATS;
+    message.frame_stats = frame_stats();
+
+    send_message(message);
+}
+
 void Client::handle_goodbye()
 {
     _disconnected = true;
@@ -191,6 +203,10 @@ void Client::handle_request()
         handle_get_mouse_position();
         break;
 
+    case COMPOSITOR_MESSAGE_GET_FRAME_STATS:
+        handle_get_frame_stats();
+        break;
+
     case COMPOSITOR_MESSAGE_GOODBYE:
         handle_goodbye();
         break;
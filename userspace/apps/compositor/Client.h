@@ -33,6 +33,8 @@ struct Client
 
     void handle_get_mouse_position();
 
+    void handle_get_frame_stats();
+
     void handle_goodbye();
 
     void handle_request();
@@ -0,0 +1,140 @@
+#include "compositor/Composite.h"
+
+namespace compositor
+{
+
+static constexpr int CORNER_RADIUS = 6;
+
+static int layer_radius(const Layer &layer)
+{
+    if (layer.flags & WINDOW_NO_ROUNDED_CORNERS)
+    {
+        return 0;
+    }
+
+    return MIN(CORNER_RADIUS, MIN(layer.bound.width() / 2, layer.bound.height() / 2));
+}
+
+// The part of the layer that hides what is under it, the rounded corners and
+// transparent windows let the layers below show through.
+static Math::Regioni layer_opaque(const Layer &layer)
+{
+    if (layer.flags & WINDOW_TRANSPARENT)
+    {
+        return {};
+    }
+
+    int radius = layer_radius(layer);
+
+    if (radius == 0)
+    {
+        return layer.bound;
+    }
+
+    return Math::Regioni{layer.bound.cutoff_top_and_botton(radius, radius)}
+        .unite(layer.bound.cutoff_left_and_right(radius, radius));
+}
+
+static Math::Recti layer_source(const Layer &layer, Math::Recti destination)
+{
+    return {destination.position() - layer.bound.position(), destination.size()};
+}
+
+static size_t paint_layer(Graphic::Painter &painter, const Layer &layer, const Math::Regioni &visible, Graphic::Bitmap &acrylic)
+{
+    size_t written = 0;
+
+    if (layer.flags & WINDOW_TRANSPARENT)
+    {
+        for (auto &rect : visible)
+        {
+            painter.blit(*layer.bitmap, layer_source(layer, rect), rect);
+            written += rect.width() * rect.height();
+        }
+
+        return written;
+    }
+
+    bool is_acrylic = layer.flags & WINDOW_ACRYLIC;
+    auto opaque = layer_opaque(layer);
+
+    for (auto &rect : visible.intersect(opaque))
+    {
+        if (is_acrylic)
+        {
+            painter.blit_no_alpha(acrylic, rect, rect);
+            painter.blit(*layer.bitmap, layer_source(layer, rect), rect);
+            written += rect.width() * rect.height();
+        }
+        else
+        {
+            painter.blit_no_alpha(*layer.bitmap, layer_source(layer, rect), rect);
+        }
+
+        written += rect.width() * rect.height();
+    }
+
+    int radius = layer_radius(layer);
+
+    for (auto &rect : visible.subtract(opaque))
+    {
+        painter.push();
+        painter.clip(rect);
+
+        if (is_acrylic)
+        {
+            painter.blit_rounded(acrylic, layer.bound, layer.bound, radius);
+            written += rect.width() * rect.height();
+        }
+
+        painter.blit_rounded(*layer.bitmap, layer.bound.size(), layer.bound, radius);
+        written += rect.width() * rect.height();
+
+        painter.pop();
+    }
+
+    return written;
+}
+
+size_t composite(
+    Graphic::Painter &painter,
+    const Math::Regioni &damage,
+    const Vec<Layer> &layers,
+    Graphic::Bitmap &wallpaper,
+    Graphic::Bitmap &acrylic)
+{
+    Vec<Math::Regioni> visible(layers.count());
+    Math::Regioni uncovered = damage;
+
+    for (auto &layer : layers)
+    {
+        visible.push_back(uncovered.intersect(layer.bound));
+
+        if (!visible.peek_back().is_empty())
+        {
+            uncovered = uncovered.subtract(layer_opaque(layer));
+        }
+    }
+
+    size_t written = 0;
+
+    for (auto &rect : uncovered)
+    {
+        painter.blit_no_alpha(wallpaper, rect, rect);
+        written += rect.width() * rect.height();
+    }
+
+    // Back to front, so the rounded corners and the transparent windows
+    // blend over what is below them.
+    for (size_t i = layers.count(); i > 0; i--)
+    {
+        if (!visible[i - 1].is_empty())
+        {
+            written += paint_layer(painter, layers[i - 1], visible[i - 1], acrylic);
+        }
+    }
+
+    return written;
+}
+
+} // namespace compositor
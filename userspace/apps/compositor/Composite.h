@@ -0,0 +1,30 @@
+#pragma once
+
+#include <libgraphic/Painter.h>
+#include <libmath/Region.h>
+#include <libutils/Vec.h>
+
+#include "compositor/Protocol.h"
+
+namespace compositor
+{
+
+struct Layer
+{
+    Math::Recti bound;
+    WindowFlag flags;
+    Graphic::Bitmap *bitmap;
+};
+
+// Paints the damaged part of the screen from the layers, which are given from
+// front to back. The visible region of each layer is computed once, so a
+// pixel under an opaque layer is never painted, and the wallpaper only shows
+// where no layer covers it. Returns the number of pixels written.
+size_t composite(
+    Graphic::Painter &painter,
+    const Math::Regioni &damage,
+    const Vec<Layer> &layers,
+    Graphic::Bitmap &wallpaper,
+    Graphic::Bitmap &acrylic);
+
+} // namespace compositor
@@ -0,0 +1,136 @@
+#include <libasync/Timer.h>
+#include <libsystem/system/System.h>
+#include <libutils/Vec.h>
+
+#include "compositor/Client.h"
+#include "compositor/Frame.h"
+#include "compositor/Renderer.h"
+#include "compositor/Window.h"
+
+// Frames start on fixed deadlines, all the damage that comes in between two
+// of them is painted at once.
+static constexpr uint64_t FRAME_RATE = 60;
+
+static constexpr size_t FRAME_SAMPLES = 128;
+
+static OwnPtr<Async::Timer> _frame_timer;
+static Tick _epoch = 0;
+static uint64_t _last_deadline = 0;
+
+static Vec<Window *> _waiting_windows;
+
+static uint32_t _frames = 0;
+static uint32_t _dropped = 0;
+static Tick _durations[FRAME_SAMPLES] = {};
+
+static uint64_t deadline_index(Tick tick)
+{
+    return (uint64_t)(tick - _epoch) * FRAME_RATE / 1000;
+}
+
+static Tick deadline_tick(uint64_t index)
+{
+    return _epoch + (index * 1000 + FRAME_RATE - 1) / FRAME_RATE;
+}
+
+static void frame_done()
+{
+    _waiting_windows.foreach([](Window *window)
+        {
+            window->client()->send_message((CompositorMessage){
+                .type = COMPOSITOR_MESSAGE_FRAME_DONE,
+                .frame_done = {
+                    .id = window->id(),
+                },
+            });
+
+            return Iter::CONTINUE;
+        });
+
+    _waiting_windows.clear();
+}
+
+static void frame_tick()
+{
+    Tick start = system_get_ticks();
+    uint64_t deadline = deadline_index(start);
+
+    // The damage was there but the frame came too late for the deadlines in
+    // between, the first frame waits for the compositor to start up.
+    if (_frames > 0 && deadline > _last_deadline + 1 && renderer_is_dirty())
+    {
+        _dropped += deadline - _last_deadline - 1;
+    }
+
+    _last_deadline = deadline;
+
+    if (renderer_repaint_dirty())
+    {
+        _durations[_frames % FRAME_SAMPLES] = system_get_ticks() - start;
+        _frames++;
+    }
+
+    frame_done();
+    client_destroy_disconnected();
+
+    // The loop schedules the timer from the moment it fired, which is when
+    // `start` was taken.
+    _frame_timer->interval(MAX(deadline_tick(deadline + 1) - start, 1u));
+}
+
+void frame_initialize()
+{
+    _epoch = system_get_ticks();
+
+    _frame_timer = own<Async::Timer>(1000 / FRAME_RATE, frame_tick);
+    _frame_timer->start();
+}
+
+void frame_notify(Window *window)
+{
+    if (!_waiting_windows.contains(window))
+    {
+        _waiting_windows.push_back(window);
+    }
+}
+
+void frame_forget(Window *window)
+{
+    _waiting_windows.remove_all_value(window);
+}
+
+CompositorFrameStats frame_stats()
+{
+    size_t count = MIN(_frames, FRAME_SAMPLES);
+
+    CompositorFrameStats stats = {
+        .interval = 1000 / FRAME_RATE,
+        .frames = _frames,
+        .dropped = _dropped,
+        .min = 0,
+        .average = 0,
+        .p99 = 0,
+    };
+
+    if (count == 0)
+    {
+        return stats;
+    }
+
+    Vec<Tick> durations(count);
+    uint32_t total = 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        durations.push_back(_durations[i]);
+        total += _durations[i];
+    }
+
+    durations.sort([](Tick a, Tick b) { return (int)a - (int)b; });
+
+    stats.min = durations[0];
+    stats.average = total / count;
+    stats.p99 = durations[count * 99 / 100];
+
+    return stats;
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "compositor/Protocol.h"
+
+struct Window;
+
+void frame_initialize();
+
+// The window flipped, tell its client once the next frame is on screen.
+void frame_notify(Window *window);
+
+void frame_forget(Window *window);
+
+CompositorFrameStats frame_stats();
@@ -23,6 +23,10 @@ enum CompositorMessageType
 
     COMPOSITOR_MESSAGE_GET_MOUSE_POSITION,
     COMPOSITOR_MESSAGE_MOUSE_POSITION,
+
+    COMPOSITOR_MESSAGE_FRAME_DONE,
+    COMPOSITOR_MESSAGE_GET_FRAME_STATS,
+    COMPOSITOR_MESSAGE_FRAME_STATS,
 };
 
 #define WINDOW_NONE (0)
@@ -125,6 +129,24 @@ struct CompositorMousePosition
     Math::Vec2i position;
 };
 
+// Sent once the frame that shows the last flip of the window is on screen.
+struct CompositorFrameDone
+{
+    int id;
+};
+
+// The durations are in milliseconds and cover the last frames rendered.
+struct CompositorFrameStats
+{
+    uint32_t interval;
+    uint32_t frames;
+    uint32_t dropped;
+
+    uint32_t min;
+    uint32_t average;
+    uint32_t p99;
+};
+
 struct CompositorMessage
 {
     CompositorMessageType type;
@@ -143,5 +165,8 @@ struct CompositorMessage
         CompositorChangedResolution changed_resolution;
 
         CompositorMousePosition mouse_position;
+
+        CompositorFrameDone frame_done;
+        CompositorFrameStats frame_stats;
     };
 };
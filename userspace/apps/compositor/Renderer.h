@@ -9,7 +9,10 @@ Math::Recti renderer_bound();
 
 void renderer_region_dirty(Math::Recti region);
 
-void renderer_repaint_dirty();
+bool renderer_is_dirty();
+
+// Returns false if there was nothing to repaint.
+bool renderer_repaint_dirty();
 
 bool renderer_set_resolution(int width, int height);
 
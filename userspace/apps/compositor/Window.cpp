@@ -1,6 +1,7 @@
 #include <libio/Streams.h>
 
 #include "compositor/Client.h"
+#include "compositor/Frame.h"
 #include "compositor/Manager.h"
 #include "compositor/Protocol.h"
 #include "compositor/Renderer.h"
@@ -27,6 +28,7 @@ Window::Window(
 
 Window::~Window()
 {
+    frame_forget(this);
     manager_unregister_window(this);
 }
 
@@ -3,7 +3,6 @@
 
 #include <libasync/Loop.h>
 #include <libasync/Notifier.h>
-#include <libasync/Timer.h>
 #include <libio/Connection.h>
 #include <libio/File.h>
 #include <libio/Socket.h>
@@ -14,6 +13,7 @@
 
 #include "compositor/Client.h"
 #include "compositor/Cursor.h"
+#include "compositor/Frame.h"
 #include "compositor/Manager.h"
 #include "compositor/Renderer.h"
 #include "compositor/Window.h"
@@ -124,16 +124,10 @@ int main(int argc, char const *argv[])
         client_destroy_disconnected();
     });
 
-    auto repaint_timer = own<Async::Timer>(1000 / 60, []() {
-        renderer_repaint_dirty();
-        client_destroy_disconnected();
-    });
-
-    repaint_timer->start();
-
     manager_initialize();
     cursor_initialize();
     renderer_initialize();
+    frame_initialize();
 
     return Async::Loop::the()->run();
 }
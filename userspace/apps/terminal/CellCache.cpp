@@ -0,0 +1,54 @@
+#include <libgraphic/Painter.h>
+
+#include "terminal/CellCache.h"
+
+CellCache::CellCache(Math::Vec2i cell_size, int baseline)
+    : _cell_size{cell_size},
+      _baseline{baseline},
+      _atlas{Graphic::Bitmap::create_shared(cell_size.x() * COLUMNS, cell_size.y() * ROWS).unwrap()}
+{
+}
+
+Math::Recti CellCache::get(RefPtr<Graphic::Font> font, Text::Rune rune, Graphic::Color color, bool bold)
+{
+    if (font != _font)
+    {
+        _font = font;
+        _cells.clear();
+    }
+
+    uint64_t key = ((uint64_t)rune << 33) |
+                   ((uint64_t)bold << 32) |
+                   ((uint64_t)color.red() << 24) |
+                   ((uint64_t)color.green() << 16) |
+                   ((uint64_t)color.blue() << 8) |
+                   color.alpha();
+
+    if (_cells.has_key(key))
+    {
+        return cell_bound(_cells[key]);
+    }
+
+    if (_cells.count() == COLUMNS * ROWS)
+    {
+        _cells.clear();
+    }
+
+    int new_index = _cells.count();
+    auto bound = cell_bound(new_index);
+    auto &glyph = font->glyph(rune);
+
+    Graphic::Painter painter{*_atlas};
+    painter.clip(bound);
+    painter.clear(bound, Graphic::Colors::BLACK.with_alpha_byte(0));
+    painter.draw_glyph(*font, glyph, bound.position() + Math::Vec2i(0, _baseline), color);
+
+    if (bold)
+    {
+        painter.draw_glyph(*font, glyph, bound.position() + Math::Vec2i(1, _baseline), color);
+    }
+
+    _cells[key] = new_index;
+
+    return bound;
+}
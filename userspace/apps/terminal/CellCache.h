@@ -0,0 +1,35 @@
+#pragma once
+
+#include <libgraphic/Bitmap.h>
+#include <libgraphic/Font.h>
+#include <libutils/HashMap.h>
+
+// Cells already drawn with their glyph in its color, twice for bold ones, so
+// painting a cell is a single blit. The background is left transparent, runs
+// of cells share it. The cells live in an atlas which starts over once full.
+struct CellCache
+{
+private:
+    static constexpr int COLUMNS = 32;
+    static constexpr int ROWS = 16;
+
+    Math::Vec2i _cell_size;
+    int _baseline;
+
+    RefPtr<Graphic::Font> _font;
+    RefPtr<Graphic::Bitmap> _atlas;
+    HashMap<uint64_t, int> _cells;
+
+    Math::Recti cell_bound(int index)
+    {
+        return {Math::Vec2i{index % COLUMNS, index / COLUMNS} * _cell_size, _cell_size};
+    }
+
+public:
+    Graphic::Bitmap &atlas() { return *_atlas; }
+
+    CellCache(Math::Vec2i cell_size, int baseline);
+
+    // Returns where the cell is in the atlas.
+    Math::Recti get(RefPtr<Graphic::Font> font, Text::Rune rune, Graphic::Color color, bool bold);
+};
@@ -117,21 +117,87 @@ void TerminalView::paint_cell(
     }
 }
 
-void TerminalView::paint(Graphic::Painter &painter, const Math::Recti &dirty)
+void TerminalView::paint_run(Graphic::Painter &painter, int from, int to, int row, int line, Terminal::Attrs attributes)
 {
-    painter.push();
-    painter.transform({0, -_scroll_offset});
+    auto foreground = attributes.foreground;
+    auto background = attributes.background;
+
+    if (attributes.invert)
+    {
+        std::swap(foreground, background);
+    }
+
+    Math::Recti bound{
+        cell_bound(from, row).position(),
+        Math::Vec2i{(to - from) * cell_size().x(), cell_size().y()},
+    };
+
+    if (background != Terminal::BACKGROUND)
+    {
+        painter.clear(bound, cell_color(background));
+    }
+
+    auto color = cell_color(foreground);
+
+    if (attributes.underline)
+    {
+        painter.draw_line(
+            bound.position() + Math::Vec2i(0, 14),
+            bound.position() + Math::Vec2i(bound.width(), 14),
+            color);
+    }
+
+    for (int x = from; x < to; x++)
+    {
+        auto rune = _terminal->surface().at(x, line).rune;
+
+        if (rune != U' ')
+        {
+            painter.blit(_cells.atlas(), _cells.get(font(), rune, color, attributes.bold), cell_bound(x, row));
+        }
+    }
+}
+
+void TerminalView::paint_row(Graphic::Painter &painter, int row, int line)
+{
+    auto &surface = _terminal->surface();
+
+    int from = 0;
 
-    for (int y = 0; y < _terminal->height(); y++)
+    while (from < _terminal->width())
     {
-        for (int x = 0; x < _terminal->width(); x++)
+        auto attributes = surface.at(from, line).attributes;
+
+        int to = from + 1;
+
+        while (to < _terminal->width() && surface.at(to, line).attributes == attributes)
         {
-            Terminal::Cell cell = _terminal->surface().at(x, y + _scroll_offset / cell_size().y());
-            paint_cell(painter, x, y + _scroll_offset / cell_size().y(), cell);
-            _terminal->surface().undirty(x, y);
+            to++;
         }
+
+        paint_run(painter, from, to, row, line, attributes);
+
+        from = to;
     }
 
+    // Scrolled back, the row on screen isn't the line of the surface.
+    surface.undirty(line);
+}
+
+void TerminalView::paint(Graphic::Painter &painter, const Math::Recti &dirty)
+{
+    int scroll = _scroll_offset / cell_size().y();
+    int from = MAX(dirty.top() / cell_size().y(), 0);
+    int to = MIN((dirty.bottom() + cell_size().y() - 1) / cell_size().y(), _terminal->height());
+
+    for (int row = from; row < to; row++)
+    {
+        paint_row(painter, row, row + scroll);
+    }
+
+    painter.push();
+    painter.transform({0, -_scroll_offset});
+
     int cx = _terminal->cursor().x;
     int cy = _terminal->cursor().y - _scroll_offset / cell_size().y();
 
@@ -320,6 +386,39 @@ void TerminalView::handle_read()
         return;
     }
 
+    int old_cursor = _terminal->cursor().y;
+
     _terminal->write(buffer, read_result.unwrap());
-    should_repaint();
+
+    if (_scroll_offset != 0)
+    {
+        should_repaint();
+        return;
+    }
+
+    // The cursor is painted over the cells, the row it leaves has to be
+    // painted again too.
+    auto &surface = _terminal->surface();
+    surface.should_repaint(old_cursor, old_cursor);
+    surface.should_repaint(_terminal->cursor().y, _terminal->cursor().y);
+
+    for (int row = 0; row < _terminal->height(); row++)
+    {
+        if (!surface.dirty(row))
+        {
+            continue;
+        }
+
+        int from = row;
+
+        while (row + 1 < _terminal->height() && surface.dirty(row + 1))
+        {
+            row++;
+        }
+
+        should_repaint({
+            cell_bound(0, from).position(),
+            Math::Vec2i{_terminal->width(), row - from + 1} * cell_size(),
+        });
+    }
 }
\ No newline at end of file
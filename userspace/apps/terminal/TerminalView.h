@@ -7,6 +7,8 @@
 #include <libterminal/Terminal.h>
 #include <libwidget/Element.h>
 
+#include "terminal/CellCache.h"
+
 struct TerminalView : public Widget::Element
 {
 private:
@@ -14,6 +16,8 @@ private:
     bool _cursor_blink;
     int _scroll_offset = 0;
 
+    CellCache _cells{cell_size(), 13};
+
     IO::Terminal _terminal_device;
 
     OwnPtr<Async::Timer> _cursor_blink_timer;
@@ -55,6 +59,10 @@ public:
         paint_cell(painter, x, y, cell.rune, cell.attributes.foreground, cell.attributes.background, cell.attributes);
     }
 
+    void paint_run(Graphic::Painter &painter, int from, int to, int row, int line, Terminal::Attrs attributes);
+
+    void paint_row(Graphic::Painter &painter, int row, int line);
+
     void paint(Graphic::Painter &, const Math::Recti &) override;
 
     void event(Widget::Event *event) override;
@@ -14,16 +14,26 @@ struct IOCallDisplayModeArgs
     int height;
 };
 
-struct IOCallDisplayBlitArgs
+struct IOCallDisplayRect
 {
-    uint32_t *buffer;
+    int x;
+    int y;
+    int width;
+    int height;
+};
+
+// Copies the damaged parts of the buffer to the screen, the buffer is in the
+// same RGBA format as Graphic::Color.
+#define IOCALL_DISPLAY_PRESENT_MAX_DAMAGES (256)
+
+struct IOCallDisplayPresentArgs
+{
+    const uint32_t *buffer;
     int buffer_width;
     int buffer_height;
 
-    int blit_x;
-    int blit_y;
-    int blit_width;
-    int blit_height;
+    const IOCallDisplayRect *damages;
+    size_t damages_count;
 };
 
 struct IOCallKeyboardSetKeymapArgs
@@ -52,7 +62,7 @@ enum IOCall
 
     IOCALL_DISPLAY_GET_MODE,
     IOCALL_DISPLAY_SET_MODE,
-    IOCALL_DISPLAY_BLIT,
+    IOCALL_DISPLAY_PRESENT,
 
     IOCALL_KEYBOARD_SET_KEYMAP,
     IOCALL_KEYBOARD_GET_KEYMAP,
@@ -3,4 +3,6 @@
 #define MEMORY_NONE (0)
 #define MEMORY_USER (1 << 0)
 #define MEMORY_CLEAR (1 << 1)
+#define MEMORY_READONLY (1 << 2)
+#define MEMORY_SHARED (1 << 3)
 typedef unsigned int MemoryFlags;
\ No newline at end of file
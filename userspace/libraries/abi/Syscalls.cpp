@@ -56,9 +56,9 @@ HjResult hj_process_wait(int tid, int *user_exit_value)
     return __syscall(HJ_PROCESS_WAIT, (uintptr_t)tid, (uintptr_t)user_exit_value);
 }
 
-HjResult hj_memory_alloc(size_t size, uintptr_t *out_address)
+HjResult hj_memory_alloc(size_t size, int flags, uintptr_t *out_address)
 {
-    return __syscall(HJ_MEMORY_ALLOC, (uintptr_t)size, (uintptr_t)out_address);
+    return __syscall(HJ_MEMORY_ALLOC, (uintptr_t)size, flags, (uintptr_t)out_address);
 }
 
 HjResult hj_memory_map(uintptr_t address, size_t size, int flags)
@@ -81,6 +81,11 @@ HjResult hj_memory_get_handle(uintptr_t address, int *out_handle)
     return __syscall(HJ_MEMORY_GET_HANDLE, address, (uintptr_t)out_handle);
 }
 
+HjResult hj_memory_map_handle(int handle, uintptr_t *out_address, size_t *out_size)
+{
+    return __syscall(HJ_MEMORY_MAP_HANDLE, (uintptr_t)handle, (uintptr_t)out_address, (uintptr_t)out_size);
+}
+
 HjResult hj_filesystem_mkdir(const char *raw_path, size_t size)
 {
     return __syscall(HJ_FILESYSTEM_MKDIR, (uintptr_t)raw_path, (uintptr_t)size);
@@ -149,9 +154,9 @@ HjResult hj_system_shutdown()
     return __syscall(HJ_SYSTEM_SHUTDOWN);
 }
 
-HjResult hj_create_pipe(int *reader_handle, int *writer_handle)
+HjResult hj_create_pipe(int *reader_handle, int *writer_handle, size_t capacity)
 {
-    return __syscall(HJ_CREATE_PIPE, (uintptr_t)reader_handle, (uintptr_t)writer_handle);
+    return __syscall(HJ_CREATE_PIPE, (uintptr_t)reader_handle, (uintptr_t)writer_handle, capacity);
 }
 
 HjResult hj_create_term(int *server_handle, int *client_handle)
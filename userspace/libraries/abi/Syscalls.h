@@ -8,6 +8,7 @@
 #include <abi/Handle.h>
 #include <abi/IOCall.h>
 #include <abi/Launchpad.h>
+#include <abi/Memory.h>
 #include <abi/System.h>
 
 #define SYSCALL_LIST(__ENTRY)     \
@@ -25,6 +26,7 @@
     __ENTRY(HJ_MEMORY_FREE)       \
     __ENTRY(HJ_MEMORY_INCLUDE)    \
     __ENTRY(HJ_MEMORY_GET_HANDLE) \
+    __ENTRY(HJ_MEMORY_MAP_HANDLE) \
     __ENTRY(HJ_FILESYSTEM_LINK)   \
     __ENTRY(HJ_FILESYSTEM_UNLINK) \
     __ENTRY(HJ_FILESYSTEM_RENAME) \
@@ -121,11 +123,12 @@ HjResult hj_process_cancel(int pid);
 HjResult hj_process_sleep(int time);
 HjResult hj_process_wait(int tid, int *user_exit_value);
 
-HjResult hj_memory_alloc(size_t size, uintptr_t *out_address);
+HjResult hj_memory_alloc(size_t size, int flags, uintptr_t *out_address);
 HjResult hj_memory_map(uintptr_t address, size_t size, int flags);
 HjResult hj_memory_free(uintptr_t address);
 HjResult hj_memory_include(int handle, uintptr_t *out_address, size_t *out_size);
 HjResult hj_memory_get_handle(uintptr_t address, int *out_handle);
+HjResult hj_memory_map_handle(int handle, uintptr_t *out_address, size_t *out_size);
 
 HjResult hj_filesystem_mkdir(const char *raw_path, size_t size);
 HjResult hj_filesystem_mkpipe(const char *raw_path, size_t size);
@@ -140,7 +143,7 @@ HjResult hj_system_tick(uint32_t *tick);
 HjResult hj_system_reboot();
 HjResult hj_system_shutdown();
 
-HjResult hj_create_pipe(int *reader_handle, int *writer_handle);
+HjResult hj_create_pipe(int *reader_handle, int *writer_handle, size_t capacity);
 HjResult hj_create_term(int *server_handle, int *client_handle);
 
 HjResult hj_handle_open(int *handle, const char *raw_path, size_t size, HjOpenFlag flags);
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <libutils/Prelude.h>
+
+// Allocations up to 2048 bytes are served from per-size-class slabs, larger
+// ones from the general purpose major blocks.
+
+#define ALLOCATOR_SIZE_CLASS_COUNT 14
+
+struct AllocatorSizeClassStats
+{
+    // Size of the objects in this class.
+    size_t size;
+
+    // Number of slabs owned by the class.
+    size_t slabs;
+
+    // Number of objects currently allocated.
+    size_t objects;
+
+    // Number of objects that fit in the slabs of the class.
+    size_t capacity;
+};
+
+struct AllocatorStats
+{
+    AllocatorSizeClassStats classes[ALLOCATOR_SIZE_CLASS_COUNT];
+
+    // Slabs kept around for any size class to pick up.
+    size_t empty_slabs;
+
+    // Bytes held by slabs, including the empty ones.
+    size_t slab_bytes;
+
+    // Allocations living in major blocks, and the bytes they cover.
+    size_t large_allocations;
+    size_t large_bytes;
+
+    // Bytes held by major blocks.
+    size_t major_bytes;
+
+    // Everything obtained from the system, bookkeeping included.
+    size_t mapped_bytes;
+
+    // Everything handed out to callers.
+    size_t used_bytes;
+
+    // Percentage of the mapped bytes not handed out.
+    int fragmentation;
+};
+
+void allocator_stats(AllocatorStats *stats);
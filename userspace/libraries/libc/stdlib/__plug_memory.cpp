@@ -20,7 +20,7 @@ void __plug_memory_unlock()
 void *__plug_memory_alloc(size_t size)
 {
     uintptr_t address = 0;
-    assert(hj_memory_alloc(size, &address) == HjResult::SUCCESS);
+    assert(hj_memory_alloc(size, MEMORY_NONE, &address) == HjResult::SUCCESS);
     return (void *)address;
 }
 
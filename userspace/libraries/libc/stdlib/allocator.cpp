@@ -1,5 +1,6 @@
 #include <abi/Syscalls.h>
 #include <assert.h>
+#include <skift/Allocator.h>
 #include <skift/Plugs.h>
 #include <stdlib.h>
 #include <string.h>
@@ -76,6 +77,412 @@ static constexpr size_t _page_size = 4096;
 // The number of pages to request per chunk. Set up in liballoc_init.
 static constexpr size_t _page_count = 16;
 
+/* --- Slabs ---------------------------------------------------------------- */
+
+// Small allocations come from slabs, 16KiB chunks split into objects of one
+// size class. Objects don't carry a header: the slab is found from the page
+// the object lives in. Slabs are mapped four at a time, and such an arena is
+// given back to the system once all of its slabs are empty.
+
+#ifndef ALLOCATOR_SLABS
+#    define ALLOCATOR_SLABS 1
+#endif
+
+static constexpr size_t SLAB_CLASS_SIZES[ALLOCATOR_SIZE_CLASS_COUNT] = {
+    16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048};
+
+static constexpr size_t SLAB_LARGEST_CLASS = SLAB_CLASS_SIZES[ALLOCATOR_SIZE_CLASS_COUNT - 1];
+
+static constexpr size_t SLAB_SIZE = 4 * _page_size;
+static constexpr size_t SLAB_ARENA_SLABS = 4;
+static constexpr size_t SLAB_ARENA_SIZE = SLAB_ARENA_SLABS * SLAB_SIZE;
+
+struct Slab
+{
+    // Linked list information. A slab is in the partial list of its class,
+    // in the empty list, or in no list at all when it's full.
+    Slab *prev;
+    Slab *next;
+
+    // The first slab of the arena this one was carved from.
+    Slab *arena;
+
+    // Objects that were freed, and the first one never allocated so far.
+    void *free_objects;
+    uintptr_t fresh;
+
+    uint32_t size_class;
+    uint32_t used;
+    uint32_t capacity;
+
+    // The number of empty slabs in the arena, only kept on its first slab.
+    uint32_t arena_empty;
+};
+
+#define SLAB_HEADER_SIZE (ALIGN_UP(sizeof(Slab), 16))
+
+static constexpr size_t slab_capacity(size_t size_class)
+{
+    return (SLAB_SIZE - SLAB_HEADER_SIZE) / SLAB_CLASS_SIZES[size_class];
+}
+
+#if ALLOCATOR_SLABS
+
+struct SlabClassTable
+{
+    uint8_t classes[SLAB_LARGEST_CLASS / 16 + 1];
+};
+
+static constexpr SlabClassTable slab_class_table()
+{
+    SlabClassTable table{};
+    size_t size_class = 0;
+
+    for (size_t i = 0; i < ARRAY_LENGTH(table.classes); i++)
+    {
+        while (SLAB_CLASS_SIZES[size_class] < i * 16)
+        {
+            size_class++;
+        }
+
+        table.classes[i] = size_class;
+    }
+
+    return table;
+}
+
+// The smallest size class that fits ALIGN_UP(size, 16), indexed by size / 16.
+static constexpr SlabClassTable SLAB_CLASS_TABLE = slab_class_table();
+
+#endif
+
+struct SlabClass
+{
+    // Slabs with at least one free object.
+    Slab *partial;
+
+    size_t slabs;
+    size_t objects;
+};
+
+static SlabClass _slab_classes[ALLOCATOR_SIZE_CLASS_COUNT] = {};
+
+static Slab *_empty_slabs = nullptr;
+static size_t _empty_slabs_count = 0;
+static size_t _slab_arenas_count = 0;
+
+// Open addressing table from the address of each page of a slab to its slab.
+struct SlabPage
+{
+    uintptr_t page;
+    Slab *slab;
+};
+
+static SlabPage *_slab_pages = nullptr;
+static size_t _slab_pages_capacity = 0;
+static size_t _slab_pages_count = 0;
+
+#if ALLOCATOR_SLABS
+
+static void slab_list_push(Slab **list, Slab *slab)
+{
+    slab->prev = nullptr;
+    slab->next = *list;
+
+    if (*list != nullptr)
+    {
+        (*list)->prev = slab;
+    }
+
+    *list = slab;
+}
+
+static void slab_list_remove(Slab **list, Slab *slab)
+{
+    if (slab->prev != nullptr)
+    {
+        slab->prev->next = slab->next;
+    }
+    else
+    {
+        *list = slab->next;
+    }
+
+    if (slab->next != nullptr)
+    {
+        slab->next->prev = slab->prev;
+    }
+
+    slab->prev = nullptr;
+    slab->next = nullptr;
+}
+
+static size_t slab_page_slot(uintptr_t page)
+{
+    return ((uint32_t)(page / _page_size) * 2654435761u) & (_slab_pages_capacity - 1);
+}
+
+static Slab *slab_page_lookup(uintptr_t page)
+{
+    if (_slab_pages == nullptr)
+    {
+        return nullptr;
+    }
+
+    for (size_t i = slab_page_slot(page);; i = (i + 1) & (_slab_pages_capacity - 1))
+    {
+        if (_slab_pages[i].page == page)
+        {
+            return _slab_pages[i].slab;
+        }
+
+        if (_slab_pages[i].page == 0)
+        {
+            return nullptr;
+        }
+    }
+}
+
+static void slab_page_insert(uintptr_t page, Slab *slab)
+{
+    size_t i = slab_page_slot(page);
+
+    while (_slab_pages[i].page != 0)
+    {
+        i = (i + 1) & (_slab_pages_capacity - 1);
+    }
+
+    _slab_pages[i] = {page, slab};
+    _slab_pages_count++;
+}
+
+static void slab_page_remove(uintptr_t page)
+{
+    size_t mask = _slab_pages_capacity - 1;
+    size_t hole = slab_page_slot(page);
+
+    while (_slab_pages[hole].page != page)
+    {
+        hole = (hole + 1) & mask;
+    }
+
+    // Backward shift deletion: pull the entries that follow into the hole,
+    // unless that would move them in front of their home slot.
+    for (size_t i = (hole + 1) & mask; _slab_pages[i].page != 0; i = (i + 1) & mask)
+    {
+        size_t home = slab_page_slot(_slab_pages[i].page);
+
+        if (((i - home) & mask) >= ((i - hole) & mask))
+        {
+            _slab_pages[hole] = _slab_pages[i];
+            hole = i;
+        }
+    }
+
+    _slab_pages[hole] = {};
+    _slab_pages_count--;
+}
+
+static bool slab_pages_grow()
+{
+    SlabPage *old_pages = _slab_pages;
+    size_t old_capacity = _slab_pages_capacity;
+
+    size_t capacity = MAX(old_capacity * 2, _page_size / sizeof(SlabPage));
+    SlabPage *pages = (SlabPage *)__plug_memory_alloc(capacity * sizeof(SlabPage));
+
+    if (pages == nullptr)
+    {
+        return false;
+    }
+
+    memset(pages, 0, capacity * sizeof(SlabPage));
+
+    _slab_pages = pages;
+    _slab_pages_capacity = capacity;
+    _slab_pages_count = 0;
+
+    for (size_t i = 0; i < old_capacity; i++)
+    {
+        if (old_pages[i].page != 0)
+        {
+            slab_page_insert(old_pages[i].page, old_pages[i].slab);
+        }
+    }
+
+    if (old_pages != nullptr)
+    {
+        __plug_memory_free(old_pages, old_capacity * sizeof(SlabPage));
+    }
+
+    return true;
+}
+
+static bool slab_arena_create()
+{
+    // Keep the page table at most half full.
+    while ((_slab_pages_count + SLAB_ARENA_SIZE / _page_size) * 2 > _slab_pages_capacity)
+    {
+        if (!slab_pages_grow())
+        {
+            return false;
+        }
+    }
+
+    Slab *arena = (Slab *)__plug_memory_alloc(SLAB_ARENA_SIZE);
+
+    if (arena == nullptr)
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < SLAB_ARENA_SLABS; i++)
+    {
+        Slab *slab = (Slab *)((uintptr_t)arena + i * SLAB_SIZE);
+        slab->arena = arena;
+        slab_list_push(&_empty_slabs, slab);
+
+        for (size_t offset = 0; offset < SLAB_SIZE; offset += _page_size)
+        {
+            slab_page_insert((uintptr_t)slab + offset, slab);
+        }
+    }
+
+    arena->arena_empty = SLAB_ARENA_SLABS;
+    _empty_slabs_count += SLAB_ARENA_SLABS;
+    _slab_arenas_count++;
+
+    return true;
+}
+
+static void slab_arena_destroy(Slab *arena)
+{
+    for (size_t i = 0; i < SLAB_ARENA_SLABS; i++)
+    {
+        Slab *slab = (Slab *)((uintptr_t)arena + i * SLAB_SIZE);
+        slab_list_remove(&_empty_slabs, slab);
+
+        for (size_t offset = 0; offset < SLAB_SIZE; offset += _page_size)
+        {
+            slab_page_remove((uintptr_t)slab + offset);
+        }
+    }
+
+    _empty_slabs_count -= SLAB_ARENA_SLABS;
+    _slab_arenas_count--;
+
+    __plug_memory_free(arena, SLAB_ARENA_SIZE);
+}
+
+static Slab *slab_create(size_t size_class)
+{
+    if (_empty_slabs == nullptr && !slab_arena_create())
+    {
+        return nullptr;
+    }
+
+    Slab *slab = _empty_slabs;
+    slab_list_remove(&_empty_slabs, slab);
+    _empty_slabs_count--;
+    slab->arena->arena_empty--;
+
+    slab->free_objects = nullptr;
+    slab->fresh = (uintptr_t)slab + SLAB_HEADER_SIZE;
+    slab->size_class = size_class;
+    slab->used = 0;
+    slab->capacity = slab_capacity(size_class);
+
+    return slab;
+}
+
+static void slab_destroy(Slab *slab)
+{
+    slab_list_push(&_empty_slabs, slab);
+    _empty_slabs_count++;
+
+    Slab *arena = slab->arena;
+    arena->arena_empty++;
+
+    // Keep an arena worth of empty slabs around, so an allocation pattern
+    // going back and forth over a slab boundary doesn't map and unmap memory
+    // every time.
+    if (arena->arena_empty == SLAB_ARENA_SLABS &&
+        _empty_slabs_count > SLAB_ARENA_SLABS)
+    {
+        slab_arena_destroy(arena);
+    }
+}
+
+static void *slab_alloc(size_t size)
+{
+    size_t size_class = SLAB_CLASS_TABLE.classes[ALIGN_UP(size, 16) / 16];
+    SlabClass &klass = _slab_classes[size_class];
+
+    Slab *slab = klass.partial;
+
+    if (slab == nullptr)
+    {
+        slab = slab_create(size_class);
+
+        if (slab == nullptr)
+        {
+            return nullptr;
+        }
+
+        slab_list_push(&klass.partial, slab);
+        klass.slabs++;
+    }
+
+    void *object = slab->free_objects;
+
+    if (object != nullptr)
+    {
+        slab->free_objects = *(void **)object;
+    }
+    else
+    {
+        object = (void *)slab->fresh;
+        slab->fresh += SLAB_CLASS_SIZES[size_class];
+    }
+
+    slab->used++;
+    klass.objects++;
+
+    if (slab->used == slab->capacity)
+    {
+        slab_list_remove(&klass.partial, slab);
+    }
+
+    return object;
+}
+
+static void slab_free(Slab *slab, void *object)
+{
+    SlabClass &klass = _slab_classes[slab->size_class];
+
+    if (slab->used == slab->capacity)
+    {
+        slab_list_push(&klass.partial, slab);
+    }
+
+    *(void **)object = slab->free_objects;
+    slab->free_objects = object;
+
+    slab->used--;
+    klass.objects--;
+
+    if (slab->used == 0)
+    {
+        slab_list_remove(&klass.partial, slab);
+        klass.slabs--;
+        slab_destroy(slab);
+    }
+}
+
+#endif
+
+/* --- Major blocks --------------------------------------------------------- */
+
 static MajorBlock *heap_major_block_create(size_t size)
 {
     // This is how much space is required.
@@ -112,7 +519,7 @@ static MajorBlock *heap_major_block_create(size_t size)
     return maj;
 }
 
-bool check_minor_magic(MinorBlock *min, void *ptr, void *caller)
+static bool check_minor_magic(MinorBlock *min, void *ptr, void *caller)
 {
     if (min->magic == LIBALLOC_MAGIC)
     {
@@ -150,6 +557,17 @@ bool check_minor_magic(MinorBlock *min, void *ptr, void *caller)
 
 void *malloc(size_t req_size)
 {
+#if ALLOCATOR_SLABS
+    if (req_size <= SLAB_LARGEST_CLASS)
+    {
+        __plug_memory_lock();
+        void *p = slab_alloc(req_size);
+        __plug_memory_unlock();
+
+        return p;
+    }
+#endif
+
     req_size = ALIGN_UP(req_size, 16);
 
     unsigned long long bestSize = 0;
@@ -397,6 +815,17 @@ void free(void *ptr)
 
     __plug_memory_lock();
 
+#if ALLOCATOR_SLABS
+    Slab *slab = slab_page_lookup(ALIGN_DOWN((uintptr_t)ptr, _page_size));
+
+    if (slab != nullptr)
+    {
+        slab_free(slab, ptr);
+        __plug_memory_unlock();
+        return;
+    }
+#endif
+
     MinorBlock *min = (MinorBlock *)((uintptr_t)ptr - MINOR_BLOCK_HEADER_SIZE);
 
     if (!check_minor_magic(min, ptr, __builtin_return_address(0)))
@@ -504,6 +933,27 @@ void *realloc(void *ptr, size_t size)
 
     __plug_memory_lock();
 
+#if ALLOCATOR_SLABS
+    Slab *slab = slab_page_lookup(ALIGN_DOWN((uintptr_t)ptr, _page_size));
+
+    if (slab != nullptr)
+    {
+        size_t slab_size = SLAB_CLASS_SIZES[slab->size_class];
+        __plug_memory_unlock();
+
+        if (slab_size >= size)
+        {
+            return ptr;
+        }
+
+        void *new_ptr = malloc(size);
+        memcpy(new_ptr, ptr, slab_size);
+        free(ptr);
+
+        return new_ptr;
+    }
+#endif
+
     MinorBlock *min = (MinorBlock *)((uintptr_t)ptr - MINOR_BLOCK_HEADER_SIZE);
 
     if (!check_minor_magic(min, ptr, __builtin_return_address(0)))
@@ -527,3 +977,49 @@ void *realloc(void *ptr, size_t size)
 
     return new_ptr;
 }
+
+void allocator_stats(AllocatorStats *stats)
+{
+    *stats = {};
+
+    __plug_memory_lock();
+
+    for (size_t i = 0; i < ALLOCATOR_SIZE_CLASS_COUNT; i++)
+    {
+        auto &klass = stats->classes[i];
+
+        klass.size = SLAB_CLASS_SIZES[i];
+        klass.slabs = _slab_classes[i].slabs;
+        klass.objects = _slab_classes[i].objects;
+        klass.capacity = klass.slabs * slab_capacity(i);
+
+        stats->used_bytes += klass.objects * klass.size;
+    }
+
+    stats->empty_slabs = _empty_slabs_count;
+    stats->slab_bytes = _slab_arenas_count * SLAB_ARENA_SIZE;
+
+    for (MajorBlock *maj = _heap_root; maj != nullptr; maj = maj->next)
+    {
+        stats->major_bytes += maj->size;
+
+        for (MinorBlock *min = maj->first; min != nullptr; min = min->next)
+        {
+            stats->large_allocations++;
+            stats->large_bytes += min->size;
+        }
+    }
+
+    stats->used_bytes += stats->large_bytes;
+
+    stats->mapped_bytes = stats->slab_bytes +
+                          stats->major_bytes +
+                          _slab_pages_capacity * sizeof(SlabPage);
+
+    __plug_memory_unlock();
+
+    if (stats->mapped_bytes > 0)
+    {
+        stats->fragmentation = 100 - stats->used_bytes * 100 / stats->mapped_bytes;
+    }
+}
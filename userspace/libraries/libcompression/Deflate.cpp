@@ -1,18 +1,928 @@
+#include <string.h>
+
 #include <libcompression/Common.h>
 #include <libcompression/Deflate.h>
-#include <libcompression/Huffman.h>
-#include <libio/BufReader.h>
-#include <libutils/Array.h>
+#include <libmath/MinMax.h>
+#include <libutils/Vec.h>
+
 namespace Compression
 {
 
-Deflate::Deflate(unsigned int compression_level) : _compression_level(compression_level)
+static constexpr size_t LIT_LEN_CODES = 286;
+static constexpr size_t FIXED_LIT_LEN_CODES = 288;
+static constexpr size_t DIST_CODES = 30;
+static constexpr size_t CODE_LENGTH_CODES = 19;
+static constexpr int MAX_CODE_LENGTH_LENGTH = 7;
+static constexpr unsigned int END_OF_BLOCK = 256;
+
+static constexpr size_t MAX_STORED_LENGTH = 65535;
+
+// Matches are only searched with this much input ahead, until the end.
+static constexpr size_t MIN_LOOKAHEAD = MAX_MATCH_LENGTH + MIN_MATCH_LENGTH + 1;
+static constexpr size_t MAX_DISTANCE = WINDOW_SIZE - MIN_LOOKAHEAD;
+
+// A three byte match further away than this costs more than the literals.
+static constexpr size_t TOO_FAR = 4096;
+
+static constexpr int HASH_BITS = 15;
+static constexpr size_t HASH_SIZE = 1 << HASH_BITS;
+
+// Position zero is never matched against, it's the end of every chain.
+static constexpr uint16_t NIL = 0;
+
+static constexpr size_t SYMBOL_BUFFER_SIZE = 16384;
+
+struct Level
+{
+    // Search less once a match is at least this long.
+    uint16_t good_length;
+
+    // Don't look for a better match past this length. For the greedy levels,
+    // longer matches don't get their strings in the hash table.
+    uint16_t lazy_length;
+
+    // Stop searching at this length.
+    uint16_t nice_length;
+
+    uint16_t max_chain;
+
+    bool lazy;
+};
+
+// Same trade-offs as zlib.
+static constexpr Level LEVELS[] = {
+    {0, 0, 0, 0, false},
+    {4, 4, 8, 4, false},
+    {4, 5, 16, 8, false},
+    {4, 6, 32, 32, false},
+    {4, 4, 16, 16, true},
+    {8, 16, 32, 32, true},
+    {8, 16, 128, 128, true},
+    {8, 32, 128, 256, true},
+    {32, 128, 258, 1024, true},
+    {32, 258, 258, 4096, true},
+};
+
+static void sort_by_frequency(uint16_t *symbols, size_t count, const uint32_t *frequencies)
+{
+    for (size_t i = 1; i < count; i++)
+    {
+        uint16_t symbol = symbols[i];
+        size_t j = i;
+
+        while (j > 0 && frequencies[symbols[j - 1]] > frequencies[symbol])
+        {
+            symbols[j] = symbols[j - 1];
+            j--;
+        }
+
+        symbols[j] = symbol;
+    }
+}
+
+// Huffman code lengths, none longer than max_length.
+static void build_lengths(const uint32_t *frequencies, size_t count, int max_length, uint8_t *lengths)
+{
+    uint16_t symbols[FIXED_LIT_LEN_CODES];
+    size_t used = 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        lengths[i] = 0;
+
+        if (frequencies[i] != 0)
+        {
+            symbols[used++] = i;
+        }
+    }
+
+    if (used == 0)
+    {
+        return;
+    }
+
+    // A lone code still takes a bit, give it a sibling so the code is
+    // complete, decoders reject incomplete code length codes.
+    if (used == 1)
+    {
+        lengths[symbols[0]] = 1;
+        lengths[symbols[0] == 0 ? 1 : 0] = 1;
+        return;
+    }
+
+    sort_by_frequency(symbols, used, frequencies);
+
+    // Leaves come first, sorted by weight, and the internal nodes are created
+    // by increasing weight too, so the two lightest nodes are always at the
+    // front of one of the two lists.
+    uint32_t weights[2 * FIXED_LIT_LEN_CODES];
+    uint16_t parents[2 * FIXED_LIT_LEN_CODES];
+    uint16_t depths[2 * FIXED_LIT_LEN_CODES];
+
+    for (size_t i = 0; i < used; i++)
+    {
+        weights[i] = frequencies[symbols[i]];
+    }
+
+    size_t leaf = 0;
+    size_t node = used;
+    size_t next = used;
+
+    auto lightest = [&]() {
+        if (leaf < used && (node == next || weights[leaf] <= weights[node]))
+        {
+            return leaf++;
+        }
+
+        return node++;
+    };
+
+    while (next < 2 * used - 1)
+    {
+        size_t left = lightest();
+        size_t right = lightest();
+
+        weights[next] = weights[left] + weights[right];
+        parents[left] = next;
+        parents[right] = next;
+        next++;
+    }
+
+    // Parents always come after their children.
+    depths[next - 1] = 0;
+
+    for (size_t i = next - 1; i-- > 0;)
+    {
+        depths[i] = depths[parents[i]] + 1;
+    }
+
+    uint16_t counts[MAX_CODE_LENGTH + 1] = {};
+
+    for (size_t i = 0; i < used; i++)
+    {
+        counts[MIN((int)depths[i], max_length)]++;
+    }
+
+    // Clamping made the code over-subscribed, make room by moving leaves down
+    // from shorter codes.
+    uint32_t total = 0;
+
+    for (int length = 1; length <= max_length; length++)
+    {
+        total += (uint32_t)counts[length] << (max_length - length);
+    }
+
+    while (total > (1u << max_length))
+    {
+        counts[max_length]--;
+
+        for (int length = max_length - 1; length > 0; length--)
+        {
+            if (counts[length] != 0)
+            {
+                counts[length]--;
+                counts[length + 1] += 2;
+                break;
+            }
+        }
+
+        total--;
+    }
+
+    // Least frequent symbols get the longest codes.
+    size_t index = 0;
+
+    for (int length = max_length; length > 0; length--)
+    {
+        for (size_t i = 0; i < counts[length]; i++)
+        {
+            lengths[symbols[index++]] = length;
+        }
+    }
+}
+
+static void build_codes(const uint8_t *lengths, size_t count, uint16_t *codes)
+{
+    uint16_t counts[MAX_CODE_LENGTH + 1] = {};
+
+    for (size_t i = 0; i < count; i++)
+    {
+        counts[lengths[i]]++;
+    }
+
+    counts[0] = 0;
+
+    uint16_t next_codes[MAX_CODE_LENGTH + 1] = {};
+    uint16_t code = 0;
+
+    for (int length = 1; length <= MAX_CODE_LENGTH; length++)
+    {
+        code = (code + counts[length - 1]) << 1;
+        next_codes[length] = code;
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        codes[i] = lengths[i] ? reverse_bits(next_codes[lengths[i]]++, lengths[i]) : 0;
+    }
+}
+
+static size_t common_length(const uint8_t *left, const uint8_t *right, size_t max_length)
+{
+    size_t length = 0;
+
+    while (length + sizeof(uint64_t) <= max_length)
+    {
+        uint64_t left_word;
+        uint64_t right_word;
+        memcpy(&left_word, left + length, sizeof(left_word));
+        memcpy(&right_word, right + length, sizeof(right_word));
+
+        uint64_t difference = left_word ^ right_word;
+
+        if (difference != 0)
+        {
+            return length + __builtin_ctzll(difference) / 8;
+        }
+
+        length += sizeof(uint64_t);
+    }
+
+    while (length < max_length && left[length] == right[length])
+    {
+        length++;
+    }
+
+    return length;
+}
+
+static ResultOr<size_t> read_full(IO::Reader &reader, uint8_t *buffer, size_t size)
+{
+    size_t total = 0;
+
+    while (total < size)
+    {
+        size_t read = TRY(reader.read(buffer + total, size - total));
+
+        if (read == 0)
+        {
+            break;
+        }
+
+        total += read;
+    }
+
+    return total;
+}
+
+struct Deflate::Encoder
+{
+    struct Symbol
+    {
+        // Zero for literals.
+        uint16_t distance;
+
+        uint16_t literal_or_length;
+    };
+
+    IO::Reader &reader;
+    IO::BitWriter &bits;
+    const Level &level;
+
+    // Input moves back by a window once it reaches the end of the second one.
+    uint8_t window[2 * WINDOW_SIZE];
+    size_t position = 0;
+    size_t lookahead = 0;
+    bool end_of_file = false;
+
+    // Most recent position of each hash, and the previous position with the
+    // same hash as each position of the window.
+    uint16_t head[HASH_SIZE] = {};
+    uint16_t previous[WINDOW_SIZE] = {};
+
+    size_t match_start = 0;
+    size_t match_length = MIN_MATCH_LENGTH - 1;
+    size_t previous_match = 0;
+    size_t previous_length = MIN_MATCH_LENGTH - 1;
+    bool match_available = false;
+
+    // Input covered by the symbols of the current block.
+    size_t block_start = 0;
+    size_t block_end = 0;
+
+    Symbol symbols[SYMBOL_BUFFER_SIZE];
+    size_t symbol_count = 0;
+
+    uint32_t lit_len_frequencies[LIT_LEN_CODES] = {};
+    uint32_t dist_frequencies[DIST_CODES] = {};
+
+    uint8_t length_codes[MAX_MATCH_LENGTH + 1];
+    uint8_t distance_codes[512];
+
+    uint8_t fixed_lit_len_lengths[FIXED_LIT_LEN_CODES];
+    uint16_t fixed_lit_len_codes[FIXED_LIT_LEN_CODES];
+    uint8_t fixed_dist_lengths[DIST_CODES];
+    uint16_t fixed_dist_codes[DIST_CODES];
+
+    Encoder(IO::Reader &reader, IO::BitWriter &bits, const Level &level)
+        : reader{reader}, bits{bits}, level{level}
+    {
+        for (size_t code = 0; code < 29; code++)
+        {
+            size_t end = MIN((size_t)BASE_LENGTHS[code] + (1 << BASE_LENGTH_EXTRA_BITS[code]), MAX_MATCH_LENGTH + 1);
+
+            for (size_t length = BASE_LENGTHS[code]; length < end; length++)
+            {
+                length_codes[length] = code;
+            }
+        }
+
+        for (size_t code = 0; code < DIST_CODES; code++)
+        {
+            size_t start = BASE_DISTANCE[code] - 1;
+            size_t end = start + (1 << BASE_DISTANCE_EXTRA_BITS[code]);
+
+            for (size_t distance = start; distance < end; distance++)
+            {
+                distance_codes[distance < 256 ? distance : 256 + (distance >> 7)] = code;
+            }
+        }
+
+        // See https://tools.ietf.org/html/rfc1951#section-3.2.6
+        for (size_t i = 0; i < FIXED_LIT_LEN_CODES; i++)
+        {
+            if (i <= 143)
+            {
+                fixed_lit_len_lengths[i] = 8;
+            }
+            else if (i <= 255)
+            {
+                fixed_lit_len_lengths[i] = 9;
+            }
+            else if (i <= 279)
+            {
+                fixed_lit_len_lengths[i] = 7;
+            }
+            else
+            {
+                fixed_lit_len_lengths[i] = 8;
+            }
+        }
+
+        for (size_t i = 0; i < DIST_CODES; i++)
+        {
+            fixed_dist_lengths[i] = 5;
+        }
+
+        build_codes(fixed_lit_len_lengths, FIXED_LIT_LEN_CODES, fixed_lit_len_codes);
+        build_codes(fixed_dist_lengths, DIST_CODES, fixed_dist_codes);
+    }
+
+    size_t distance_code(size_t distance)
+    {
+        distance--;
+        return distance_codes[distance < 256 ? distance : 256 + (distance >> 7)];
+    }
+
+    /* --- Matching --------------------------------------------------------- */
+
+    // Adds the string at the given position to its hash chain, and returns
+    // the previous head of the chain.
+    ALWAYS_INLINE uint16_t insert(size_t at)
+    {
+        uint32_t bytes = window[at] | (window[at + 1] << 8) | (window[at + 2] << 16);
+        uint32_t hash = (bytes * 2654435761u) >> (32 - HASH_BITS);
+
+        uint16_t match_head = head[hash];
+        previous[at & (WINDOW_SIZE - 1)] = match_head;
+        head[hash] = at;
+
+        return match_head;
+    }
+
+    size_t longest_match(size_t current)
+    {
+        size_t chain = level.max_chain;
+        size_t best_length = previous_length;
+        size_t max_length = MIN(MAX_MATCH_LENGTH, lookahead);
+        size_t nice_length = MIN((size_t)level.nice_length, lookahead);
+        size_t limit = position > MAX_DISTANCE ? position - MAX_DISTANCE : NIL;
+
+        if (previous_length >= level.good_length)
+        {
+            chain /= 4;
+        }
+
+        if (best_length >= max_length)
+        {
+            return max_length;
+        }
+
+        const uint8_t *scan = window + position;
+
+        do
+        {
+            const uint8_t *match = window + current;
+
+            if (match[best_length] != scan[best_length] ||
+                match[0] != scan[0] ||
+                match[1] != scan[1])
+            {
+                continue;
+            }
+
+            size_t length = common_length(scan, match, max_length);
+
+            if (length > best_length)
+            {
+                match_start = current;
+                best_length = length;
+
+                if (length >= nice_length)
+                {
+                    break;
+                }
+            }
+        } while ((current = previous[current & (WINDOW_SIZE - 1)]) > limit && --chain != 0);
+
+        return best_length;
+    }
+
+    /* --- Input ------------------------------------------------------------ */
+
+    HjResult slide()
+    {
+        // Everything before the first window is about to go, including the
+        // data a stored block would need.
+        if (block_start < WINDOW_SIZE)
+        {
+            TRY(flush_block(false));
+        }
+
+        memmove(window, window + WINDOW_SIZE, position + lookahead - WINDOW_SIZE);
+
+        // Positions in the lazy state may end up wrapping around, only the
+        // distance between them matters.
+        position -= WINDOW_SIZE;
+        match_start -= WINDOW_SIZE;
+        previous_match -= WINDOW_SIZE;
+        block_start -= WINDOW_SIZE;
+        block_end -= WINDOW_SIZE;
+
+        for (size_t i = 0; i < HASH_SIZE; i++)
+        {
+            head[i] = head[i] >= WINDOW_SIZE ? head[i] - WINDOW_SIZE : NIL;
+        }
+
+        for (size_t i = 0; i < WINDOW_SIZE; i++)
+        {
+            previous[i] = previous[i] >= WINDOW_SIZE ? previous[i] - WINDOW_SIZE : NIL;
+        }
+
+        return SUCCESS;
+    }
+
+    HjResult fill()
+    {
+        while (lookahead < MIN_LOOKAHEAD && !end_of_file)
+        {
+            if (position >= WINDOW_SIZE + MAX_DISTANCE)
+            {
+                TRY(slide());
+            }
+
+            size_t space = 2 * WINDOW_SIZE - position - lookahead;
+            size_t read = TRY(reader.read(window + position + lookahead, space));
+
+            if (read == 0)
+            {
+                end_of_file = true;
+            }
+
+            lookahead += read;
+        }
+
+        return SUCCESS;
+    }
+
+    /* --- Symbols ---------------------------------------------------------- */
+
+    ALWAYS_INLINE bool emit_literal(uint8_t literal)
+    {
+        symbols[symbol_count++] = {0, literal};
+        lit_len_frequencies[literal]++;
+        block_end++;
+
+        return symbol_count == SYMBOL_BUFFER_SIZE;
+    }
+
+    ALWAYS_INLINE bool emit_match(size_t distance, size_t length)
+    {
+        symbols[symbol_count++] = {(uint16_t)distance, (uint16_t)length};
+        lit_len_frequencies[257 + length_codes[length]]++;
+        dist_frequencies[distance_code(distance)]++;
+        block_end += length;
+
+        return symbol_count == SYMBOL_BUFFER_SIZE;
+    }
+
+    // Takes the longest match found at each position.
+    HjResult compress_greedy()
+    {
+        while (true)
+        {
+            TRY(fill());
+
+            if (lookahead == 0)
+            {
+                return SUCCESS;
+            }
+
+            uint16_t match_head = NIL;
+
+            if (lookahead >= MIN_MATCH_LENGTH)
+            {
+                match_head = insert(position);
+            }
+
+            match_length = MIN_MATCH_LENGTH - 1;
+
+            if (match_head != NIL && position - match_head <= MAX_DISTANCE)
+            {
+                match_length = longest_match(match_head);
+            }
+
+            bool full;
+
+            if (match_length >= MIN_MATCH_LENGTH)
+            {
+                full = emit_match(position - match_start, match_length);
+                lookahead -= match_length;
+
+                if (match_length <= level.lazy_length && lookahead >= MIN_MATCH_LENGTH)
+                {
+                    for (size_t i = 1; i < match_length; i++)
+                    {
+                        insert(position + i);
+                    }
+                }
+
+                position += match_length;
+            }
+            else
+            {
+                full = emit_literal(window[position]);
+                lookahead--;
+                position++;
+            }
+
+            if (full)
+            {
+                TRY(flush_block(false));
+            }
+        }
+    }
+
+    // Only takes a match when the one at the next position isn't longer.
+    HjResult compress_lazy()
+    {
+        while (true)
+        {
+            TRY(fill());
+
+            if (lookahead == 0)
+            {
+                break;
+            }
+
+            uint16_t match_head = NIL;
+
+            if (lookahead >= MIN_MATCH_LENGTH)
+            {
+                match_head = insert(position);
+            }
+
+            previous_length = match_length;
+            previous_match = match_start;
+            match_length = MIN_MATCH_LENGTH - 1;
+
+            if (match_head != NIL &&
+                previous_length < level.lazy_length &&
+                position - match_head <= MAX_DISTANCE)
+            {
+                match_length = longest_match(match_head);
+
+                if (match_length == MIN_MATCH_LENGTH && position - match_start > TOO_FAR)
+                {
+                    match_length = MIN_MATCH_LENGTH - 1;
+                }
+            }
+
+            if (previous_length >= MIN_MATCH_LENGTH && match_length <= previous_length)
+            {
+                // The match found one byte ago wins.
+                size_t max_insert = position + lookahead - MIN_MATCH_LENGTH;
+                bool full = emit_match(position - 1 - previous_match, previous_length);
+
+                lookahead -= previous_length - 1;
+
+                for (size_t i = 0; i < previous_length - 2; i++)
+                {
+                    position++;
+
+                    if (position <= max_insert)
+                    {
+                        insert(position);
+                    }
+                }
+
+                match_available = false;
+                match_length = MIN_MATCH_LENGTH - 1;
+                position++;
+
+                if (full)
+                {
+                    TRY(flush_block(false));
+                }
+            }
+            else if (match_available)
+            {
+                // The match at this position is better, the previous byte goes
+                // out as a literal.
+                bool full = emit_literal(window[position - 1]);
+
+                position++;
+                lookahead--;
+
+                if (full)
+                {
+                    TRY(flush_block(false));
+                }
+            }
+            else
+            {
+                match_available = true;
+                position++;
+                lookahead--;
+            }
+        }
+
+        if (match_available)
+        {
+            emit_literal(window[position - 1]);
+            match_available = false;
+        }
+
+        return SUCCESS;
+    }
+
+    /* --- Blocks ----------------------------------------------------------- */
+
+    void write_symbols(const uint16_t *lit_len_codes, const uint8_t *lit_len_lengths, const uint16_t *dist_codes, const uint8_t *dist_lengths)
+    {
+        for (size_t i = 0; i < symbol_count; i++)
+        {
+            auto symbol = symbols[i];
+
+            if (symbol.distance == 0)
+            {
+                bits.put_bits(lit_len_codes[symbol.literal_or_length], lit_len_lengths[symbol.literal_or_length]);
+                continue;
+            }
+
+            size_t length_code = length_codes[symbol.literal_or_length];
+            bits.put_bits(lit_len_codes[257 + length_code], lit_len_lengths[257 + length_code]);
+            bits.put_bits(symbol.literal_or_length - BASE_LENGTHS[length_code], BASE_LENGTH_EXTRA_BITS[length_code]);
+
+            size_t dist_code = distance_code(symbol.distance);
+            bits.put_bits(dist_codes[dist_code], dist_lengths[dist_code]);
+            bits.put_bits(symbol.distance - BASE_DISTANCE[dist_code], BASE_DISTANCE_EXTRA_BITS[dist_code]);
+        }
+
+        bits.put_bits(lit_len_codes[END_OF_BLOCK], lit_len_lengths[END_OF_BLOCK]);
+    }
+
+    HjResult flush_block(bool final)
+    {
+        lit_len_frequencies[END_OF_BLOCK] = 1;
+
+        uint8_t lit_len_lengths[LIT_LEN_CODES];
+        uint8_t dist_lengths[DIST_CODES];
+
+        build_lengths(lit_len_frequencies, LIT_LEN_CODES, MAX_CODE_LENGTH, lit_len_lengths);
+        build_lengths(dist_frequencies, DIST_CODES, MAX_CODE_LENGTH, dist_lengths);
+
+        size_t hlit = LIT_LEN_CODES;
+        size_t hdist = DIST_CODES;
+
+        while (hlit > 257 && lit_len_lengths[hlit - 1] == 0)
+        {
+            hlit--;
+        }
+
+        while (hdist > 1 && dist_lengths[hdist - 1] == 0)
+        {
+            hdist--;
+        }
+
+        // Both sets of code lengths go out together, with runs encoded
+        // through the code length codes 16, 17 and 18.
+        uint8_t lengths[LIT_LEN_CODES + DIST_CODES];
+        memcpy(lengths, lit_len_lengths, hlit);
+        memcpy(lengths + hlit, dist_lengths, hdist);
+
+        uint8_t runs[LIT_LEN_CODES + DIST_CODES];
+        uint8_t runs_extra[LIT_LEN_CODES + DIST_CODES];
+        size_t run_count = 0;
+
+        uint32_t code_length_frequencies[CODE_LENGTH_CODES] = {};
+
+        auto emit_run = [&](uint8_t code, uint8_t extra) {
+            runs[run_count] = code;
+            runs_extra[run_count] = extra;
+            run_count++;
+            code_length_frequencies[code]++;
+        };
+
+        for (size_t i = 0; i < hlit + hdist;)
+        {
+            uint8_t length = lengths[i];
+            size_t run = 1;
+
+            while (i + run < hlit + hdist && lengths[i + run] == length)
+            {
+                run++;
+            }
+
+            i += run;
+
+            if (length == 0)
+            {
+                while (run >= 11)
+                {
+                    size_t count = MIN(run, (size_t)138);
+                    emit_run(18, count - 11);
+                    run -= count;
+                }
+
+                if (run >= 3)
+                {
+                    emit_run(17, run - 3);
+                    run = 0;
+                }
+            }
+            else
+            {
+                emit_run(length, 0);
+                run--;
+
+                while (run >= 3)
+                {
+                    size_t count = MIN(run, (size_t)6);
+                    emit_run(16, count - 3);
+                    run -= count;
+                }
+            }
+
+            while (run > 0)
+            {
+                emit_run(length, 0);
+                run--;
+            }
+        }
+
+        uint8_t code_length_lengths[CODE_LENGTH_CODES];
+        uint16_t code_length_codes[CODE_LENGTH_CODES];
+        build_lengths(code_length_frequencies, CODE_LENGTH_CODES, MAX_CODE_LENGTH_LENGTH, code_length_lengths);
+        build_codes(code_length_lengths, CODE_LENGTH_CODES, code_length_codes);
+
+        size_t hclen = CODE_LENGTH_CODES;
+
+        while (hclen > 4 && code_length_lengths[CODE_LENGTH_ORDER[hclen - 1]] == 0)
+        {
+            hclen--;
+        }
+
+        // Size of the block with each kind of encoding.
+        size_t extra_bits = 0;
+        size_t dynamic_bits = 3 + 5 + 5 + 4 + 3 * hclen;
+        size_t fixed_bits = 3;
+
+        for (size_t i = 0; i < LIT_LEN_CODES; i++)
+        {
+            dynamic_bits += lit_len_frequencies[i] * lit_len_lengths[i];
+            fixed_bits += lit_len_frequencies[i] * fixed_lit_len_lengths[i];
+
+            if (i > END_OF_BLOCK)
+            {
+                extra_bits += lit_len_frequencies[i] * BASE_LENGTH_EXTRA_BITS[i - 257];
+            }
+        }
+
+        for (size_t i = 0; i < DIST_CODES; i++)
+        {
+            dynamic_bits += dist_frequencies[i] * dist_lengths[i];
+            fixed_bits += dist_frequencies[i] * fixed_dist_lengths[i];
+            extra_bits += dist_frequencies[i] * BASE_DISTANCE_EXTRA_BITS[i];
+        }
+
+        for (size_t i = 0; i < CODE_LENGTH_CODES; i++)
+        {
+            dynamic_bits += code_length_frequencies[i] * code_length_lengths[i];
+        }
+
+        dynamic_bits += code_length_frequencies[16] * 2 + code_length_frequencies[17] * 3 + code_length_frequencies[18] * 7;
+        dynamic_bits += extra_bits;
+        fixed_bits += extra_bits;
+
+        size_t stored_length = block_end - block_start;
+        size_t stored_blocks = MAX((stored_length + MAX_STORED_LENGTH - 1) / MAX_STORED_LENGTH, (size_t)1);
+        size_t stored_bits = stored_blocks * (3 + 7 + 32) + stored_length * 8;
+
+        if (stored_bits <= fixed_bits && stored_bits <= dynamic_bits)
+        {
+            const uint8_t *data = window + block_start;
+
+            do
+            {
+                size_t length = MIN(stored_length, MAX_STORED_LENGTH);
+                stored_length -= length;
+
+                write_uncompressed_block(data, length, bits, final && stored_length == 0);
+                data += length;
+            } while (stored_length > 0);
+        }
+        else if (fixed_bits <= dynamic_bits)
+        {
+            write_block_header(bits, BT_FIXED_HUFFMAN, final);
+            write_symbols(fixed_lit_len_codes, fixed_lit_len_lengths, fixed_dist_codes, fixed_dist_lengths);
+        }
+        else
+        {
+            write_block_header(bits, BT_DYNAMIC_HUFFMAN, final);
+
+            bits.put_bits(hlit - 257, 5);
+            bits.put_bits(hdist - 1, 5);
+            bits.put_bits(hclen - 4, 4);
+
+            for (size_t i = 0; i < hclen; i++)
+            {
+                bits.put_bits(code_length_lengths[CODE_LENGTH_ORDER[i]], 3);
+            }
+
+            for (size_t i = 0; i < run_count; i++)
+            {
+                uint8_t code = runs[i];
+                bits.put_bits(code_length_codes[code], code_length_lengths[code]);
+
+                if (code == 16)
+                {
+                    bits.put_bits(runs_extra[i], 2);
+                }
+                else if (code == 17)
+                {
+                    bits.put_bits(runs_extra[i], 3);
+                }
+                else if (code == 18)
+                {
+                    bits.put_bits(runs_extra[i], 7);
+                }
+            }
+
+            uint16_t lit_len_codes[LIT_LEN_CODES];
+            uint16_t dist_codes[DIST_CODES];
+            build_codes(lit_len_lengths, LIT_LEN_CODES, lit_len_codes);
+            build_codes(dist_lengths, DIST_CODES, dist_codes);
+
+            write_symbols(lit_len_codes, lit_len_lengths, dist_codes, dist_lengths);
+        }
+
+        symbol_count = 0;
+        block_start = block_end;
+        memset(lit_len_frequencies, 0, sizeof(lit_len_frequencies));
+        memset(dist_frequencies, 0, sizeof(dist_frequencies));
+
+        return SUCCESS;
+    }
+
+    HjResult run()
+    {
+        if (level.lazy)
+        {
+            TRY(compress_lazy());
+        }
+        else
+        {
+            TRY(compress_greedy());
+        }
+
+        return flush_block(true);
+    }
+};
+
+Deflate::Deflate(unsigned int compression_level)
+    : _compression_level(MIN(compression_level, MAX_COMPRESSION_LEVEL))
 {
-    /*
-	 * The higher the compression level, the more we should bother trying to
-	 * compress very small inputs.
-	 */
-    _min_size_to_compress = 56 - (_compression_level * 4);
 }
 
 void Deflate::write_block_header(IO::BitWriter &out_writer, BlockType block_type, bool final)
@@ -31,49 +941,55 @@ void Deflate::write_uncompressed_block(const uint8_t *block_data, size_t block_l
     out_writer.put_data(block_data, block_len);
 }
 
-HjResult Deflate::write_uncompressed_blocks(IO::Reader &in_data, IO::BitWriter &out_writer, bool write_final)
+HjResult Deflate::compress_none(IO::Reader &uncompressed, IO::Writer &compressed)
 {
+    IO::BitWriter bit_writer(compressed);
+
+    // One byte more than a block holds, to know if it's the final one.
     Vec<uint8_t> block_data;
-    block_data.resize(UINT16_MAX);
-    bool final_block = false;
+    block_data.resize(MAX_STORED_LENGTH + 1);
+    uint8_t *data = block_data.raw_storage();
 
-    do
+    size_t length = TRY(read_full(uncompressed, data, MAX_STORED_LENGTH + 1));
+
+    while (length > MAX_STORED_LENGTH)
     {
-        size_t len = TRY(in_data.read(block_data.raw_storage(), block_data.count()));
+        write_uncompressed_block(data, MAX_STORED_LENGTH, bit_writer, false);
+
+        data[0] = data[MAX_STORED_LENGTH];
+        length = 1 + TRY(read_full(uncompressed, data + 1, MAX_STORED_LENGTH));
+    }
 
-        // The condition for detecting the final is wrong here ( e.g. for multiples for UINT16_MAX)
-        final_block = len < block_data.count();
-        write_uncompressed_block(block_data.raw_storage(), len, out_writer, write_final && final_block);
-    } while (!final_block);
+    write_uncompressed_block(data, length, bit_writer, true);
 
-    return HjResult::SUCCESS;
+    return bit_writer.flush();
 }
 
-HjResult Deflate::compress_none(IO::Reader &uncompressed, IO::Writer &compressed)
+HjResult Deflate::compress_huffman(IO::Reader &uncompressed, IO::Writer &compressed)
 {
     IO::BitWriter bit_writer(compressed);
-    return write_uncompressed_blocks(uncompressed, bit_writer, true);
-}
 
-HjResult Deflate::perform(IO::Reader &uncompressed, IO::Writer &compressed)
-{
-    // Use a bufreader to increase performance and actually check for the minimum size
-    IO::BufReader buf_reader(uncompressed, 4096);
+    auto *encoder = new Encoder(uncompressed, bit_writer, LEVELS[_compression_level]);
+    HjResult result = encoder->run();
+    delete encoder;
 
-    // If the data amount is too small it's not worth compressing it.
-    // Depends on the compression level
-    if (buf_reader.buffered().unwrap() < _min_size_to_compress)
-        [[unlikely]]
+    if (result != SUCCESS)
     {
-        return compress_none(buf_reader, compressed);
+        return result;
     }
 
-    switch (_compression_level)
+    bit_writer.align();
+    return bit_writer.flush();
+}
+
+HjResult Deflate::perform(IO::Reader &uncompressed, IO::Writer &compressed)
+{
+    if (_compression_level == 0)
     {
-    // TODO: set the compression method according to the level
-    default:
-        return compress_none(buf_reader, compressed);
+        return compress_none(uncompressed, compressed);
     }
+
+    return compress_huffman(uncompressed, compressed);
 }
 
-} // namespace Compression
\ No newline at end of file
+} // namespace Compression
@@ -8,24 +8,32 @@
 namespace Compression
 {
 
+// LZ77 with hash chains over a 32 KiB window, the result is cut in blocks
+// which are stored, or Huffman coded with the fixed or their own codes,
+// whichever comes out smallest. Level 0 only stores, levels 1 to 3 take the
+// first long enough match, levels 4 to 9 look one byte further before
+// settling and search longer chains.
 struct Deflate
 {
 private:
+    struct Encoder;
+
     unsigned int _compression_level;
-    unsigned int _min_size_to_compress;
 
     // Compression modes
     static HjResult compress_none(IO::Reader &uncompressed, IO::Writer &compressed);
+    HjResult compress_huffman(IO::Reader &uncompressed, IO::Writer &compressed);
 
     // Write functions
-    static HjResult write_uncompressed_blocks(IO::Reader &in_data, IO::BitWriter &out_writer, bool final);
     static void write_block_header(IO::BitWriter &out_writer, BlockType block_type, bool final);
     static void write_uncompressed_block(const uint8_t *block_data, size_t block_len, IO::BitWriter &out_writer, bool final);
 
 public:
+    static constexpr unsigned int MAX_COMPRESSION_LEVEL = 9;
+
     Deflate(unsigned int compression_level);
 
     HjResult perform(IO::Reader &uncompressed, IO::Writer &compressed);
 };
 
-} // namespace Compression
\ No newline at end of file
+} // namespace Compression
@@ -1,173 +1,386 @@
+#include <string.h>
+
 #include <libcompression/Common.h>
-#include <libcompression/Huffman.h>
 #include <libcompression/Inflate.h>
-#include <libio/BitReader.h>
-#include <libio/BufReader.h>
-#include <libio/Copy.h>
-#include <libio/MemoryWriter.h>
-#include <libio/Skip.h>
 #include <libio/Streams.h>
-#include <libutils/InlineRing.h>
+#include <libmath/MinMax.h>
 
 namespace Compression
 {
 
-static constexpr uint8_t BASE_LENGTH_EXTRA_BITS[] = {
-    0, 0, 0, 0, 0, 0, 0, 0, //257 - 264
-    1, 1, 1, 1,             //265 - 268
-    2, 2, 2, 2,             //269 - 273
-    3, 3, 3, 3,             //274 - 276
-    4, 4, 4, 4,             //278 - 280
-    5, 5, 5, 5,             //281 - 284
-    0                       //285
-};
+static constexpr size_t MAX_LIT_LEN_CODES = 288;
+static constexpr size_t MAX_DIST_CODES = 32;
 
-static constexpr uint16_t BASE_LENGTHS[] = {
-    3, 4, 5, 6, 7, 8, 9, 10, //257 - 264
-    11, 13, 15, 17,          //265 - 268
-    19, 23, 27, 31,          //269 - 273
-    35, 43, 51, 59,          //274 - 276
-    67, 83, 99, 115,         //278 - 280
-    131, 163, 195, 227,      //281 - 284
-    258                      //285
-};
+// Output accumulates up to twice the window before being written out, the
+// last window is then moved back to the start. A match never has to wrap
+// around, and the slack lets match copies overshoot by a word.
+static constexpr size_t WINDOW_LIMIT = 2 * WINDOW_SIZE;
+static constexpr size_t WINDOW_CAPACITY = WINDOW_LIMIT + MAX_MATCH_LENGTH + sizeof(uint64_t);
 
-static constexpr uint16_t BASE_DISTANCE[] = {
-    1, 2, 3, 4,   //0-3
-    5, 7,         //4-5
-    9, 13,        //6-7
-    17, 25,       //8-9
-    33, 49,       //10-11
-    65, 97,       //12-13
-    129, 193,     //14-15
-    257, 385,     //16-17
-    513, 769,     //18-19
-    1025, 1537,   //20-21
-    2049, 3073,   //22-23
-    4097, 6145,   //24-25
-    8193, 12289,  //26-27
-    16385, 24577, //28-29
-};
+static constexpr size_t INPUT_BUFFER_SIZE = 4096;
 
-static constexpr uint8_t BASE_DISTANCE_EXTRA_BITS[] = {
-    0, 0, 0, 0, //0-3
-    1, 1,       //4-5
-    2, 2,       //6-7
-    3, 3,       //8-9
-    4, 4,       //10-11
-    5, 5,       //12-13
-    6, 6,       //14-15
-    7, 7,       //16-17
-    8, 8,       //18-19
-    9, 9,       //20-21
-    10, 10,     //22-23
-    11, 11,     //24-25
-    12, 12,     //26-27
-    13, 13,     //28-29
+enum HuffmanEntryKind : uint8_t
+{
+    ENTRY_INVALID,
+    ENTRY_SYMBOL,
+    ENTRY_LINK,
 };
 
-void Inflate::get_bit_length_count(HashMap<unsigned int, unsigned int> &bit_length_count, const Vec<unsigned int> &code_bit_lengths)
+static constexpr unsigned int INVALID_SYMBOL = 0xffff;
+
+// Bits are consumed least significant first from a 64-bit buffer, which is
+// refilled a word at a time while enough input is buffered.
+struct Inflate::Bits
 {
-    for (unsigned int i = 0; i != code_bit_lengths.count(); i++)
+    IO::Reader &reader;
+
+    uint8_t buffer[INPUT_BUFFER_SIZE];
+    size_t head = 0;
+    size_t used = 0;
+    bool end_of_file = false;
+
+    uint64_t value = 0;
+    unsigned int count = 0;
+
+    // Bytes taken out of the input buffer.
+    size_t loaded = 0;
+
+    // Set when more bits were dropped than the input had.
+    bool overrun = false;
+
+    Bits(IO::Reader &reader) : reader{reader} {}
+
+    HjResult fill()
     {
-        bit_length_count[code_bit_lengths[i]] = 0;
+        used = TRY(reader.read(buffer, INPUT_BUFFER_SIZE));
+        head = 0;
+        end_of_file = used == 0;
+
+        return SUCCESS;
     }
 
-    for (unsigned int i = 0; i != code_bit_lengths.count(); i++)
+    // Makes at least 56 bits available, unless the input ends first.
+    ALWAYS_INLINE HjResult refill()
     {
-        bit_length_count[code_bit_lengths[i]]++;
+        if (used - head >= sizeof(uint64_t))
+        {
+            uint64_t word;
+            memcpy(&word, buffer + head, sizeof(word));
+
+            // The bits of the next byte that end up above count are the same
+            // ones it brings in when it is loaded for good.
+            value |= word << count;
+
+            size_t bytes = (63 - count) / 8;
+            head += bytes;
+            loaded += bytes;
+            count += bytes * 8;
+
+            return SUCCESS;
+        }
+
+        while (count < 56)
+        {
+            if (head == used)
+            {
+                if (end_of_file)
+                {
+                    return SUCCESS;
+                }
+
+                TRY(fill());
+                continue;
+            }
+
+            value |= (uint64_t)buffer[head++] << count;
+            loaded++;
+            count += 8;
+        }
+
+        return SUCCESS;
     }
-}
 
-void Inflate::get_first_code(HashMap<unsigned int, unsigned int> &first_codes, HashMap<unsigned int, unsigned int> &bit_length_count)
-{
-    unsigned int code = 0;
-    unsigned int prev_bl_count = 0;
-    for (unsigned int i = 1; i <= (unsigned int)bit_length_count.count(); i++)
+    ALWAYS_INLINE uint32_t peek(unsigned int bits)
+    {
+        return value & ((1ull << bits) - 1);
+    }
+
+    ALWAYS_INLINE void drop(unsigned int bits)
     {
-        if (i >= 2)
+        if (bits > count)
         {
-            prev_bl_count = bit_length_count[i - 1];
+            overrun = true;
+            bits = count;
         }
-        code = (code + prev_bl_count) << 1;
-        first_codes[i] = code;
+
+        value >>= bits;
+        count -= bits;
     }
-}
 
-void Inflate::assign_huffman_codes(Vec<unsigned int> &assigned_codes, const Vec<unsigned int> &code_bit_lengths, HashMap<unsigned int, unsigned int> &first_codes)
+    ALWAYS_INLINE uint32_t grab(unsigned int bits)
+    {
+        uint32_t result = peek(bits);
+        drop(bits);
+        return result;
+    }
+
+    void align()
+    {
+        drop(count % 8);
+    }
+
+    // Reads whole bytes, the bit buffer must be aligned.
+    HjResult read(uint8_t *data, size_t size)
+    {
+        while (size > 0 && count > 0)
+        {
+            *data++ = value & 0xff;
+            value >>= 8;
+            count -= 8;
+            size--;
+        }
+
+        if (count == 0)
+        {
+            value = 0;
+        }
+
+        while (size > 0)
+        {
+            if (head == used)
+            {
+                TRY(fill());
+
+                if (end_of_file)
+                {
+                    return ERR_INVALID_DATA;
+                }
+            }
+
+            size_t chunk = MIN(size, used - head);
+            memcpy(data, buffer + head, chunk);
+
+            data += chunk;
+            size -= chunk;
+            head += chunk;
+            loaded += chunk;
+        }
+
+        return SUCCESS;
+    }
+
+    size_t consumed()
+    {
+        return loaded - count / 8;
+    }
+};
+
+HjResult Inflate::build_table(HuffmanEntry *table, size_t table_size, int root_bits, const uint8_t *code_lengths, size_t count)
 {
-    assigned_codes.resize(code_bit_lengths.count());
+    uint16_t counts[MAX_CODE_LENGTH + 1] = {};
 
-    for (unsigned int i = 0; i < (unsigned int)code_bit_lengths.count(); i++)
+    for (size_t i = 0; i < count; i++)
     {
-        if (code_bit_lengths[i])
+        counts[code_lengths[i]]++;
+    }
+
+    counts[0] = 0;
+
+    // Refuse over-subscribed codes, incomplete ones are fine as long as the
+    // missing codes never show up.
+    int left = 1;
+
+    for (int length = 1; length <= MAX_CODE_LENGTH; length++)
+    {
+        left = (left << 1) - counts[length];
+
+        if (left < 0)
         {
-            assigned_codes[i] = first_codes[code_bit_lengths[i]]++;
+            return ERR_INVALID_DATA;
         }
-        else
+    }
+
+    // Canonical order: by code length, then by symbol.
+    uint16_t offsets[MAX_CODE_LENGTH + 2] = {};
+
+    for (int length = 1; length <= MAX_CODE_LENGTH; length++)
+    {
+        offsets[length + 1] = offsets[length] + counts[length];
+    }
+
+    uint16_t sorted[MAX_LIT_LEN_CODES];
+    size_t symbol_count = offsets[MAX_CODE_LENGTH + 1];
+
+    for (size_t symbol = 0; symbol < count; symbol++)
+    {
+        if (code_lengths[symbol] != 0)
         {
-            assigned_codes[i] = 0;
+            sorted[offsets[code_lengths[symbol]]++] = symbol;
         }
     }
+
+    uint32_t next_codes[MAX_CODE_LENGTH + 1] = {};
+    uint32_t code = 0;
+
+    for (int length = 1; length <= MAX_CODE_LENGTH; length++)
+    {
+        code = (code + counts[length - 1]) << 1;
+        next_codes[length] = code;
+    }
+
+    int max_length = MAX_CODE_LENGTH;
+
+    while (max_length > 0 && counts[max_length] == 0)
+    {
+        max_length--;
+    }
+
+    size_t root_size = 1 << root_bits;
+
+    for (size_t i = 0; i < root_size; i++)
+    {
+        table[i] = {INVALID_SYMBOL, 0, ENTRY_INVALID};
+    }
+
+    size_t used = root_size;
+    size_t subtable = 0;
+    size_t subtable_prefix = root_size;
+    int subtable_bits = 0;
+
+    for (size_t i = 0; i < symbol_count; i++)
+    {
+        uint16_t symbol = sorted[i];
+        int length = code_lengths[symbol];
+        uint32_t reversed = reverse_bits(next_codes[length]++, length);
+
+        if (length <= root_bits)
+        {
+            for (size_t j = reversed; j < root_size; j += 1 << length)
+            {
+                table[j] = {symbol, (uint8_t)length, ENTRY_SYMBOL};
+            }
+
+            continue;
+        }
+
+        // Codes sharing their first root bits are next to each other in
+        // canonical order, they all go in the same subtable.
+        size_t prefix = reversed & (root_size - 1);
+
+        if (prefix != subtable_prefix)
+        {
+            // Make the subtable just big enough for the codes still to come.
+            int bits = length - root_bits;
+            int remaining = 1 << bits;
+
+            while (bits + root_bits < max_length)
+            {
+                remaining -= counts[bits + root_bits];
+
+                if (remaining <= 0)
+                {
+                    break;
+                }
+
+                bits++;
+                remaining <<= 1;
+            }
+
+            if (used + (1 << bits) > table_size)
+            {
+                return ERR_INVALID_DATA;
+            }
+
+            subtable = used;
+            subtable_prefix = prefix;
+            subtable_bits = bits;
+            used += 1 << bits;
+
+            table[prefix] = {(uint16_t)subtable, (uint8_t)bits, ENTRY_LINK};
+
+            for (size_t j = 0; j < (1u << bits); j++)
+            {
+                table[subtable + j] = {INVALID_SYMBOL, 0, ENTRY_INVALID};
+            }
+        }
+
+        counts[length]--;
+
+        int sub_length = length - root_bits;
+
+        for (size_t j = reversed >> root_bits; j < (1u << subtable_bits); j += 1 << sub_length)
+        {
+            table[subtable + j] = {symbol, (uint8_t)sub_length, ENTRY_SYMBOL};
+        }
+    }
+
+    return SUCCESS;
 }
 
-void Inflate::build_huffman_alphabet(Vec<unsigned int> &alphabet, const Vec<unsigned int> &code_bit_lengths)
+unsigned int Inflate::decode(Bits &bits, const HuffmanEntry *table, int root_bits)
 {
-    HashMap<unsigned int, unsigned int> bit_length_count, first_codes;
+    HuffmanEntry entry = table[bits.peek(root_bits)];
 
-    get_bit_length_count(bit_length_count, code_bit_lengths);
-    get_first_code(first_codes, bit_length_count);
-    assign_huffman_codes(alphabet, code_bit_lengths, first_codes);
+    if (entry.kind == ENTRY_LINK)
+    {
+        bits.drop(root_bits);
+        entry = table[entry.value + bits.peek(entry.bits)];
+    }
+
+    bits.drop(entry.bits);
+
+    return entry.value;
 }
 
-// TODO: use a constexpr function to calculate these tables
-void Inflate::build_fixed_huffman_alphabet()
+void Inflate::build_fixed_tables()
 {
-    if (_fixed_code_bit_lengths.count())
+    if (_fixed_built)
     {
         return;
     }
 
-    _fixed_code_bit_lengths.resize(288);
-    _fixed_dist_code_bit_lengths.resize(32);
+    // See https://tools.ietf.org/html/rfc1951#section-3.2.6
+    uint8_t lengths[MAX_LIT_LEN_CODES];
 
-    for (int i = 0; i <= 287; i++)
+    for (size_t i = 0; i < MAX_LIT_LEN_CODES; i++)
     {
-        if (i >= 0 && i <= 143)
+        if (i <= 143)
         {
-            _fixed_code_bit_lengths[i] = 8;
+            lengths[i] = 8;
         }
-        else if (i >= 144 && i <= 255)
+        else if (i <= 255)
         {
-            _fixed_code_bit_lengths[i] = 9;
+            lengths[i] = 9;
         }
-        else if (i >= 256 && i <= 279)
+        else if (i <= 279)
         {
-            _fixed_code_bit_lengths[i] = 7;
+            lengths[i] = 7;
         }
-        else if (i >= 280 && i <= 287)
+        else
         {
-            _fixed_code_bit_lengths[i] = 8;
+            lengths[i] = 8;
         }
     }
 
-    for (int i = 0; i != 32; i++)
+    build_table(_fixed_lit_len, LIT_LEN_TABLE_SIZE, LIT_LEN_ROOT_BITS, lengths, MAX_LIT_LEN_CODES);
+
+    for (size_t i = 0; i < MAX_DIST_CODES; i++)
     {
-        _fixed_dist_code_bit_lengths[i] = 5;
+        lengths[i] = 5;
     }
 
-    build_huffman_alphabet(_fixed_alphabet, _fixed_code_bit_lengths);
-    build_huffman_alphabet(_fixed_dist_alphabet, _fixed_dist_code_bit_lengths);
+    build_table(_fixed_dist, DIST_TABLE_SIZE, DIST_ROOT_BITS, lengths, MAX_DIST_CODES);
+
+    _fixed_built = true;
 }
 
-HjResult Inflate::build_dynamic_huffman_alphabet(IO::BitReader &input)
+HjResult Inflate::build_dynamic_tables(Bits &bits)
 {
-    Vec<unsigned int> code_length_of_code_length_order = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
-    Vec<unsigned int> code_length_of_code_length = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+    TRY(bits.refill());
 
-    unsigned int hlit = input.grab_bits(5) + 257;
-    unsigned int hdist = input.grab_bits(5) + 1;
-    unsigned int hclen = input.grab_bits(4) + 4;
+    unsigned int hlit = bits.grab(5) + 257;
+    unsigned int hdist = bits.grab(5) + 1;
+    unsigned int hclen = bits.grab(4) + 4;
 
     // See: https://github.com/madler/zlib/issues/82
     if (hlit > 286 || hdist > 30)
@@ -175,154 +388,247 @@ HjResult Inflate::build_dynamic_huffman_alphabet(IO::BitReader &input)
         return ERR_INVALID_DATA;
     }
 
+    uint8_t code_length_lengths[19] = {};
+
     for (unsigned int i = 0; i < hclen; i++)
     {
-        code_length_of_code_length[code_length_of_code_length_order[i]] = input.grab_bits(3);
+        TRY(bits.refill());
+        code_length_lengths[CODE_LENGTH_ORDER[i]] = bits.grab(3);
     }
 
-    Vec<unsigned int> lit_len_and_dist_alphabets;
-    build_huffman_alphabet(lit_len_and_dist_alphabets, code_length_of_code_length);
+    HuffmanEntry code_length_table[CODE_LENGTH_TABLE_SIZE];
+    TRY(build_table(code_length_table, CODE_LENGTH_TABLE_SIZE, CODE_LENGTH_ROOT_BITS, code_length_lengths, 19));
+
+    uint8_t lengths[286 + 30];
+    unsigned int count = 0;
 
-    Vec<unsigned int> lit_len_and_dist_trees_unpacked;
-    HuffmanDecoder huffman(lit_len_and_dist_alphabets, code_length_of_code_length);
-    while (lit_len_and_dist_trees_unpacked.count() < (hdist + hlit))
+    while (count < hlit + hdist)
     {
-        unsigned int decoded_value = huffman.decode(input);
+        TRY(bits.refill());
+
+        unsigned int symbol = decode(bits, code_length_table, CODE_LENGTH_ROOT_BITS);
+
+        if (bits.overrun)
+        {
+            return ERR_INVALID_DATA;
+        }
 
         // Everything below 16 corresponds directly to a codelength. See https://tools.ietf.org/html/rfc1951#section-3.2.7
-        if (decoded_value < 16)
+        if (symbol < 16)
         {
-            lit_len_and_dist_trees_unpacked.push_back(decoded_value);
+            lengths[count++] = symbol;
             continue;
         }
 
         unsigned int repeat_count = 0;
-        unsigned int code_length_to_repeat = 0;
+        uint8_t length_to_repeat = 0;
 
-        switch (decoded_value)
+        switch (symbol)
         {
         // 3-6
         case 16:
-            repeat_count = input.grab_bits(2) + 3;
-            code_length_to_repeat = lit_len_and_dist_trees_unpacked.peek_back();
+            if (count == 0)
+            {
+                return ERR_INVALID_DATA;
+            }
+
+            repeat_count = bits.grab(2) + 3;
+            length_to_repeat = lengths[count - 1];
             break;
         // 3-10
         case 17:
-            repeat_count = input.grab_bits(3) + 3;
+            repeat_count = bits.grab(3) + 3;
             break;
         // 11 - 138
         case 18:
-            repeat_count = input.grab_bits(7) + 11;
+            repeat_count = bits.grab(7) + 11;
             break;
+
+        default:
+            return ERR_INVALID_DATA;
         }
 
-        for (unsigned int i = 0; i != repeat_count; i++)
+        if (count + repeat_count > hlit + hdist)
         {
-            lit_len_and_dist_trees_unpacked.push_back(code_length_to_repeat);
+            return ERR_INVALID_DATA;
         }
+
+        memset(lengths + count, length_to_repeat, repeat_count);
+        count += repeat_count;
     }
 
-    _lit_len_code_bit_length.resize(hlit);
-    for (unsigned int i = 0; i < _lit_len_code_bit_length.count(); i++)
+    TRY(build_table(_lit_len, LIT_LEN_TABLE_SIZE, LIT_LEN_ROOT_BITS, lengths, hlit));
+    TRY(build_table(_dist, DIST_TABLE_SIZE, DIST_ROOT_BITS, lengths + hlit, hdist));
+
+    return SUCCESS;
+}
+
+HjResult Inflate::flush_window(IO::Writer &uncompressed)
+{
+    if (_window_head > _window_flushed)
     {
-        _lit_len_code_bit_length[i] = lit_len_and_dist_trees_unpacked[i];
+        TRY(uncompressed.write(_window + _window_flushed, _window_head - _window_flushed));
+        _window_flushed = _window_head;
     }
 
-    _dist_code_bit_length.resize(lit_len_and_dist_trees_unpacked.count() - hlit);
-    for (unsigned int i = 0; i < _dist_code_bit_length.count(); i++)
+    // Only keep what matches can still refer to.
+    if (_window_head >= WINDOW_LIMIT)
     {
-        _dist_code_bit_length[i] = lit_len_and_dist_trees_unpacked[hlit + i];
+        memmove(_window, _window + _window_head - WINDOW_SIZE, WINDOW_SIZE);
+        _window_head = WINDOW_SIZE;
+        _window_flushed = WINDOW_SIZE;
     }
 
-    build_huffman_alphabet(_lit_len_alphabet, _lit_len_code_bit_length);
-    build_huffman_alphabet(_dist_alphabet, _dist_code_bit_length);
-    return HjResult::SUCCESS;
+    return SUCCESS;
 }
 
-FLATTEN HjResult Inflate::read_blocks(IO::Reader &reader, IO::Writer &uncompressed)
+HjResult Inflate::read_uncompressed(Bits &bits, IO::Writer &uncompressed)
 {
-    // We use this as our sliding window. We should write directly into "uncompressed in the future"
-    // And limit the amount of data we keep in our sliding window (Dequeue would be nice)
-    IO::MemoryWriter dest_writer{32768};
+    bits.align();
+    TRY(bits.refill());
 
-    uint8_t bfinal;
-    IO::BitReader bits{reader};
-    do
+    uint16_t length = bits.grab(16);
+    uint16_t complement = bits.grab(16);
+
+    if (bits.overrun || length != (uint16_t)~complement)
+    {
+        return ERR_INVALID_DATA;
+    }
+
+    while (length > 0)
     {
-        bfinal = bits.grab_bits(1);
-        uint8_t btype = bits.grab_bits(2);
+        if (_window_head >= WINDOW_LIMIT)
+        {
+            TRY(flush_window(uncompressed));
+        }
 
-        // Uncompressed block
-        if (btype == BT_UNCOMPRESSED)
+        size_t chunk = MIN((size_t)length, WINDOW_LIMIT - _window_head);
+        TRY(bits.read(_window + _window_head, chunk));
+
+        _window_head += chunk;
+        length -= chunk;
+    }
+
+    return SUCCESS;
+}
+
+FLATTEN HjResult Inflate::read_huffman(Bits &bits, IO::Writer &uncompressed, const HuffmanEntry *lit_len, const HuffmanEntry *dist)
+{
+    while (true)
+    {
+        if (_window_head >= WINDOW_LIMIT)
         {
-            // Align to byte bounadries
-            bits.skip_bits(5);
+            TRY(flush_window(uncompressed));
+        }
 
-            uint16_t len = TRY(IO::read<uint16_t>(reader));
+        // A length and distance pair takes at most 48 bits.
+        TRY(bits.refill());
 
-            // Skip complement of LEN
-            TRY(IO::skip(reader, 2));
+        unsigned int symbol = decode(bits, lit_len, LIT_LEN_ROOT_BITS);
 
-            // copy the uncompressed data
-            TRY(IO::copy(reader, dest_writer, len));
+        if (bits.overrun)
+        {
+            return ERR_INVALID_DATA;
+        }
+
+        if (symbol <= 255)
+        {
+            // Literal symbol
+            _window[_window_head++] = symbol;
         }
-        else if (btype == BT_FIXED_HUFFMAN || btype == BT_DYNAMIC_HUFFMAN)
+        else if (symbol >= 257 && symbol <= 285)
         {
-            // Use a fixed huffman alphabet
-            if (btype == BT_FIXED_HUFFMAN)
+            // Length code
+            unsigned int length_index = symbol - 257;
+            size_t length = BASE_LENGTHS[length_index] + bits.grab(BASE_LENGTH_EXTRA_BITS[length_index]);
+
+            unsigned int dist_code = decode(bits, dist, DIST_ROOT_BITS);
+
+            if (dist_code >= 30)
             {
-                build_fixed_huffman_alphabet();
+                return ERR_INVALID_DATA;
             }
-            // Use a dynamic huffman alphabet
-            else
+
+            size_t distance = BASE_DISTANCE[dist_code] + bits.grab(BASE_DISTANCE_EXTRA_BITS[dist_code]);
+
+            if (distance > _window_head)
             {
-                TRY(build_dynamic_huffman_alphabet(bits));
+                return ERR_INVALID_DATA;
             }
 
-            // Do the actual huffman decoding
-            HuffmanDecoder symbol_decoder(btype == BT_FIXED_HUFFMAN ? _fixed_alphabet : _lit_len_alphabet,
-                btype == BT_FIXED_HUFFMAN ? _fixed_code_bit_lengths : _lit_len_code_bit_length);
+            uint8_t *to = _window + _window_head;
+            const uint8_t *from = to - distance;
 
-            HuffmanDecoder dist_decoder(btype == BT_FIXED_HUFFMAN ? _fixed_dist_alphabet : _dist_alphabet,
-                btype == BT_FIXED_HUFFMAN ? _fixed_dist_code_bit_lengths : _dist_code_bit_length);
-
-            while (true)
+            if (distance >= sizeof(uint64_t))
             {
-                unsigned int decoded_symbol = symbol_decoder.decode(bits);
-                if (decoded_symbol <= 255)
+                // Every word read was written by a previous iteration, or
+                // before the match.
+                for (size_t i = 0; i < length; i += sizeof(uint64_t))
                 {
-                    // Literal symbol
-                    IO::write(dest_writer, decoded_symbol);
+                    uint64_t word;
+                    memcpy(&word, from + i, sizeof(word));
+                    memcpy(to + i, &word, sizeof(word));
                 }
-                else if (decoded_symbol >= 257 && decoded_symbol <= 285)
+            }
+            else if (distance == 1)
+            {
+                memset(to, *from, length);
+            }
+            else
+            {
+                for (size_t i = 0; i < length; i++)
                 {
-                    // Length code
-                    unsigned int length_index = decoded_symbol - 257;
-                    unsigned int total_length = BASE_LENGTHS[length_index] + bits.grab_bits(BASE_LENGTH_EXTRA_BITS[length_index]);
-                    unsigned int dist_code = dist_decoder.decode(bits);
+                    to[i] = from[i];
+                }
+            }
 
-                    Assert::lower_than(dist_code, 30);
+            _window_head += length;
+        }
+        else if (symbol == 256)
+        {
+            // End code
+            return SUCCESS;
+        }
+        else
+        {
+            IO::logln("Invalid decoded symbol: {}", symbol);
+            return ERR_INVALID_DATA;
+        }
+    }
+}
 
-                    unsigned int total_dist = BASE_DISTANCE[dist_code] + bits.grab_bits(BASE_DISTANCE_EXTRA_BITS[dist_code]);
+HjResult Inflate::read_blocks(Bits &bits, IO::Writer &uncompressed)
+{
+    _window_head = 0;
+    _window_flushed = 0;
 
-                    for (unsigned int i = 0; i != total_length; i++)
-                    {
-                        size_t offset = TRY(dest_writer.length()) - total_dist;
-                        uint8_t val = dest_writer.buffer()[offset];
-                        IO::write(dest_writer, val);
-                    }
-                }
-                else if (decoded_symbol == 256)
-                {
-                    // End code
-                    break;
-                }
-                else
-                {
-                    IO::logln("Invalid decoded symbol: {}", decoded_symbol);
-                    return ERR_INVALID_DATA;
-                }
-            }
+    bool bfinal;
+
+    do
+    {
+        TRY(bits.refill());
+
+        bfinal = bits.grab(1);
+        uint8_t btype = bits.grab(2);
+
+        if (bits.overrun)
+        {
+            return ERR_INVALID_DATA;
+        }
+
+        if (btype == BT_UNCOMPRESSED)
+        {
+            TRY(read_uncompressed(bits, uncompressed));
+        }
+        else if (btype == BT_FIXED_HUFFMAN)
+        {
+            build_fixed_tables();
+            TRY(read_huffman(bits, uncompressed, _fixed_lit_len, _fixed_dist));
+        }
+        else if (btype == BT_DYNAMIC_HUFFMAN)
+        {
+            TRY(build_dynamic_tables(bits));
+            TRY(read_huffman(bits, uncompressed, _lit_len, _dist));
         }
         else
         {
@@ -331,15 +637,26 @@ FLATTEN HjResult Inflate::read_blocks(IO::Reader &reader, IO::Writer &uncompress
         }
     } while (!bfinal);
 
-    auto final_reader = IO::MemoryReader(Slice(dest_writer.slice()));
-    return IO::copy(final_reader, uncompressed);
+    TRY(flush_window(uncompressed));
+
+    return uncompressed.flush();
 }
 
-FLATTEN ResultOr<size_t> Inflate::perform(IO::Reader &compressed, IO::Writer &uncompressed)
+ResultOr<size_t> Inflate::perform(IO::Reader &compressed, IO::Writer &uncompressed)
 {
-    IO::ReadCounter counter{compressed};
-    TRY(read_blocks(counter, uncompressed));
-    return counter.count();
+    Bits bits{compressed};
+
+    _window = new uint8_t[WINDOW_CAPACITY];
+    auto result = read_blocks(bits, uncompressed);
+    delete[] _window;
+    _window = nullptr;
+
+    if (result != SUCCESS)
+    {
+        return result;
+    }
+
+    return bits.consumed();
 }
 
 } // namespace Compression
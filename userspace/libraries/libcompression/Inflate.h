@@ -1,45 +1,73 @@
 #pragma once
 
 #include <abi/Result.h>
-#include <libio/BitReader.h>
-#include <libio/Read.h>
-#include <libio/ReadCounter.h>
+#include <libio/Reader.h>
 #include <libio/Writer.h>
-#include <libutils/Assert.h>
-#include <libutils/HashMap.h>
 #include <libutils/Prelude.h>
-#include <libutils/Vec.h>
 
 namespace Compression
 {
 
+// Symbols are decoded through zlib-style lookup tables: the next root bits of
+// the input index a table giving the symbol and the length of its code, codes
+// longer than that continue in a subtable. Output goes through a 32 KiB
+// sliding window which is handed to the writer as it fills up.
 struct Inflate
 {
 private:
-    // Fixed huffmann
-    Vec<unsigned int> _fixed_alphabet;
-    Vec<unsigned int> _fixed_code_bit_lengths;
-    Vec<unsigned int> _fixed_dist_alphabet;
-    Vec<unsigned int> _fixed_dist_code_bit_lengths;
+    struct HuffmanEntry
+    {
+        // Symbol, or offset of the subtable for links.
+        uint16_t value;
 
-    // Dynamic huffmann
-    Vec<unsigned int> _lit_len_alphabet;
-    Vec<unsigned int> _lit_len_code_bit_length;
-    Vec<unsigned int> _dist_code_bit_length;
-    Vec<unsigned int> _dist_alphabet;
+        // Bits to drop for symbols, index bits of the subtable for links.
+        uint8_t bits;
 
-    void build_fixed_huffman_alphabet();
-    HjResult build_dynamic_huffman_alphabet(IO::BitReader &input);
-    void build_huffman_alphabet(Vec<unsigned int> &alphabet, const Vec<unsigned int> &code_bit_lengths);
+        uint8_t kind;
+    };
 
-    void get_bit_length_count(HashMap<unsigned int, unsigned int> &bit_length_count, const Vec<unsigned int> &code_bit_lengths);
-    void get_first_code(HashMap<unsigned int, unsigned int> &firstCodes, HashMap<unsigned int, unsigned int> &bit_length_count);
-    void assign_huffman_codes(Vec<unsigned int> &assigned_codes, const Vec<unsigned int> &code_bit_lengths, HashMap<unsigned int, unsigned int> &first_codes);
+    struct Bits;
 
-    HjResult read_blocks(IO::Reader &reader, IO::Writer &uncompressed);
+    static constexpr int LIT_LEN_ROOT_BITS = 9;
+    static constexpr int DIST_ROOT_BITS = 6;
+    static constexpr int CODE_LENGTH_ROOT_BITS = 7;
+
+    // Largest tables possible for these root sizes, see zlib's "enough".
+    static constexpr size_t LIT_LEN_TABLE_SIZE = 852;
+    static constexpr size_t DIST_TABLE_SIZE = 592;
+    static constexpr size_t CODE_LENGTH_TABLE_SIZE = 1 << CODE_LENGTH_ROOT_BITS;
+
+    HuffmanEntry _fixed_lit_len[LIT_LEN_TABLE_SIZE];
+    HuffmanEntry _fixed_dist[DIST_TABLE_SIZE];
+    bool _fixed_built = false;
+
+    HuffmanEntry _lit_len[LIT_LEN_TABLE_SIZE];
+    HuffmanEntry _dist[DIST_TABLE_SIZE];
+
+    uint8_t *_window = nullptr;
+    size_t _window_head = 0;
+    size_t _window_flushed = 0;
+
+    static HjResult build_table(HuffmanEntry *table, size_t table_size, int root_bits, const uint8_t *code_lengths, size_t count);
+
+    static unsigned int decode(Bits &bits, const HuffmanEntry *table, int root_bits);
+
+    void build_fixed_tables();
+
+    HjResult build_dynamic_tables(Bits &bits);
+
+    HjResult flush_window(IO::Writer &uncompressed);
+
+    HjResult read_uncompressed(Bits &bits, IO::Writer &uncompressed);
+
+    HjResult read_huffman(Bits &bits, IO::Writer &uncompressed, const HuffmanEntry *lit_len, const HuffmanEntry *dist);
+
+    HjResult read_blocks(Bits &bits, IO::Writer &uncompressed);
 
 public:
+    // Returns how many bytes of compressed data were used, the reader might
+    // have been read a little further than that.
     ResultOr<size_t> perform(IO::Reader &compressed, IO::Writer &uncompressed);
 };
 
-} // namespace Compression
\ No newline at end of file
+} // namespace Compression
@@ -38,39 +38,43 @@ struct PACKED TARRawBlock
     }
 };
 
-bool tar_read(void *tarfile, TARBlock *block, size_t index)
+Iter tar_iterate(void *tarfile, size_t size, IterFunc<TARBlock &> callback)
 {
-    TARRawBlock *header = (TARRawBlock *)tarfile;
+    size_t offset = 0;
 
-    for (size_t i = 0; i < index; i++)
+    while (offset + sizeof(TARRawBlock) <= size)
     {
+        TARRawBlock *header = (TARRawBlock *)((char *)tarfile + offset);
+
         if (header->name[0] == '\0')
         {
-            return false;
+            break;
         }
 
-        size_t size = header->file_size();
-
-        header = (TARRawBlock *)((char *)header + ((size / 512) + 1) * 512);
+        TARBlock block;
+        memcpy(block.name, header->name, 100);
+        block.name[100] = '\0';
+        block.size = header->file_size();
+        block.typeflag = header->typeflag;
+        memcpy(block.linkname, header->linkname, 100);
+        block.linkname[100] = '\0';
+        block.data = (char *)header + sizeof(TARRawBlock);
+
+        // Truncated archive
+        if (block.size > size - offset - sizeof(TARRawBlock))
+        {
+            break;
+        }
 
-        if (size % 512)
+        if (callback(block) == Iter::STOP)
         {
-            header = (TARRawBlock *)((char *)header + 512);
+            return Iter::STOP;
         }
-    }
 
-    if (header->name[0] == '\0')
-    {
-        return false;
+        offset += sizeof(TARRawBlock) + ALIGN_UP(block.size, 512);
     }
 
-    memcpy(block->name, header->name, 100);
-    block->size = header->file_size();
-    block->typeflag = header->typeflag;
-    memcpy(block->linkname, header->linkname, 100);
-    block->data = (char *)header + 512;
-
-    return true;
+    return Iter::CONTINUE;
 }
 
 #ifndef __KERNEL__
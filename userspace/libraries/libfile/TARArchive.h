@@ -1,17 +1,20 @@
 #pragma once
 
 #include <libfile/Archive.h>
+#include <libutils/Iter.h>
 
 struct TARBlock
 {
-    char name[100];
+    char name[101];
     char typeflag;
-    char linkname[100];
+    char linkname[101];
     size_t size;
     char *data;
 };
 
-bool tar_read(void *tarfile, TARBlock *block, size_t index);
+// Walks the `size` bytes long archive at `tarfile` once, from the first to the
+// last entry. Block data points into the archive, nothing is copied.
+Iter tar_iterate(void *tarfile, size_t size, IterFunc<TARBlock &> callback);
 
 struct TARArchive final : public Archive
 {
@@ -6,6 +6,7 @@
 #include <libio/MemoryReader.h>
 #include <libio/MemoryWriter.h>
 #include <libio/Read.h>
+#include <libio/ReadCounter.h>
 #include <libio/ScopedReader.h>
 #include <libio/Skip.h>
 #include <libio/Streams.h>
@@ -2,6 +2,7 @@
 #include <libgraphic/svg/Svg.h>
 #include <libio/Copy.h>
 #include <libio/File.h>
+#include <libio/MappedFile.h>
 #include <libio/MemoryReader.h>
 #include <libio/Path.h>
 #include <libio/Streams.h>
@@ -20,7 +21,7 @@ static Color _placeholder_buffer[] = {
 ResultOr<RefPtr<Bitmap>> Bitmap::create_shared(int width, int height)
 {
     Color *pixels = nullptr;
-    TRY(memory_alloc(width * height * sizeof(Color), reinterpret_cast<uintptr_t *>(&pixels)));
+    TRY(memory_alloc(width * height * sizeof(Color), MEMORY_SHARED, reinterpret_cast<uintptr_t *>(&pixels)));
 
     int handle = -1;
     memory_get_handle(reinterpret_cast<uintptr_t>(pixels), &handle);
@@ -61,21 +62,23 @@ RefPtr<Bitmap> Bitmap::placeholder()
 
 ResultOr<RefPtr<Bitmap>> Bitmap::load_from(String path, int size_hint)
 {
-    IO::File file{path, HJ_OPEN_READ};
+    IO::MappedFile file{path};
 
     if (!file.exist())
     {
-        return ERR_NO_SUCH_FILE_OR_DIRECTORY;
+        return file.result();
     }
 
+    IO::MemoryReader reader{file.slice()};
+
     IO::Path p = IO::Path::parse(path);
     if (p.extension() == ".png")
     {
-        return Png::load(file);
+        return Png::load(reader);
     }
     else if (p.extension() == ".svg")
     {
-        return Svg::render(file, size_hint);
+        return Svg::render(reader, size_hint);
     }
     IO::logln("Unknown bitmap extension: {}", p.extension());
     return ERR_NOT_IMPLEMENTED;
@@ -0,0 +1,394 @@
+#include <math.h>
+#include <string.h>
+
+#include <libgraphic/Blur.h>
+#include <libutils/Vec.h>
+
+#ifdef __SSE2__
+#    include <emmintrin.h>
+#endif
+
+namespace Graphic
+{
+
+static constexpr int BOX_PASSES = 3;
+static constexpr int MAX_BOX_RADIUS = 63;
+
+// Each level of the pyramid halves the size of the region. The blur runs on
+// the smallest level where the kernel still covers a few pixels.
+static constexpr int MAX_LEVEL = 3;
+static constexpr float MIN_LEVEL_SIGMA = 1.5;
+
+static Vec<Color> _front;
+static Vec<Color> _back;
+static Vec<uint16_t> _sums;
+static Vec<uint16_t> _row;
+static Vec<int> _columns;
+static Vec<int> _weights;
+
+// The sizes of the boxes whose sum has the variance of the gaussian.
+static void box_radii(float sigma, int radii[BOX_PASSES])
+{
+    float ideal = sqrtf(12 * sigma * sigma / BOX_PASSES + 1);
+    int lower = (int)ideal;
+
+    if (lower % 2 == 0)
+    {
+        lower--;
+    }
+
+    float lower_count = (12 * sigma * sigma - BOX_PASSES * lower * lower - 4 * BOX_PASSES * lower - 3 * BOX_PASSES) / (-4.0f * lower - 4);
+    int count = clamp((int)roundf(lower_count), 0, BOX_PASSES);
+
+    for (int i = 0; i < BOX_PASSES; i++)
+    {
+        radii[i] = MIN(((i < count ? lower : lower + 2) - 1) / 2, MAX_BOX_RADIUS);
+    }
+}
+
+// The sums of a box start at half its size, so multiplying by the rounded up
+// inverse and keeping the high half is the sum divided by the size and
+// rounded to nearest. A box is at most 127 pixels wide, which keeps the sums
+// in 16 bits.
+static uint16_t box_inverse(int radius)
+{
+    int size = 2 * radius + 1;
+    return (65536 + size - 1) / size;
+}
+
+#ifdef __SSE2__
+
+// Two rows go through the same registers, the pixel of the first one in the
+// low half and the one of the second in the high half.
+static inline __m128i load_pixels(const Color *first, const Color *second, int x)
+{
+    int a, b;
+    memcpy(&a, first + x, sizeof(Color));
+    memcpy(&b, second + x, sizeof(Color));
+
+    __m128i packed = _mm_unpacklo_epi32(_mm_cvtsi32_si128(a), _mm_cvtsi32_si128(b));
+    return _mm_unpacklo_epi8(packed, _mm_setzero_si128());
+}
+
+static inline void store_pixels(Color *first, Color *second, int x, __m128i value)
+{
+    __m128i packed = _mm_packus_epi16(value, value);
+
+    int a = _mm_cvtsi128_si32(packed);
+    int b = _mm_cvtsi128_si32(_mm_srli_si128(packed, 4));
+
+    memcpy(second + x, &b, sizeof(Color));
+    memcpy(first + x, &a, sizeof(Color));
+}
+
+static void box_rows(const Color *source, Color *destination, int width, int height, int radius)
+{
+    __m128i inverse = _mm_set1_epi16(box_inverse(radius));
+
+    for (int y = 0; y < height; y += 2)
+    {
+        // The last row of an odd height is done twice.
+        int next = MIN(y + 1, height - 1);
+
+        const Color *first = source + y * width;
+        const Color *second = source + next * width;
+
+        __m128i sum = _mm_add_epi16(
+            _mm_set1_epi16(radius),
+            _mm_mullo_epi16(load_pixels(first, second, 0), _mm_set1_epi16(radius + 1)));
+
+        for (int i = 1; i <= radius; i++)
+        {
+            sum = _mm_add_epi16(sum, load_pixels(first, second, MIN(i, width - 1)));
+        }
+
+        Color *out_first = destination + y * width;
+        Color *out_second = destination + next * width;
+
+        for (int x = 0; x < width; x++)
+        {
+            store_pixels(out_first, out_second, x, _mm_mulhi_epu16(sum, inverse));
+
+            sum = _mm_add_epi16(sum, load_pixels(first, second, MIN(x + radius + 1, width - 1)));
+            sum = _mm_sub_epi16(sum, load_pixels(first, second, MAX(x - radius, 0)));
+        }
+    }
+}
+
+#else
+
+static void box_rows(const Color *source, Color *destination, int width, int height, int radius)
+{
+    uint32_t inverse = box_inverse(radius);
+
+    for (int y = 0; y < height; y++)
+    {
+        auto *in = reinterpret_cast<const uint8_t *>(source + y * width);
+        auto *out = reinterpret_cast<uint8_t *>(destination + y * width);
+
+        uint32_t sum[4];
+
+        for (int c = 0; c < 4; c++)
+        {
+            sum[c] = radius + in[c] * (radius + 1);
+
+            for (int i = 1; i <= radius; i++)
+            {
+                sum[c] += in[MIN(i, width - 1) * 4 + c];
+            }
+        }
+
+        for (int x = 0; x < width; x++)
+        {
+            int add = MIN(x + radius + 1, width - 1) * 4;
+            int remove = MAX(x - radius, 0) * 4;
+
+            for (int c = 0; c < 4; c++)
+            {
+                out[x * 4 + c] = (sum[c] * inverse) >> 16;
+                sum[c] += in[add + c] - in[remove + c];
+            }
+        }
+    }
+}
+
+#endif
+
+// Writes one row of averages and slides the sums of every column down by a
+// row.
+static void box_step(uint16_t *__restrict sum, uint8_t *__restrict out,
+                     const uint8_t *__restrict add, const uint8_t *__restrict remove,
+                     size_t count, uint16_t inverse)
+{
+    size_t i = 0;
+
+#ifdef __SSE2__
+    __m128i zero = _mm_setzero_si128();
+    __m128i inverses = _mm_set1_epi16(inverse);
+
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i low = _mm_loadu_si128(reinterpret_cast<__m128i *>(sum + i));
+        __m128i high = _mm_loadu_si128(reinterpret_cast<__m128i *>(sum + i + 8));
+
+        __m128i averages = _mm_packus_epi16(_mm_mulhi_epu16(low, inverses), _mm_mulhi_epu16(high, inverses));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), averages);
+
+        __m128i added = _mm_loadu_si128(reinterpret_cast<const __m128i *>(add + i));
+        __m128i removed = _mm_loadu_si128(reinterpret_cast<const __m128i *>(remove + i));
+
+        low = _mm_add_epi16(low, _mm_unpacklo_epi8(added, zero));
+        low = _mm_sub_epi16(low, _mm_unpacklo_epi8(removed, zero));
+        high = _mm_add_epi16(high, _mm_unpackhi_epi8(added, zero));
+        high = _mm_sub_epi16(high, _mm_unpackhi_epi8(removed, zero));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(sum + i), low);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(sum + i + 8), high);
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        out[i] = (sum[i] * inverse) >> 16;
+        sum[i] += add[i] - remove[i];
+    }
+}
+
+// Runs down all the columns at once, one row at a time, so the inner loops
+// go over contiguous bytes.
+static void box_columns(const Color *source, Color *destination, int width, int height, int radius)
+{
+    uint16_t inverse = box_inverse(radius);
+    size_t count = width * 4;
+
+    _sums.resize(count);
+    uint16_t *sum = _sums.raw_storage();
+
+    auto row = [&](int y) {
+        return reinterpret_cast<const uint8_t *>(source + clamp(y, 0, height - 1) * width);
+    };
+
+    for (size_t i = 0; i < count; i++)
+    {
+        sum[i] = radius + row(0)[i] * (radius + 1);
+    }
+
+    for (int y = 1; y <= radius; y++)
+    {
+        auto *in = row(y);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            sum[i] += in[i];
+        }
+    }
+
+    for (int y = 0; y < height; y++)
+    {
+        auto *out = reinterpret_cast<uint8_t *>(destination + y * width);
+        auto *add = row(y + radius + 1);
+        auto *remove = row(y - radius);
+
+        box_step(sum, out, add, remove, count, inverse);
+    }
+}
+
+// Averages each block of 2x2 pixels, the last row and column are repeated
+// when the size is odd.
+static void downsample(const Color *source, int stride, int width, int height, Color *destination)
+{
+    int half_width = (width + 1) / 2;
+    int half_height = (height + 1) / 2;
+
+    for (int y = 0; y < half_height; y++)
+    {
+        auto *top = reinterpret_cast<const uint8_t *>(source + y * 2 * stride);
+        auto *bottom = reinterpret_cast<const uint8_t *>(source + MIN(y * 2 + 1, height - 1) * stride);
+        auto *out = reinterpret_cast<uint8_t *>(destination + y * half_width);
+
+        for (int x = 0; x < half_width; x++)
+        {
+            int left = x * 8;
+            int right = MIN(x * 2 + 1, width - 1) * 4;
+
+            for (int c = 0; c < 4; c++)
+            {
+                out[x * 4 + c] = (top[left + c] + top[right + c] + bottom[left + c] + bottom[right + c] + 2) / 4;
+            }
+        }
+    }
+}
+
+// Where the center of each pixel of the region falls on the level, as the
+// first of the two pixels to interpolate between and the weight of the
+// second one out of 256.
+static void upsample_table(int size, int level_size, int scale, Vec<int> &positions, Vec<int> &weights)
+{
+    positions.resize(size);
+    weights.resize(size);
+
+    for (int i = 0; i < size; i++)
+    {
+        float position = clamp((i + 0.5f) / scale - 0.5f, 0, level_size - 1);
+        int first = MIN((int)position, level_size - 1);
+
+        positions[i] = first;
+        weights[i] = (int)((position - first) * 256);
+    }
+}
+
+static void upsample(const Color *source, int level_width, int level_height, int scale, Color *destination, int stride, int width, int height)
+{
+    upsample_table(width, level_width, scale, _columns, _weights);
+
+    _row.resize(level_width * 4);
+    uint16_t *row = _row.raw_storage();
+
+    for (int y = 0; y < height; y++)
+    {
+        float position = clamp((y + 0.5f) / scale - 0.5f, 0, level_height - 1);
+        int first = MIN((int)position, level_height - 1);
+        uint32_t weight = (position - first) * 256;
+
+        auto *top = reinterpret_cast<const uint8_t *>(source + first * level_width);
+        auto *bottom = reinterpret_cast<const uint8_t *>(source + MIN(first + 1, level_height - 1) * level_width);
+
+        for (int i = 0; i < level_width * 4; i++)
+        {
+            row[i] = top[i] * (256 - weight) + bottom[i] * weight;
+        }
+
+        auto *out = reinterpret_cast<uint8_t *>(destination + y * stride);
+
+        for (int x = 0; x < width; x++)
+        {
+            int left = _columns[x] * 4;
+            int right = MIN(_columns[x] + 1, level_width - 1) * 4;
+            uint32_t right_weight = _weights[x];
+
+            for (int c = 0; c < 4; c++)
+            {
+                out[x * 4 + c] = (row[left + c] * (256 - right_weight) + row[right + c] * right_weight + 32768) >> 16;
+            }
+        }
+    }
+}
+
+void blur(Bitmap &bitmap, Math::Recti region, int radius)
+{
+    region = region.clipped_with(bitmap.bound());
+
+    if (region.is_empty() || radius <= 0)
+    {
+        return;
+    }
+
+    // The variance of the tent shaped kernel of a stack blur.
+    float sigma = sqrtf(radius * (radius + 2) / 6.0f);
+
+    int level = 0;
+
+    while (level < MAX_LEVEL &&
+           sigma / (2 << level) >= MIN_LEVEL_SIGMA &&
+           (region.width() >> (level + 1)) >= 2 &&
+           (region.height() >> (level + 1)) >= 2)
+    {
+        level++;
+    }
+
+    Color *pixels = bitmap.pixels() + region.y() * bitmap.width() + region.x();
+
+    int width = region.width();
+    int height = region.height();
+
+    _front.resize(width * height);
+    _back.resize(width * height);
+
+    if (level == 0)
+    {
+        for (int y = 0; y < height; y++)
+        {
+            memcpy(_front.raw_storage() + y * width, pixels + y * bitmap.width(), width * sizeof(Color));
+        }
+    }
+    else
+    {
+        downsample(pixels, bitmap.width(), width, height, _front.raw_storage());
+        width = (width + 1) / 2;
+        height = (height + 1) / 2;
+
+        for (int i = 1; i < level; i++)
+        {
+            downsample(_front.raw_storage(), width, width, height, _back.raw_storage());
+            width = (width + 1) / 2;
+            height = (height + 1) / 2;
+            std::swap(_front, _back);
+        }
+    }
+
+    int radii[BOX_PASSES];
+    box_radii(sigma / (1 << level), radii);
+
+    for (int i = 0; i < BOX_PASSES; i++)
+    {
+        if (radii[i] > 0)
+        {
+            box_rows(_front.raw_storage(), _back.raw_storage(), width, height, radii[i]);
+            box_columns(_back.raw_storage(), _front.raw_storage(), width, height, radii[i]);
+        }
+    }
+
+    if (level == 0)
+    {
+        for (int y = 0; y < height; y++)
+        {
+            memcpy(pixels + y * bitmap.width(), _front.raw_storage() + y * width, width * sizeof(Color));
+        }
+    }
+    else
+    {
+        upsample(_front.raw_storage(), width, height, 1 << level, pixels, bitmap.width(), region.width(), region.height());
+    }
+}
+
+} // namespace Graphic
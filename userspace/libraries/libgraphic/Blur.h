@@ -0,0 +1,16 @@
+#pragma once
+
+#include <libgraphic/Bitmap.h>
+
+namespace Graphic
+{
+
+// Blurs the pixels of `region` in place. The kernel is close to a gaussian and
+// spreads as far as the one of a stack blur of the same radius. Three box
+// blurs are run in each direction, the edges of the region are extended and
+// the pixels outside of it are never read. Large radii are blurred on a
+// downsampled copy of the region that is scaled back up, the buffers are
+// kept from one call to the next.
+void blur(Bitmap &bitmap, Math::Recti region, int radius);
+
+} // namespace Graphic
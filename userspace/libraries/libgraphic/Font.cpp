@@ -1,10 +1,9 @@
 #include <stdio.h>
 
 #include <libgraphic/Font.h>
-#include <libio/File.h>
 #include <libio/Format.h>
+#include <libio/MappedFile.h>
 #include <libio/Path.h>
-#include <libio/Read.h>
 #include <libio/Streams.h>
 #include <libutils/HashMap.h>
 
@@ -16,16 +15,15 @@ static HashMap<String, RefPtr<Font>> _fonts;
 static ResultOr<Vec<Glyph>> font_load_glyph(String name)
 {
     auto path = IO::format("/files/fonts/{}.glyph", name);
-    IO::File glyph_file{path, HJ_OPEN_READ};
+    IO::MappedFile glyph_file{path};
 
     if (!glyph_file.exist())
     {
-        return ERR_NO_SUCH_FILE_OR_DIRECTORY;
+        return glyph_file.result();
     }
 
     Vec<Glyph> glyphs;
-
-    TRY(IO::read_vector(glyph_file, glyphs));
+    glyphs.push_back_many(static_cast<const Glyph *>(glyph_file.data()), glyph_file.size() / sizeof(Glyph));
 
     return glyphs;
 }
@@ -61,30 +59,150 @@ ResultOr<RefPtr<Font>> Font::get(String name)
     return _fonts[name];
 }
 
-bool Font::has(Text::Rune rune) const
+Font::Font(RefPtr<Bitmap> bitmap, Vec<Glyph> glyphs)
+    : _bitmap(bitmap),
+      _glyphs(std::move(glyphs))
+{
+    for (size_t i = 0; i < _direct.count(); i++)
+    {
+        _direct[i] = -1;
+    }
+
+    for (size_t i = 0; i < _glyphs.count() && _glyphs[i].rune != 0; i++)
+    {
+        if (_glyphs[i].rune < DIRECT_RUNES)
+        {
+            _direct[_glyphs[i].rune] = i;
+        }
+        else
+        {
+            _sorted.push_back(i);
+        }
+    }
+
+    _sorted.sort([&](int a, int b) {
+        return (int)_glyphs[a].rune - (int)_glyphs[b].rune;
+    });
+
+    _default = glyph(U'?');
+}
+
+int Font::index_of(Text::Rune rune) const
 {
-    for (int i = 0; _glyphs[i].rune != 0; i++)
+    if (rune < DIRECT_RUNES)
+    {
+        return _direct[rune];
+    }
+
+    size_t lower = 0;
+    size_t upper = _sorted.count();
+
+    while (lower < upper)
     {
-        if (_glyphs[i].rune == rune)
+        size_t middle = (lower + upper) / 2;
+        Text::Rune candidate = _glyphs[_sorted[middle]].rune;
+
+        if (candidate == rune)
+        {
+            return _sorted[middle];
+        }
+        else if (candidate < rune)
         {
-            return true;
+            lower = middle + 1;
+        }
+        else
+        {
+            upper = middle;
         }
     }
 
-    return false;
+    return -1;
+}
+
+bool Font::has(Text::Rune rune) const
+{
+    return index_of(rune) >= 0;
 }
 
 const Glyph &Font::glyph(Text::Rune rune) const
 {
-    for (int i = 0; _glyphs[i].rune != 0; i++)
+    int index = index_of(rune);
+
+    if (index < 0)
+    {
+        return _default;
+    }
+
+    return _glyphs[index];
+}
+
+Font::Tint &Font::tint(Color color)
+{
+    for (size_t i = 0; i < _tints.count(); i++)
+    {
+        if (_tints[i]->color == color)
+        {
+            if (i > 0)
+            {
+                _tints.push(_tints.take_at(i));
+            }
+
+            return *_tints[0];
+        }
+    }
+
+    if (_tints.count() == MAX_TINTS)
+    {
+        _tints.pop_back();
+    }
+
+    auto tint = own<Tint>();
+    tint->color = color;
+    tint->offsets.resize(_glyphs.count());
+
+    for (size_t i = 0; i < tint->offsets.count(); i++)
+    {
+        tint->offsets[i] = -1;
+    }
+
+    _tints.push(std::move(tint));
+
+    return *_tints[0];
+}
+
+const Color *Font::tinted(const Glyph &glyph, Color color)
+{
+    int index = index_of(glyph.rune);
+
+    // A glyph of another font can have the same rune, but not the same
+    // bound in the bitmap.
+    if (index < 0 || (&glyph != &_glyphs[index] && &glyph != &_default))
     {
-        if (_glyphs[i].rune == rune)
+        return nullptr;
+    }
+
+    auto &tint = Font::tint(color);
+
+    if (tint.offsets[index] < 0)
+    {
+        auto bound = _glyphs[index].bound;
+
+        tint.offsets[index] = tint.pixels.count();
+
+        for (int y = bound.top(); y < bound.bottom(); y++)
         {
-            return _glyphs[i];
+            for (int x = bound.left(); x < bound.right(); x++)
+            {
+                // Same as (red * alpha) / 255 for any pair of bytes.
+                unsigned int alpha = _bitmap->get_pixel({x, y}).red() * color.alpha();
+                alpha = (alpha + 1 + (alpha >> 8)) >> 8;
+
+                tint.pixels.push_back(color.with_alpha_byte(alpha));
+            }
         }
     }
 
-    return _default;
+    return tint.pixels.raw_storage() + tint.offsets[index];
 }
 
 Math::Recti Font::mesure(Text::Rune rune) const
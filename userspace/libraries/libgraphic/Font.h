@@ -2,6 +2,8 @@
 
 #include <libgraphic/Bitmap.h>
 #include <libtext/Rune.h>
+#include <libutils/Array.h>
+#include <libutils/OwnPtr.h>
 #include <libutils/String.h>
 #include <libutils/Vec.h>
 
@@ -52,10 +54,33 @@ struct Glyph
 struct Font : public RefCounted<Font>
 {
 private:
+    // ASCII, Latin-1 and the Latin extended blocks.
+    static constexpr auto DIRECT_RUNES = 0x250;
+    static constexpr auto MAX_TINTS = 32;
+
+    struct Tint
+    {
+        Color color;
+        Vec<int> offsets;
+        Vec<Color> pixels;
+    };
+
     RefPtr<Bitmap> _bitmap;
     Glyph _default;
     Vec<Glyph> _glyphs;
 
+    // Index of the glyph of each rune below DIRECT_RUNES, or -1 if the font
+    // doesn't have it. The indexes of the other glyphs, sorted by rune.
+    Array<int, DIRECT_RUNES> _direct;
+    Vec<int> _sorted;
+
+    // Glyphs already blended with a color, the most recently used first.
+    Vec<OwnPtr<Tint>> _tints;
+
+    int index_of(Text::Rune rune) const;
+
+    Tint &tint(Color color);
+
 public:
     const FontMetrics metrics() const
     {
@@ -66,17 +91,17 @@ public:
 
     static ResultOr<RefPtr<Font>> get(String name);
 
-    Font(RefPtr<Bitmap> bitmap, Vec<Glyph> glyphs)
-        : _bitmap(bitmap),
-          _glyphs(std::move(glyphs))
-    {
-        _default = glyph(U'?');
-    }
+    Font(RefPtr<Bitmap> bitmap, Vec<Glyph> glyphs);
 
     bool has(Text::Rune rune) const;
 
     const Glyph &glyph(Text::Rune rune) const;
 
+    // The pixels of the glyph in `color`, with the alpha of the font bitmap,
+    // one row after the other. They stay valid until the next call. Returns
+    // nullptr if the glyph isn't from this font.
+    const Color *tinted(const Glyph &glyph, Color color);
+
     Math::Recti mesure(Text::Rune rune) const;
 
     Math::Recti mesure(const char *string) const;
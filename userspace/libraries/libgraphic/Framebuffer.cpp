@@ -97,24 +97,42 @@ void Framebuffer::blit()
         return;
     }
 
-    _dirty_bounds.foreach([&](auto &bound)
-        {
-            IOCallDisplayBlitArgs args;
+    Vec<IOCallDisplayRect> damages;
 
-            args.buffer = reinterpret_cast<uint32_t *>(_bitmap->pixels());
-            args.buffer_width = _bitmap->width();
-            args.buffer_height = _bitmap->height();
+    if (_dirty_bounds.count() > IOCALL_DISPLAY_PRESENT_MAX_DAMAGES)
+    {
+        // More than the display takes, present everything they cover.
+        Math::Recti bound = _dirty_bounds[0];
 
-            args.blit_x = bound.x();
-            args.blit_y = bound.y();
-            args.blit_width = bound.width();
-            args.blit_height = bound.height();
+        _dirty_bounds.foreach([&](auto &region)
+            {
+                bound = bound.merged_with(region);
 
-            __plug_handle_call(&_handle, IOCALL_DISPLAY_BLIT, &args);
+                return Iter::CONTINUE;
+            });
+
+        _dirty_bounds.clear();
+        _dirty_bounds.push_back(bound);
+    }
+
+    _dirty_bounds.foreach([&](auto &bound)
+        {
+            damages.push_back({bound.x(), bound.y(), bound.width(), bound.height()});
 
             return Iter::CONTINUE;
         });
 
+    IOCallDisplayPresentArgs args;
+
+    args.buffer = reinterpret_cast<uint32_t *>(_bitmap->pixels());
+    args.buffer_width = _bitmap->width();
+    args.buffer_height = _bitmap->height();
+
+    args.damages = damages.raw_storage();
+    args.damages_count = damages.count();
+
+    __plug_handle_call(&_handle, IOCALL_DISPLAY_PRESENT, &args);
+
     _dirty_bounds.clear();
 }
 
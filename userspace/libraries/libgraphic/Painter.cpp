@@ -1,9 +1,10 @@
 #include <math.h>
 #include <stdlib.h>
 
+#include <libgraphic/Blur.h>
 #include <libgraphic/Font.h>
 #include <libgraphic/Painter.h>
-#include <libgraphic/StackBlur.h>
+#include <libgraphic/Spans.h>
 #include <libmath/Random.h>
 #include <libutils/Assert.h>
 
@@ -31,6 +32,21 @@ void Painter::blit_fast(Bitmap &bitmap, Math::Recti source, Math::Recti destinat
         return;
     }
 
+    Math::Recti source_rows{result.source.position(), result.destination.size()};
+
+    if (bitmap.bound().contains(source_rows))
+    {
+        for (int y = 0; y < result.destination.height(); y++)
+        {
+            span_blend(
+                _bitmap.pixels() + (result.destination.y() + y) * _bitmap.width() + result.destination.x(),
+                bitmap.pixels() + (source_rows.y() + y) * bitmap.width() + source_rows.x(),
+                result.destination.width());
+        }
+
+        return;
+    }
+
     for (int y = 0; y < result.destination.height(); y++)
     {
         for (int x = 0; x < result.destination.width(); x++)
@@ -43,6 +59,35 @@ void Painter::blit_fast(Bitmap &bitmap, Math::Recti source, Math::Recti destinat
     }
 }
 
+void Painter::blit_no_alpha(Bitmap &bitmap, Math::Recti source, Math::Recti destination)
+{
+    if (source.width() != destination.width() ||
+        source.height() != destination.height())
+    {
+        blit(bitmap, source, destination);
+        return;
+    }
+
+    auto result = _stack.apply(source, destination);
+
+    if (result.is_empty())
+    {
+        return;
+    }
+
+    Math::Recti source_rows{result.source.position(), result.destination.size()};
+    Math::Recti clipped_rows = source_rows.clipped_with(bitmap.bound());
+    Math::Vec2i origin = result.destination.position() + clipped_rows.position() - source_rows.position();
+
+    for (int y = 0; y < clipped_rows.height(); y++)
+    {
+        span_copy(
+            _bitmap.pixels() + (origin.y() + y) * _bitmap.width() + origin.x(),
+            bitmap.pixels() + (clipped_rows.y() + y) * bitmap.width() + clipped_rows.x(),
+            clipped_rows.width());
+    }
+}
+
 void Painter::blit_scaled(Bitmap &bitmap, Math::Recti source, Math::Recti destination)
 {
     auto result = _stack.apply(source, destination);
@@ -116,12 +161,9 @@ FLATTEN void Painter::clear(Math::Recti rectangle, Color color)
         return;
     }
 
-    for (int y = 0; y < rectangle.height(); y++)
+    for (int y = rectangle.y(); y < rectangle.y() + rectangle.height(); y++)
     {
-        for (int x = 0; x < rectangle.width(); x++)
-        {
-            _bitmap.set_pixel_no_check(Math::Vec2i(rectangle.x() + x, rectangle.y() + y), color);
-        }
+        span_fill(_bitmap.pixels() + y * _bitmap.width() + rectangle.x(), color, rectangle.width());
     }
 }
 
@@ -144,12 +186,9 @@ FLATTEN void Painter::fill_rectangle(Math::Recti rectangle, Color color)
         return;
     }
 
-    for (int y = 0; y < rectangle.height(); y++)
+    for (int y = rectangle.y(); y < rectangle.y() + rectangle.height(); y++)
     {
-        for (int x = 0; x < rectangle.width(); x++)
-        {
-            _bitmap.blend_pixel_no_check(Math::Vec2i(rectangle.x() + x, rectangle.y() + y), color);
-        }
+        span_blend_color(_bitmap.pixels() + y * _bitmap.width() + rectangle.x(), color, rectangle.width());
     }
 }
 
@@ -476,6 +515,33 @@ FLATTEN void Painter::blit(Icon &icon, IconSize size, Math::Recti destination, C
 
 FLATTEN void Painter::blit_colored(Bitmap &bitmap, Math::Recti source, Math::Recti destination, Color color)
 {
+    if (source.width() == destination.width() &&
+        source.height() == destination.height())
+    {
+        auto result = _stack.apply(source, destination);
+
+        if (result.is_empty())
+        {
+            return;
+        }
+
+        Math::Recti source_rows{result.source.position(), result.destination.size()};
+
+        if (bitmap.bound().contains(source_rows))
+        {
+            for (int y = 0; y < result.destination.height(); y++)
+            {
+                span_blend_mask(
+                    _bitmap.pixels() + (result.destination.y() + y) * _bitmap.width() + result.destination.x(),
+                    bitmap.pixels() + (source_rows.y() + y) * bitmap.width() + source_rows.x(),
+                    color,
+                    result.destination.width());
+            }
+
+            return;
+        }
+    }
+
     for (int y = 0; y < destination.height(); y++)
     {
         for (int x = 0; x < destination.width(); x++)
@@ -510,7 +576,29 @@ void Painter::draw_glyph(Font &font, const Glyph &glyph, Math::Vec2i position, C
     //  draw_metric(metrics.descend(baseline), Colors::ORANGE);
     //  draw_metric(metrics.fulldescend(baseline), Colors::RED);
 
-    blit_colored(font.bitmap(), glyph.bound, dest, color);
+    auto result = _stack.apply(glyph.bound.size(), dest);
+
+    if (result.is_empty())
+    {
+        return;
+    }
+
+    Math::Recti source_rows{result.source.position(), result.destination.size()};
+    const Color *pixels = font.tinted(glyph, color);
+
+    if (pixels == nullptr || !Math::Recti{glyph.bound.size()}.contains(source_rows))
+    {
+        blit_colored(font.bitmap(), glyph.bound, dest, color);
+        return;
+    }
+
+    for (int y = 0; y < result.destination.height(); y++)
+    {
+        span_blend(
+            _bitmap.pixels() + (result.destination.y() + y) * _bitmap.width() + result.destination.x(),
+            pixels + (source_rows.y() + y) * glyph.bound.width() + source_rows.x(),
+            result.destination.width());
+    }
 }
 
 FLATTEN void Painter::draw_string(Font &font, const char *str, Math::Vec2i position, Color color)
@@ -535,52 +623,64 @@ void Painter::draw_string_within(Font &font, const char *str, Math::Recti contai
 
 FLATTEN void Painter::blur(Math::Recti rectangle, int radius)
 {
-    rectangle = _stack.apply(rectangle);
-
-    stackblur((unsigned char *)_bitmap.pixels(),
-              _bitmap.width(),
-              _bitmap.height(),
-              radius,
-              rectangle.x(), rectangle.x() + rectangle.width(),
-              rectangle.y(), rectangle.y() + rectangle.height());
+    Graphic::blur(_bitmap, _stack.apply(rectangle), radius);
 }
 
 FLATTEN void Painter::saturation(Math::Recti rectangle, float value)
 {
     rectangle = _stack.apply(rectangle);
 
-    for (int y = 0; y < rectangle.height(); y++)
+    // Fixed point with 8 bits of fraction, the weights of the gray are the
+    // ones of the CCIR 601 spec and sum up to 256.
+    // https://stackoverflow.com/questions/13806483/increase-or-decrease-color-saturation
+    int factor = value * 256;
+
+    auto saturate = [&](int channel, int gray) {
+        return (uint8_t)clamp(channel + (((channel - gray) * factor) >> 8), 0, 255);
+    };
+
+    for (int y = rectangle.y(); y < rectangle.y() + rectangle.height(); y++)
     {
+        Color *pixels = _bitmap.pixels() + y * _bitmap.width() + rectangle.x();
+
         for (int x = 0; x < rectangle.width(); x++)
         {
-            Color color = _bitmap.get_pixel({rectangle.x() + x, rectangle.y() + y});
-
-            // weights from CCIR 601 spec
-            // https://stackoverflow.com/questions/13806483/increase-or-decrease-color-saturation
-            double gray = 0.2989 * color.red() + 0.5870 * color.green() + 0.1140 * color.blue();
-
-            uint8_t red = (uint8_t)clamp(-gray * value + color.red() * (1 + value), 0, 255);
-            uint8_t green = (uint8_t)clamp(-gray * value + color.green() * (1 + value), 0, 255);
-            uint8_t blue = (uint8_t)clamp(-gray * value + color.blue() * (1 + value), 0, 255);
+            Color color = pixels[x];
 
-            color = Color::from_rgb_byte(red, green, blue);
+            int gray = (77 * color.red() + 150 * color.green() + 29 * color.blue()) >> 8;
 
-            _bitmap.set_pixel({rectangle.x() + x, rectangle.y() + y}, color);
+            pixels[x] = Color::from_rgb_byte(
+                saturate(color.red(), gray),
+                saturate(color.green(), gray),
+                saturate(color.blue(), gray));
         }
     }
 }
 
 FLATTEN void Painter::noise(Math::Recti rectangle, float opacity)
 {
+    rectangle = _stack.apply(rectangle);
+
+    if (rectangle.is_empty())
+    {
+        return;
+    }
+
     Math::Random random{0x12341234};
+    uint8_t alpha = opacity * 255;
 
-    for (int y = 0; y < rectangle.height(); y++)
+    Vec<Color> noise;
+    noise.resize(rectangle.width());
+
+    for (int y = rectangle.y(); y < rectangle.y() + rectangle.height(); y++)
     {
         for (int x = 0; x < rectangle.width(); x++)
         {
-            double noise = random.next_double();
-            plot({rectangle.x() + x, rectangle.y() + y}, Color::from_rgba(noise, noise, noise, opacity));
+            uint8_t value = random.next_u8();
+            noise[x] = Color::from_rgba_byte(value, value, value, alpha);
         }
+
+        span_blend(_bitmap.pixels() + y * _bitmap.width() + rectangle.x(), noise.raw_storage(), rectangle.width());
     }
 }
 
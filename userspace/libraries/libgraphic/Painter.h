@@ -47,6 +47,7 @@ public:
     void blit(Bitmap &bitmap, Math::Recti source, Math::Recti destination);
     void blit(Bitmap &bitmap, BitmapScaling scaling, Math::Recti destionation);
     void blit(Icon &icon, IconSize size, Math::Recti destination, Color color);
+    void blit_no_alpha(Bitmap &bitmap, Math::Recti source, Math::Recti destination);
     void blit_rounded(Bitmap &bitmap, Math::Recti source, Math::Recti destination, int radius);
 
     void clear(Color color);
@@ -0,0 +1,602 @@
+#include <string.h>
+
+#include <libgraphic/Spans.h>
+#include <libmath/MinMax.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#    include <cpuid.h>
+#    include <immintrin.h>
+#    define SPANS_X86 1
+#endif
+
+namespace Graphic
+{
+
+struct SpanFunctions
+{
+    void (*fill)(Color *destination, Color color, size_t count);
+    void (*blend)(Color *destination, const Color *source, size_t count);
+    void (*blend_color)(Color *destination, Color color, size_t count);
+    void (*blend_mask)(Color *destination, const Color *mask, Color color, size_t count);
+};
+
+/* --- Scalar --------------------------------------------------------------- */
+
+// Same as (red * alpha) / 255, rounded down, for any pair of bytes.
+static inline uint8_t mask_alpha(uint8_t red, uint8_t alpha)
+{
+    unsigned int x = red * alpha;
+    return (x + 1 + (x >> 8)) >> 8;
+}
+
+static void scalar_fill(Color *destination, Color color, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        destination[i] = color;
+    }
+}
+
+static void scalar_blend(Color *destination, const Color *source, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        destination[i] = Color::blend(source[i], destination[i]);
+    }
+}
+
+static void scalar_blend_color(Color *destination, Color color, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        destination[i] = Color::blend(color, destination[i]);
+    }
+}
+
+static void scalar_blend_mask(Color *destination, const Color *mask, Color color, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        Color source = color.with_alpha_byte(mask_alpha(mask[i].red(), color.alpha()));
+        destination[i] = Color::blend(source, destination[i]);
+    }
+}
+
+static constexpr SpanFunctions SCALAR_SPANS = {
+    scalar_fill,
+    scalar_blend,
+    scalar_blend_color,
+    scalar_blend_mask,
+};
+
+/* --- SSE2 ----------------------------------------------------------------- */
+
+// Blending only happens in integers over an opaque background, groups of
+// pixels over a translucent one go through Color::blend() instead.
+
+#ifdef SPANS_X86
+
+__attribute__((target("sse2"))) static inline __m128i sse2_over(__m128i source, __m128i destination)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alpha_mask = _mm_set1_epi32(0xff000000);
+    const __m128i k256 = _mm_set1_epi16(256);
+
+    __m128i source_lo = _mm_unpacklo_epi8(source, zero);
+    __m128i source_hi = _mm_unpackhi_epi8(source, zero);
+    __m128i destination_lo = _mm_unpacklo_epi8(destination, zero);
+    __m128i destination_hi = _mm_unpackhi_epi8(destination, zero);
+
+    __m128i alpha_lo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(source_lo, 0xff), 0xff);
+    __m128i alpha_hi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(source_hi, 0xff), 0xff);
+
+    __m128i result_lo = _mm_srli_epi16(
+        _mm_add_epi16(
+            _mm_mullo_epi16(source_lo, alpha_lo),
+            _mm_mullo_epi16(destination_lo, _mm_sub_epi16(k256, alpha_lo))),
+        8);
+
+    __m128i result_hi = _mm_srli_epi16(
+        _mm_add_epi16(
+            _mm_mullo_epi16(source_hi, alpha_hi),
+            _mm_mullo_epi16(destination_hi, _mm_sub_epi16(k256, alpha_hi))),
+        8);
+
+    __m128i result = _mm_or_si128(_mm_packus_epi16(result_lo, result_hi), alpha_mask);
+
+    // Like Color::blend(), opaque pixels replace the background and
+    // transparent ones leave it untouched.
+    __m128i source_alpha = _mm_and_si128(source, alpha_mask);
+    __m128i opaque = _mm_cmpeq_epi32(source_alpha, alpha_mask);
+    __m128i clear = _mm_cmpeq_epi32(source_alpha, zero);
+
+    result = _mm_or_si128(_mm_and_si128(opaque, source), _mm_andnot_si128(opaque, result));
+    result = _mm_or_si128(_mm_and_si128(clear, destination), _mm_andnot_si128(clear, result));
+
+    return result;
+}
+
+__attribute__((target("sse2"))) static inline bool sse2_is_opaque(__m128i pixels)
+{
+    const __m128i alpha_mask = _mm_set1_epi32(0xff000000);
+    return _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(pixels, alpha_mask), alpha_mask)) == 0xffff;
+}
+
+__attribute__((target("sse2"))) static inline bool sse2_is_clear(__m128i pixels)
+{
+    const __m128i alpha_mask = _mm_set1_epi32(0xff000000);
+    return _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(pixels, alpha_mask), _mm_setzero_si128())) == 0xffff;
+}
+
+__attribute__((target("sse2"))) static void sse2_fill(Color *destination, Color color, size_t count)
+{
+    uint32_t value;
+    memcpy(&value, &color, sizeof(value));
+    __m128i pixels = _mm_set1_epi32(value);
+
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4)
+    {
+        _mm_storeu_si128((__m128i *)(destination + i), pixels);
+    }
+
+    scalar_fill(destination + i, color, count - i);
+}
+
+__attribute__((target("sse2"))) static void sse2_blend(Color *destination, const Color *source, size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i s = _mm_loadu_si128((const __m128i *)(source + i));
+
+        if (sse2_is_opaque(s))
+        {
+            _mm_storeu_si128((__m128i *)(destination + i), s);
+            continue;
+        }
+
+        if (sse2_is_clear(s))
+        {
+            continue;
+        }
+
+        __m128i d = _mm_loadu_si128((const __m128i *)(destination + i));
+
+        if (sse2_is_opaque(d))
+        {
+            _mm_storeu_si128((__m128i *)(destination + i), sse2_over(s, d));
+        }
+        else
+        {
+            scalar_blend(destination + i, source + i, 4);
+        }
+    }
+
+    scalar_blend(destination + i, source + i, count - i);
+}
+
+__attribute__((target("sse2"))) static void sse2_blend_color(Color *destination, Color color, size_t count)
+{
+    uint32_t value;
+    memcpy(&value, &color, sizeof(value));
+    __m128i s = _mm_set1_epi32(value);
+
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i d = _mm_loadu_si128((const __m128i *)(destination + i));
+
+        if (sse2_is_opaque(d))
+        {
+            _mm_storeu_si128((__m128i *)(destination + i), sse2_over(s, d));
+        }
+        else
+        {
+            scalar_blend_color(destination + i, color, 4);
+        }
+    }
+
+    scalar_blend_color(destination + i, color, count - i);
+}
+
+__attribute__((target("sse2"))) static void sse2_blend_mask(Color *destination, const Color *mask, Color color, size_t count)
+{
+    uint32_t value;
+    memcpy(&value, &color, sizeof(value));
+
+    const __m128i rgb = _mm_set1_epi32(value & 0x00ffffff);
+    const __m128i alpha = _mm_set1_epi32(color.alpha());
+    const __m128i red_mask = _mm_set1_epi32(0xff);
+    const __m128i one = _mm_set1_epi16(1);
+
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i m = _mm_loadu_si128((const __m128i *)(mask + i));
+
+        // (red * alpha) / 255, the same way as mask_alpha().
+        __m128i x = _mm_mullo_epi16(_mm_and_si128(m, red_mask), alpha);
+        __m128i a = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(x, one), _mm_srli_epi16(x, 8)), 8);
+
+        if (sse2_is_clear(_mm_slli_epi32(a, 24)))
+        {
+            continue;
+        }
+
+        __m128i s = _mm_or_si128(rgb, _mm_slli_epi32(a, 24));
+        __m128i d = _mm_loadu_si128((const __m128i *)(destination + i));
+
+        if (sse2_is_opaque(d))
+        {
+            _mm_storeu_si128((__m128i *)(destination + i), sse2_over(s, d));
+        }
+        else
+        {
+            scalar_blend_mask(destination + i, mask + i, color, 4);
+        }
+    }
+
+    scalar_blend_mask(destination + i, mask + i, color, count - i);
+}
+
+static constexpr SpanFunctions SSE2_SPANS = {
+    sse2_fill,
+    sse2_blend,
+    sse2_blend_color,
+    sse2_blend_mask,
+};
+
+/* --- AVX2 ----------------------------------------------------------------- */
+
+// The same as the SSE2 versions, eight pixels at a time. The SSE2 versions
+// take the pixels before the destination is on a 32 bytes boundary: rows of
+// a bitmap rarely are, and every other unaligned store would then be split
+// across two cache lines.
+
+__attribute__((target("avx2"))) static inline __m256i avx2_over(__m256i source, __m256i destination)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i alpha_mask = _mm256_set1_epi32(0xff000000);
+    const __m256i k256 = _mm256_set1_epi16(256);
+
+    __m256i source_lo = _mm256_unpacklo_epi8(source, zero);
+    __m256i source_hi = _mm256_unpackhi_epi8(source, zero);
+    __m256i destination_lo = _mm256_unpacklo_epi8(destination, zero);
+    __m256i destination_hi = _mm256_unpackhi_epi8(destination, zero);
+
+    __m256i alpha_lo = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(source_lo, 0xff), 0xff);
+    __m256i alpha_hi = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(source_hi, 0xff), 0xff);
+
+    __m256i result_lo = _mm256_srli_epi16(
+        _mm256_add_epi16(
+            _mm256_mullo_epi16(source_lo, alpha_lo),
+            _mm256_mullo_epi16(destination_lo, _mm256_sub_epi16(k256, alpha_lo))),
+        8);
+
+    __m256i result_hi = _mm256_srli_epi16(
+        _mm256_add_epi16(
+            _mm256_mullo_epi16(source_hi, alpha_hi),
+            _mm256_mullo_epi16(destination_hi, _mm256_sub_epi16(k256, alpha_hi))),
+        8);
+
+    __m256i result = _mm256_or_si256(_mm256_packus_epi16(result_lo, result_hi), alpha_mask);
+
+    __m256i source_alpha = _mm256_and_si256(source, alpha_mask);
+    __m256i opaque = _mm256_cmpeq_epi32(source_alpha, alpha_mask);
+    __m256i clear = _mm256_cmpeq_epi32(source_alpha, zero);
+
+    result = _mm256_blendv_epi8(result, source, opaque);
+    result = _mm256_blendv_epi8(result, destination, clear);
+
+    return result;
+}
+
+__attribute__((target("avx2"))) static inline bool avx2_is_opaque(__m256i pixels)
+{
+    const __m256i alpha_mask = _mm256_set1_epi32(0xff000000);
+    return _mm256_movemask_epi8(_mm256_cmpeq_epi32(_mm256_and_si256(pixels, alpha_mask), alpha_mask)) == -1;
+}
+
+__attribute__((target("avx2"))) static inline bool avx2_is_clear(__m256i pixels)
+{
+    const __m256i alpha_mask = _mm256_set1_epi32(0xff000000);
+    return _mm256_movemask_epi8(_mm256_cmpeq_epi32(_mm256_and_si256(pixels, alpha_mask), _mm256_setzero_si256())) == -1;
+}
+
+static inline size_t avx2_head(const Color *destination, size_t count)
+{
+    size_t head = (-reinterpret_cast<uintptr_t>(destination) & 31) / sizeof(Color);
+    return MIN(head, count);
+}
+
+__attribute__((target("avx2"))) static void avx2_blend(Color *destination, const Color *source, size_t count)
+{
+    size_t i = avx2_head(destination, count);
+    sse2_blend(destination, source, i);
+
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i s = _mm256_loadu_si256((const __m256i *)(source + i));
+
+        if (avx2_is_opaque(s))
+        {
+            _mm256_store_si256((__m256i *)(destination + i), s);
+            continue;
+        }
+
+        if (avx2_is_clear(s))
+        {
+            continue;
+        }
+
+        __m256i d = _mm256_load_si256((const __m256i *)(destination + i));
+
+        if (avx2_is_opaque(d))
+        {
+            _mm256_store_si256((__m256i *)(destination + i), avx2_over(s, d));
+        }
+        else
+        {
+            scalar_blend(destination + i, source + i, 8);
+        }
+    }
+
+    sse2_blend(destination + i, source + i, count - i);
+}
+
+__attribute__((target("avx2"))) static void avx2_blend_color(Color *destination, Color color, size_t count)
+{
+    uint32_t value;
+    memcpy(&value, &color, sizeof(value));
+
+    // Every pixel blends the same color, which is neither opaque nor clear
+    // here, so its part of avx2_over() is only done once.
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i alpha_mask = _mm256_set1_epi32(0xff000000);
+    const __m256i source = _mm256_mullo_epi16(
+        _mm256_unpacklo_epi8(_mm256_set1_epi32(value), zero),
+        _mm256_set1_epi16(color.alpha()));
+    const __m256i inverse = _mm256_set1_epi16(256 - color.alpha());
+
+    size_t i = avx2_head(destination, count);
+    sse2_blend_color(destination, color, i);
+
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i d = _mm256_load_si256((const __m256i *)(destination + i));
+
+        if (!avx2_is_opaque(d))
+        {
+            scalar_blend_color(destination + i, color, 8);
+            continue;
+        }
+
+        __m256i result_lo = _mm256_srli_epi16(
+            _mm256_add_epi16(source, _mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero), inverse)), 8);
+
+        __m256i result_hi = _mm256_srli_epi16(
+            _mm256_add_epi16(source, _mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero), inverse)), 8);
+
+        _mm256_store_si256(
+            (__m256i *)(destination + i),
+            _mm256_or_si256(_mm256_packus_epi16(result_lo, result_hi), alpha_mask));
+    }
+
+    sse2_blend_color(destination + i, color, count - i);
+}
+
+__attribute__((target("avx2"))) static void avx2_blend_mask(Color *destination, const Color *mask, Color color, size_t count)
+{
+    uint32_t value;
+    memcpy(&value, &color, sizeof(value));
+
+    const __m256i rgb = _mm256_set1_epi32(value & 0x00ffffff);
+    const __m256i alpha = _mm256_set1_epi32(color.alpha());
+    const __m256i red_mask = _mm256_set1_epi32(0xff);
+    const __m256i one = _mm256_set1_epi16(1);
+
+    size_t i = avx2_head(destination, count);
+    sse2_blend_mask(destination, mask, color, i);
+
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i m = _mm256_loadu_si256((const __m256i *)(mask + i));
+
+        __m256i x = _mm256_mullo_epi16(_mm256_and_si256(m, red_mask), alpha);
+        __m256i a = _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(x, one), _mm256_srli_epi16(x, 8)), 8);
+
+        if (avx2_is_clear(_mm256_slli_epi32(a, 24)))
+        {
+            continue;
+        }
+
+        __m256i s = _mm256_or_si256(rgb, _mm256_slli_epi32(a, 24));
+        __m256i d = _mm256_load_si256((const __m256i *)(destination + i));
+
+        if (avx2_is_opaque(d))
+        {
+            _mm256_store_si256((__m256i *)(destination + i), avx2_over(s, d));
+        }
+        else
+        {
+            scalar_blend_mask(destination + i, mask + i, color, 8);
+        }
+    }
+
+    sse2_blend_mask(destination + i, mask + i, color, count - i);
+}
+
+// Filling is bound by the stores, wider ones don't make it any faster.
+static constexpr SpanFunctions AVX2_SPANS = {
+    sse2_fill,
+    avx2_blend,
+    avx2_blend_color,
+    avx2_blend_mask,
+};
+
+static bool cpu_has_sse2()
+{
+    unsigned int eax, ebx, ecx, edx;
+
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+    {
+        return false;
+    }
+
+    return edx & bit_SSE2;
+}
+
+static bool cpu_has_avx2()
+{
+    unsigned int eax, ebx, ecx, edx;
+
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+    {
+        return false;
+    }
+
+    if (!(ecx & bit_OSXSAVE) || !(ecx & bit_AVX))
+    {
+        return false;
+    }
+
+    // The kernel has to save the upper halves of the ymm registers.
+    uint32_t xcr0_low, xcr0_high;
+    asm volatile("xgetbv"
+                 : "=a"(xcr0_low), "=d"(xcr0_high)
+                 : "c"(0));
+
+    if ((xcr0_low & 0b110) != 0b110)
+    {
+        return false;
+    }
+
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+    {
+        return false;
+    }
+
+    return ebx & bit_AVX2;
+}
+
+#endif
+
+/* --- Dispatch ------------------------------------------------------------- */
+
+static SpanBackend _backend = SpanBackend::SCALAR;
+static const SpanFunctions *_spans = nullptr;
+
+static bool cpu_supports(SpanBackend backend)
+{
+    switch (backend)
+    {
+#ifdef SPANS_X86
+    case SpanBackend::AVX2:
+        return cpu_has_avx2();
+
+    case SpanBackend::SSE2:
+        return cpu_has_sse2();
+#endif
+
+    case SpanBackend::SCALAR:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+bool span_backend(SpanBackend backend)
+{
+    if (!cpu_supports(backend))
+    {
+        return false;
+    }
+
+    _backend = backend;
+
+    switch (backend)
+    {
+#ifdef SPANS_X86
+    case SpanBackend::AVX2:
+        _spans = &AVX2_SPANS;
+        break;
+
+    case SpanBackend::SSE2:
+        _spans = &SSE2_SPANS;
+        break;
+#endif
+
+    default:
+        _spans = &SCALAR_SPANS;
+        break;
+    }
+
+    return true;
+}
+
+SpanBackend span_backend()
+{
+    if (_spans == nullptr)
+    {
+        if (!span_backend(SpanBackend::AVX2) &&
+            !span_backend(SpanBackend::SSE2))
+        {
+            span_backend(SpanBackend::SCALAR);
+        }
+    }
+
+    return _backend;
+}
+
+static const SpanFunctions &spans()
+{
+    if (__builtin_expect(_spans == nullptr, 0))
+    {
+        span_backend();
+    }
+
+    return *_spans;
+}
+
+void span_copy(Color *destination, const Color *source, size_t count)
+{
+    memcpy(destination, source, count * sizeof(Color));
+}
+
+void span_fill(Color *destination, Color color, size_t count)
+{
+    spans().fill(destination, color, count);
+}
+
+void span_blend(Color *destination, const Color *source, size_t count)
+{
+    spans().blend(destination, source, count);
+}
+
+void span_blend_color(Color *destination, Color color, size_t count)
+{
+    if (color.alpha() == 0xff)
+    {
+        spans().fill(destination, color, count);
+    }
+    else if (color.alpha() != 0)
+    {
+        spans().blend_color(destination, color, count);
+    }
+}
+
+void span_blend_mask(Color *destination, const Color *mask, Color color, size_t count)
+{
+    if (color.alpha() != 0)
+    {
+        spans().blend_mask(destination, mask, color, count);
+    }
+}
+
+} // namespace Graphic
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <libgraphic/Color.h>
+
+namespace Graphic
+{
+
+// Row primitives the Painter draws with. Each one comes in a scalar, an SSE2
+// and an AVX2 version, the fastest one the processor supports is picked the
+// first time a span is drawn. All of them give the same result as
+// Color::blend() pixel by pixel.
+
+enum struct SpanBackend
+{
+    SCALAR,
+    SSE2,
+    AVX2,
+};
+
+SpanBackend span_backend();
+
+// Returns false if the processor doesn't support the backend.
+bool span_backend(SpanBackend backend);
+
+void span_copy(Color *destination, const Color *source, size_t count);
+
+void span_fill(Color *destination, Color color, size_t count);
+
+void span_blend(Color *destination, const Color *source, size_t count);
+
+void span_blend_color(Color *destination, Color color, size_t count);
+
+// Blends `color` with its alpha scaled by the red channel of the mask, which
+// is how glyphs and icons are stored.
+void span_blend_mask(Color *destination, const Color *mask, Color color, size_t count);
+
+} // namespace Graphic
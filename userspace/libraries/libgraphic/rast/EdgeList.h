@@ -33,6 +33,12 @@ private:
         auto c = curve.cp2();
         auto d = curve.end();
 
+        // Nothing to draw, and it would never pass the flatness test below.
+        if (a == b && b == c && c == d)
+        {
+            return;
+        }
+
         auto delta1 = d - a;
         float delta2 = fabsf((b.x() - d.x()) * delta1.y() - (b.y() - d.y()) * delta1.x());
         float delta3 = fabsf((c.x() - d.x()) * delta1.y() - (c.y() - d.y()) * delta1.x());
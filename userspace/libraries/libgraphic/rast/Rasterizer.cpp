@@ -1,3 +1,5 @@
+#include <math.h>
+
 #include <libgraphic/Painter.h>
 #include <libgraphic/rast/Rasterizer.h>
 
@@ -7,7 +9,6 @@ namespace Graphic
 Rasterizer::Rasterizer(Bitmap &bitmap, TransformStack &stack)
     : _bitmap{bitmap}, _stack{stack}
 {
-    _scanline.resize(_bitmap.width());
 }
 
 void Rasterizer::clear()
@@ -41,86 +42,251 @@ void Rasterizer::flatten(const Path &path, const Math::Mat3x2f &transform)
 
 void Rasterizer::flatten(const EdgeList &edges, const Math::Mat3x2f &transform)
 {
+    // Each edge is a chain of its own, so consecutive edges are not joined.
     for (auto &edge : edges.edges())
     {
+        _edges.begin();
         _edges.append(transform.apply(edge.start()));
         _edges.append(transform.apply(edge.end()));
     }
 }
 
-void Rasterizer::rasterize(Paint &paint)
+void Rasterizer::build_edge_table(Math::Recti bound)
 {
-    auto line = [&](float start, float end) {
-        for (float x = start; x < end; x += 1.0f / 4)
+    _table_edges.clear();
+    _table_next.clear();
+    _table_rows.resize(bound.height());
+
+    for (size_t i = 0; i < _table_rows.count(); i++)
+    {
+        _table_rows[i] = -1;
+    }
+
+    float left = bound.left();
+    float right = bound.right();
+
+    for (auto &edge : _edges.edges())
+    {
+        if (edge.sy() == edge.ey() ||
+            edge.max_y() <= bound.top() ||
+            edge.min_y() >= bound.bottom())
+        {
+            continue;
+        }
+
+        // Split the edge where it leaves the bound, the parts outside are
+        // pushed against its sides: they still cover everything on their
+        // right, but the pixels they cross are never drawn.
+        float splits[4];
+        size_t count = 0;
+
+        splits[count++] = 0;
+
+        float dx = edge.ex() - edge.sx();
+
+        if (dx != 0)
         {
-            if ((int)x < (int)_scanline.count())
+            float at_left = (left - edge.sx()) / dx;
+            float at_right = (right - edge.sx()) / dx;
+
+            if (at_left > 0 && at_left < 1)
             {
-                _scanline[(int)x] += 1;
+                splits[count++] = at_left;
+            }
+
+            if (at_right > 0 && at_right < 1)
+            {
+                splits[count++] = at_right;
+            }
+
+            if (count == 3 && splits[1] > splits[2])
+            {
+                std::swap(splits[1], splits[2]);
             }
         }
-    };
 
-    auto scanline = [&](int start, int end, float y) {
-        _actives_edges.clear();
+        splits[count++] = 1;
+
+        auto point = [&](float t) {
+            return Math::Vec2f{
+                clamp(edge.sx() + dx * t, left, right),
+                edge.sy() + (edge.ey() - edge.sy()) * t,
+            };
+        };
 
-        for (auto &edge : _edges.edges())
+        for (size_t i = 0; i + 1 < count; i++)
         {
-            if (y >= edge.min_y() && y < edge.max_y())
+            auto start = point(splits[i]);
+            auto end = point(splits[i + 1]);
+
+            if (start.y() == end.y())
             {
-                _actives_edges.push_back(edge);
+                continue;
             }
+
+            int row = clamp((int)floorf(MIN(start.y(), end.y())) - bound.top(), 0, bound.height() - 1);
+
+            _table_next.push_back(_table_rows[row]);
+            _table_rows[row] = _table_edges.count();
+            _table_edges.push_back({start, end});
         }
+    }
+}
 
-        _actives_edges.sort([&](Math::Edgef &a, Math::Edgef &b) { return a.intersection_y(y).x() - b.intersection_y(y).x(); });
+// Adds the signed area between the part of the edge inside the row and the
+// right side of the row to the cells it crosses. Once summed from left to
+// right, the cells give the exact coverage of each pixel.
+void Rasterizer::accumulate(Math::Edgef const &edge, int y, int left)
+{
+    auto top = edge.start();
+    auto bottom = edge.end();
+    float direction = 1;
 
-        bool odd_even = true;
+    if (top.y() > bottom.y())
+    {
+        std::swap(top, bottom);
+        direction = -1;
+    }
 
-        for (size_t i = 0; i + 1 < _actives_edges.count(); i++)
-        {
-            auto &a = _actives_edges[i];
-            auto &b = _actives_edges[i + 1];
+    float y0 = MAX(top.y(), (float)y);
+    float y1 = MIN(bottom.y(), (float)(y + 1));
+
+    if (y0 >= y1)
+    {
+        return;
+    }
+
+    float width = _scanline.count() - 2;
+    float dxdy = (bottom.x() - top.x()) / (bottom.y() - top.y());
+    float xa = clamp(top.x() + (y0 - top.y()) * dxdy - left, 0.0f, width);
+    float xb = clamp(top.x() + (y1 - top.y()) * dxdy - left, 0.0f, width);
+    float d = (y1 - y0) * direction;
+
+    float x0 = MIN(xa, xb);
+    float x1 = MAX(xa, xb);
+    float x0_floor = floorf(x0);
+    int x0i = x0_floor;
+    int x1i = ceilf(x1);
+
+    float *cells = _scanline.raw_storage();
+
+    if (x1i <= x0i + 1)
+    {
+        // The edge stays within one pixel, which is covered up to the
+        // middle of the edge.
+        float xm = (xa + xb) / 2 - x0_floor;
+
+        cells[x0i] += d - d * xm;
+        cells[x0i + 1] += d * xm;
+    }
+    else
+    {
+        float s = 1 / (x1 - x0);
+        float x0f = x0 - x0_floor;
+        float a0 = 0.5f * s * (1 - x0f) * (1 - x0f);
+        float x1f = x1 - x1i + 1;
+        float am = 0.5f * s * x1f * x1f;
+
+        cells[x0i] += d * a0;
 
-            float seg_start = MAX(a.intersection_y(y).x(), start);
-            float seg_end = MIN(b.intersection_y(y).x(), end);
+        if (x1i == x0i + 2)
+        {
+            cells[x0i + 1] += d * (1 - a0 - am);
+        }
+        else
+        {
+            float a1 = s * (1.5f - x0f);
+            cells[x0i + 1] += d * (a1 - a0);
 
-            if (odd_even)
+            for (int xi = x0i + 2; xi < x1i - 1; xi++)
             {
-                line(seg_start, seg_end);
+                cells[xi] += d * s;
             }
 
-            odd_even = !odd_even;
+            float a2 = a1 + (x1i - x0i - 3) * s;
+            cells[x1i - 1] += d * (1 - a2 - am);
         }
-    };
 
-    auto bound = _stack.clip();
+        cells[x1i] += d * am;
+    }
+}
+
+void Rasterizer::rasterize(Paint &paint)
+{
+    auto bound = _edges.bound().clipped_with(_stack.clip());
+
+    if (_edges.edges().empty() || bound.is_empty())
+    {
+        return;
+    }
+
+    build_edge_table(bound);
+
+    _actives_edges.clear();
+
+    // Two more cells for the area spilling past the right of the bound.
+    _scanline.resize(bound.width() + 2);
+
+    for (size_t i = 0; i < _scanline.count(); i++)
+    {
+        _scanline[i] = 0;
+    }
 
     for (int y = bound.top(); y < bound.bottom(); y++)
     {
-        for (int i = bound.left(); i < bound.right(); i++)
+        size_t still_active = 0;
+
+        for (size_t i = 0; i < _actives_edges.count(); i++)
         {
-            _scanline[i] = 0;
+            if (_actives_edges[i].max_y() > y)
+            {
+                _actives_edges[still_active++] = _actives_edges[i];
+            }
         }
 
-        for (float yy = (y - 0.5f); yy < (y + 0.5f); yy += 1.0f / 4)
+        _actives_edges.resize(still_active);
+
+        for (int i = _table_rows[y - bound.top()]; i != -1; i = _table_next[i])
         {
-            scanline(bound.left(), bound.right(), yy + 0.5f);
+            _actives_edges.push_back(_table_edges[i]);
         }
 
-        for (int i = bound.left(); i < bound.right(); i++)
+        for (auto &edge : _actives_edges)
         {
-            Math::Vec2f p = {
-                (i - _edges.bound().left()) / (float)_edges.bound().width(),
-                (y - _edges.bound().top()) / (float)_edges.bound().height(),
-            };
+            accumulate(edge, y, bound.left());
+        }
 
-            auto color = sample(paint, p);
-            auto alpha = clamp((_scanline[i] / 16.0f), 0, 1);
+        float coverage = 0;
+
+        for (int i = 0; i < bound.width(); i++)
+        {
+            coverage += _scanline[i];
+            _scanline[i] = 0;
+
+            // Even-odd fill rule, every crossing flips between in and out.
+            float alpha = fmodf(fabsf(coverage), 2);
+
+            if (alpha > 1)
+            {
+                alpha = 2 - alpha;
+            }
 
             if (alpha >= 0.003f)
             {
-                _bitmap.blend_pixel_no_check({i, y}, color.with_alpha(color.alphaf() * alpha));
+                int x = bound.left() + i;
+
+                Math::Vec2f p = {
+                    (x - _edges.bound().left()) / (float)_edges.bound().width(),
+                    (y - _edges.bound().top()) / (float)_edges.bound().height(),
+                };
+
+                auto color = sample(paint, p);
+                _bitmap.blend_pixel_no_check({x, y}, color.with_alpha(color.alphaf() * alpha));
             }
         }
+
+        _scanline[bound.width()] = 0;
+        _scanline[bound.width() + 1] = 0;
     }
 }
 
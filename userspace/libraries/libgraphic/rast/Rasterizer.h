@@ -28,8 +28,18 @@ private:
     TransformStack &_stack;
 
     EdgeList _edges;
+
+    // Edges clamped horizontally to the area being drawn. Each row of the
+    // edge table links the edges starting on it, the active ones cross the
+    // current row.
+    Vec<Math::Edgef> _table_edges;
+    Vec<int> _table_next;
+    Vec<int> _table_rows;
     Vec<Math::Edgef> _actives_edges;
-    Vec<uint16_t> _scanline;
+
+    // Signed area each edge adds to the pixels of the current row, their
+    // running sum is the coverage.
+    Vec<float> _scanline;
 
     void clear();
 
@@ -37,6 +47,10 @@ private:
 
     void flatten(const EdgeList &edges, const Math::Mat3x2f &transform);
 
+    void build_edge_table(Math::Recti bound);
+
+    void accumulate(Math::Edgef const &edge, int y, int left);
+
     void rasterize(Paint &paint);
 
 public:
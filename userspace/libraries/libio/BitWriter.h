@@ -1,4 +1,6 @@
 #pragma once
+#include <string.h>
+
 #include <libio/Write.h>
 #include <libutils/Prelude.h>
 
@@ -7,10 +9,45 @@ namespace IO
 struct BitWriter
 {
 private:
-    uint_fast32_t _bit_buffer;
-    uint8_t _bit_count;
+    static constexpr size_t BUFFER_SIZE = 4096;
+
     Writer &_writer;
 
+    // Bits go out least significant first.
+    uint64_t _bit_buffer = 0;
+    unsigned int _bit_count = 0;
+
+    uint8_t _buffer[BUFFER_SIZE];
+    size_t _used = 0;
+
+    // First error the writer gave us, reported by flush().
+    HjResult _result = SUCCESS;
+
+    inline void write_buffer()
+    {
+        if (_used > 0 && _result == SUCCESS)
+        {
+            _result = _writer.write(_buffer, _used).result();
+        }
+
+        _used = 0;
+    }
+
+    inline void put_bytes()
+    {
+        while (_bit_count >= 8)
+        {
+            if (_used == BUFFER_SIZE)
+            {
+                write_buffer();
+            }
+
+            _buffer[_used++] = _bit_buffer;
+            _bit_count -= 8;
+            _bit_buffer >>= 8;
+        }
+    }
+
 public:
     BitWriter(Writer &writer) : _writer(writer)
     {
@@ -21,37 +58,56 @@ public:
         flush();
     }
 
+    // At most 32 bits at a time.
     inline void put_bits(unsigned int v, const size_t num_bits)
     {
-        _bit_buffer |= v << _bit_count;
+        _bit_buffer |= (uint64_t)v << _bit_count;
         _bit_count += num_bits;
+
+        if (_bit_count >= 32)
+        {
+            put_bytes();
+        }
     }
 
+    // Must be aligned.
     inline void put_data(const uint8_t *data, size_t len)
     {
-        _writer.write(data, len);
+        put_bytes();
+
+        if (len < BUFFER_SIZE - _used)
+        {
+            memcpy(_buffer + _used, data, len);
+            _used += len;
+            return;
+        }
+
+        write_buffer();
+
+        if (_result == SUCCESS)
+        {
+            _result = _writer.write(data, len).result();
+        }
     }
 
     inline void put_uint16(uint16_t v)
     {
-        IO::write(_writer, v);
+        put_bits(v, 16);
     }
 
     inline void align()
     {
         _bit_count += -_bit_count & 7;
-        flush();
+        put_bytes();
     }
 
-    inline void flush()
+    // Writes out everything but an incomplete last byte.
+    inline HjResult flush()
     {
-        // Flush one byte at a time
-        while (_bit_count >= 8)
-        {
-            IO::write(_writer, (uint8_t)_bit_buffer);
-            _bit_count -= 8;
-            _bit_buffer >>= 8;
-        }
+        put_bytes();
+        write_buffer();
+
+        return _result;
     }
 };
-} // namespace IO
\ No newline at end of file
+} // namespace IO
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <abi/Syscalls.h>
+#include <libio/Handle.h>
+#include <libutils/Slice.h>
+
+namespace IO
+{
+
+// The content of a file mapped read-only in memory, instead of being read
+// into a buffer. It stays valid until the MappedFile is destroyed.
+struct MappedFile
+{
+private:
+    uintptr_t _address = 0;
+    size_t _size = 0;
+    HjResult _result = ERR_BAD_HANDLE;
+
+    NONCOPYABLE(MappedFile);
+    NONMOVABLE(MappedFile);
+
+public:
+    const void *data() const { return reinterpret_cast<const void *>(_address); }
+
+    size_t size() const { return _size; }
+
+    Slice slice() const { return {data(), _size}; }
+
+    HjResult result() const { return _result; }
+
+    bool exist() const { return _result == SUCCESS; }
+
+    MappedFile(String path)
+    {
+        Handle handle{path, HJ_OPEN_READ};
+
+        _result = handle.result();
+
+        if (_result == SUCCESS)
+        {
+            _result = hj_memory_map_handle(handle.id(), &_address, &_size);
+        }
+    }
+
+    ~MappedFile()
+    {
+        if (_address)
+        {
+            hj_memory_free(_address);
+        }
+    }
+};
+
+} // namespace IO
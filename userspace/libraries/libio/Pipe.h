@@ -11,12 +11,13 @@ struct Pipe
     RefPtr<Handle> reader;
     RefPtr<Handle> writer;
 
-    static ResultOr<Pipe> create()
+    // A capacity of zero gives the default one.
+    static ResultOr<Pipe> create(size_t capacity = 0)
     {
         int reader_handle = HANDLE_INVALID_ID;
         int writer_handle = HANDLE_INVALID_ID;
 
-        TRY(hj_create_pipe(&reader_handle, &writer_handle));
+        TRY(hj_create_pipe(&reader_handle, &writer_handle, capacity));
 
         return Pipe{
             make<Handle>(reader_handle),
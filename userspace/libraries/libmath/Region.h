@@ -0,0 +1,389 @@
+#pragma once
+
+#include <libmath/Rect.h>
+#include <libutils/Vec.h>
+
+namespace Math
+{
+
+// A set of pixels stored as a list of non-overlapping rectangles grouped in
+// horizontal bands. The rectangles of a band share the same top and bottom,
+// are sorted from left to right and never touch, the bands are sorted from
+// top to bottom and two bands that touch never have the same spans, so a
+// region only has one representation.
+template <typename Scalar>
+struct Region
+{
+private:
+    Vec<Rect<Scalar>> _rects;
+
+    static Rect<Scalar> span(Scalar left, Scalar top, Scalar right, Scalar bottom)
+    {
+        return {left, top, right - left, bottom - top};
+    }
+
+    static bool is_valid(Rect<Scalar> rect)
+    {
+        return rect.width() > 0 && rect.height() > 0;
+    }
+
+    // The end of the band that starts at `index`.
+    size_t band_end(size_t index) const
+    {
+        size_t end = index;
+
+        while (end < _rects.count() && _rects[end].top() == _rects[index].top())
+        {
+            end++;
+        }
+
+        return end;
+    }
+
+    // Appends the top and the bottom of each band, in order and without
+    // duplicates.
+    void collect_edges(Vec<Scalar> &edges) const
+    {
+        for (size_t i = 0; i < _rects.count(); i = band_end(i))
+        {
+            edges.push_back(_rects[i].top());
+            edges.push_back(_rects[i].bottom());
+        }
+    }
+
+    // Moves `index` to the band that covers `y`, returns the end of that
+    // band, or `index` if no band covers it.
+    size_t band_at(size_t &index, Scalar y) const
+    {
+        while (index < _rects.count() && _rects[index].bottom() <= y)
+        {
+            index = band_end(index);
+        }
+
+        if (index < _rects.count() && _rects[index].top() <= y)
+        {
+            return band_end(index);
+        }
+
+        return index;
+    }
+
+    static void merge_edges(const Vec<Scalar> &a, const Vec<Scalar> &b, Vec<Scalar> &edges)
+    {
+        size_t i = 0;
+        size_t j = 0;
+
+        while (i < a.count() || j < b.count())
+        {
+            Scalar edge;
+
+            if (j >= b.count() || (i < a.count() && a[i] <= b[j]))
+            {
+                edge = a[i++];
+            }
+            else
+            {
+                edge = b[j++];
+            }
+
+            if (edges.empty() || edges.peek_back() != edge)
+            {
+                edges.push_back(edge);
+            }
+        }
+    }
+
+    // Extends the previous band instead of starting a new one when it sits
+    // right on top of the band that was just added and has the same spans.
+    void coalesce(size_t previous, size_t current)
+    {
+        if (previous == current ||
+            _rects[previous].bottom() != _rects[current].top() ||
+            current - previous != _rects.count() - current)
+        {
+            return;
+        }
+
+        for (size_t i = 0; i < current - previous; i++)
+        {
+            if (_rects[previous + i].left() != _rects[current + i].left() ||
+                _rects[previous + i].right() != _rects[current + i].right())
+            {
+                return;
+            }
+        }
+
+        Scalar bottom = _rects[current].bottom();
+
+        for (size_t i = previous; i < current; i++)
+        {
+            _rects[i] = _rects[i].with_height(bottom - _rects[i].top());
+        }
+
+        while (_rects.count() > current)
+        {
+            _rects.pop_back();
+        }
+    }
+
+    // Sweeps both regions band by band and keeps the spans where `keep`
+    // returns true given whether `a` and `b` cover them.
+    template <typename Keep>
+    static Region combine(const Region &a, const Region &b, Keep keep)
+    {
+        Vec<Scalar> a_edges;
+        Vec<Scalar> b_edges;
+        a.collect_edges(a_edges);
+        b.collect_edges(b_edges);
+
+        Vec<Scalar> y_edges;
+        merge_edges(a_edges, b_edges, y_edges);
+
+        Region result;
+        size_t a_index = 0;
+        size_t b_index = 0;
+        size_t previous_band = 0;
+
+        Vec<Scalar> a_spans;
+        Vec<Scalar> b_spans;
+        Vec<Scalar> x_edges;
+
+        for (size_t i = 0; i + 1 < y_edges.count(); i++)
+        {
+            Scalar top = y_edges[i];
+            Scalar bottom = y_edges[i + 1];
+
+            size_t a_end = a.band_at(a_index, top);
+            size_t b_end = b.band_at(b_index, top);
+
+            a_spans.clear();
+            b_spans.clear();
+            x_edges.clear();
+
+            for (size_t j = a_index; j < a_end; j++)
+            {
+                a_spans.push_back(a._rects[j].left());
+                a_spans.push_back(a._rects[j].right());
+            }
+
+            for (size_t j = b_index; j < b_end; j++)
+            {
+                b_spans.push_back(b._rects[j].left());
+                b_spans.push_back(b._rects[j].right());
+            }
+
+            merge_edges(a_spans, b_spans, x_edges);
+
+            size_t current_band = result._rects.count();
+            size_t a_span = 0;
+            size_t b_span = 0;
+
+            for (size_t j = 0; j + 1 < x_edges.count(); j++)
+            {
+                Scalar left = x_edges[j];
+                Scalar right = x_edges[j + 1];
+
+                // Each list alternates between the left and the right
+                // edge of its spans, the ones behind `left` are done.
+                while (a_span < a_spans.count() && a_spans[a_span] <= left)
+                {
+                    a_span++;
+                }
+
+                while (b_span < b_spans.count() && b_spans[b_span] <= left)
+                {
+                    b_span++;
+                }
+
+                if (!keep(a_span % 2 == 1, b_span % 2 == 1))
+                {
+                    continue;
+                }
+
+                if (result._rects.count() > current_band &&
+                    result._rects.peek_back().right() == left)
+                {
+                    auto &last = result._rects.peek_back();
+                    last = last.with_width(right - last.left());
+                }
+                else
+                {
+                    result._rects.push_back(span(left, top, right, bottom));
+                }
+            }
+
+            if (result._rects.count() > current_band)
+            {
+                result.coalesce(previous_band, current_band);
+
+                if (result._rects.count() > current_band)
+                {
+                    previous_band = current_band;
+                }
+            }
+        }
+
+        return result;
+    }
+
+public:
+    static Region empty() { return {}; }
+
+    Region() = default;
+
+    Region(Rect<Scalar> rect)
+    {
+        if (is_valid(rect))
+        {
+            _rects.push_back(rect);
+        }
+    }
+
+    bool is_empty() const { return _rects.empty(); }
+
+    size_t count() const { return _rects.count(); }
+
+    const Rect<Scalar> &operator[](size_t index) const { return _rects[index]; }
+
+    auto begin() const { return _rects.begin(); }
+
+    auto end() const { return _rects.end(); }
+
+    Rect<Scalar> bound() const
+    {
+        if (is_empty())
+        {
+            return Rect<Scalar>::empty();
+        }
+
+        Rect<Scalar> result = _rects[0];
+
+        for (size_t i = 1; i < _rects.count(); i++)
+        {
+            result = result.merged_with(_rects[i]);
+        }
+
+        return result;
+    }
+
+    Scalar area() const
+    {
+        Scalar result = 0;
+
+        for (auto &rect : _rects)
+        {
+            result += rect.width() * rect.height();
+        }
+
+        return result;
+    }
+
+    bool contains(Vec2<Scalar> position) const
+    {
+        for (auto &rect : _rects)
+        {
+            if (rect.contains(position))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool colide_with(Rect<Scalar> rect) const
+    {
+        for (auto &r : _rects)
+        {
+            if (r.colide_with(rect))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    Region unite(const Region &other) const
+    {
+        return combine(*this, other, [](bool a, bool b) { return a || b; });
+    }
+
+    Region intersect(const Region &other) const
+    {
+        return combine(*this, other, [](bool a, bool b) { return a && b; });
+    }
+
+    Region subtract(const Region &other) const
+    {
+        return combine(*this, other, [](bool a, bool b) { return a && !b; });
+    }
+
+    Region unite(Rect<Scalar> rect) const { return unite(Region{rect}); }
+
+    Region intersect(Rect<Scalar> rect) const
+    {
+        // Clipping to a rectangle is the common case, it does not need the
+        // band sweep.
+        Region result;
+        size_t previous_band = 0;
+
+        for (size_t i = 0; i < _rects.count();)
+        {
+            size_t end = band_end(i);
+            size_t current_band = result._rects.count();
+
+            for (size_t j = i; j < end; j++)
+            {
+                auto clipped = _rects[j].clipped_with(rect);
+
+                if (is_valid(clipped))
+                {
+                    result._rects.push_back(clipped);
+                }
+            }
+
+            if (result._rects.count() > current_band)
+            {
+                result.coalesce(previous_band, current_band);
+
+                if (result._rects.count() > current_band)
+                {
+                    previous_band = current_band;
+                }
+            }
+
+            i = end;
+        }
+
+        return result;
+    }
+
+    Region subtract(Rect<Scalar> rect) const { return subtract(Region{rect}); }
+
+    bool operator==(const Region &other) const
+    {
+        if (_rects.count() != other._rects.count())
+        {
+            return false;
+        }
+
+        for (size_t i = 0; i < _rects.count(); i++)
+        {
+            auto a = _rects[i];
+
+            if (a != other._rects[i])
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool operator!=(const Region &other) const { return !(*this == other); }
+};
+
+using Regioni = Region<int>;
+
+} // namespace Math
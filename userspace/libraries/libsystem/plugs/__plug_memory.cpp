@@ -3,9 +3,9 @@
 #include <abi/Result.h>
 #include <libsystem/system/Memory.h>
 
-HjResult memory_alloc(size_t size, uintptr_t *out_address)
+HjResult memory_alloc(size_t size, int flags, uintptr_t *out_address)
 {
-    return hj_memory_alloc(size, out_address);
+    return hj_memory_alloc(size, flags, out_address);
 }
 
 HjResult memory_free(uintptr_t address)
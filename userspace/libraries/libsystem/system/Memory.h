@@ -1,9 +1,10 @@
 #pragma once
 
+#include <abi/Memory.h>
 #include <abi/Result.h>
 #include <libutils/Prelude.h>
 
-HjResult memory_alloc(size_t size, uintptr_t *out_address);
+HjResult memory_alloc(size_t size, int flags, uintptr_t *out_address);
 
 HjResult memory_free(uintptr_t address);
 
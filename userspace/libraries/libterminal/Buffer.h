@@ -7,13 +7,47 @@
 namespace Terminal
 {
 
+// The lines are stored in a ring, scrolling the whole buffer only moves the
+// index of the first line and clears the one that was recycled.
 struct Buffer
 {
 private:
     int _width;
     int _height;
+    int _first = 0;
     Vec<Cell> _buffer;
 
+    Cell *line(int y)
+    {
+        return &_buffer[((_first + y) % _height) * _width];
+    }
+
+    const Cell *line(int y) const
+    {
+        return &_buffer[((_first + y) % _height) * _width];
+    }
+
+    void fill_line(int y, int fromx, int tox, Attrs attributes)
+    {
+        Cell *cells = line(y);
+
+        for (int x = MAX(fromx, 0); x < MIN(tox, _width); x++)
+        {
+            cells[x] = {U' ', attributes};
+        }
+    }
+
+    void copy_line(int to, int from)
+    {
+        Cell *destination = line(to);
+        const Cell *source = line(from);
+
+        for (int x = 0; x < _width; x++)
+        {
+            destination[x] = source[x];
+        }
+    }
+
 public:
     int width() const { return _width; }
 
@@ -29,75 +63,65 @@ public:
     {
         if (x >= 0 && x < _width && y >= 0 && y < _height)
         {
-            return _buffer[y * _width + x];
+            return line(y)[x];
         }
 
-        return {U' ', {}, true};
+        return {U' ', {}};
     }
 
-    void set(int x, int y, Cell cell)
+    // Returns true if the cell changed.
+    bool set(int x, int y, Cell cell)
     {
         if (x >= 0 && x < _width &&
             y >= 0 && y < _height)
         {
-            Cell old_cell = _buffer[y * _width + x];
+            Cell &old_cell = line(y)[x];
 
             if (old_cell.rune != cell.rune ||
                 old_cell.attributes != cell.attributes)
             {
-                _buffer[y * _width + x] = cell;
-                _buffer[y * _width + x].dirty = true;
+                old_cell = cell;
+                return true;
             }
         }
-    }
 
-    void undirty(int x, int y)
-    {
-        if (x >= 0 && x < _width && y >= 0 && y < _height)
-        {
-            _buffer[y * _width + x].dirty = false;
-        }
+        return false;
     }
 
     void clear(int fromx, int fromy, int tox, int toy, Attrs attributes)
     {
-        for (int i = fromx + fromy * _width; i < tox + toy * _width; i++)
+        for (int y = MAX(fromy, 0); y <= MIN(toy, _height - 1); y++)
         {
-            set(i % _width, i / _width, (Cell){U' ', attributes, true});
+            fill_line(y, y == fromy ? fromx : 0, y == toy ? tox : _width, attributes);
         }
     }
 
     void clear_all(Attrs attributes)
     {
-        clear(0, 0, _width, _height, attributes);
+        clear(0, 0, _width, _height - 1, attributes);
     }
 
     void clear_line(int line, Attrs attributes)
     {
         if (line >= 0 && line < _height)
         {
-            for (int i = 0; i < _width; i++)
-            {
-                set(i, line, (Cell){U' ', attributes, true});
-            }
+            fill_line(line, 0, _width, attributes);
         }
     }
 
+    // Keeps the last lines, which are the ones on screen.
     void resize(int width, int height)
     {
         Vec<Cell> new_buffer;
         new_buffer.resize(width * height);
 
-        for (int i = 0; i < width * height; i++)
-        {
-            new_buffer[i] = {U' ', {}, true};
-        }
+        int lines = MIN(height, _height);
 
-        for (int x = 0; x < MIN(width, _width); x++)
+        for (int y = 0; y < lines; y++)
         {
-            for (int y = 0; y < MIN(height, _height); y++)
+            for (int x = 0; x < MIN(width, _width); x++)
             {
-                new_buffer[y * width + x] = at(x, y);
+                new_buffer[(height - lines + y) * width + x] = at(x, _height - lines + y);
             }
         }
 
@@ -105,38 +129,59 @@ public:
 
         _width = width;
         _height = height;
+        _first = 0;
     }
 
-    void scroll(int how_many_line, Attrs attributes)
+    // Moves the lines starting at `top` up, or down when `how_many_line` is
+    // negative, the lines above `top` stay where they are. The lines that
+    // come in are blank.
+    void scroll(int how_many_line, Attrs attributes, int top = 0)
     {
-        if (how_many_line < 0)
-        {
-            for (int line = 0; line < how_many_line; line++)
-            {
-                for (int i = (width() * height()) - 1; i >= height(); i++)
-                {
-                    int x = i % width();
-                    int y = i / width();
+        int count = MIN(how_many_line > 0 ? how_many_line : -how_many_line, _height - top);
 
-                    set(x, y, at(x, y - 1));
-                }
+        if (count <= 0)
+        {
+            return;
+        }
 
+        if (top == 0 && how_many_line > 0)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                clear_line(0, attributes);
+                _first = (_first + 1) % _height;
+            }
+        }
+        else if (top == 0)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                _first = (_first + _height - 1) % _height;
                 clear_line(0, attributes);
             }
         }
         else if (how_many_line > 0)
         {
-            for (int line = 0; line < how_many_line; line++)
+            for (int y = top; y < _height - count; y++)
             {
-                for (int i = 0; i < width() * (height() - 1); i++)
-                {
-                    int x = i % width();
-                    int y = i / width();
+                copy_line(y, y + count);
+            }
 
-                    set(x, y, at(x, y + 1));
-                }
+            for (int y = _height - count; y < _height; y++)
+            {
+                clear_line(y, attributes);
+            }
+        }
+        else
+        {
+            for (int y = _height - 1; y >= top + count; y--)
+            {
+                copy_line(y, y - count);
+            }
 
-                clear_line(height() - 1, attributes);
+            for (int y = top; y < top + count; y++)
+            {
+                clear_line(y, attributes);
             }
         }
     }
@@ -10,7 +10,6 @@ struct Cell
 {
     Text::Rune rune = U' ';
     Attrs attributes;
-    bool dirty;
 };
 
 } // namespace Terminal
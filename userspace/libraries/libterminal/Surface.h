@@ -5,6 +5,9 @@
 namespace Terminal
 {
 
+// The screen is the last lines of the buffer, the ones above it are the
+// scrollback. Each line of the screen remembers if it changed since the view
+// last painted it.
 struct Surface
 {
 private:
@@ -14,6 +17,9 @@ private:
     int _width;
 
     int _scrollback = 0;
+    int _scrollback_length;
+
+    Vec<bool> _dirty;
 
     int convert_y(int y) const
     {
@@ -21,17 +27,23 @@ private:
     }
 
 public:
+    static constexpr int DEFAULT_SCROLLBACK = 1000;
+
     int width() { return _width; }
 
     int height() { return _height; }
 
     int scrollback() { return _scrollback; }
 
-    Surface(int width, int height)
-        : _buffer{width, 1000}
+    Surface(int width, int height, int scrollback_length = DEFAULT_SCROLLBACK)
+        : _buffer{width, height + scrollback_length},
+          _scrollback_length{scrollback_length}
     {
         _width = width;
         _height = height;
+
+        _dirty.resize(height);
+        should_repaint(0, height - 1);
     }
 
     const Cell at(int x, int y) const
@@ -41,17 +53,37 @@ public:
 
     void set(int x, int y, Cell cell)
     {
-        _buffer.set(x, convert_y(y), cell);
+        if (_buffer.set(x, convert_y(y), cell))
+        {
+            should_repaint(y, y);
+        }
+    }
+
+    bool dirty(int y) const
+    {
+        return y >= 0 && y < _height && _dirty[y];
     }
 
-    void undirty(int x, int y)
+    void should_repaint(int from, int to)
     {
-        _buffer.undirty(x, convert_y(y));
+        for (int y = MAX(from, 0); y <= MIN(to, _height - 1); y++)
+        {
+            _dirty[y] = true;
+        }
+    }
+
+    void undirty(int y)
+    {
+        if (y >= 0 && y < _height)
+        {
+            _dirty[y] = false;
+        }
     }
 
     void clear(int fromx, int fromy, int tox, int toy, Attrs attributes)
     {
         _buffer.clear(fromx, convert_y(fromy), tox, convert_y(toy), attributes);
+        should_repaint(fromy, toy);
     }
 
     void clear_all(Attrs attributes)
@@ -62,19 +94,37 @@ public:
     void clear_line(int line, Attrs attributes)
     {
         _buffer.clear_line(convert_y(line), attributes);
+        should_repaint(line, line);
     }
 
     void resize(int width, int height)
     {
-        _buffer.resize(MAX(_buffer.width(), width), MAX(MAX(height, _height), 1000));
+        _buffer.resize(MAX(_buffer.width(), width), height + _scrollback_length);
+        _scrollback = MIN(_scrollback, _scrollback_length);
+
         _width = width;
         _height = height;
+
+        _dirty.resize(height);
+        should_repaint(0, height - 1);
     }
 
+    // Scrolling down pushes the first lines of the screen into the
+    // scrollback, scrolling up leaves the scrollback alone and brings blank
+    // lines in at the top of the screen.
     void scroll(int how_many_line, Attrs attributes)
     {
-        _buffer.scroll(how_many_line, attributes);
-        _scrollback += how_many_line;
+        if (how_many_line > 0)
+        {
+            _buffer.scroll(how_many_line, attributes);
+            _scrollback = MIN(_scrollback + how_many_line, _scrollback_length);
+        }
+        else if (how_many_line < 0)
+        {
+            _buffer.scroll(how_many_line, attributes, convert_y(0));
+        }
+
+        should_repaint(0, _height - 1);
     }
 };
 
@@ -6,8 +6,8 @@
 namespace Terminal
 {
 
-Terminal::Terminal(int width, int height)
-    : _surface{width, height}
+Terminal::Terminal(int width, int height, int scrollback)
+    : _surface{width, height, scrollback}
 {
     _decoder.callback([this](auto rune) { write(rune); });
 
@@ -105,7 +105,7 @@ void Terminal::append(Text::Rune rune)
     }
     else
     {
-        _surface.set(_cursor.x, _cursor.y, {rune, _attributes, true});
+        _surface.set(_cursor.x, _cursor.y, {rune, _attributes});
         cursor_move(1, 0);
     }
 }
@@ -48,7 +48,7 @@ public:
 
     Cursor &cursor() { return _cursor; }
 
-    Terminal(int width, int height);
+    Terminal(int width, int height, int scrollback = Surface::DEFAULT_SCROLLBACK);
 
     void resize(int width, int height);
 
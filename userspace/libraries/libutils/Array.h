@@ -20,13 +20,13 @@ public:
     constexpr T *raw_storage() { return _storage; }
     constexpr const T *raw_storage() const { return _storage; }
 
-    T &at(size_t index)
+    constexpr T &at(size_t index)
     {
         assert(index < N);
         return _storage[index];
     }
 
-    const T &at(size_t index) const
+    constexpr const T &at(size_t index) const
     {
         assert(index < N);
         return _storage[index];
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <libutils/Prelude.h>
+#include <string.h>
 
 namespace Utils
 {
@@ -17,6 +18,13 @@ static inline uint32_t hash(const void *object, size_t size)
     return hash;
 }
 
+// Hashes like a String with the same content, so C strings can be used to
+// look String keys up.
+static inline uint32_t hash(const char *cstring)
+{
+    return hash(cstring, strlen(cstring));
+}
+
 template <typename TObject>
 constexpr bool has_hash_function()
 {
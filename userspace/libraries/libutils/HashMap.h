@@ -1,11 +1,18 @@
 #pragma once
 
+#include <libmath/MinMax.h>
 #include <libutils/Hash.h>
-#include <libutils/Vec.h>
+#include <libutils/Iter.h>
+#include <libutils/Std.h>
 
 namespace Utils
 {
 
+// Open addressing with Robin Hood hashing: every item remembers how far it
+// is from the slot its hash maps to, an insertion takes the place of any item
+// closer to its own slot, and a lookup gives up as soon as it meets one.
+// Lookups accept any type that hashes and compares like the keys, for example
+// a const char * against String keys.
 template <typename TKey, typename TValue>
 struct HashMap
 {
@@ -17,102 +24,230 @@ private:
         TValue value;
     };
 
-    static constexpr int BUCKET_COUNT = 256;
+    static constexpr size_t MIN_CAPACITY = 8;
 
-    Vec<Vec<Item>> _buckets{};
+    // Distance to the ideal slot plus one, zero for empty slots.
+    uint32_t *_distances = nullptr;
+    Item *_items = nullptr;
+    size_t _capacity = 0;
+    size_t _count = 0;
 
-    Vec<Item> &bucket(uint32_t hash)
+    size_t ideal_slot(uint32_t hash) const
     {
-        return _buckets[hash % BUCKET_COUNT];
+        uint32_t mixed = hash * 2654435769u;
+        return (mixed ^ (mixed >> 16)) & (_capacity - 1);
     }
 
-    Item *item_by_key(const TKey &key)
+    template <typename TLookup>
+    Item *item_by_key(const TLookup &key, uint32_t hash) const
     {
-        return item_by_key(key, hash<TKey>(key));
+        if (_count == 0)
+        {
+            return nullptr;
+        }
+
+        size_t index = ideal_slot(hash);
+
+        for (uint32_t distance = 1; _distances[index] >= distance; distance++)
+        {
+            Item &item = _items[index];
+
+            if (item.hash == hash && item.key == key)
+            {
+                return &item;
+            }
+
+            index = (index + 1) & (_capacity - 1);
+        }
+
+        return nullptr;
     }
 
-    Item *item_by_key(const TKey &key, uint32_t hash)
+    template <typename TLookup>
+    Item *item_by_key(const TLookup &key) const
+    {
+        return item_by_key(key, hash(key));
+    }
+
+    Item *place(Item &&item)
     {
         Item *result = nullptr;
-        auto &b = bucket(hash);
 
-        b.foreach([&](Item &item)
+        size_t index = ideal_slot(item.hash);
+        uint32_t distance = 1;
+
+        while (_distances[index] != 0)
+        {
+            if (_distances[index] < distance)
             {
-                if (item.hash == hash && item.key == key)
+                std::swap(item, _items[index]);
+                std::swap(distance, _distances[index]);
+
+                if (result == nullptr)
                 {
-                    result = &item;
-                    return Iter::STOP;
+                    result = &_items[index];
                 }
-                else
-                {
-                    return Iter::CONTINUE;
-                }
-            });
+            }
 
-        return result;
+            index = (index + 1) & (_capacity - 1);
+            distance++;
+        }
+
+        new (&_items[index]) Item(std::move(item));
+        _distances[index] = distance;
+        _count++;
+
+        return result ? result : &_items[index];
     }
 
-public:
-    size_t count() const
+    void remove_at(size_t index)
     {
-        size_t result = 0;
+        _items[index].~Item();
+        _distances[index] = 0;
+        _count--;
 
-        for (size_t i = 0; i < BUCKET_COUNT; i++)
+        // Shift the items that follow back by one, until one is already in
+        // its ideal slot.
+        size_t next = (index + 1) & (_capacity - 1);
+
+        while (_distances[next] > 1)
         {
-            result += _buckets[i].count();
+            new (&_items[index]) Item(std::move(_items[next]));
+            _items[next].~Item();
+
+            _distances[index] = _distances[next] - 1;
+            _distances[next] = 0;
+
+            index = next;
+            next = (next + 1) & (_capacity - 1);
         }
+    }
 
-        return result;
+    void rehash(size_t capacity)
+    {
+        auto *old_distances = _distances;
+        auto *old_items = _items;
+        size_t old_capacity = _capacity;
+
+        _distances = (uint32_t *)calloc(capacity, sizeof(uint32_t));
+        _items = (Item *)malloc(capacity * sizeof(Item));
+        _capacity = capacity;
+        _count = 0;
+
+        for (size_t i = 0; i < old_capacity; i++)
+        {
+            if (old_distances[i] != 0)
+            {
+                place(std::move(old_items[i]));
+                old_items[i].~Item();
+            }
+        }
+
+        free(old_distances);
+        free(old_items);
     }
 
-    HashMap()
+    void destroy_items()
     {
-        for (size_t i = 0; i < BUCKET_COUNT; i++)
+        for (size_t i = 0; i < _capacity; i++)
         {
-            _buckets.push_back({});
+            if (_distances[i] != 0)
+            {
+                _items[i].~Item();
+                _distances[i] = 0;
+            }
         }
+
+        _count = 0;
+    }
+
+public:
+    size_t count() const
+    {
+        return _count;
     }
 
+    HashMap() {}
+
     HashMap(const HashMap &other)
-        : _buckets(other._buckets)
     {
+        if (other._capacity == 0)
+        {
+            return;
+        }
+
+        _distances = (uint32_t *)calloc(other._capacity, sizeof(uint32_t));
+        _items = (Item *)malloc(other._capacity * sizeof(Item));
+        _capacity = other._capacity;
+        _count = other._count;
+
+        for (size_t i = 0; i < _capacity; i++)
+        {
+            if (other._distances[i] != 0)
+            {
+                new (&_items[i]) Item(other._items[i]);
+                _distances[i] = other._distances[i];
+            }
+        }
     }
 
     HashMap(HashMap &&other)
-        : _buckets(std::move(other._buckets))
     {
+        std::swap(_distances, other._distances);
+        std::swap(_items, other._items);
+        std::swap(_capacity, other._capacity);
+        std::swap(_count, other._count);
+    }
+
+    ~HashMap()
+    {
+        destroy_items();
+
+        free(_distances);
+        free(_items);
     }
 
     void clear()
     {
-        _buckets.clear();
+        destroy_items();
     }
 
-    void remove_key(TKey &key)
+    template <typename TLookup>
+    void remove_key(const TLookup &key)
     {
-        uint32_t h = hash<TKey>(key);
+        Item *item = item_by_key(key);
 
-        bucket(h).remove_all_match([&](auto &item)
-            { return item.hash == h && item.key == key; });
+        if (item)
+        {
+            remove_at(item - _items);
+        }
     }
 
-    void remove_value(TValue &value)
+    void remove_value(const TValue &value)
     {
-        _buckets.foreach([&](auto &bucket)
-            {
-                bucket.remove_all_match([&](auto &item)
-                    { return item.value == value; });
+        size_t i = 0;
 
-                return Iter::CONTINUE;
-            });
+        while (i < _capacity)
+        {
+            // Removing shifts the next items back, so look at this slot again.
+            if (_distances[i] != 0 && _items[i].value == value)
+            {
+                remove_at(i);
+            }
+            else
+            {
+                i++;
+            }
+        }
     }
 
-    bool has_key(const TKey &key)
+    template <typename TLookup>
+    bool has_key(const TLookup &key) const
     {
         return item_by_key(key) != nullptr;
     }
 
-    bool has_value(const TValue &value)
+    bool has_value(const TValue &value) const
     {
         bool result = false;
 
@@ -135,20 +270,36 @@ public:
     template <typename TCallback>
     Iter foreach(TCallback callback) const
     {
-        return _buckets.foreach([&](auto &bucket)
-            { return bucket.foreach([&](auto &item)
-                  { return callback(item.key, item.value); }); });
+        for (size_t i = 0; i < _capacity; i++)
+        {
+            if (_distances[i] != 0 &&
+                callback(_items[i].key, _items[i].value) == Iter::STOP)
+            {
+                return Iter::STOP;
+            }
+        }
+
+        return Iter::CONTINUE;
     }
 
     HashMap &operator=(const HashMap &other)
     {
-        _buckets = other._buckets;
+        if (this != &other)
+        {
+            HashMap copy{other};
+            *this = std::move(copy);
+        }
+
         return *this;
     }
 
     HashMap &operator=(HashMap &&other)
     {
-        std::swap(_buckets, other._buckets);
+        std::swap(_distances, other._distances);
+        std::swap(_items, other._items);
+        std::swap(_capacity, other._capacity);
+        std::swap(_count, other._count);
+
         return *this;
     }
 
@@ -161,11 +312,14 @@ public:
         {
             return i->value;
         }
-        else
+
+        // Keep the table at most 80% full.
+        if ((_count + 1) * 5 > _capacity * 4)
         {
-            auto &b = bucket(h);
-            return b.push_back({h, key, {}}).value;
+            rehash(MAX(_capacity * 2, MIN_CAPACITY));
         }
+
+        return place({h, key, {}})->value;
     }
 };
 
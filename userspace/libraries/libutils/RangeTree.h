@@ -0,0 +1,400 @@
+#pragma once
+
+#include <libmath/MinMax.h>
+#include <libutils/Assert.h>
+#include <libutils/Iter.h>
+#include <libutils/Opt.h>
+#include <libutils/Prelude.h>
+
+namespace Utils
+{
+
+// Ranges that never overlap, inside of [start, end), in an AVL tree sorted by
+// address. Each node also knows the lowest and the highest address of its
+// subtree and the largest gap between two of its ranges, which is enough to
+// find the first gap that fits a given size in O(log n).
+template <typename T>
+struct RangeTree
+{
+private:
+    struct Node
+    {
+        uint64_t base;
+        uint64_t end;
+        T value;
+
+        Node *left = nullptr;
+        Node *right = nullptr;
+        int height = 1;
+
+        uint64_t lowest;
+        uint64_t highest;
+        uint64_t largest_gap = 0;
+
+        Node(uint64_t base, uint64_t end, const T &value)
+            : base{base}, end{end}, value{value}, lowest{base}, highest{end}
+        {
+        }
+    };
+
+    uint64_t _start;
+    uint64_t _end;
+
+    Node *_root = nullptr;
+    size_t _count = 0;
+
+    static int height(Node *node)
+    {
+        return node ? node->height : 0;
+    }
+
+    static void update(Node *node)
+    {
+        node->height = MAX(height(node->left), height(node->right)) + 1;
+        node->lowest = node->left ? node->left->lowest : node->base;
+        node->highest = node->right ? node->right->highest : node->end;
+
+        uint64_t gap = 0;
+
+        if (node->left)
+        {
+            gap = MAX(node->left->largest_gap, node->base - node->left->highest);
+        }
+
+        if (node->right)
+        {
+            gap = MAX(gap, MAX(node->right->largest_gap, node->right->lowest - node->end));
+        }
+
+        node->largest_gap = gap;
+    }
+
+    static Node *rotate_left(Node *node)
+    {
+        Node *right = node->right;
+
+        node->right = right->left;
+        right->left = node;
+
+        update(node);
+        update(right);
+
+        return right;
+    }
+
+    static Node *rotate_right(Node *node)
+    {
+        Node *left = node->left;
+
+        node->left = left->right;
+        left->right = node;
+
+        update(node);
+        update(left);
+
+        return left;
+    }
+
+    static Node *balance(Node *node)
+    {
+        update(node);
+
+        int factor = height(node->left) - height(node->right);
+
+        if (factor > 1)
+        {
+            if (height(node->left->left) < height(node->left->right))
+            {
+                node->left = rotate_left(node->left);
+            }
+
+            return rotate_right(node);
+        }
+
+        if (factor < -1)
+        {
+            if (height(node->right->right) < height(node->right->left))
+            {
+                node->right = rotate_right(node->right);
+            }
+
+            return rotate_left(node);
+        }
+
+        return node;
+    }
+
+    static Node *insert(Node *node, Node *inserted)
+    {
+        if (!node)
+        {
+            return inserted;
+        }
+
+        if (inserted->base < node->base)
+        {
+            node->left = insert(node->left, inserted);
+        }
+        else
+        {
+            node->right = insert(node->right, inserted);
+        }
+
+        return balance(node);
+    }
+
+    static Node *detach_lowest(Node *node, Node *&lowest)
+    {
+        if (!node->left)
+        {
+            lowest = node;
+            return node->right;
+        }
+
+        node->left = detach_lowest(node->left, lowest);
+
+        return balance(node);
+    }
+
+    static Node *remove(Node *node, uint64_t base, Node *&removed)
+    {
+        if (!node)
+        {
+            return nullptr;
+        }
+
+        if (base < node->base)
+        {
+            node->left = remove(node->left, base, removed);
+        }
+        else if (base > node->base)
+        {
+            node->right = remove(node->right, base, removed);
+        }
+        else
+        {
+            removed = node;
+
+            if (!node->left || !node->right)
+            {
+                return node->left ? node->left : node->right;
+            }
+
+            // The next range takes the place of the node, the others don't
+            // move so pointers to their values stay valid.
+            Node *next = nullptr;
+            Node *right = detach_lowest(node->right, next);
+
+            next->left = node->left;
+            next->right = right;
+
+            return balance(next);
+        }
+
+        return balance(node);
+    }
+
+    // The subtree has a gap between two of its ranges that fits `size`,
+    // finds the first one.
+    static uint64_t first_gap(Node *node, uint64_t size)
+    {
+        while (true)
+        {
+            if (node->left && node->left->largest_gap >= size)
+            {
+                node = node->left;
+            }
+            else if (node->left && node->base - node->left->highest >= size)
+            {
+                return node->left->highest;
+            }
+            else if (node->right && node->right->lowest - node->end >= size)
+            {
+                return node->end;
+            }
+            else
+            {
+                node = node->right;
+            }
+        }
+    }
+
+    static void destroy(Node *node)
+    {
+        if (node)
+        {
+            destroy(node->left);
+            destroy(node->right);
+            delete node;
+        }
+    }
+
+    template <typename TCallback>
+    static Iter foreach(Node *node, TCallback &callback)
+    {
+        if (!node)
+        {
+            return Iter::CONTINUE;
+        }
+
+        if (foreach(node->left, callback) == Iter::STOP ||
+            callback(node->value) == Iter::STOP)
+        {
+            return Iter::STOP;
+        }
+
+        return foreach(node->right, callback);
+    }
+
+public:
+    size_t count() const { return _count; }
+
+    bool empty() const { return _count == 0; }
+
+    bool any() const { return _count > 0; }
+
+    RangeTree(uint64_t start, uint64_t end) : _start{start}, _end{end} {}
+
+    RangeTree(const RangeTree &) = delete;
+
+    RangeTree &operator=(const RangeTree &) = delete;
+
+    ~RangeTree()
+    {
+        destroy(_root);
+    }
+
+    void insert(uint64_t base, uint64_t size, const T &value)
+    {
+        assert(size > 0);
+        assert(base >= _start && base + size <= _end);
+        assert(!colides(base, size));
+
+        _root = insert(_root, new Node(base, base + size, value));
+        _count++;
+    }
+
+    bool remove(uint64_t base)
+    {
+        Node *removed = nullptr;
+        _root = remove(_root, base, removed);
+
+        if (!removed)
+        {
+            return false;
+        }
+
+        delete removed;
+        _count--;
+
+        return true;
+    }
+
+    T *containing(uint64_t address)
+    {
+        Node *node = _root;
+
+        while (node)
+        {
+            if (address < node->base)
+            {
+                node = node->left;
+            }
+            else if (address >= node->end)
+            {
+                node = node->right;
+            }
+            else
+            {
+                return &node->value;
+            }
+        }
+
+        return nullptr;
+    }
+
+    T *at(uint64_t base)
+    {
+        Node *node = _root;
+
+        while (node && node->base != base)
+        {
+            node = base < node->base ? node->left : node->right;
+        }
+
+        return node ? &node->value : nullptr;
+    }
+
+    bool colides(uint64_t base, uint64_t size) const
+    {
+        Node *node = _root;
+
+        while (node)
+        {
+            if (base + size <= node->base)
+            {
+                node = node->left;
+            }
+            else if (base >= node->end)
+            {
+                node = node->right;
+            }
+            else
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // The lowest address where `size` bytes fit between the ranges.
+    Opt<uint64_t> find_gap(uint64_t size) const
+    {
+        if (size == 0 || size > _end - _start)
+        {
+            return NONE;
+        }
+
+        if (!_root || _root->lowest - _start >= size)
+        {
+            return _start;
+        }
+
+        if (_root->largest_gap >= size)
+        {
+            return first_gap(_root, size);
+        }
+
+        if (_end - _root->highest >= size)
+        {
+            return _root->highest;
+        }
+
+        return NONE;
+    }
+
+    T &first()
+    {
+        assert(_root);
+
+        Node *node = _root;
+
+        while (node->left)
+        {
+            node = node->left;
+        }
+
+        return node->value;
+    }
+
+    // Goes through the ranges from the lowest to the highest, the tree must
+    // not change meanwhile.
+    template <typename TCallback>
+    Iter foreach(TCallback callback)
+    {
+        return foreach(_root, callback);
+    }
+};
+
+} // namespace Utils
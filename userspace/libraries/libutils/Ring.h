@@ -3,6 +3,7 @@
 #include <assert.h>
 #include <string.h>
 
+#include <libmath/MinMax.h>
 #include <libutils/Std.h>
 
 namespace Utils
@@ -113,28 +114,32 @@ public:
         return _buffer[offset];
     }
 
+    // Reads and writes copy at most two segments, before and after the end
+    // of the buffer.
     size_t read(T *buffer, size_t size)
     {
-        size_t read = 0;
+        size_t read = MIN(size, _used);
+        size_t first = MIN(read, _size - _tail);
 
-        while (!empty() && read < size)
-        {
-            buffer[read] = get();
-            read++;
-        }
+        memcpy(buffer, _buffer + _tail, first * sizeof(T));
+        memcpy(buffer + first, _buffer, (read - first) * sizeof(T));
+
+        _tail = (_tail + read) % _size;
+        _used -= read;
 
         return read;
     }
 
     size_t write(const T *buffer, size_t size)
     {
-        size_t written = 0;
+        size_t written = MIN(size, _size - _used);
+        size_t first = MIN(written, _size - _head);
+
+        memcpy(_buffer + _head, buffer, first * sizeof(T));
+        memcpy(_buffer, buffer + first, (written - first) * sizeof(T));
 
-        while (!full() && written < size)
-        {
-            put(buffer[written]);
-            written++;
-        }
+        _head = (_head + written) % _size;
+        _used += written;
 
         return written;
     }
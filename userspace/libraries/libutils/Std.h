@@ -15,10 +15,6 @@ inline void *operator new[](size_t, void *ptr)
     return ptr;
 }
 
-#else
-#    include <new>
-#endif
-
 namespace std
 {
 
@@ -93,4 +89,13 @@ public:
     constexpr const T *end() const { return _data + _size; }
 };
 
-} // namespace std
\ No newline at end of file
+} // namespace std
+
+#else
+
+// The host C++ library has its own, and it gets pulled in by the libc headers.
+#    include <initializer_list>
+#    include <new>
+#    include <utility>
+
+#endif
\ No newline at end of file
@@ -109,6 +109,15 @@ void Application::do_message(const CompositorMessage &message)
             window->dispatch_event(&copy);
         }
     }
+    else if (message.type == COMPOSITOR_MESSAGE_FRAME_DONE)
+    {
+        Window *window = get_window(message.frame_done.id);
+
+        if (window)
+        {
+            window->frame_done();
+        }
+    }
     else if (message.type == COMPOSITOR_MESSAGE_CHANGED_RESOLUTION)
     {
         Screen::bound(message.changed_resolution.resolution);
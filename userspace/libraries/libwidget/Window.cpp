@@ -161,11 +161,17 @@ void Window::flip(Math::Recti region)
 
     std::swap(frontbuffer, backbuffer);
 
+    _waiting_for_frame = true;
     Application::the().flip_window(this, region);
 }
 
 void Window::update()
 {
+    if (_waiting_for_frame)
+    {
+        return;
+    }
+
     if (_dirty_layout)
     {
         relayout();
@@ -196,6 +202,16 @@ void Window::update()
     flip(repaited_regions);
 }
 
+void Window::frame_done()
+{
+    _waiting_for_frame = false;
+
+    if (_visible && (_dirty_layout || _dirty_paint.count() > 0))
+    {
+        _update_invoker->invoke_later();
+    }
+}
+
 void Window::change_framebuffer_if_needed()
 {
     if (bound().width() > frontbuffer->width() ||
@@ -215,6 +231,7 @@ void Window::show()
     }
 
     _visible = true;
+    _waiting_for_frame = false;
 
     change_framebuffer_if_needed();
 
@@ -48,6 +48,10 @@ private:
     bool _dirty_layout;
     Vec<Math::Recti> _dirty_paint{};
 
+    // The compositor has not shown the last flip yet, the next one waits
+    // for its frame to be done.
+    bool _waiting_for_frame = false;
+
     EventHandler _handlers[EventType::__COUNT];
 
     RefPtr<Element> _root;
@@ -186,6 +190,8 @@ public:
 
     void update();
 
+    void frame_done();
+
     void should_relayout();
 
     void should_repaint(Math::Recti rectangle);
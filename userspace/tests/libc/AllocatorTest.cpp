@@ -0,0 +1,79 @@
+#include <skift/Allocator.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tests/Driver.h"
+
+static AllocatorSizeClassStats size_class_stats(size_t size)
+{
+    AllocatorStats stats;
+    allocator_stats(&stats);
+
+    for (auto &klass : stats.classes)
+    {
+        if (klass.size >= size)
+        {
+            return klass;
+        }
+    }
+
+    return {};
+}
+
+TEST(allocator_small_objects_are_counted_in_their_size_class)
+{
+    auto before = size_class_stats(40);
+
+    void *objects[64];
+
+    for (auto &object : objects)
+    {
+        object = malloc(40);
+        Assert::equal((uintptr_t)object % 16, 0u);
+    }
+
+    auto during = size_class_stats(40);
+
+    Assert::equal(during.size, 48u);
+    Assert::equal(during.objects, before.objects + 64);
+    Assert::lower_equal(during.objects, during.capacity);
+
+    for (auto &object : objects)
+    {
+        free(object);
+    }
+
+    Assert::equal(size_class_stats(40).objects, before.objects);
+}
+
+TEST(allocator_realloc_keeps_content_across_size_classes)
+{
+    char *buffer = (char *)malloc(24);
+    strcpy(buffer, "Hello, world!");
+
+    Assert::equal((void *)realloc(buffer, 32), (void *)buffer);
+
+    buffer = (char *)realloc(buffer, 1000);
+    Assert::equal(strcmp(buffer, "Hello, world!"), 0);
+
+    buffer = (char *)realloc(buffer, 64 * 1024);
+    Assert::equal(strcmp(buffer, "Hello, world!"), 0);
+
+    free(buffer);
+}
+
+TEST(allocator_large_objects_use_major_blocks)
+{
+    AllocatorStats before;
+    allocator_stats(&before);
+
+    void *object = malloc(16 * 1024);
+
+    AllocatorStats during;
+    allocator_stats(&during);
+
+    Assert::equal(during.large_allocations, before.large_allocations + 1);
+    Assert::greater_equal(during.mapped_bytes, during.used_bytes);
+
+    free(object);
+}
@@ -0,0 +1,103 @@
+#include <libcompression/Deflate.h>
+#include <libcompression/Inflate.h>
+#include <libio/MemoryReader.h>
+#include <libio/MemoryWriter.h>
+#include <string.h>
+
+#include "tests/Driver.h"
+
+static size_t deflate_and_inflate(unsigned int level, const uint8_t *data, size_t size)
+{
+    IO::MemoryReader uncompressed_reader(data, size);
+    IO::MemoryWriter compressed_writer;
+    Compression::Deflate def(level);
+
+    Assert::equal(def.perform(uncompressed_reader, compressed_writer), HjResult::SUCCESS);
+
+    size_t compressed_size = compressed_writer.length().unwrap();
+
+    IO::MemoryReader compressed_reader(Slice(compressed_writer.slice()));
+    IO::MemoryWriter uncompressed_writer;
+    Compression::Inflate inf;
+    auto result = inf.perform(compressed_reader, uncompressed_writer);
+
+    Assert::equal(result.result(), HjResult::SUCCESS);
+    Assert::equal(result.unwrap(), compressed_size);
+    Assert::equal(uncompressed_writer.length().unwrap(), size);
+
+    auto uncompressed = Slice(uncompressed_writer.slice());
+    Assert::truth(memcmp(uncompressed.start(), data, size) == 0);
+
+    return compressed_size;
+}
+
+TEST(deflate_empty)
+{
+    static uint8_t data[1];
+
+    for (unsigned int level = 0; level <= Compression::Deflate::MAX_COMPRESSION_LEVEL; level++)
+    {
+        deflate_and_inflate(level, data, 0);
+    }
+}
+
+TEST(deflate_repetitive_data_shrinks)
+{
+    static uint8_t data[100000];
+
+    for (size_t i = 0; i < sizeof(data); i++)
+    {
+        data[i] = "skift operating system "[i % 23];
+    }
+
+    Assert::greater_than(deflate_and_inflate(0, data, sizeof(data)), sizeof(data));
+
+    for (unsigned int level = 1; level <= Compression::Deflate::MAX_COMPRESSION_LEVEL; level++)
+    {
+        Assert::lower_than(deflate_and_inflate(level, data, sizeof(data)), sizeof(data) / 50);
+    }
+}
+
+TEST(deflate_higher_levels_compress_better)
+{
+    // Text-like data with matches at every distance, longer than the window.
+    static uint8_t data[200000];
+    uint32_t state = 0x5eed;
+
+    for (size_t i = 0; i < sizeof(data); i++)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+
+        if (i > 64 && state % 4 != 0)
+        {
+            data[i] = data[i - 1 - (state >> 8) % MIN(i - 1, (size_t)40000)];
+        }
+        else
+        {
+            data[i] = 'a' + state % 26;
+        }
+    }
+
+    size_t fastest = deflate_and_inflate(1, data, sizeof(data));
+    size_t best = deflate_and_inflate(9, data, sizeof(data));
+
+    Assert::lower_than(fastest, sizeof(data));
+    Assert::lower_equal(best, fastest);
+}
+
+TEST(deflate_random_data_stays_stored)
+{
+    static uint8_t data[70000];
+    uint32_t state = 42;
+
+    for (size_t i = 0; i < sizeof(data); i++)
+    {
+        state = state * 1103515245 + 12345;
+        data[i] = state >> 24;
+    }
+
+    // Stored blocks, a few bytes of overhead each.
+    Assert::lower_than(deflate_and_inflate(6, data, sizeof(data)), sizeof(data) + 64);
+}
@@ -200,3 +200,36 @@ TEST(inflate_max_matchdist)
     Assert::equal(out[uncompressed.size() - 2], 1);
     Assert::equal(out[uncompressed.size() - 1], 0);
 }
+
+TEST(inflate_uncompressed)
+{
+    /* Stored block holding "hello" */
+    static const unsigned char data[] = {
+        0x01, 0x05, 0x00, 0xFA, 0xFF, 'h', 'e', 'l', 'l', 'o'};
+
+    IO::MemoryReader mem_reader(data, sizeof(data));
+    IO::MemoryWriter mem_writer;
+    Compression::Inflate inf;
+    auto result = inf.perform(mem_reader, mem_writer);
+
+    Assert::equal(result.result(), HjResult::SUCCESS);
+    Assert::equal(result.unwrap(), sizeof(data));
+    Assert::equal(mem_writer.length().unwrap(), 5);
+
+    auto uncompressed = Slice(mem_writer.slice());
+    Assert::truth(memcmp(uncompressed.start(), "hello", 5) == 0);
+}
+
+TEST(inflate_over_subscribed)
+{
+    /* Dynamic block where all 19 code length codes are one bit long */
+    static const unsigned char data[] = {
+        0x05, 0xE0, 0x93, 0x24, 0x49, 0x92, 0x24, 0x49, 0x92, 0x00};
+
+    IO::MemoryReader mem_reader(data, sizeof(data));
+    IO::MemoryWriter mem_writer;
+    Compression::Inflate inf;
+    auto result = inf.perform(mem_reader, mem_writer);
+
+    Assert::equal(result.result(), HjResult::ERR_INVALID_DATA);
+}
@@ -0,0 +1,73 @@
+#include <libfile/TARArchive.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "tests/Driver.h"
+
+static void tar_entry(uint8_t *archive, const char *name, const char *content)
+{
+    memset(archive, 0, 512);
+    strcpy((char *)archive, name);
+    snprintf((char *)archive + 124, 12, "%011o", (unsigned int)strlen(content));
+    archive[156] = '0';
+    memcpy(archive + 512, content, strlen(content));
+}
+
+TEST(tar_iterate_visits_entries_in_order)
+{
+    static uint8_t archive[512 * 6];
+    memset(archive, 0, sizeof(archive));
+
+    tar_entry(archive, "hello.txt", "Hello, world!");
+    tar_entry(archive + 1024, "empty", "");
+    tar_entry(archive + 1536, "bye.txt", "Bye");
+
+    const char *names[] = {"hello.txt", "empty", "bye.txt"};
+    size_t sizes[] = {13, 0, 3};
+    size_t count = 0;
+
+    tar_iterate(archive, sizeof(archive), [&](TARBlock &block)
+        {
+            Assert::lower_than(count, 3u);
+            Assert::equal(strcmp(block.name, names[count]), 0);
+            Assert::equal(block.size, sizes[count]);
+            count++;
+
+            return Iter::CONTINUE;
+        });
+
+    Assert::equal(count, 3u);
+}
+
+TEST(tar_iterate_data_points_into_the_archive)
+{
+    static uint8_t archive[512 * 3];
+    memset(archive, 0, sizeof(archive));
+
+    tar_entry(archive, "hello.txt", "Hello, world!");
+
+    tar_iterate(archive, sizeof(archive), [&](TARBlock &block)
+        {
+            Assert::equal((uint8_t *)block.data, archive + 512);
+            return Iter::CONTINUE;
+        });
+}
+
+TEST(tar_iterate_stops_at_truncated_entries)
+{
+    static uint8_t archive[512 * 2];
+    memset(archive, 0, sizeof(archive));
+
+    tar_entry(archive, "hello.txt", "Hello, world!");
+    snprintf((char *)archive + 124, 12, "%011o", 4096u);
+
+    size_t count = 0;
+
+    tar_iterate(archive, sizeof(archive), [&](TARBlock &)
+        {
+            count++;
+            return Iter::CONTINUE;
+        });
+
+    Assert::equal(count, 0u);
+}
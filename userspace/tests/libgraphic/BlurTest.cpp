@@ -0,0 +1,119 @@
+#include <libgraphic/Blur.h>
+
+#include "tests/Driver.h"
+
+using namespace Graphic;
+
+static constexpr int WIDTH = 64;
+static constexpr int HEIGHT = 48;
+
+static Color pixels[WIDTH * HEIGHT];
+
+static RefPtr<Bitmap> create_bitmap(Color color)
+{
+    for (int i = 0; i < WIDTH * HEIGHT; i++)
+    {
+        pixels[i] = color;
+    }
+
+    return make<Bitmap>(-1, BITMAP_STATIC, WIDTH, HEIGHT, pixels);
+}
+
+TEST(blur_keeps_uniform_colors)
+{
+    auto color = Color::from_rgba_byte(10, 120, 250, 200);
+    auto bitmap = create_bitmap(color);
+
+    // Small radii blur the region as is, large ones go through the pyramid.
+    for (int radius : {2, 24})
+    {
+        blur(*bitmap, bitmap->bound(), radius);
+
+        for (int i = 0; i < WIDTH * HEIGHT; i++)
+        {
+            Assert::equal(pixels[i].red(), 10);
+            Assert::equal(pixels[i].green(), 120);
+            Assert::equal(pixels[i].blue(), 250);
+            Assert::equal(pixels[i].alpha(), 200);
+        }
+    }
+}
+
+TEST(blur_spreads_a_dot_evenly)
+{
+    auto bitmap = create_bitmap(Colors::BLACK);
+    pixels[24 * WIDTH + 32] = Colors::WHITE;
+
+    blur(*bitmap, {16, 8, 33, 33}, 4);
+
+    auto at = [](int x, int y) { return pixels[y * WIDTH + x].red(); };
+
+    Assert::greater_than(at(32, 24), at(33, 24));
+    Assert::greater_than(at(33, 24), at(35, 24));
+    Assert::greater_than(at(32, 27), 0);
+    Assert::equal(at(32, 24 + 8), 0);
+
+    Assert::equal(at(31, 24), at(33, 24));
+    Assert::equal(at(32, 22), at(32, 26));
+    Assert::equal(at(30, 24), at(32, 26));
+}
+
+TEST(blur_stays_inside_the_region)
+{
+    auto bitmap = create_bitmap(Colors::BLACK);
+
+    for (int y = 0; y < HEIGHT; y++)
+    {
+        for (int x = 0; x < WIDTH; x++)
+        {
+            pixels[y * WIDTH + x] = ((x / 4 + y / 4) % 2) ? Colors::WHITE : Colors::BLACK;
+        }
+    }
+
+    Math::Recti region{10, 6, 30, 20};
+
+    for (int radius : {3, 20})
+    {
+        blur(*bitmap, region, radius);
+
+        for (int y = 0; y < HEIGHT; y++)
+        {
+            for (int x = 0; x < WIDTH; x++)
+            {
+                if (!region.contains(Math::Vec2i{x, y}))
+                {
+                    Color expected = ((x / 4 + y / 4) % 2) ? Colors::WHITE : Colors::BLACK;
+                    Assert::equal(pixels[y * WIDTH + x].red(), expected.red());
+                }
+            }
+        }
+    }
+}
+
+TEST(blur_keeps_gradients_straight)
+{
+    // A box blur of a ramp is the same ramp away from the edges, on the
+    // region itself and through the downsampled levels.
+    for (int radius : {2, 16})
+    {
+        auto bitmap = create_bitmap(Colors::BLACK);
+
+        for (int y = 0; y < HEIGHT; y++)
+        {
+            for (int x = 0; x < WIDTH; x++)
+            {
+                pixels[y * WIDTH + x] = Color::from_rgb_byte(x * 3, 0, 0);
+            }
+        }
+
+        blur(*bitmap, bitmap->bound(), radius);
+
+        for (int x = WIDTH / 2 - 4; x < WIDTH / 2 + 4; x++)
+        {
+            int red = pixels[(HEIGHT / 2) * WIDTH + x].red();
+
+            Assert::greater_equal(red, x * 3 - 2);
+            Assert::lower_equal(red, x * 3 + 2);
+        }
+    }
+}
@@ -0,0 +1,89 @@
+#include <libgraphic/Font.h>
+
+#include "tests/Driver.h"
+
+using namespace Graphic;
+
+static Color atlas[4 * 2];
+
+// Four 1x2 glyphs side by side, the mask of each pixel is its index.
+static RefPtr<Font> create_font()
+{
+    for (int i = 0; i < 8; i++)
+    {
+        atlas[i] = Color::from_rgb_byte(i * 32, 0, 0);
+    }
+
+    Vec<Glyph> glyphs;
+
+    glyphs.push_back({U'a', {0, 0, 1, 2}, {0, 2}, 1});
+    glyphs.push_back({U'?', {1, 0, 1, 2}, {0, 2}, 2});
+    glyphs.push_back({0x2500, {2, 0, 1, 2}, {0, 2}, 3});
+    glyphs.push_back({0x03A9, {3, 0, 1, 2}, {0, 2}, 4});
+    glyphs.push_back({0, {}, {}, 0});
+
+    return make<Font>(make<Bitmap>(-1, BITMAP_STATIC, 4, 2, atlas), glyphs);
+}
+
+TEST(font_finds_glyphs_in_every_range)
+{
+    auto font = create_font();
+
+    Assert::equal(font->glyph(U'a').advance, 1);
+    Assert::equal(font->glyph(0x03A9).advance, 4);
+    Assert::equal(font->glyph(0x2500).advance, 3);
+
+    Assert::truth(font->has(U'?'));
+    Assert::truth(font->has(0x2500));
+    Assert::falsity(font->has(U'b'));
+    Assert::falsity(font->has(0x2501));
+}
+
+TEST(font_falls_back_to_the_question_mark)
+{
+    auto font = create_font();
+
+    Assert::equal(font->glyph(U'z').advance, 2);
+    Assert::equal(font->glyph(0x10000).advance, 2);
+}
+
+TEST(font_tints_glyphs_with_the_mask)
+{
+    auto font = create_font();
+    auto color = Color::from_rgba_byte(10, 20, 30, 128);
+
+    auto &glyph = font->glyph(0x2500);
+    const Color *pixels = font->tinted(glyph, color);
+
+    Assert::not_null(pixels);
+
+    for (int y = 0; y < 2; y++)
+    {
+        Assert::equal(pixels[y].red(), 10);
+        Assert::equal(pixels[y].blue(), 30);
+        Assert::equal(pixels[y].alpha(), atlas[y * 4 + 2].red() * 128 / 255);
+    }
+
+    // Cycling through more colors than the cache holds still gives the
+    // right pixels.
+    for (int i = 0; i < 40; i++)
+    {
+        auto other = Color::from_rgba_byte(i, 0, 0, 255);
+        Assert::equal(font->tinted(glyph, other)[1].red(), i);
+    }
+
+    Assert::equal(font->tinted(glyph, color)[1].alpha(), atlas[6].red() * 128 / 255);
+}
+
+TEST(font_only_tints_its_own_glyphs)
+{
+    auto font = create_font();
+    auto other = create_font();
+    auto color = Color::from_rgba_byte(10, 20, 30, 255);
+
+    Assert::not_null(font->tinted(font->glyph(U'z'), color));
+    Assert::truth(font->tinted(other->glyph(U'a'), color) == nullptr);
+
+    Glyph copy = font->glyph(U'a');
+    Assert::truth(font->tinted(copy, color) == nullptr);
+}
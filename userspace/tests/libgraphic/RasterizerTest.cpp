@@ -0,0 +1,134 @@
+#include <libgraphic/rast/Rasterizer.h>
+
+#include "tests/Driver.h"
+
+using namespace Graphic;
+
+static constexpr int SIZE = 32;
+
+struct Canvas
+{
+    Color pixels[SIZE * SIZE];
+    RefPtr<Bitmap> bitmap = make<Bitmap>(-1, BITMAP_STATIC, SIZE, SIZE, pixels);
+    TransformStack stack{bitmap->bound()};
+    Rasterizer rasterizer{*bitmap, stack};
+
+    Canvas()
+    {
+        for (auto &pixel : pixels)
+        {
+            pixel = Colors::WHITE;
+        }
+    }
+
+    // How much of the pixel is covered by the black fill, from 0 to 255.
+    int coverage(int x, int y)
+    {
+        return 255 - pixels[y * SIZE + x].red();
+    }
+};
+
+static void rectangle(EdgeList &edges, float left, float top, float right, float bottom)
+{
+    edges.begin();
+    edges.append(Math::Vec2f{left, top});
+    edges.append(Math::Vec2f{right, top});
+    edges.append(Math::Vec2f{right, bottom});
+    edges.append(Math::Vec2f{left, bottom});
+    edges.append(Math::Vec2f{left, top});
+    edges.end();
+}
+
+static void fill(Canvas &canvas, EdgeList &edges)
+{
+    canvas.rasterizer.fill(edges, Math::Mat3x2f::identity(), Fill{Colors::BLACK});
+}
+
+TEST(rasterizer_fills_aligned_rectangle)
+{
+    Canvas canvas;
+    EdgeList edges;
+    rectangle(edges, 4, 4, 12, 8);
+
+    fill(canvas, edges);
+
+    for (int y = 0; y < SIZE; y++)
+    {
+        for (int x = 0; x < SIZE; x++)
+        {
+            bool inside = x >= 4 && x < 12 && y >= 4 && y < 8;
+            Assert::equal(canvas.coverage(x, y), inside ? 255 : 0);
+        }
+    }
+}
+
+TEST(rasterizer_covers_partial_pixels_by_area)
+{
+    Canvas canvas;
+    EdgeList edges;
+    rectangle(edges, 4.5, 4.25, 12, 8);
+
+    fill(canvas, edges);
+
+    Assert::lower_equal(abs(canvas.coverage(4, 6) - 127), 2);
+    Assert::lower_equal(abs(canvas.coverage(6, 4) - 191), 2);
+    Assert::lower_equal(abs(canvas.coverage(4, 4) - 95), 2);
+    Assert::equal(canvas.coverage(6, 6), 255);
+}
+
+TEST(rasterizer_covers_diagonal_by_area)
+{
+    Canvas canvas;
+    EdgeList edges;
+
+    // A right triangle, the pixels along the hypotenuse are half covered.
+    edges.begin();
+    edges.append(Math::Vec2f{0, 0});
+    edges.append(Math::Vec2f{16, 16});
+    edges.append(Math::Vec2f{0, 16});
+    edges.append(Math::Vec2f{0, 0});
+    edges.end();
+
+    fill(canvas, edges);
+
+    for (int i = 0; i < 16; i++)
+    {
+        Assert::lower_equal(abs(canvas.coverage(i, i) - 127), 2);
+        Assert::equal(canvas.coverage(i + 1, i), 0);
+    }
+
+    Assert::equal(canvas.coverage(2, 10), 255);
+}
+
+TEST(rasterizer_uses_the_even_odd_rule)
+{
+    Canvas canvas;
+    EdgeList edges;
+    rectangle(edges, 2, 2, 20, 20);
+    rectangle(edges, 8, 8, 14, 14);
+
+    fill(canvas, edges);
+
+    Assert::equal(canvas.coverage(4, 4), 255);
+    Assert::equal(canvas.coverage(10, 10), 0);
+    Assert::equal(canvas.coverage(16, 16), 255);
+}
+
+TEST(rasterizer_stays_within_the_clip)
+{
+    Canvas canvas;
+    EdgeList edges;
+    rectangle(edges, -40, -40, 80, 80);
+
+    canvas.stack.clip(Math::Recti{8, 8, 8, 8});
+    fill(canvas, edges);
+
+    for (int y = 0; y < SIZE; y++)
+    {
+        for (int x = 0; x < SIZE; x++)
+        {
+            bool inside = x >= 8 && x < 16 && y >= 8 && y < 16;
+            Assert::equal(canvas.coverage(x, y), inside ? 255 : 0);
+        }
+    }
+}
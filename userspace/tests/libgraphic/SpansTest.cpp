@@ -0,0 +1,125 @@
+#include <libgraphic/Spans.h>
+
+#include "tests/Driver.h"
+
+using namespace Graphic;
+
+static constexpr size_t PIXELS = 67;
+
+static uint32_t next(uint32_t &state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+// Mostly opaque backgrounds and a mix of opaque, transparent and translucent
+// foregrounds, so every group takes a different path.
+static void random_pixels(Color *pixels, uint32_t &state, bool opaque)
+{
+    for (size_t i = 0; i < PIXELS; i++)
+    {
+        uint32_t value = next(state);
+        uint8_t alpha = value >> 24;
+
+        if (opaque || value % 5 == 0)
+        {
+            alpha = 0xff;
+        }
+        else if (value % 7 == 0)
+        {
+            alpha = 0;
+        }
+
+        pixels[i] = Color::from_rgba_byte(value, value >> 8, value >> 16, alpha);
+    }
+}
+
+static void assert_same(const Color *expected, const Color *actual)
+{
+    for (size_t i = 0; i < PIXELS; i++)
+    {
+        Assert::truth(expected[i] == actual[i]);
+    }
+}
+
+static void check_backend(SpanBackend backend)
+{
+    if (!span_backend(backend))
+    {
+        return;
+    }
+
+    uint32_t state = 0x5eed;
+
+    for (int round = 0; round < 64; round++)
+    {
+        Color source[PIXELS];
+        Color background[PIXELS];
+        Color expected[PIXELS];
+        Color actual[PIXELS];
+
+        random_pixels(source, state, false);
+        random_pixels(background, state, round % 4 != 0);
+
+        Color color = source[round % PIXELS];
+
+        // The spans start at every alignment of the SIMD backends.
+        size_t start = round % 8;
+
+        for (size_t i = 0; i < PIXELS; i++)
+        {
+            expected[i] = i < start ? background[i] : Color::blend(source[i], background[i]);
+            actual[i] = background[i];
+        }
+
+        span_blend(actual + start, source + start, PIXELS - start);
+        assert_same(expected, actual);
+
+        for (size_t i = 0; i < PIXELS; i++)
+        {
+            expected[i] = i < start ? background[i] : Color::blend(color, background[i]);
+            actual[i] = background[i];
+        }
+
+        span_blend_color(actual + start, color, PIXELS - start);
+        assert_same(expected, actual);
+
+        for (size_t i = 0; i < PIXELS; i++)
+        {
+            uint8_t alpha = source[i].red() * color.alpha() / 255;
+            expected[i] = i < start ? background[i] : Color::blend(color.with_alpha_byte(alpha), background[i]);
+            actual[i] = background[i];
+        }
+
+        span_blend_mask(actual + start, source + start, color, PIXELS - start);
+        assert_same(expected, actual);
+
+        for (size_t i = 0; i < PIXELS; i++)
+        {
+            expected[i] = i < start ? background[i] : color;
+            actual[i] = background[i];
+        }
+
+        span_fill(actual + start, color, PIXELS - start);
+        assert_same(expected, actual);
+    }
+
+    span_backend(SpanBackend::SCALAR);
+}
+
+TEST(spans_scalar_match_color_blend)
+{
+    check_backend(SpanBackend::SCALAR);
+}
+
+TEST(spans_sse2_match_color_blend)
+{
+    check_backend(SpanBackend::SSE2);
+}
+
+TEST(spans_avx2_match_color_blend)
+{
+    check_backend(SpanBackend::AVX2);
+}
@@ -0,0 +1,159 @@
+#include <libmath/Region.h>
+
+#include "tests/Driver.h"
+
+using namespace Math;
+
+static constexpr int SIZE = 24;
+
+static uint32_t next(uint32_t &state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static Recti random_rect(uint32_t &state)
+{
+    int x = next(state) % SIZE;
+    int y = next(state) % SIZE;
+
+    return {x, y, (int)(next(state) % (SIZE - x)) + 1, (int)(next(state) % (SIZE - y)) + 1};
+}
+
+// The rectangles never overlap and keep their bands sorted.
+static void assert_well_formed(const Regioni &region)
+{
+    for (size_t i = 0; i < region.count(); i++)
+    {
+        Assert::greater_than(region[i].width(), 0);
+        Assert::greater_than(region[i].height(), 0);
+
+        for (size_t j = i + 1; j < region.count(); j++)
+        {
+            Assert::falsity(region[i].colide_with(region[j]));
+            Assert::lower_equal(region[i].top(), region[j].top());
+        }
+    }
+}
+
+TEST(region_subtract_punches_a_hole)
+{
+    Regioni region{Recti{0, 0, 10, 10}};
+    region = region.subtract(Recti{3, 3, 4, 4});
+
+    Assert::equal(region.count(), 4u);
+    Assert::equal(region.area(), 100 - 16);
+    Assert::falsity(region.contains({5, 5}));
+    Assert::truth(region.contains({2, 5}));
+    Assert::truth(region.contains({7, 5}));
+    assert_well_formed(region);
+
+    Assert::truth(region.unite(Recti{3, 3, 4, 4}) == Regioni{Recti{0, 0, 10, 10}});
+}
+
+TEST(region_merges_touching_rectangles)
+{
+    Regioni region;
+    region = region.unite(Recti{0, 0, 5, 5});
+    region = region.unite(Recti{5, 0, 5, 5});
+    region = region.unite(Recti{0, 5, 10, 5});
+
+    Assert::equal(region.count(), 1u);
+    Assert::truth(region.bound() == Recti{0, 0, 10, 10});
+}
+
+TEST(region_intersect_clips)
+{
+    Regioni region = Regioni{Recti{0, 0, 10, 4}}.unite(Recti{0, 6, 10, 4});
+
+    auto clipped = region.intersect(Recti{2, 2, 4, 6});
+
+    Assert::equal(clipped.area(), 2 * 4 * 2);
+    Assert::truth(clipped == region.intersect(Regioni{Recti{2, 2, 4, 6}}));
+    Assert::truth(region.intersect(Recti{0, 4, 10, 2}).is_empty());
+}
+
+TEST(region_matches_a_pixel_mask)
+{
+    uint32_t state = 0x5eed;
+
+    for (int round = 0; round < 200; round++)
+    {
+        bool mask[SIZE][SIZE] = {};
+        Regioni region;
+
+        for (int step = 0; step < 8; step++)
+        {
+            auto rect = random_rect(state);
+            auto other = random_rect(state);
+            int operation = next(state) % 3;
+
+            if (operation == 0)
+            {
+                region = region.unite(rect);
+            }
+            else if (operation == 1)
+            {
+                region = region.subtract(rect);
+            }
+            else
+            {
+                region = region.intersect(Regioni{rect}.unite(other));
+            }
+
+            for (int y = 0; y < SIZE; y++)
+            {
+                for (int x = 0; x < SIZE; x++)
+                {
+                    bool inside = rect.contains(Vec2i{x, y});
+
+                    if (operation == 0)
+                    {
+                        mask[y][x] = mask[y][x] || inside;
+                    }
+                    else if (operation == 1)
+                    {
+                        mask[y][x] = mask[y][x] && !inside;
+                    }
+                    else
+                    {
+                        mask[y][x] = mask[y][x] && (inside || other.contains(Vec2i{x, y}));
+                    }
+                }
+            }
+
+            assert_well_formed(region);
+
+            int area = 0;
+
+            for (int y = 0; y < SIZE; y++)
+            {
+                for (int x = 0; x < SIZE; x++)
+                {
+                    Assert::equal(region.contains(Vec2i{x, y}), mask[y][x]);
+                    area += mask[y][x];
+                }
+            }
+
+            Assert::equal(region.area(), area);
+        }
+
+        // The same pixels always end up as the same rectangles.
+        Regioni rebuilt;
+
+        for (int y = 0; y < SIZE; y++)
+        {
+            for (int x = 0; x < SIZE; x++)
+            {
+                if (region.contains(Vec2i{x, y}))
+                {
+                    rebuilt = rebuilt.unite(Recti{x, y, 1, 1});
+                }
+            }
+        }
+
+        Assert::truth(rebuilt == region);
+    }
+}
@@ -0,0 +1,98 @@
+#include <string.h>
+
+#include <libterminal/Terminal.h>
+
+#include "tests/Driver.h"
+
+static void write(Terminal::Terminal &terminal, const char *text)
+{
+    terminal.write(text, strlen(text));
+}
+
+static void undirty_all(Terminal::Surface &surface)
+{
+    for (int y = 0; y < surface.height(); y++)
+    {
+        surface.undirty(y);
+    }
+}
+
+TEST(terminal_scrolls_lines_into_the_scrollback)
+{
+    Terminal::Terminal terminal{8, 3, 4};
+
+    write(terminal, "a\nb\nc\nd\ne\nf\ng\nh");
+
+    Assert::equal(terminal.surface().at(0, 0).rune, U'f');
+    Assert::equal(terminal.surface().at(0, 2).rune, U'h');
+    Assert::equal(terminal.surface().at(0, -1).rune, U'e');
+    Assert::equal(terminal.surface().at(0, -4).rune, U'b');
+
+    // The scrollback only keeps four lines.
+    Assert::equal(terminal.surface().scrollback(), 4);
+}
+
+TEST(terminal_scrolls_up_without_touching_the_scrollback)
+{
+    Terminal::Terminal terminal{8, 3, 4};
+
+    write(terminal, "a\nb\nc\nd");
+    write(terminal, "\e[2S");
+
+    Assert::equal(terminal.surface().at(0, -1).rune, U'a');
+    Assert::equal(terminal.surface().at(0, 0).rune, U' ');
+    Assert::equal(terminal.surface().at(0, 1).rune, U' ');
+    Assert::equal(terminal.surface().at(0, 2).rune, U'b');
+    Assert::equal(terminal.surface().scrollback(), 1);
+}
+
+TEST(terminal_tracks_the_lines_that_changed)
+{
+    Terminal::Terminal terminal{8, 4};
+    auto &surface = terminal.surface();
+
+    undirty_all(surface);
+    write(terminal, "\e[3;1Hx");
+
+    Assert::falsity(surface.dirty(0));
+    Assert::falsity(surface.dirty(1));
+    Assert::truth(surface.dirty(2));
+    Assert::falsity(surface.dirty(3));
+
+    // Writing the same thing again doesn't change anything.
+    undirty_all(surface);
+    write(terminal, "\e[3;1Hx");
+
+    Assert::falsity(surface.dirty(2));
+
+    write(terminal, "\n\n\n");
+
+    for (int y = 0; y < surface.height(); y++)
+    {
+        Assert::truth(surface.dirty(y));
+    }
+}
+
+TEST(terminal_buffer_scrolls_a_region)
+{
+    Terminal::Buffer buffer{1, 4};
+
+    for (int y = 0; y < 4; y++)
+    {
+        buffer.set(0, y, {(Text::Rune)('a' + y), {}});
+    }
+
+    buffer.scroll(1, {}, 1);
+
+    Assert::equal(buffer.at(0, 0).rune, U'a');
+    Assert::equal(buffer.at(0, 1).rune, U'c');
+    Assert::equal(buffer.at(0, 2).rune, U'd');
+    Assert::equal(buffer.at(0, 3).rune, U' ');
+
+    buffer.scroll(-2, {});
+
+    Assert::equal(buffer.at(0, 0).rune, U' ');
+    Assert::equal(buffer.at(0, 1).rune, U' ');
+    Assert::equal(buffer.at(0, 2).rune, U'a');
+    Assert::equal(buffer.at(0, 3).rune, U'c');
+}
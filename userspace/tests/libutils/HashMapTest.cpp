@@ -0,0 +1,106 @@
+#include <libutils/HashMap.h>
+#include <libutils/String.h>
+
+#include "tests/Driver.h"
+
+TEST(hashmap_insert_and_lookup)
+{
+    HashMap<String, int> map;
+
+    map["one"] = 1;
+    map["two"] = 2;
+    map["three"] = 3;
+
+    Assert::equal(map.count(), 3u);
+    Assert::equal(map["two"], 2);
+    Assert::truth(map.has_key(String{"three"}));
+    Assert::falsity(map.has_key(String{"four"}));
+}
+
+TEST(hashmap_lookup_string_keys_with_cstrings)
+{
+    HashMap<String, int> map;
+
+    map["hello"] = 42;
+
+    Assert::truth(map.has_key("hello"));
+    Assert::falsity(map.has_key("world"));
+
+    map.remove_key("hello");
+
+    Assert::equal(map.count(), 0u);
+}
+
+TEST(hashmap_grow_and_remove_many_keys)
+{
+    HashMap<uint32_t, uint32_t> map;
+
+    for (uint32_t i = 0; i < 10000; i++)
+    {
+        map[i] = i * 2;
+    }
+
+    Assert::equal(map.count(), 10000u);
+
+    for (uint32_t i = 0; i < 10000; i += 2)
+    {
+        map.remove_key(i);
+    }
+
+    Assert::equal(map.count(), 5000u);
+
+    for (uint32_t i = 0; i < 10000; i++)
+    {
+        Assert::equal(map.has_key(i), i % 2 == 1);
+    }
+
+    Assert::equal(map[9999], 19998u);
+}
+
+TEST(hashmap_remove_value)
+{
+    HashMap<uint32_t, uint32_t> map;
+
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        map[i] = i % 3;
+    }
+
+    map.remove_value(0);
+
+    Assert::equal(map.count(), 66u);
+    Assert::falsity(map.has_value(0));
+    Assert::truth(map.has_value(2));
+}
+
+TEST(hashmap_copy_is_independent)
+{
+    HashMap<String, String> map;
+    map["key"] = "value";
+
+    HashMap<String, String> copy = map;
+    copy["key"] = "other";
+    copy["new"] = "new";
+
+    Assert::equal(map.count(), 1u);
+    Assert::equal(map["key"], "value");
+    Assert::equal(copy.count(), 2u);
+}
+
+TEST(hashmap_clear)
+{
+    HashMap<uint32_t, uint32_t> map;
+
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        map[i] = i;
+    }
+
+    map.clear();
+
+    Assert::equal(map.count(), 0u);
+    Assert::falsity(map.has_key(50u));
+
+    map[50] = 1;
+    Assert::equal(map.count(), 1u);
+}
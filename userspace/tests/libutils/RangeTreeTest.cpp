@@ -0,0 +1,123 @@
+#include <libutils/RangeTree.h>
+
+#include "tests/Driver.h"
+
+static constexpr uint64_t SLOTS = 64;
+
+static uint32_t next(uint32_t &state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+TEST(range_tree_finds_ranges_by_address)
+{
+    RangeTree<int> tree{0x1000, 0x10000};
+
+    tree.insert(0x4000, 0x1000, 4);
+    tree.insert(0x2000, 0x2000, 2);
+    tree.insert(0x8000, 0x1000, 8);
+
+    Assert::equal(tree.count(), 3u);
+    Assert::equal(*tree.containing(0x3fff), 2);
+    Assert::equal(*tree.containing(0x4000), 4);
+    Assert::truth(tree.containing(0x5000) == nullptr);
+    Assert::truth(tree.at(0x3000) == nullptr);
+    Assert::equal(*tree.at(0x8000), 8);
+    Assert::equal(tree.first(), 2);
+
+    Assert::truth(tree.colides(0x4800, 0x4000));
+    Assert::falsity(tree.colides(0x5000, 0x3000));
+
+    Assert::truth(tree.remove(0x4000));
+    Assert::falsity(tree.remove(0x4000));
+    Assert::truth(tree.containing(0x4000) == nullptr);
+}
+
+TEST(range_tree_finds_the_first_gap_that_fits)
+{
+    RangeTree<int> tree{0, 100};
+
+    Assert::equal(tree.find_gap(100).unwrap(), 0u);
+    Assert::falsity(tree.find_gap(101).present());
+
+    tree.insert(0, 10, 0);
+    tree.insert(12, 8, 0);
+    tree.insert(25, 5, 0);
+    tree.insert(60, 30, 0);
+
+    Assert::equal(tree.find_gap(2).unwrap(), 10u);
+    Assert::equal(tree.find_gap(3).unwrap(), 20u);
+    Assert::equal(tree.find_gap(10).unwrap(), 30u);
+    Assert::equal(tree.find_gap(30).unwrap(), 30u);
+    Assert::falsity(tree.find_gap(31).present());
+}
+
+TEST(range_tree_matches_a_slot_map)
+{
+    uint32_t state = 0x5eed;
+
+    RangeTree<uint64_t> tree{0, SLOTS};
+
+    // The base of the range covering each slot, or SLOTS.
+    uint64_t slots[SLOTS];
+
+    for (auto &slot : slots)
+    {
+        slot = SLOTS;
+    }
+
+    for (int step = 0; step < 4000; step++)
+    {
+        uint64_t base = next(state) % SLOTS;
+        uint64_t size = next(state) % 8 + 1;
+
+        if (next(state) % 2 && base + size <= SLOTS && !tree.colides(base, size))
+        {
+            tree.insert(base, size, base);
+
+            for (uint64_t i = base; i < base + size; i++)
+            {
+                slots[i] = base;
+            }
+        }
+        else if (slots[base] != SLOTS)
+        {
+            uint64_t removed = slots[base];
+            Assert::truth(tree.remove(removed));
+
+            for (auto &slot : slots)
+            {
+                if (slot == removed)
+                {
+                    slot = SLOTS;
+                }
+            }
+        }
+
+        for (uint64_t i = 0; i < SLOTS; i++)
+        {
+            auto *found = tree.containing(i);
+            Assert::equal(found ? *found : SLOTS, slots[i]);
+        }
+
+        uint64_t wanted = next(state) % 12 + 1;
+        uint64_t expected = SLOTS;
+        uint64_t run = 0;
+
+        for (uint64_t i = 0; i < SLOTS; i++)
+        {
+            run = slots[i] == SLOTS ? run + 1 : 0;
+
+            if (run == wanted)
+            {
+                expected = i + 1 - wanted;
+                break;
+            }
+        }
+
+        Assert::equal(tree.find_gap(wanted).unwrap_or(SLOTS), expected);
+    }
+}
@@ -0,0 +1,25 @@
+#include <libutils/Ring.h>
+
+#include "tests/Driver.h"
+
+TEST(ring_reads_and_writes_across_the_end)
+{
+    Ring<char> ring{8};
+    char buffer[8];
+
+    Assert::equal(ring.write("abcdef", 6), 6);
+    Assert::equal(ring.read(buffer, 4), 4);
+    Assert::equal(buffer[3], 'd');
+
+    // Only six bytes fit, two at the end and four at the beginning.
+    Assert::equal(ring.write("ghijklmn", 8), 6);
+    Assert::truth(ring.full());
+
+    Assert::equal(ring.read(buffer, 8), 8);
+    Assert::truth(ring.empty());
+    Assert::equal(buffer[0], 'e');
+    Assert::equal(buffer[2], 'g');
+    Assert::equal(buffer[7], 'l');
+
+    Assert::equal(ring.read(buffer, 8), 0);
+}
@@ -2,6 +2,7 @@ UTILITIES = \
 	BASENAME \
 	CAT \
 	CLEAR \
+	CLONEBENCH \
 	CP \
 	CRC32 \
 	DIRNAME \
@@ -23,11 +24,14 @@ UTILITIES = \
 	NETCTL\
 	NOW \
 	OPEN \
+	PAGEBENCH \
 	PANIC \
+	PIPEBENCH \
 	PLAY \
 	POWERCTL \
 	PWD	\
 	RMDIR \
+	SCHEDBENCH \
 	SETTINGSCTL \
 	SYSFETCH \
 	TAC \
@@ -49,6 +53,9 @@ CAT_NAME = cat
 CLEAR_LIBS = system io
 CLEAR_NAME = clear
 
+CLONEBENCH_LIBS = system io
+CLONEBENCH_NAME = clonebench
+
 CP_LIBS = system io
 CP_NAME = cp
 
@@ -103,9 +110,18 @@ NOW_NAME = now
 OPEN_LIBS = system io
 OPEN_NAME = open
 
+PAGEBENCH_LIBS = graphic png system io
+PAGEBENCH_NAME = pagebench
+
 PANIC_LIBS = system io
 PANIC_NAME = panic
 
+PIPEBENCH_LIBS = system io
+PIPEBENCH_NAME = pipebench
+
+SCHEDBENCH_LIBS = system io
+SCHEDBENCH_NAME = schedbench
+
 RMDIR_LIBS = system io
 RMDIR_NAME = rmdir
 
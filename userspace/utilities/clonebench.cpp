@@ -0,0 +1,113 @@
+#include <abi/Syscalls.h>
+#include <string.h>
+
+#include <libio/Streams.h>
+#include <libsystem/process/Process.h>
+
+static constexpr size_t HEAP_SIZES[] = {0, 1024 * 1024, 4 * 1024 * 1024, 16 * 1024 * 1024, 64 * 1024 * 1024};
+static constexpr int ROUNDS = 16;
+
+struct Sample
+{
+    uint32_t clone;
+    uint32_t write;
+};
+
+// Clones with `size` bytes of heap, then writes to all of it while the child
+// is still around, which is when copy-on-write memory gets copied.
+static bool measure(uint8_t *heap, size_t size, Sample &sample)
+{
+    int reader = HANDLE_INVALID_ID;
+    int writer = HANDLE_INVALID_ID;
+
+    if (hj_create_pipe(&reader, &writer, 0) != SUCCESS)
+    {
+        return false;
+    }
+
+    uint32_t start = 0;
+    hj_system_tick(&start);
+
+    int pid = -1;
+
+    if (hj_process_clone(&pid, TASK_WAITABLE) != SUCCESS)
+    {
+        hj_handle_close(reader);
+        hj_handle_close(writer);
+        return false;
+    }
+
+    if (pid == 0)
+    {
+        // Wait for the parent to be done writing.
+        hj_handle_close(writer);
+
+        char byte;
+        size_t read = 0;
+        hj_handle_read(reader, &byte, 1, &read);
+
+        hj_process_exit(PROCESS_SUCCESS);
+    }
+
+    uint32_t cloned = 0;
+    hj_system_tick(&cloned);
+
+    memset(heap, 0x5a, size);
+
+    uint32_t written = 0;
+    hj_system_tick(&written);
+
+    hj_handle_close(reader);
+    hj_handle_close(writer);
+
+    int exit_value = 0;
+    process_wait(pid, &exit_value);
+
+    sample.clone += cloned - start;
+    sample.write += written - cloned;
+
+    return true;
+}
+
+int main(int argc, char const *argv[])
+{
+    UNUSED(argc);
+    UNUSED(argv);
+
+    // Ticks are milliseconds, the times are for all the rounds.
+    IO::outln("heap KiB\tclone ms\twrite ms\t({} rounds)", ROUNDS);
+
+    for (size_t size : HEAP_SIZES)
+    {
+        uintptr_t address = 0;
+
+        if (size && hj_memory_alloc(size, MEMORY_NONE, &address) != SUCCESS)
+        {
+            IO::errln("clonebench: failed to allocate {} bytes", size);
+            return PROCESS_FAILURE;
+        }
+
+        auto *heap = reinterpret_cast<uint8_t *>(address);
+        memset(heap, 0xa5, size);
+
+        Sample sample = {};
+
+        for (int i = 0; i < ROUNDS; i++)
+        {
+            if (!measure(heap, size, sample))
+            {
+                IO::errln("clonebench: clone failed");
+                return PROCESS_FAILURE;
+            }
+        }
+
+        IO::outln("{}\t{}\t{}", size / 1024, sample.clone, sample.write);
+
+        if (size)
+        {
+            hj_memory_free(address);
+        }
+    }
+
+    return PROCESS_SUCCESS;
+}
@@ -92,6 +92,56 @@ HjResult gfxmode_set_compositor(IOCallDisplayModeArgs mode)
     return HjResult::SUCCESS;
 }
 
+HjResult frames_get_compositor(CompositorFrameStats &stats)
+{
+    auto connection = TRY(IO::Socket::connect("/session/compositor.ipc"));
+
+    CompositorMessage message{
+        .type = COMPOSITOR_MESSAGE_GET_FRAME_STATS,
+        .greetings = {},
+    };
+
+    TRY(connection.write(&message, sizeof(message)));
+
+    // The greetings and the events of other windows come first.
+    do
+    {
+        TRY(connection.read(&message, sizeof(message)));
+    } while (message.type != COMPOSITOR_MESSAGE_FRAME_STATS);
+
+    stats = message.frame_stats;
+
+    CompositorMessage goodbye_message{
+        .type = COMPOSITOR_MESSAGE_GOODBYE,
+        .greetings = {},
+    };
+
+    TRY(connection.write(&goodbye_message, sizeof(goodbye_message)));
+
+    return HjResult::SUCCESS;
+}
+
+Shell::ArgParseResult frames_get()
+{
+    CompositorFrameStats stats;
+
+    if (frames_get_compositor(stats) != HjResult::SUCCESS)
+    {
+        IO::errln("Error: could not reach the compositor");
+        return Shell::ArgParseResult::FAILURE;
+    }
+
+    IO::outln("Interval: {}ms\nFrames: {}\nDropped: {}\nMin: {}ms\nAverage: {}ms\nP99: {}ms\n",
+        stats.interval,
+        stats.frames,
+        stats.dropped,
+        stats.min,
+        stats.average,
+        stats.p99);
+
+    return Shell::ArgParseResult::SHOULD_FINISH;
+}
+
 HjResult gfxmode_set_iocall(Stream *device, IOCallDisplayModeArgs mode)
 {
     if (stream_call(device, IOCALL_DISPLAY_SET_MODE, &mode) != SUCCESS)
@@ -154,6 +204,9 @@ int main(int argc, const char *argv[])
     args.option_string('s', "set", "Set graphic mode.", [&](String &mode)
         { return gfxmode_set(mode); });
 
+    args.option('f', "frames", "Show how long the compositor takes to render its frames.", [](auto &)
+        { return frames_get(); });
+
     args.epiloge("Options can be combined.");
 
     return args.eval(argc, argv) == Shell::ArgParseResult::FAILURE
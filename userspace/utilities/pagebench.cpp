@@ -0,0 +1,103 @@
+#include <abi/Syscalls.h>
+#include <string.h>
+
+#include <libgraphic/Painter.h>
+#include <libio/Streams.h>
+
+static constexpr int WIDTH = 1920;
+static constexpr int HEIGHT = 1080;
+static constexpr int CLEAR_ROUNDS = 64;
+
+static constexpr size_t MEMSET_SIZE = 64 * 1024 * 1024;
+static constexpr int MEMSET_ROUNDS = 16;
+
+static uint32_t now()
+{
+    uint32_t tick = 0;
+    hj_system_tick(&tick);
+    return tick;
+}
+
+// Memory from hj_memory_alloc gets its pages as they are touched, a whole
+// large page at a time where the arch has them and the allocation covers
+// one. Getting a handle on it gathers it in a single object instead.
+static uint8_t *allocate(size_t size, bool gathered)
+{
+    uintptr_t address = 0;
+
+    if (hj_memory_alloc(size, MEMORY_NONE, &address) != SUCCESS)
+    {
+        return nullptr;
+    }
+
+    memset(reinterpret_cast<void *>(address), 0, size);
+
+    int handle = -1;
+
+    if (gathered && hj_memory_get_handle(address, &handle) != SUCCESS)
+    {
+        hj_memory_free(address);
+        return nullptr;
+    }
+
+    return reinterpret_cast<uint8_t *>(address);
+}
+
+static uint32_t measure_clear(uint8_t *pixels)
+{
+    auto bitmap = Graphic::Bitmap::create_static(WIDTH, HEIGHT, reinterpret_cast<Graphic::Color *>(pixels));
+    Graphic::Painter painter{*bitmap};
+
+    uint32_t start = now();
+
+    for (int i = 0; i < CLEAR_ROUNDS; i++)
+    {
+        painter.clear(i % 2 ? Graphic::Colors::BLACK : Graphic::Colors::WHITE);
+    }
+
+    return now() - start;
+}
+
+static uint32_t measure_memset(uint8_t *data)
+{
+    uint32_t start = now();
+
+    for (int i = 0; i < MEMSET_ROUNDS; i++)
+    {
+        memset(data, i, MEMSET_SIZE);
+    }
+
+    return now() - start;
+}
+
+int main(int argc, char const *argv[])
+{
+    UNUSED(argc);
+    UNUSED(argv);
+
+    // Ticks are milliseconds, the times are for all the rounds.
+    IO::outln("memory\tclear ms\tmemset ms\t({} clears of {}x{}, {} memsets of {} MiB)",
+              CLEAR_ROUNDS, WIDTH, HEIGHT, MEMSET_ROUNDS, MEMSET_SIZE / (1024 * 1024));
+
+    for (bool gathered : {false, true})
+    {
+        auto *pixels = allocate(WIDTH * HEIGHT * sizeof(Graphic::Color), gathered);
+        auto *data = allocate(MEMSET_SIZE, gathered);
+
+        if (!pixels || !data)
+        {
+            IO::errln("pagebench: failed to allocate memory");
+            return PROCESS_FAILURE;
+        }
+
+        uint32_t clear = measure_clear(pixels);
+        uint32_t set = measure_memset(data);
+
+        IO::outln("{}\t{}\t{}", gathered ? "gathered" : "paged", clear, set);
+
+        hj_memory_free(reinterpret_cast<uintptr_t>(pixels));
+        hj_memory_free(reinterpret_cast<uintptr_t>(data));
+    }
+
+    return PROCESS_SUCCESS;
+}
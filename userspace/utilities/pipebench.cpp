@@ -0,0 +1,121 @@
+#include <abi/Syscalls.h>
+
+#include <libio/Streams.h>
+#include <libsystem/process/Process.h>
+
+static constexpr size_t CAPACITIES[] = {4096, 16 * 1024, 64 * 1024, 256 * 1024, 1024 * 1024};
+static constexpr size_t TRANSFER_SIZE = 64 * 1024 * 1024;
+static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+static char _chunk[CHUNK_SIZE];
+
+static void write_everything(int writer)
+{
+    size_t written = 0;
+
+    while (written < TRANSFER_SIZE)
+    {
+        size_t chunk_written = 0;
+
+        if (hj_handle_write(writer, _chunk, CHUNK_SIZE, &chunk_written) != SUCCESS)
+        {
+            break;
+        }
+
+        written += chunk_written;
+    }
+}
+
+static size_t read_everything(int reader)
+{
+    size_t read = 0;
+
+    while (true)
+    {
+        size_t chunk_read = 0;
+
+        if (hj_handle_read(reader, _chunk, CHUNK_SIZE, &chunk_read) != SUCCESS ||
+            chunk_read == 0)
+        {
+            return read;
+        }
+
+        read += chunk_read;
+    }
+}
+
+// Returns the throughput in KiB/s, or -1 if something went wrong.
+static int64_t measure(size_t capacity)
+{
+    int reader = HANDLE_INVALID_ID;
+    int writer = HANDLE_INVALID_ID;
+
+    if (hj_create_pipe(&reader, &writer, capacity) != SUCCESS)
+    {
+        return -1;
+    }
+
+    uint32_t start = 0;
+    hj_system_tick(&start);
+
+    int pid = -1;
+
+    if (hj_process_clone(&pid, TASK_WAITABLE) != SUCCESS)
+    {
+        hj_handle_close(reader);
+        hj_handle_close(writer);
+        return -1;
+    }
+
+    if (pid == 0)
+    {
+        hj_handle_close(reader);
+        write_everything(writer);
+        hj_handle_close(writer);
+        hj_process_exit(PROCESS_SUCCESS);
+    }
+
+    // The reader only sees the end of the stream once the child closed the
+    // last writer.
+    hj_handle_close(writer);
+
+    size_t read = read_everything(reader);
+
+    uint32_t end = 0;
+    hj_system_tick(&end);
+
+    int exit_value = 0;
+    process_wait(pid, &exit_value);
+    hj_handle_close(reader);
+
+    if (read != TRANSFER_SIZE)
+    {
+        return -1;
+    }
+
+    // Ticks are milliseconds.
+    return (int64_t)(TRANSFER_SIZE / 1024) * 1000 / MAX(end - start, 1u);
+}
+
+int main(int argc, char const *argv[])
+{
+    UNUSED(argc);
+    UNUSED(argv);
+
+    IO::outln("capacity\tKiB/s");
+
+    for (size_t capacity : CAPACITIES)
+    {
+        auto throughput = measure(capacity);
+
+        if (throughput < 0)
+        {
+            IO::errln("pipebench: transfer through a {} bytes pipe failed", capacity);
+            return PROCESS_FAILURE;
+        }
+
+        IO::outln("{}\t{}", capacity, throughput);
+    }
+
+    return PROCESS_SUCCESS;
+}
@@ -0,0 +1,107 @@
+#include <abi/Syscalls.h>
+
+#include <libio/File.h>
+#include <libio/Streams.h>
+#include <libjson/Json.h>
+#include <libsystem/process/Process.h>
+#include <libutils/Vec.h>
+
+static constexpr int BLOCKED_TASKS_COUNTS[] = {0, 50, 100, 200, 400};
+static constexpr int SAMPLE_DURATION = 1000;
+
+struct Sample
+{
+    int64_t schedules;
+    int64_t cycles;
+};
+
+static Sample sample()
+{
+    IO::File file{"/system/scheduler", HJ_OPEN_READ};
+    auto stats = Json::parse(file);
+
+    return {
+        stats.get("schedules").as_integer(),
+        stats.get("cycles").as_integer(),
+    };
+}
+
+static Vec<int> spawn_blocked_tasks(int reader, int count)
+{
+    Vec<int> tasks;
+
+    for (int i = 0; i < count; i++)
+    {
+        int pid = -1;
+
+        if (hj_process_clone(&pid, TASK_WAITABLE) != SUCCESS)
+        {
+            IO::errln("schedbench: clone failed");
+            break;
+        }
+
+        if (pid == 0)
+        {
+            // Nobody ever writes to this pipe, so this blocks until we are canceled.
+            char byte;
+            size_t read = 0;
+            hj_handle_read(reader, &byte, 1, &read);
+            hj_process_exit(PROCESS_SUCCESS);
+        }
+
+        tasks.push_back(pid);
+    }
+
+    return tasks;
+}
+
+static void cancel_tasks(Vec<int> &tasks)
+{
+    for (size_t i = 0; i < tasks.count(); i++)
+    {
+        int exit_value = 0;
+        process_cancel(tasks[i]);
+        process_wait(tasks[i], &exit_value);
+    }
+}
+
+int main(int argc, char const *argv[])
+{
+    UNUSED(argc);
+    UNUSED(argv);
+
+    int reader = HANDLE_INVALID_ID;
+    int writer = HANDLE_INVALID_ID;
+
+    if (hj_create_pipe(&reader, &writer, 0) != SUCCESS)
+    {
+        IO::errln("schedbench: failed to create a pipe");
+        return PROCESS_FAILURE;
+    }
+
+    IO::outln("blocked\tschedules\tcycles/schedule");
+
+    for (int count : BLOCKED_TASKS_COUNTS)
+    {
+        auto tasks = spawn_blocked_tasks(reader, count);
+
+        // Let the system settle down after the clone storm.
+        process_sleep(100);
+
+        auto before = sample();
+        process_sleep(SAMPLE_DURATION);
+        auto after = sample();
+
+        auto schedules = after.schedules - before.schedules;
+        auto cycles = after.cycles - before.cycles;
+
+        IO::outln("{}\t{}\t{}", tasks.count(), schedules, schedules ? cycles / schedules : 0);
+
+        cancel_tasks(tasks);
+    }
+
+    hj_handle_close(reader);
+    hj_handle_close(writer);
+
+    return PROCESS_SUCCESS;
+}